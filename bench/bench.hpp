@@ -0,0 +1,318 @@
+#pragma once
+
+// A tiny header-only benchmark harness shared by every bench_*.cpp.
+//
+// Each benchmark body receives a `bench::state` and drives its operations
+// through `state::loop`, which times them in small chunks.  The chunk timings
+// give the latency percentiles, the sum gives the throughput.
+//
+// Command line (all optional):
+//   --filter=<substr>   only run benchmarks whose name contains <substr>
+//   --max-bytes=<n>     largest working set to try, accepts K/M/G suffixes
+//   --min-time=<sec>    repeat each benchmark until this much time is measured
+//   --quick             smoke-test mode: tiny working sets, single repetition
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+template <class T>
+inline void do_not_optimize(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<volatile const char *>(&value);
+#endif
+}
+
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+using clock = std::chrono::steady_clock;
+
+class state {
+public:
+    // Operations per timed chunk; small enough that a single slow operation
+    // (a reallocation, a rehash) shows up in the tail percentiles.
+    static constexpr std::size_t chunk = 32;
+
+    template <class Op>
+    void loop(std::size_t n, Op &&op) {
+        std::size_t i = 0;
+        while (i < n) {
+            std::size_t end = std::min(n, i + chunk);
+            std::size_t count = end - i;
+            clock::time_point t0 = clock::now();
+            for (; i < end; ++i) {
+                op(i);
+            }
+            clock::time_point t1 = clock::now();
+            double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+            _samples.push_back(ns / static_cast<double>(count));
+            _total_ns += ns;
+            _ops += count;
+        }
+    }
+
+    // Records `count` operations that took `ns` in total, for bodies that
+    // time themselves (several threads sharing one wall-clock interval).
+    void record(std::size_t count, double ns) {
+        _samples.push_back(ns / static_cast<double>(count));
+        _total_ns += ns;
+        _ops += count;
+    }
+
+    std::size_t ops() const noexcept {
+        return _ops;
+    }
+
+    double total_ns() const noexcept {
+        return _total_ns;
+    }
+
+    double percentile(double p) {
+        if (_samples.empty()) {
+            return 0;
+        }
+        std::size_t k = static_cast<std::size_t>(
+            p / 100.0 * static_cast<double>(_samples.size() - 1));
+        std::nth_element(_samples.begin(), _samples.begin() + k,
+                         _samples.end());
+        return _samples[k];
+    }
+
+private:
+    std::vector<double> _samples;
+    double _total_ns = 0;
+    std::size_t _ops = 0;
+};
+
+class suite {
+public:
+    suite(int argc, char **argv) {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (arg.starts_with("--filter=")) {
+                _filter = arg.substr(9);
+            } else if (arg.starts_with("--max-bytes=")) {
+                _max_bytes = parse_bytes(arg.substr(12));
+            } else if (arg.starts_with("--min-time=")) {
+                _min_time_ns = std::strtod(std::string(arg.substr(11)).c_str(),
+                                           nullptr) *
+                               1e9;
+            } else if (arg == "--quick") {
+                _max_bytes = 256 << 10;
+                _min_time_ns = 0;
+            } else {
+                std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+                std::exit(2);
+            }
+        }
+        std::printf("%-52s %12s %10s %9s %9s %9s %9s\n", "benchmark", "n",
+                    "Mops/s", "ns/op", "p50", "p90", "p99");
+    }
+
+    // Element counts for working sets from L1-resident (16 KiB) up to far
+    // beyond a typical last-level cache (1 GiB), capped by --max-bytes.
+    std::vector<std::size_t> sizes(std::size_t elem_bytes) const {
+        static constexpr std::size_t working_sets[] = {
+            std::size_t(16) << 10, std::size_t(256) << 10,
+            std::size_t(4) << 20,  std::size_t(64) << 20,
+            std::size_t(1) << 30,
+        };
+        std::vector<std::size_t> result;
+        for (std::size_t bytes: working_sets) {
+            if (bytes <= _max_bytes) {
+                result.push_back(std::max<std::size_t>(bytes / elem_bytes, 1));
+            }
+        }
+        return result;
+    }
+
+    bool enabled(std::string_view name) const noexcept {
+        return _filter.empty() || name.find(_filter) != std::string_view::npos;
+    }
+
+    // Runs `fn(state &)` repeatedly until --min-time worth of operations have
+    // been measured, then prints one result line.  `n` is only reported.
+    template <class Fn>
+    void run(std::string const &name, std::size_t n, Fn &&fn) {
+        if (!enabled(name)) {
+            return;
+        }
+        state st;
+        int reps = 0;
+        do {
+            fn(st);
+            ++reps;
+        } while (st.total_ns() < _min_time_ns && reps < _max_reps);
+        double ns_per_op =
+            st.ops() ? st.total_ns() / static_cast<double>(st.ops()) : 0;
+        std::printf("%-52s %12zu %10.2f %9.2f %9.2f %9.2f %9.2f\n",
+                    name.c_str(), n, ns_per_op ? 1e3 / ns_per_op : 0,
+                    ns_per_op, st.percentile(50), st.percentile(90),
+                    st.percentile(99));
+        std::fflush(stdout);
+    }
+
+private:
+    static std::size_t parse_bytes(std::string_view text) {
+        std::string s(text);
+        char *end = nullptr;
+        double value = std::strtod(s.c_str(), &end);
+        switch (end && *end ? *end : ' ') {
+        case 'k':
+        case 'K': value *= 1 << 10; break;
+        case 'm':
+        case 'M': value *= 1 << 20; break;
+        case 'g':
+        case 'G': value *= 1 << 30; break;
+        default:  break;
+        }
+        return static_cast<std::size_t>(value);
+    }
+
+    std::string_view _filter;
+    std::size_t _max_bytes = std::size_t(64) << 20;
+    double _min_time_ns = 2e8;
+    int _max_reps = 1000;
+};
+
+// Runs `op(t, i)` for i in [0, n) on each of `threads` threads and records
+// threads * n operations over the wall-clock time from releasing them all at
+// once to the last one finishing. Starting the threads is not timed.
+template <class Op>
+inline void parallel_loop(state &st, std::size_t threads, std::size_t n,
+                          Op &&op) {
+    std::atomic<bool> go = false;
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                op(t, i);
+            }
+        });
+    }
+    clock::time_point t0 = clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+    clock::time_point t1 = clock::now();
+    st.record(threads * n,
+              std::chrono::duration<double, std::nano>(t1 - t0).count());
+}
+
+// Benchmark element types: a scalar, a cache-line sized POD and a string that
+// does not fit into the small-string buffer.
+struct pod64 {
+    std::uint64_t key;
+    char payload[56];
+
+    bool operator==(pod64 const &that) const noexcept {
+        return key == that.key;
+    }
+
+    bool operator<(pod64 const &that) const noexcept {
+        return key < that.key;
+    }
+};
+
+static_assert(sizeof(pod64) == 64);
+
+template <class T>
+inline T make_value(std::uint64_t i);
+
+template <>
+inline int make_value<int>(std::uint64_t i) {
+    return static_cast<int>(i);
+}
+
+template <>
+inline pod64 make_value<pod64>(std::uint64_t i) {
+    pod64 value;
+    value.key = i;
+    std::memset(value.payload, static_cast<int>(i & 0x7f),
+                sizeof(value.payload));
+    return value;
+}
+
+template <>
+inline std::string make_value<std::string>(std::uint64_t i) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "key-%020llu",
+                  static_cast<unsigned long long>(i));
+    return buf;
+}
+
+inline std::uint64_t weight(int value) noexcept {
+    return static_cast<std::uint64_t>(value);
+}
+
+inline std::uint64_t weight(pod64 const &value) noexcept {
+    return value.key;
+}
+
+inline std::uint64_t weight(std::string const &value) noexcept {
+    return value.size() + static_cast<unsigned char>(value.back());
+}
+
+template <class T>
+inline char const *type_name();
+
+template <>
+inline char const *type_name<int>() {
+    return "int";
+}
+
+template <>
+inline char const *type_name<pod64>() {
+    return "pod64";
+}
+
+template <>
+inline char const *type_name<std::string>() {
+    return "string";
+}
+
+// `n` distinct values in a deterministic pseudo-random order.
+template <class T>
+inline std::vector<T> shuffled_values(std::size_t n, std::uint64_t seed = 1) {
+    std::vector<std::uint64_t> keys(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        keys[i] = i;
+    }
+    std::uint64_t x = seed * 0x9e3779b97f4a7c15ull + 1;
+    for (std::size_t i = n; i > 1; --i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        std::swap(keys[i - 1], keys[x % i]);
+    }
+    std::vector<T> values;
+    values.reserve(n);
+    for (std::uint64_t key: keys) {
+        values.push_back(make_value<T>(key));
+    }
+    return values;
+}
+
+} // namespace bench
@@ -0,0 +1,82 @@
+#include "bench.hpp"
+#include <any>
+#include <map>
+#include <string>
+#include <utility/any.hpp>
+#include <vector>
+
+// A plugin property bag: map<string, any> holding small values (ints, doubles,
+// pointers). The fill rows store n mixed values into a vector and read the
+// ints back with any_cast; the cast rows only cast values already in the bag;
+// the copy rows copy every value out of the bag. Marcus::any keeps these
+// values inline and checks the type by comparing a per-type table pointer.
+
+namespace {
+
+int const *get_int(Marcus::any const *a) {
+    return Marcus::any_cast<int>(a);
+}
+
+int const *get_int(std::any const *a) {
+    return std::any_cast<int>(a);
+}
+
+template <class Any>
+void bench_any(bench::suite &s, std::string const &name, std::size_t n) {
+    s.run(name + "/fill", n, [&](bench::state &st) {
+        std::vector<Any> values;
+        values.reserve(n);
+        st.loop(n, [&](std::size_t i) {
+            if (i % 3 == 0) {
+                values.emplace_back(int(i));
+            } else if (i % 3 == 1) {
+                values.emplace_back(double(i));
+            } else {
+                values.emplace_back(static_cast<void *>(values.data()));
+            }
+        });
+        std::uint64_t sum = 0;
+        st.loop(n, [&](std::size_t i) {
+            if (int const *p = get_int(&values[i])) {
+                sum += std::uint64_t(*p);
+            }
+        });
+        bench::do_not_optimize(sum);
+    });
+
+    std::map<std::string, Any> bag;
+    std::vector<Any const *> slots;
+    slots.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto it = bag.emplace("prop." + std::to_string(i), Any(int(i))).first;
+        slots.push_back(&it->second);
+    }
+    s.run(name + "/cast", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        st.loop(n, [&](std::size_t i) {
+            if (int const *p = get_int(slots[i])) {
+                sum += std::uint64_t(*p);
+            }
+        });
+        bench::do_not_optimize(sum);
+    });
+    s.run(name + "/copy", n, [&](bench::state &st) {
+        std::vector<Any> copy;
+        copy.reserve(n);
+        st.loop(n, [&](std::size_t i) {
+            copy.push_back(*slots[i]);
+        });
+        bench::do_not_optimize(copy.data());
+    });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    for (std::size_t n: s.sizes(80)) {
+        std::string suffix = "/" + std::to_string(n);
+        bench_any<Marcus::any>(s, "Marcus::any" + suffix, n);
+        bench_any<std::any>(s, "std::any" + suffix, n);
+    }
+}
@@ -0,0 +1,96 @@
+#include "bench.hpp"
+#include <containers/deque.hpp>
+#include <containers/list.hpp>
+#include <containers/map.hpp>
+#include <containers/vector.hpp>
+#include <memory/arena_allocator.hpp>
+#include <memory/shared_ptr.hpp>
+
+// Request-scoped workloads: each iteration builds a few short-lived containers,
+// reads them once and throws everything away. With the arena the teardown is
+// a single reset(); with std::allocator every node goes back to malloc.
+
+namespace {
+
+struct Heap {
+    template <class T>
+    using alloc = std::allocator<T>;
+
+    template <class T>
+    alloc<T> get() {
+        return alloc<T>();
+    }
+
+    void reset() {}
+};
+
+struct Arena {
+    template <class T>
+    using alloc = Marcus::arena_allocator<T>;
+
+    Marcus::monotonic_arena arena;
+
+    template <class T>
+    alloc<T> get() {
+        return alloc<T>(arena);
+    }
+
+    void reset() {
+        arena.reset();
+    }
+};
+
+template <class R>
+std::uint64_t handle_request(R &r, std::vector<int> const &keys,
+                             std::size_t base, std::size_t len) {
+    std::uint64_t sum = 0;
+    {
+        using A = typename R::template alloc<int>;
+        Marcus::vector<int, A> v(r.template get<int>());
+        Marcus::deque<int, A> d(r.template get<int>());
+        Marcus::list<int, A> l(r.template get<int>());
+        using P = std::pair<const int, int>;
+        Marcus::map<int, int, std::less<int>, typename R::template alloc<P>> m(
+            r.template get<P>());
+        for (std::size_t j = 0; j < len; ++j) {
+            int k = keys[base + j];
+            v.push_back(k);
+            d.push_back(k);
+            l.push_back(k);
+            m[k] = int(j);
+        }
+        auto sp = Marcus::allocate_shared<std::uint64_t>(
+            r.template get<std::uint64_t>(), v.size());
+        for (int x: l) {
+            sum += std::uint64_t(x);
+        }
+        sum += *sp + m.size() + d.back() + v.front();
+    }
+    r.reset();
+    return sum;
+}
+
+template <class R>
+void bench_requests(bench::suite &s, std::string const &name,
+                    std::vector<int> const &keys, std::size_t len) {
+    std::size_t n = keys.size() / len;
+    s.run(name + "/request" + std::to_string(len), n, [&](bench::state &st) {
+        R r;
+        std::uint64_t sum = 0;
+        st.loop(n, [&](std::size_t i) {
+            sum += handle_request(r, keys, i * len, len);
+        });
+        bench::do_not_optimize(sum);
+    });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    std::vector<int> const keys = bench::shuffled_values<int>(1 << 16);
+    for (std::size_t len: {16, 128, 1024}) {
+        bench_requests<Heap>(s, "std::allocator", keys, len);
+        bench_requests<Arena>(s, "arena_allocator", keys, len);
+    }
+}
@@ -0,0 +1,98 @@
+#include "bench.hpp"
+#include <containers/btree_map.hpp>
+#include <containers/map.hpp>
+#include <map>
+#include <string>
+
+// Large ordered indexes: random inserts, point lookups, lower_bound and a
+// range scan of 64 consecutive elements from a random start. btree_map (with
+// the default 256-byte and a 128-byte node) against the red-black
+// Marcus::map and std::map. The insert row times one whole build of n
+// elements; the scan row counts one element visited as one op.
+
+namespace {
+
+template <class C, class T>
+void bench_index(bench::suite &s, std::string const &name,
+                 std::vector<T> const &values, std::vector<T> const &misses) {
+    std::size_t n = values.size();
+    s.run(name + "/insert", n, [&](bench::state &st) {
+        std::size_t total = 0;
+        st.loop(1, [&](std::size_t) {
+            C c;
+            for (std::size_t i = 0; i < n; ++i) {
+                c.emplace(values[i], int(i));
+            }
+            total += c.size();
+        });
+        bench::do_not_optimize(total);
+    });
+    C table;
+    for (std::size_t i = 0; i < n; ++i) {
+        table.emplace(values[i], int(i));
+    }
+    C const &ctable = table;
+    s.run(name + "/find_hit", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        st.loop(n, [&](std::size_t i) {
+            sum += ctable.find(values[n - 1 - i])->second;
+        });
+        bench::do_not_optimize(sum);
+    });
+    s.run(name + "/lower_bound", n, [&](bench::state &st) {
+        std::size_t hits = 0;
+        st.loop(n, [&](std::size_t i) {
+            hits += ctable.lower_bound(misses[i]) != ctable.end();
+        });
+        bench::do_not_optimize(hits);
+    });
+    constexpr std::size_t span = 64;
+    s.run(name + "/scan64", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        std::size_t i = 0;
+        st.loop(n, [&](std::size_t) {
+            auto it = ctable.lower_bound(misses[i++ % n]);
+            for (std::size_t k = 0; k < span && it != ctable.end(); ++k) {
+                sum += it->second;
+                ++it;
+            }
+        });
+        bench::do_not_optimize(sum);
+    });
+    s.run(name + "/iterate", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        auto it = ctable.begin();
+        st.loop(n, [&](std::size_t) {
+            sum += it->second;
+            ++it;
+        });
+        bench::do_not_optimize(sum);
+    });
+}
+
+template <class T>
+void bench_type(bench::suite &s) {
+    std::string suffix = std::string("<") + bench::type_name<T>() + ">";
+    for (std::size_t n: s.sizes(sizeof(T) + sizeof(int))) {
+        std::vector<T> all = bench::shuffled_values<T>(2 * n);
+        std::vector<T> const values(all.begin(), all.begin() + n);
+        std::vector<T> const misses(all.begin() + n, all.end());
+        bench_index<Marcus::btree_map<T, int>>(s, "Marcus::btree_map" + suffix,
+                                               values, misses);
+        bench_index<Marcus::btree_map<T, int, std::less<T>,
+                                      std::allocator<std::pair<const T, int>>,
+                                      128>>(s, "Marcus::btree_map_128" + suffix,
+                                            values, misses);
+        bench_index<Marcus::map<T, int>>(s, "Marcus::map" + suffix, values,
+                                         misses);
+        bench_index<std::map<T, int>>(s, "std::map" + suffix, values, misses);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    bench_type<int>(s);
+    bench_type<std::string>(s);
+}
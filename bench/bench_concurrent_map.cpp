@@ -0,0 +1,98 @@
+#include "bench.hpp"
+#include <atomic>
+#include <containers/concurrent_map.hpp>
+#include <containers/map.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+// Read-mostly ordered index: 1 to all hardware threads doing point lookups
+// while one background thread keeps overwriting random keys. The lock-free
+// Marcus::concurrent_map (epoch-protected readers, path-copying writer)
+// against Marcus::map behind a std::shared_mutex and behind a std::mutex.
+// One op is one lookup; Mops/s is the aggregate over all reader threads, so
+// flat rows mean the readers serialize.
+
+namespace {
+
+struct locked_map {
+    Marcus::map<int, int> map;
+    mutable std::shared_mutex mutex;
+
+    bool contains(int key) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return map.find(key) != map.end();
+    }
+
+    void insert_or_assign(int key, int value) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        map.insert_or_assign(key, value);
+    }
+};
+
+struct mutex_map {
+    Marcus::map<int, int> map;
+    mutable std::mutex mutex;
+
+    bool contains(int key) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return map.find(key) != map.end();
+    }
+
+    void insert_or_assign(int key, int value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        map.insert_or_assign(key, value);
+    }
+};
+
+template <class C>
+void bench_readers(bench::suite &s, std::string const &name,
+                   std::vector<int> const &keys) {
+    std::size_t n = keys.size();
+    C table;
+    for (std::size_t i = 0; i < n; ++i) {
+        table.insert_or_assign(keys[i], int(i));
+    }
+    std::size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t threads = 1;; threads = std::min(threads * 2, hw)) {
+        std::string row = name + "/readers=" + std::to_string(threads);
+        if (s.enabled(row)) {
+            std::atomic<bool> stop = false;
+            std::thread writer([&] {
+                for (std::size_t i = 0; !stop.load(); ++i) {
+                    table.insert_or_assign(keys[(i * 7) % n], int(i));
+                    std::this_thread::yield();
+                }
+            });
+            std::size_t per_thread = std::max<std::size_t>(n, 1 << 16);
+            s.run(row, n, [&](bench::state &st) {
+                bench::parallel_loop(
+                    st, threads, per_thread, [&](std::size_t t, std::size_t i) {
+                        bench::do_not_optimize(
+                            table.contains(keys[(i + t * 4099) % n]));
+                    });
+            });
+            stop = true;
+            writer.join();
+        }
+        if (threads == hw) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    // A node is about 40 bytes.
+    for (std::size_t n: s.sizes(40)) {
+        std::vector<int> keys = bench::shuffled_values<int>(n);
+        std::string suffix = "<int>/" + std::to_string(n);
+        bench_readers<Marcus::concurrent_map<int, int>>(
+            s, "Marcus::concurrent_map" + suffix, keys);
+        bench_readers<locked_map>(s, "Marcus::map+shared_mutex" + suffix, keys);
+        bench_readers<mutex_map>(s, "Marcus::map+mutex" + suffix, keys);
+    }
+}
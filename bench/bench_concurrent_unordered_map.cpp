@@ -0,0 +1,95 @@
+#include "bench.hpp"
+#include <containers/concurrent_unordered_map.hpp>
+#include <containers/unordered_map.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+// Session-table workload: 1 to all hardware threads, each doing 90% lookups
+// and 10% find_or_emplace/erase on a shared table. The sharded
+// Marcus::concurrent_unordered_map (lock-free reads, per-shard writer locks)
+// against Marcus::unordered_map behind one std::shared_mutex and behind one
+// std::mutex. Mops/s is the aggregate over all threads, so flat rows mean the
+// threads serialize.
+
+namespace {
+
+template <class Mutex>
+struct locked_map {
+    Marcus::unordered_map<int, int> map;
+    mutable Mutex mutex;
+
+    bool contains(int key) const {
+        if constexpr (std::is_same_v<Mutex, std::shared_mutex>) {
+            std::shared_lock<Mutex> lock(mutex);
+            return map.contains(key);
+        } else {
+            std::lock_guard<Mutex> lock(mutex);
+            return map.contains(key);
+        }
+    }
+
+    void find_or_emplace(int key, int value) {
+        std::lock_guard<Mutex> lock(mutex);
+        map.try_emplace(key, value);
+    }
+
+    void erase(int key) {
+        std::lock_guard<Mutex> lock(mutex);
+        map.erase(key);
+    }
+};
+
+template <class C>
+void bench_mixed(bench::suite &s, std::string const &name,
+                 std::vector<int> const &keys) {
+    std::size_t n = keys.size();
+    std::size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t threads = 1;; threads = std::min(threads * 2, hw)) {
+        std::string row = name + "/threads=" + std::to_string(threads);
+        if (s.enabled(row)) {
+            C table;
+            for (std::size_t i = 0; i < n; i += 2) {
+                table.find_or_emplace(keys[i], int(i));
+            }
+            std::size_t per_thread = std::max<std::size_t>(n, 1 << 16);
+            s.run(row, n, [&](bench::state &st) {
+                bench::parallel_loop(
+                    st, threads, per_thread, [&](std::size_t t, std::size_t i) {
+                        int key = keys[(i + t * 4099) % n];
+                        switch (i % 20) {
+                        case 0:
+                            table.find_or_emplace(key, int(i));
+                            break;
+                        case 10:
+                            table.erase(key);
+                            break;
+                        default:
+                            bench::do_not_optimize(table.contains(key));
+                        }
+                    });
+            });
+        }
+        if (threads == hw) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    // A node is about 24 bytes plus its bucket.
+    for (std::size_t n: s.sizes(32)) {
+        std::vector<int> keys = bench::shuffled_values<int>(n);
+        std::string suffix = "<int>/" + std::to_string(n);
+        bench_mixed<Marcus::concurrent_unordered_map<int, int>>(
+            s, "Marcus::concurrent_unordered_map" + suffix, keys);
+        bench_mixed<locked_map<std::shared_mutex>>(
+            s, "Marcus::unordered_map+shared_mutex" + suffix, keys);
+        bench_mixed<locked_map<std::mutex>>(
+            s, "Marcus::unordered_map+mutex" + suffix, keys);
+    }
+}
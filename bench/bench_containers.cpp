@@ -0,0 +1,246 @@
+#include "bench.hpp"
+#include <adaptors/priority_queue.hpp>
+#include <containers/deque.hpp>
+#include <containers/forward_list.hpp>
+#include <containers/list.hpp>
+#include <containers/map.hpp>
+#include <containers/set.hpp>
+#include <containers/vector.hpp>
+#include <deque>
+#include <forward_list>
+#include <list>
+#include <map>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+// Every Marcus container against its std:: counterpart, for each element type
+// and working-set size.  Usage: see the comment at the top of bench.hpp.
+
+namespace {
+
+template <class T>
+std::string label(char const *impl, char const *container) {
+    return std::string(impl) + "::" + container + "<" + bench::type_name<T>() +
+           ">";
+}
+
+// Number of O(n) middle insertions/erasures: keep the big sizes affordable.
+std::size_t shift_ops(std::size_t n) {
+    return std::clamp<std::size_t>((std::size_t(1) << 22) / n, 16, 1024);
+}
+
+std::size_t random_index(std::size_t i, std::size_t size) {
+    return static_cast<std::size_t>((i + 1) * 0x9e3779b97f4a7c15ull >> 17) %
+           size;
+}
+
+template <class C>
+void iterate(bench::suite &s, std::string const &name, C const &c,
+             std::size_t n) {
+    s.run(name + "/iterate", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        auto it = c.begin();
+        st.loop(n, [&](std::size_t) {
+            sum += bench::weight(*it);
+            ++it;
+        });
+        bench::do_not_optimize(sum);
+    });
+}
+
+// vector, deque
+template <class C, bool Front, class T>
+void bench_random_access(bench::suite &s, std::string const &name,
+                         std::vector<T> const &values) {
+    std::size_t n = values.size();
+    s.run(name + "/push_back", n, [&](bench::state &st) {
+        C c;
+        st.loop(n, [&](std::size_t i) { c.push_back(values[i]); });
+        bench::do_not_optimize(c.size());
+    });
+    if constexpr (Front) {
+        s.run(name + "/push_front", n, [&](bench::state &st) {
+            C c;
+            st.loop(n, [&](std::size_t i) { c.push_front(values[i]); });
+            bench::do_not_optimize(c.size());
+        });
+    }
+    C full(values.begin(), values.end());
+    iterate(s, name, full, n);
+    std::size_t ops = shift_ops(n);
+    s.run(name + "/insert", ops, [&](bench::state &st) {
+        C c(values.begin(), values.end());
+        st.loop(ops, [&](std::size_t i) {
+            c.insert(c.begin() + random_index(i, c.size()), values[i]);
+        });
+        bench::do_not_optimize(c.size());
+    });
+    s.run(name + "/erase", std::min(ops, n), [&](bench::state &st) {
+        C c(values.begin(), values.end());
+        st.loop(std::min(ops, n), [&](std::size_t i) {
+            c.erase(c.begin() + random_index(i, c.size()));
+        });
+        bench::do_not_optimize(c.size());
+    });
+}
+
+template <class C, class T>
+void bench_list(bench::suite &s, std::string const &name,
+                std::vector<T> const &values) {
+    std::size_t n = values.size();
+    s.run(name + "/push_back", n, [&](bench::state &st) {
+        C c;
+        st.loop(n, [&](std::size_t i) { c.push_back(values[i]); });
+        bench::do_not_optimize(c.size());
+    });
+    s.run(name + "/push_front", n, [&](bench::state &st) {
+        C c;
+        st.loop(n, [&](std::size_t i) { c.push_front(values[i]); });
+        bench::do_not_optimize(c.size());
+    });
+    C full(values.begin(), values.end());
+    iterate(s, name, full, n);
+    s.run(name + "/insert", n, [&](bench::state &st) {
+        C c(values.begin(), values.begin() + n / 2);
+        auto pos = c.end();
+        st.loop(n, [&](std::size_t i) { pos = c.insert(pos, values[i]); });
+        bench::do_not_optimize(c.size());
+    });
+    s.run(name + "/erase", n, [&](bench::state &st) {
+        C c(values.begin(), values.end());
+        auto pos = c.begin();
+        st.loop(n, [&](std::size_t) { pos = c.erase(pos); });
+        bench::do_not_optimize(c.size());
+    });
+}
+
+template <class C, class T>
+void bench_forward_list(bench::suite &s, std::string const &name,
+                        std::vector<T> const &values) {
+    std::size_t n = values.size();
+    s.run(name + "/push_front", n, [&](bench::state &st) {
+        C c;
+        st.loop(n, [&](std::size_t i) { c.push_front(values[i]); });
+        bench::do_not_optimize(c.empty());
+    });
+    C full(values.begin(), values.end());
+    iterate(s, name, full, n);
+    s.run(name + "/insert_after", n, [&](bench::state &st) {
+        C c;
+        auto pos = c.before_begin();
+        st.loop(n,
+                [&](std::size_t i) { pos = c.insert_after(pos, values[i]); });
+        bench::do_not_optimize(c.empty());
+    });
+    s.run(name + "/erase_after", n, [&](bench::state &st) {
+        C c(values.begin(), values.end());
+        st.loop(n, [&](std::size_t) { c.erase_after(c.before_begin()); });
+        bench::do_not_optimize(c.empty());
+    });
+}
+
+template <class C, class T, class Make>
+void bench_associative(bench::suite &s, std::string const &name,
+                       std::vector<T> const &values, Make make) {
+    std::size_t n = values.size();
+    s.run(name + "/insert", n, [&](bench::state &st) {
+        C c;
+        st.loop(n, [&](std::size_t i) { c.insert(make(values[i])); });
+        bench::do_not_optimize(c.empty());
+    });
+    C full;
+    for (T const &value: values) {
+        full.insert(make(value));
+    }
+    s.run(name + "/find", n, [&](bench::state &st) {
+        std::size_t hits = 0;
+        st.loop(n, [&](std::size_t i) {
+            hits += full.find(values[n - 1 - i]) != full.end();
+        });
+        bench::do_not_optimize(hits);
+    });
+    s.run(name + "/iterate", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        auto it = full.begin();
+        st.loop(n, [&](std::size_t) {
+            sum += it != full.end();
+            ++it;
+        });
+        bench::do_not_optimize(sum);
+    });
+    s.run(name + "/erase", n, [&](bench::state &st) {
+        C c;
+        for (T const &value: values) {
+            c.insert(make(value));
+        }
+        st.loop(n, [&](std::size_t i) { c.erase(values[n - 1 - i]); });
+        bench::do_not_optimize(c.empty());
+    });
+}
+
+template <class C, class T>
+void bench_priority_queue(bench::suite &s, std::string const &name,
+                          std::vector<T> const &values) {
+    std::size_t n = values.size();
+    s.run(name + "/push", n, [&](bench::state &st) {
+        C c;
+        st.loop(n, [&](std::size_t i) { c.push(values[i]); });
+        bench::do_not_optimize(c.size());
+    });
+    s.run(name + "/pop", n, [&](bench::state &st) {
+        C c(values.begin(), values.end());
+        st.loop(n, [&](std::size_t) { c.pop(); });
+        bench::do_not_optimize(c.size());
+    });
+}
+
+template <class T>
+void bench_type(bench::suite &s) {
+    for (std::size_t n: s.sizes(sizeof(T))) {
+        std::vector<T> const values = bench::shuffled_values<T>(n);
+
+        bench_random_access<Marcus::vector<T>, false>(
+            s, label<T>("Marcus", "vector"), values);
+        bench_random_access<std::vector<T>, false>(
+            s, label<T>("std", "vector"), values);
+        bench_random_access<Marcus::deque<T>, true>(
+            s, label<T>("Marcus", "deque"), values);
+        bench_random_access<std::deque<T>, true>(s, label<T>("std", "deque"),
+                                                 values);
+        bench_list<Marcus::list<T>>(s, label<T>("Marcus", "list"), values);
+        bench_list<std::list<T>>(s, label<T>("std", "list"), values);
+        bench_forward_list<Marcus::forward_list<T>>(
+            s, label<T>("Marcus", "forward_list"), values);
+        bench_forward_list<std::forward_list<T>>(
+            s, label<T>("std", "forward_list"), values);
+
+        auto as_key = [](T const &value) -> T const & { return value; };
+        auto as_pair = [](T const &value) {
+            return std::pair<T const, int>(value, 0);
+        };
+        bench_associative<Marcus::set<T>>(s, label<T>("Marcus", "set"), values,
+                                          as_key);
+        bench_associative<std::set<T>>(s, label<T>("std", "set"), values,
+                                       as_key);
+        bench_associative<Marcus::map<T, int>>(s, label<T>("Marcus", "map"),
+                                               values, as_pair);
+        bench_associative<std::map<T, int>>(s, label<T>("std", "map"), values,
+                                            as_pair);
+
+        bench_priority_queue<Marcus::priority_queue<T>>(
+            s, label<T>("Marcus", "priority_queue"), values);
+        bench_priority_queue<std::priority_queue<T>>(
+            s, label<T>("std", "priority_queue"), values);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    bench_type<int>(s);
+    bench_type<bench::pod64>(s);
+    bench_type<std::string>(s);
+}
@@ -0,0 +1,98 @@
+#include "bench.hpp"
+#include <containers/flat_map.hpp>
+#include <containers/map.hpp>
+#include <map>
+#include <string>
+
+// Read-mostly lookup tables: bulk build from an unsorted range, then point
+// lookups (hit and miss), lower_bound and a full scan. flat_map against the
+// node-based Marcus::map and std::map. The build row times one whole
+// construction of n elements.
+
+namespace {
+
+template <class C, class T>
+C build(std::vector<std::pair<T, int>> const &input) {
+    if constexpr (requires { C(input.begin(), input.end()); }) {
+        return C(input.begin(), input.end());
+    } else {
+        C c;
+        for (auto const &kv: input) {
+            c.insert(kv);
+        }
+        return c;
+    }
+}
+
+template <class C, class T>
+void bench_table(bench::suite &s, std::string const &name,
+                 std::vector<T> const &values, std::vector<T> const &misses) {
+    std::size_t n = values.size();
+    std::vector<std::pair<T, int>> input;
+    for (std::size_t i = 0; i < n; ++i) {
+        input.emplace_back(values[i], int(i));
+    }
+    s.run(name + "/build", n, [&](bench::state &st) {
+        std::size_t total = 0;
+        st.loop(1, [&](std::size_t) {
+            total += build<C>(input).size();
+        });
+        bench::do_not_optimize(total);
+    });
+    C const table = build<C>(input);
+    s.run(name + "/find_hit", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        st.loop(n, [&](std::size_t i) {
+            sum += table.find(values[n - 1 - i])->second;
+        });
+        bench::do_not_optimize(sum);
+    });
+    s.run(name + "/find_miss", n, [&](bench::state &st) {
+        std::size_t hits = 0;
+        st.loop(n, [&](std::size_t i) {
+            hits += table.find(misses[i]) != table.end();
+        });
+        bench::do_not_optimize(hits);
+    });
+    if constexpr (requires { table.lower_bound(misses[0]); }) {
+        s.run(name + "/lower_bound", n, [&](bench::state &st) {
+            std::size_t hits = 0;
+            st.loop(n, [&](std::size_t i) {
+                hits += table.lower_bound(misses[i]) != table.end();
+            });
+            bench::do_not_optimize(hits);
+        });
+    }
+    s.run(name + "/iterate", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        auto it = table.begin();
+        st.loop(n, [&](std::size_t) {
+            sum += it->second;
+            ++it;
+        });
+        bench::do_not_optimize(sum);
+    });
+}
+
+template <class T>
+void bench_type(bench::suite &s) {
+    std::string suffix = std::string("<") + bench::type_name<T>() + ">";
+    for (std::size_t n: s.sizes(sizeof(T) + sizeof(int))) {
+        std::vector<T> all = bench::shuffled_values<T>(2 * n);
+        std::vector<T> const values(all.begin(), all.begin() + n);
+        std::vector<T> const misses(all.begin() + n, all.end());
+        bench_table<Marcus::flat_map<T, int>>(s, "Marcus::flat_map" + suffix,
+                                              values, misses);
+        bench_table<Marcus::map<T, int>>(s, "Marcus::map" + suffix, values,
+                                         misses);
+        bench_table<std::map<T, int>>(s, "std::map" + suffix, values, misses);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    bench_type<int>(s);
+    bench_type<std::string>(s);
+}
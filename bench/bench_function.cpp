@@ -0,0 +1,112 @@
+#include "bench.hpp"
+#include <functional>
+#include <utility/functional.hpp>
+#include <vector>
+
+// An event queue of callbacks: each event pushes a lambda capturing a few
+// pointers into a vector, then the queue is drained by invoking every
+// callback. One op is one enqueue plus one invoke. Small callbacks capture two
+// pointers and fit Marcus::Function's inline buffer; large ones capture six
+// and go to the heap, except in a 48-byte Marcus::inplace_function, which
+// never allocates. The copy rows copy the whole
+// queue, which clones every callback.
+
+namespace {
+
+struct payload {
+    std::uint64_t *counter;
+    std::uint64_t const *step;
+};
+
+template <class F>
+void bench_queue(bench::suite &s, std::string const &name, std::size_t n) {
+    std::uint64_t counter = 0;
+    std::uint64_t const step = 3;
+    std::uint64_t const pad[4] = {1, 2, 3, 4};
+    std::vector<F> queue;
+    queue.reserve(n);
+    s.run(name + "/small", n, [&](bench::state &st) {
+        st.loop(n, [&](std::size_t) {
+            queue.emplace_back([p = payload{&counter, &step}](std::uint64_t v) {
+                *p.counter += *p.step + v;
+            });
+        });
+        st.loop(n, [&](std::size_t i) {
+            queue[i](i);
+        });
+        queue.clear();
+    });
+    s.run(name + "/large", n, [&](bench::state &st) {
+        st.loop(n, [&](std::size_t) {
+            queue.emplace_back([p = payload{&counter, &step},
+                                q = payload{&counter, pad},
+                                r = payload{&counter, pad + 2}](std::uint64_t v) {
+                *p.counter += *p.step + *q.step + *r.step + v;
+            });
+        });
+        st.loop(n, [&](std::size_t i) {
+            queue[i](i);
+        });
+        queue.clear();
+    });
+    for (std::size_t i = 0; i < n; ++i) {
+        queue.emplace_back([p = payload{&counter, &step}](std::uint64_t v) {
+            *p.counter += *p.step + v;
+        });
+    }
+    s.run(name + "/small/copy", n, [&](bench::state &st) {
+        std::vector<F> copy;
+        copy.reserve(n);
+        st.loop(n, [&](std::size_t i) {
+            copy.push_back(queue[i]);
+        });
+        bench::do_not_optimize(copy.data());
+    });
+    bench::do_not_optimize(counter);
+}
+
+template <class F>
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((noinline))
+#endif
+bool call_predicate(F pred, std::uint64_t v) {
+    return pred(v);
+}
+
+template <class F>
+void bench_param(bench::suite &s, std::string const &name, std::size_t n) {
+    std::uint64_t const bounds[4] = {10, 20, 30, 40};
+    s.run(name + "/param", n, [&](bench::state &st) {
+        std::size_t hits = 0;
+        st.loop(n, [&](std::size_t i) {
+            hits += call_predicate<F>(
+                [a = &bounds[0], b = &bounds[1], c = &bounds[2],
+                 d = &bounds[3]](std::uint64_t v) {
+                    return v % 64 > *a && v % 64 < *b + *c + *d;
+                },
+                i);
+        });
+        bench::do_not_optimize(hits);
+    });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    for (std::size_t n: s.sizes(48)) {
+        std::string suffix = "/" + std::to_string(n);
+        bench_queue<Marcus::Function<void(std::uint64_t)>>(
+            s, "Marcus::Function" + suffix, n);
+        bench_queue<std::function<void(std::uint64_t)>>(
+            s, "std::function" + suffix, n);
+        bench_queue<Marcus::inplace_function<void(std::uint64_t), 48>>(
+            s, "Marcus::inplace_function<48>" + suffix, n);
+    }
+    std::size_t n = std::size_t(1) << 16;
+    bench_param<Marcus::Function<bool(std::uint64_t)>>(s, "Marcus::Function",
+                                                       n);
+    bench_param<std::function<bool(std::uint64_t)>>(s, "std::function", n);
+    bench_param<Marcus::function_ref<bool(std::uint64_t)>>(
+        s, "Marcus::function_ref", n);
+}
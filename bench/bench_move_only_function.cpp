@@ -0,0 +1,105 @@
+#include "bench.hpp"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility/functional.hpp>
+
+// A task queue: enqueue a job, dequeue it by moving it out of the queue, then
+// invoke it. One op is one job through all three steps. Small jobs capture two
+// pointers and fit MoveOnlyFunction's inline buffer; a move of one is a
+// 24-byte copy. Large jobs capture a unique_ptr and five pointers and are
+// heap-allocated by every implementation. heap_move_only_function is the
+// previous MoveOnlyFunction (unique_ptr to a virtual base), kept here as the
+// baseline.
+
+namespace {
+
+template <typename Sig>
+struct heap_move_only_function;
+
+template <typename Ret, typename... Args>
+struct heap_move_only_function<Ret(Args...)> {
+    struct base {
+        virtual Ret call(Args... args) = 0;
+        virtual ~base() = default;
+    };
+
+    template <typename Fn>
+    struct impl : base {
+        Fn f;
+
+        explicit impl(Fn fn) : f(std::move(fn)) {}
+
+        Ret call(Args... args) override {
+            return std::invoke(f, std::forward<Args>(args)...);
+        }
+    };
+
+    std::unique_ptr<base> ptr;
+
+    template <typename Fn>
+    heap_move_only_function(Fn fn)
+        : ptr(std::make_unique<impl<Fn>>(std::move(fn))) {}
+
+    Ret operator()(Args... args) const {
+        return ptr->call(std::forward<Args>(args)...);
+    }
+};
+
+struct job_state {
+    std::uint64_t counter = 0;
+    std::uint64_t step = 3;
+};
+
+template <class F>
+void bench_tasks(bench::suite &s, std::string const &name, std::size_t n) {
+    job_state js;
+    std::deque<F> queue;
+    // Keep the queue a few jobs deep so enqueue and dequeue both move.
+    constexpr std::size_t depth = 64;
+    s.run(name + "/small", n, [&](bench::state &st) {
+        st.loop(n, [&](std::size_t i) {
+            queue.emplace_back([c = &js.counter, d = &js.step](std::uint64_t v) {
+                *c += *d + v;
+            });
+            if (queue.size() > depth) {
+                F job = std::move(queue.front());
+                queue.pop_front();
+                job(i);
+            }
+        });
+        queue.clear();
+    });
+    s.run(name + "/large", n, [&](bench::state &st) {
+        st.loop(n, [&](std::size_t i) {
+            queue.emplace_back([c = &js.counter, d = &js.step, e = &js.step,
+                                f = &js.step, g = &js.step,
+                                owned = std::make_unique<std::uint64_t>(i)](
+                                   std::uint64_t v) {
+                *c += *d + *e + *f + *g + *owned + v;
+            });
+            if (queue.size() > depth) {
+                F job = std::move(queue.front());
+                queue.pop_front();
+                job(i);
+            }
+        });
+        queue.clear();
+    });
+    bench::do_not_optimize(js.counter);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    std::size_t n = std::size_t(1) << 16;
+    bench_tasks<Marcus::MoveOnlyFunction<void(std::uint64_t)>>(
+        s, "Marcus::MoveOnlyFunction", n);
+    bench_tasks<heap_move_only_function<void(std::uint64_t)>>(
+        s, "heap_move_only_function", n);
+#if __cpp_lib_move_only_function
+    bench_tasks<std::move_only_function<void(std::uint64_t)>>(
+        s, "std::move_only_function", n);
+#endif
+}
@@ -0,0 +1,61 @@
+#include "bench.hpp"
+#include <containers/map.hpp>
+#include <containers/persistent_map.hpp>
+#include <map>
+#include <string>
+
+// Versioned state where every update must leave the previous version intact
+// for readers: take a snapshot, then insert_or_assign one random key.
+// persistent_map shares everything except the copied path; Marcus::map and
+// std::map have to copy the whole tree per snapshot. One op is one
+// snapshot plus one update. The find rows compare plain lookups, where the
+// persistent tree pays only for its slightly larger nodes.
+
+namespace {
+
+template <class C>
+void bench_versions(bench::suite &s, std::string const &name,
+                    std::vector<int> const &keys) {
+    std::size_t n = keys.size();
+    C table;
+    for (std::size_t i = 0; i < n; ++i) {
+        table.insert_or_assign(keys[i], int(i));
+    }
+    s.run(name + "/snapshot_update", n, [&](bench::state &st) {
+        C current = table;
+        std::size_t total = 0;
+        st.loop(n, [&](std::size_t i) {
+            C previous = current;
+            current.insert_or_assign(keys[(i * 7) % n], int(i));
+            total += previous.size();
+        });
+        bench::do_not_optimize(total);
+    });
+    C const &ctable = table;
+    s.run(name + "/find_hit", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        st.loop(n, [&](std::size_t i) {
+            sum += ctable.find(keys[n - 1 - i])->second;
+        });
+        bench::do_not_optimize(sum);
+    });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    // A node is about 40 bytes.
+    for (std::size_t n: s.sizes(40)) {
+        std::vector<int> keys = bench::shuffled_values<int>(n);
+        std::string suffix = "<int>/" + std::to_string(n);
+        bench_versions<Marcus::persistent_map<int, int>>(
+            s, "Marcus::persistent_map" + suffix, keys);
+        // Copying the whole tree per update is quadratic; cap those rows.
+        if (n <= 16384) {
+            bench_versions<Marcus::map<int, int>>(s, "Marcus::map" + suffix,
+                                                  keys);
+            bench_versions<std::map<int, int>>(s, "std::map" + suffix, keys);
+        }
+    }
+}
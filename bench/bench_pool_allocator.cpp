@@ -0,0 +1,113 @@
+#include "bench.hpp"
+#include <containers/forward_list.hpp>
+#include <containers/list.hpp>
+#include <containers/map.hpp>
+#include <containers/set.hpp>
+#include <memory/pool_allocator.hpp>
+
+// Node-based containers with std::allocator versus Marcus::pool_allocator:
+// bulk insert, insert/erase churn (nodes recycled through the free list) and
+// teardown.
+
+namespace {
+
+template <class Map>
+void bench_map(bench::suite &s, std::string const &name,
+               std::vector<int> const &keys) {
+    std::size_t n = keys.size();
+    s.run(name + "/insert", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        Map m;
+        st.loop(n, [&](std::size_t i) {
+            m[keys[i]] = i;
+        });
+        sum += m.size();
+        bench::do_not_optimize(sum);
+    });
+    Map m;
+    for (std::size_t i = 0; i < n; ++i) {
+        m[keys[i]] = i;
+    }
+    s.run(name + "/churn", n, [&](bench::state &st) {
+        st.loop(n, [&](std::size_t i) {
+            m.erase(keys[i]);
+            m[keys[i]] = i;
+        });
+        bench::do_not_optimize(m.size());
+    });
+}
+
+template <class Set>
+void bench_set(bench::suite &s, std::string const &name,
+               std::vector<int> const &keys) {
+    std::size_t n = keys.size();
+    s.run(name + "/insert", n, [&](bench::state &st) {
+        Set c;
+        st.loop(n, [&](std::size_t i) {
+            c.insert(keys[i]);
+        });
+        bench::do_not_optimize(c.size());
+    });
+    Set c;
+    for (int k: keys) {
+        c.insert(k);
+    }
+    s.run(name + "/churn", n, [&](bench::state &st) {
+        st.loop(n, [&](std::size_t i) {
+            c.erase(keys[i]);
+            c.insert(keys[i]);
+        });
+        bench::do_not_optimize(c.size());
+    });
+}
+
+template <class List>
+void bench_list(bench::suite &s, std::string const &name,
+                std::vector<int> const &values) {
+    std::size_t n = values.size();
+    s.run(name + "/push", n, [&](bench::state &st) {
+        List c;
+        st.loop(n, [&](std::size_t i) {
+            c.push_front(values[i]);
+        });
+        bench::do_not_optimize(c.front());
+    });
+    List c;
+    for (std::size_t i = 0; i < n; ++i) {
+        c.push_front(values[i]);
+    }
+    s.run(name + "/churn", n, [&](bench::state &st) {
+        st.loop(n, [&](std::size_t i) {
+            c.pop_front();
+            c.push_front(values[i]);
+        });
+        bench::do_not_optimize(c.front());
+    });
+}
+
+template <class T>
+using Pool = Marcus::pool_allocator<T>;
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    for (std::size_t n: s.sizes(48)) {
+        std::vector<int> const keys = bench::shuffled_values<int>(n);
+        std::string suffix = "<int>/" + std::to_string(n);
+        bench_map<Marcus::map<int, std::size_t>>(s, "map" + suffix, keys);
+        bench_map<Marcus::map<int, std::size_t, std::less<int>,
+                              Pool<std::pair<const int, std::size_t>>>>(
+            s, "map+pool" + suffix, keys);
+        bench_set<Marcus::set<int>>(s, "set" + suffix, keys);
+        bench_set<Marcus::set<int, std::less<int>, Pool<int>>>(
+            s, "set+pool" + suffix, keys);
+        bench_list<Marcus::list<int>>(s, "list" + suffix, keys);
+        bench_list<Marcus::list<int, Pool<int>>>(s, "list+pool" + suffix,
+                                                 keys);
+        bench_list<Marcus::forward_list<int>>(s, "forward_list" + suffix,
+                                              keys);
+        bench_list<Marcus::forward_list<int, Pool<int>>>(
+            s, "forward_list+pool" + suffix, keys);
+    }
+}
@@ -0,0 +1,96 @@
+#include "bench.hpp"
+#include <algorithm>
+#include <containers/map.hpp>
+#include <containers/set.hpp>
+#include <map>
+#include <set>
+#include <string>
+
+// Building a tree from a sorted range: the sorted_unique constructor and the
+// plain range constructor (which detects sorted input) link a balanced tree
+// in O(n); the insert loop is the per-element O(n log n) path, and
+// emplace_hint(end()) is the append-at-rightmost pattern of time-series
+// indexes. std:: containers are the baseline. Each row times one whole
+// construction.
+
+namespace {
+
+template <class C, class V>
+C build_loop(V const &input) {
+    C c;
+    for (auto const &v: input) {
+        c.insert(v);
+    }
+    return c;
+}
+
+template <class C, class V>
+C build_hinted(V const &input) {
+    C c;
+    for (auto const &v: input) {
+        c.emplace_hint(c.end(), v);
+    }
+    return c;
+}
+
+template <class C, class V>
+void bench_builds(bench::suite &s, std::string const &name, V const &input) {
+    std::size_t n = input.size();
+    s.run(name + "/insert_loop", n, [&](bench::state &st) {
+        std::size_t total = 0;
+        st.loop(1, [&](std::size_t) {
+            total += build_loop<C>(input).size();
+        });
+        bench::do_not_optimize(total);
+    });
+    s.run(name + "/emplace_hint_end", n, [&](bench::state &st) {
+        std::size_t total = 0;
+        st.loop(1, [&](std::size_t) {
+            total += build_hinted<C>(input).size();
+        });
+        bench::do_not_optimize(total);
+    });
+    s.run(name + "/range_ctor", n, [&](bench::state &st) {
+        std::size_t total = 0;
+        st.loop(1, [&](std::size_t) {
+            total += C(input.begin(), input.end()).size();
+        });
+        bench::do_not_optimize(total);
+    });
+    if constexpr (requires { C(Marcus::sorted_unique, input.begin(),
+                               input.end()); }) {
+        s.run(name + "/sorted_unique", n, [&](bench::state &st) {
+            std::size_t total = 0;
+            st.loop(1, [&](std::size_t) {
+                total +=
+                    C(Marcus::sorted_unique, input.begin(), input.end()).size();
+            });
+            bench::do_not_optimize(total);
+        });
+    }
+}
+
+template <class T>
+void bench_type(bench::suite &s) {
+    std::string suffix = std::string("<") + bench::type_name<T>() + ">";
+    for (std::size_t n: s.sizes(sizeof(T) + sizeof(int))) {
+        std::vector<T> keys = bench::shuffled_values<T>(n);
+        std::sort(keys.begin(), keys.end());
+        std::vector<std::pair<T, int>> pairs;
+        for (std::size_t i = 0; i < n; ++i) {
+            pairs.emplace_back(keys[i], int(i));
+        }
+        bench_builds<Marcus::set<T>>(s, "Marcus::set" + suffix, keys);
+        bench_builds<std::set<T>>(s, "std::set" + suffix, keys);
+        bench_builds<Marcus::map<T, int>>(s, "Marcus::map" + suffix, pairs);
+        bench_builds<std::map<T, int>>(s, "std::map" + suffix, pairs);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    bench_type<int>(s);
+    bench_type<std::string>(s);
+}
@@ -0,0 +1,109 @@
+#include "bench.hpp"
+#include <containers/set.hpp>
+#include <iterator>
+#include <set>
+#include <string>
+
+// Union, intersection and difference of two ordered sets, as done when
+// merging per-shard results: the join-based Marcus::set operations (which
+// reuse the argument's nodes) against the element-at-a-time loops they
+// replace, on Marcus::set and std::set. The merge() rows compare the two
+// node-relinking merges; Marcus::set rebuilds linearly when both sides are
+// large. The second set is either as large as the first (interleaved keys) or
+// 64 times smaller. One op is one whole set operation; building the inputs is
+// not timed.
+
+namespace {
+
+template <class C>
+void loop_union(C &a, C &b) {
+    for (auto it = b.begin(); it != b.end(); ++it) {
+        a.insert(*it);
+    }
+}
+
+template <class C>
+void loop_intersection(C &a, C &b) {
+    for (auto it = a.begin(); it != a.end();) {
+        it = b.count(*it) ? std::next(it) : a.erase(it);
+    }
+}
+
+template <class C>
+void loop_difference(C &a, C &b) {
+    for (auto it = b.begin(); it != b.end(); ++it) {
+        a.erase(*it);
+    }
+}
+
+template <class C, class Op>
+void bench_op(bench::suite &s, std::string const &name,
+              std::vector<int> const &x, std::vector<int> const &y, Op op) {
+    s.run(name, x.size() + y.size(), [&](bench::state &st) {
+        C a(x.begin(), x.end());
+        C b(y.begin(), y.end());
+        st.loop(1, [&](std::size_t) {
+            op(a, b);
+        });
+        bench::do_not_optimize(a.size());
+    });
+}
+
+void bench_sizes(bench::suite &s, std::size_t n, std::size_t m) {
+    // Keys interleave; about half of the smaller set also occurs in the other.
+    std::vector<int> x(n);
+    std::vector<int> y(m);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = int(i * 2);
+    }
+    std::size_t stride = n / m * 2;
+    for (std::size_t i = 0; i < m; ++i) {
+        y[i] = int(i * stride + i % 2);
+    }
+    std::string suffix = "<int>/" + std::to_string(n) + "+" + std::to_string(m);
+    using set = Marcus::set<int>;
+    bench_op<set>(s, "Marcus::set/set_union" + suffix, x, y,
+                  [](set &a, set &b) {
+                      a.set_union(std::move(b));
+                  });
+    bench_op<set>(s, "Marcus::set/insert_loop" + suffix, x, y,
+                  loop_union<set>);
+    bench_op<std::set<int>>(s, "std::set/insert_loop" + suffix, x, y,
+                            loop_union<std::set<int>>);
+    bench_op<set>(s, "Marcus::set/set_intersection" + suffix, x, y,
+                  [](set &a, set &b) {
+                      a.set_intersection(std::move(b));
+                  });
+    bench_op<set>(s, "Marcus::set/count_erase_loop" + suffix, x, y,
+                  loop_intersection<set>);
+    bench_op<std::set<int>>(s, "std::set/count_erase_loop" + suffix, x, y,
+                            loop_intersection<std::set<int>>);
+    bench_op<set>(s, "Marcus::set/set_difference" + suffix, x, y,
+                  [](set &a, set &b) {
+                      a.set_difference(std::move(b));
+                  });
+    bench_op<set>(s, "Marcus::set/erase_loop" + suffix, x, y,
+                  loop_difference<set>);
+    bench_op<std::set<int>>(s, "std::set/erase_loop" + suffix, x, y,
+                            loop_difference<std::set<int>>);
+    bench_op<set>(s, "Marcus::set/merge" + suffix, x, y, [](set &a, set &b) {
+        a.merge(b);
+    });
+    bench_op<std::set<int>>(s, "std::set/merge" + suffix, x, y,
+                            [](std::set<int> &a, std::set<int> &b) {
+                                a.merge(b);
+                            });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    // A node is about 32 bytes.
+    for (std::size_t n: s.sizes(32)) {
+        bench_sizes(s, n, n);
+        if (n >= 64) {
+            bench_sizes(s, n, n / 64);
+        }
+    }
+}
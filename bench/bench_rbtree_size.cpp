@@ -0,0 +1,126 @@
+#include "bench.hpp"
+#include <containers/map.hpp>
+#include <iterator>
+#include <map>
+#include <string>
+
+// map::size() at 1M elements: the cached count against the in-order walk
+// (std::distance(begin(), end())) that size() used to perform. Also prints the
+// heap bytes each tree spends per element (node links plus the value), and
+// times the order-statistic map's distance() and nth() (median lookup).
+
+namespace {
+
+std::size_t g_live = 0;
+
+template <class T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template <class U>
+    counting_allocator(counting_allocator<U> const &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        g_live += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        g_live -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <class U>
+    bool operator==(counting_allocator<U> const &) const noexcept {
+        return true;
+    }
+};
+
+template <class C>
+void footprint(bench::suite &s, std::string const &name, std::size_t n) {
+    if (!s.enabled(name + "/bytes_per_element")) {
+        return;
+    }
+    g_live = 0;
+    C c;
+    for (std::size_t i = 0; i < n; ++i) {
+        c.emplace(int(i), int(i));
+    }
+    std::printf("%-52s %12zu   %6.2f bytes/element (payload %zu)\n",
+                (name + "/bytes_per_element").c_str(), n,
+                static_cast<double>(g_live) / static_cast<double>(n),
+                sizeof(std::pair<const int, int>));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    std::size_t const n = 1 << 20;
+    std::size_t const calls = 64;
+
+    using ranked_map = Marcus::map<int, int, std::less<int>,
+                                   std::allocator<std::pair<const int, int>>,
+                                   true>;
+    Marcus::map<int, int> marcus;
+    ranked_map ranked;
+    std::map<int, int> standard;
+    for (int key: bench::shuffled_values<int>(n)) {
+        marcus.emplace(key, key);
+        ranked.emplace(key, key);
+        standard.emplace(key, key);
+    }
+
+    s.run("Marcus::map<int>/size", n, [&](bench::state &st) {
+        std::size_t sum = 0;
+        st.loop(calls, [&](std::size_t) {
+            bench::clobber_memory();
+            sum += marcus.size();
+        });
+        bench::do_not_optimize(sum);
+    });
+    s.run("Marcus::map<int>/distance(begin,end)", n, [&](bench::state &st) {
+        std::size_t sum = 0;
+        st.loop(calls, [&](std::size_t) {
+            sum += std::distance(marcus.begin(), marcus.end());
+        });
+        bench::do_not_optimize(sum);
+    });
+    s.run("Marcus::ranked_map<int>/distance(begin,end)", n,
+          [&](bench::state &st) {
+              std::ptrdiff_t sum = 0;
+              st.loop(calls, [&](std::size_t) {
+                  bench::clobber_memory();
+                  sum += ranked.distance(ranked.begin(), ranked.end());
+              });
+              bench::do_not_optimize(sum);
+          });
+    s.run("Marcus::ranked_map<int>/nth(median)", n, [&](bench::state &st) {
+        std::size_t sum = 0;
+        st.loop(calls, [&](std::size_t i) {
+            bench::clobber_memory();
+            sum += ranked.nth(ranked.size() / 2 + i % 2)->second;
+        });
+        bench::do_not_optimize(sum);
+    });
+    footprint<Marcus::map<int, int, std::less<int>,
+                          counting_allocator<std::pair<const int, int>>>>(
+        s, "Marcus::map<int>", n);
+    footprint<Marcus::map<int, int, std::less<int>,
+                          counting_allocator<std::pair<const int, int>>, true>>(
+        s, "Marcus::ranked_map<int>", n);
+    footprint<std::map<int, int, std::less<int>,
+                       counting_allocator<std::pair<const int, int>>>>(
+        s, "std::map<int>", n);
+
+    s.run("std::map<int>/size", n, [&](bench::state &st) {
+        std::size_t sum = 0;
+        st.loop(calls, [&](std::size_t) {
+            bench::clobber_memory();
+            sum += standard.size();
+        });
+        bench::do_not_optimize(sum);
+    });
+}
@@ -0,0 +1,48 @@
+#include "bench.hpp"
+#include <containers/small_vector.hpp>
+#include <containers/vector.hpp>
+#include <vector>
+
+// Building and destroying short-lived vectors of a few elements, the pattern
+// small_vector exists for: one malloc/free pair per vector versus none.
+
+namespace {
+
+template <class C, class T>
+void bench_short_lived(bench::suite &s, std::string const &name,
+                       std::vector<T> const &values, std::size_t len) {
+    std::size_t n = values.size() / len;
+    s.run(name + "/build" + std::to_string(len), n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        st.loop(n, [&](std::size_t i) {
+            C c;
+            for (std::size_t j = 0; j < len; ++j) {
+                c.push_back(values[i * len + j]);
+            }
+            sum += bench::weight(c.back()) + c.size();
+        });
+        bench::do_not_optimize(sum);
+    });
+}
+
+template <class T>
+void bench_type(bench::suite &s) {
+    std::vector<T> const values = bench::shuffled_values<T>(1 << 16);
+    std::string suffix = std::string("<") + bench::type_name<T>() + ">";
+    for (std::size_t len: {1, 4, 8, 16}) {
+        bench_short_lived<Marcus::small_vector<T, 8>>(
+            s, "Marcus::small_vector" + suffix, values, len);
+        bench_short_lived<Marcus::vector<T>>(s, "Marcus::vector" + suffix,
+                                             values, len);
+        bench_short_lived<std::vector<T>>(s, "std::vector" + suffix, values,
+                                          len);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    bench_type<int>(s);
+    bench_type<std::string>(s);
+}
@@ -0,0 +1,78 @@
+#include "bench.hpp"
+#include <containers/map.hpp>
+#include <containers/unordered_map.hpp>
+#include <string>
+#include <unordered_map>
+
+// Point lookups (hit and miss), insertion, erasure and iteration for the
+// SwissTable-based Marcus::unordered_map against std::unordered_map and the
+// tree-based Marcus::map.
+
+namespace {
+
+template <class C, class T>
+void bench_map(bench::suite &s, std::string const &name,
+               std::vector<T> const &values, std::vector<T> const &misses) {
+    std::size_t n = values.size();
+    s.run(name + "/insert", n, [&](bench::state &st) {
+        C c;
+        st.loop(n, [&](std::size_t i) { c.emplace(values[i], 0); });
+        bench::do_not_optimize(c.size());
+    });
+    C full;
+    for (T const &value: values) {
+        full.emplace(value, 1);
+    }
+    s.run(name + "/find_hit", n, [&](bench::state &st) {
+        std::size_t hits = 0;
+        st.loop(n, [&](std::size_t i) {
+            hits += full.find(values[n - 1 - i]) != full.end();
+        });
+        bench::do_not_optimize(hits);
+    });
+    s.run(name + "/find_miss", n, [&](bench::state &st) {
+        std::size_t hits = 0;
+        st.loop(n, [&](std::size_t i) {
+            hits += full.find(misses[i]) != full.end();
+        });
+        bench::do_not_optimize(hits);
+    });
+    s.run(name + "/iterate", n, [&](bench::state &st) {
+        std::uint64_t sum = 0;
+        auto it = full.begin();
+        st.loop(n, [&](std::size_t) {
+            sum += it->second;
+            ++it;
+        });
+        bench::do_not_optimize(sum);
+    });
+    s.run(name + "/erase", n, [&](bench::state &st) {
+        C c = full;
+        st.loop(n, [&](std::size_t i) { c.erase(values[n - 1 - i]); });
+        bench::do_not_optimize(c.size());
+    });
+}
+
+template <class T>
+void bench_type(bench::suite &s) {
+    std::string suffix = std::string("<") + bench::type_name<T>() + ">";
+    for (std::size_t n: s.sizes(sizeof(T) + sizeof(int))) {
+        std::vector<T> all = bench::shuffled_values<T>(2 * n);
+        std::vector<T> const values(all.begin(), all.begin() + n);
+        std::vector<T> const misses(all.begin() + n, all.end());
+        bench_map<Marcus::unordered_map<T, int>>(
+            s, "Marcus::unordered_map" + suffix, values, misses);
+        bench_map<std::unordered_map<T, int>>(
+            s, "std::unordered_map" + suffix, values, misses);
+        bench_map<Marcus::map<T, int>>(s, "Marcus::map" + suffix, values,
+                                       misses);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    bench_type<int>(s);
+    bench_type<std::string>(s);
+}
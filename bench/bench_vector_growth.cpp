@@ -0,0 +1,114 @@
+#include "bench.hpp"
+#include <containers/vector.hpp>
+#include <vector>
+
+// Marcus::vector growth policies: append throughput, plus the peak number of
+// live heap bytes while appending (old and new buffers coexist during each
+// reallocation, so the peak is what decides RSS for very large vectors).
+
+namespace {
+
+struct heap_stats {
+    std::size_t live = 0;
+    std::size_t peak = 0;
+    std::size_t allocations = 0;
+};
+
+heap_stats g_heap;
+
+// std::allocator that keeps count of live bytes in g_heap.  It deliberately
+// has no allocate_at_least, so vector_growth_at_least uses the size-class
+// rounding fallback.
+template <class T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template <class U>
+    counting_allocator(counting_allocator<U> const &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        g_heap.live += n * sizeof(T);
+        g_heap.peak = std::max(g_heap.peak, g_heap.live);
+        ++g_heap.allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        g_heap.live -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <class U>
+    bool operator==(counting_allocator<U> const &) const noexcept {
+        return true;
+    }
+};
+
+template <class T, class Growth>
+using marcus_vector = Marcus::vector<T, counting_allocator<T>, Growth>;
+
+template <class C, class T>
+void bench_policy(bench::suite &s, std::string const &name,
+                  std::vector<T> const &values) {
+    std::size_t n = values.size();
+    s.run(name + "/push_back", n, [&](bench::state &st) {
+        C c;
+        st.loop(n, [&](std::size_t i) { c.push_back(values[i]); });
+        bench::do_not_optimize(c.size());
+    });
+    if (!s.enabled(name + "/peak")) {
+        return;
+    }
+    g_heap = {};
+    std::size_t capacity;
+    {
+        C c;
+        for (std::size_t i = 0; i < n; ++i) {
+            c.push_back(values[i]);
+        }
+        capacity = c.capacity();
+    }
+    double payload = static_cast<double>(n * sizeof(T));
+    std::printf("%-52s %12zu   peak %6.2fx  final cap %6.2fx  %4zu allocs\n",
+                (name + "/peak").c_str(), n,
+                static_cast<double>(g_heap.peak) / payload,
+                static_cast<double>(capacity * sizeof(T)) / payload,
+                g_heap.allocations);
+}
+
+template <class T>
+void bench_type(bench::suite &s) {
+    for (std::size_t n: s.sizes(sizeof(T))) {
+        std::vector<T> const values = bench::shuffled_values<T>(n);
+        auto label = [](char const *policy) {
+            return std::string("vector<") + bench::type_name<T>() + ">/" +
+                   policy;
+        };
+        bench_policy<marcus_vector<T, Marcus::vector_growth_x2>>(
+            s, label("x2"), values);
+        bench_policy<marcus_vector<T, Marcus::vector_growth_x1_5>>(
+            s, label("x1.5"), values);
+        bench_policy<marcus_vector<T, Marcus::vector_growth_at_least<>>>(
+            s, label("x1.5_at_least"), values);
+        bench_policy<marcus_vector<T, Marcus::vector_growth_at_least<
+                                          Marcus::vector_growth_x2>>>(
+            s, label("x2_at_least"), values);
+        // Fixed increments are quadratic; keep them to the smaller sizes.
+        if (n * sizeof(T) <= (std::size_t(4) << 20)) {
+            bench_policy<marcus_vector<T, Marcus::vector_growth_fixed<4096>>>(
+                s, label("fixed4096"), values);
+        }
+        bench_policy<std::vector<T, counting_allocator<T>>>(
+            s, label("std"), values);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::suite s(argc, argv);
+    bench_type<int>(s);
+    bench_type<bench::pod64>(s);
+}
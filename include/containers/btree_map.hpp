@@ -0,0 +1,424 @@
+#pragma once
+
+#include <containers/core/_BTree.hpp>
+#include <core/_common.hpp>
+#include <core/_sorted_tag.hpp>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace Marcus {
+
+// 接口与 map 相同的 B 树，每个节点连续存放一批元素，查找和区间遍历
+// 比红黑树少碰很多缓存行。_NodeBytes 是叶子节点的目标大小。
+// 插入和删除会搬动元素，使所有迭代器与元素引用失效
+template <typename _Key, typename _Mapped, typename _Compare = std::less<_Key>,
+          typename _Alloc = std::allocator<std::pair<const _Key, _Mapped>>,
+          std::size_t _NodeBytes = 256>
+struct btree_map
+    : _BTreeImpl<std::pair<const _Key, _Mapped>, _BTreeSelectFirst, _Compare,
+                 _Alloc, _NodeBytes, false> {
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<const _Key, _Mapped>;
+    using key_compare = _Compare;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+private:
+    using _Base = _BTreeImpl<value_type, _BTreeSelectFirst, _Compare, _Alloc,
+                             _NodeBytes, false>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::iterator;
+    using typename _Base::node_type;
+
+    btree_map() = default;
+
+    explicit btree_map(const _Compare &__comp,
+                       const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {}
+
+    explicit btree_map(const _Alloc &__alloc) : _Base(_Compare(), __alloc) {}
+
+    btree_map(std::initializer_list<value_type> __ilist,
+              const _Compare &__comp = _Compare(),
+              const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {
+        this->_M_insert_range_unique(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    btree_map(_InputIt __first, _InputIt __last,
+              const _Compare &__comp = _Compare(),
+              const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {
+        this->_M_insert_range_unique(__first, __last);
+    }
+
+    // [__first, __last) 必须已按键严格递增
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    btree_map(sorted_unique_t, _InputIt __first, _InputIt __last,
+              const _Compare &__comp = _Compare())
+        : _Base(__comp) {
+        this->_M_append_sorted(__first, __last);
+    }
+
+    btree_map(sorted_unique_t, std::initializer_list<value_type> __ilist,
+              const _Compare &__comp = _Compare())
+        : _Base(__comp) {
+        this->_M_append_sorted(__ilist.begin(), __ilist.end());
+    }
+
+    btree_map(btree_map &&) = default;
+
+    btree_map &operator=(btree_map &&) = default;
+
+    btree_map(const btree_map &) = default;
+
+    btree_map &operator=(const btree_map &) = default;
+
+    btree_map &operator=(std::initializer_list<value_type> __ilist) {
+        assign(__ilist);
+        return *this;
+    }
+
+    void assign(std::initializer_list<value_type> __ilist) {
+        this->clear();
+        this->_M_insert_range_unique(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(_InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_insert_range_unique(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(sorted_unique_t, _InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_append_sorted(__first, __last);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const _Mapped &at(const _Kv &__key) const {
+        const_iterator __it = this->find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("btree_map::at");
+        }
+        return __it->second;
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    _Mapped &at(const _Kv &__key) {
+        iterator __it = this->find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("btree_map::at");
+        }
+        return __it->second;
+    }
+
+    const _Mapped &at(const _Key &__key) const {
+        const_iterator __it = this->find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("btree_map::at");
+        }
+        return __it->second;
+    }
+
+    _Mapped &at(const _Key &__key) {
+        iterator __it = this->find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("btree_map::at");
+        }
+        return __it->second;
+    }
+
+    _Mapped &operator[](const _Key &__key) {
+        return this
+            ->_M_try_emplace_key(__key, std::piecewise_construct,
+                                 std::forward_as_tuple(__key),
+                                 std::forward_as_tuple())
+            .first->second;
+    }
+
+    _Mapped &operator[](_Key &&__key) {
+        return this
+            ->_M_try_emplace_key(__key, std::piecewise_construct,
+                                 std::forward_as_tuple(std::move(__key)),
+                                 std::forward_as_tuple())
+            .first->second;
+    }
+
+    std::pair<iterator, bool> insert(const value_type &__value) {
+        return this->_M_try_emplace_key(__value.first, __value);
+    }
+
+    std::pair<iterator, bool> insert(value_type &&__value) {
+        return this->_M_try_emplace_key(__value.first, std::move(__value));
+    }
+
+    iterator insert(const_iterator __hint, const value_type &__value) {
+        return this->_M_try_emplace_key_hint(__hint, __value.first, __value);
+    }
+
+    iterator insert(const_iterator __hint, value_type &&__value) {
+        return this->_M_try_emplace_key_hint(__hint, __value.first,
+                                             std::move(__value));
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_insert_range_unique(__first, __last);
+    }
+
+    void insert(std::initializer_list<value_type> __ilist) {
+        this->_M_insert_range_unique(__ilist.begin(), __ilist.end());
+    }
+
+    // 键已存在时元素留在句柄中
+    std::pair<iterator, bool> insert(node_type &&__nh) {
+        return this->_M_insert_unique_handle(__nh);
+    }
+
+    template <typename _Mp,
+              typename = std::enable_if_t<std::is_assignable_v<_Mapped &, _Mp>>>
+    std::pair<iterator, bool> insert_or_assign(const _Key &__key,
+                                               _Mp &&__mapped) {
+        std::pair<iterator, bool> __pos = this->_M_find_insert_unique(__key);
+        if (__pos.second) {
+            __pos.first->second = std::forward<_Mp>(__mapped);
+            return {__pos.first, false};
+        }
+        return {this->_M_insert_args(__pos.first, __key,
+                                     std::forward<_Mp>(__mapped)),
+                true};
+    }
+
+    template <typename _Mp,
+              typename = std::enable_if_t<std::is_assignable_v<_Mapped &, _Mp>>>
+    std::pair<iterator, bool> insert_or_assign(_Key &&__key, _Mp &&__mapped) {
+        std::pair<iterator, bool> __pos = this->_M_find_insert_unique(__key);
+        if (__pos.second) {
+            __pos.first->second = std::forward<_Mp>(__mapped);
+            return {__pos.first, false};
+        }
+        return {this->_M_insert_args(__pos.first, std::move(__key),
+                                     std::forward<_Mp>(__mapped)),
+                true};
+    }
+
+    template <typename... _Vs>
+    std::pair<iterator, bool> emplace(_Vs &&...__value) {
+        return this->_M_emplace_unique(std::forward<_Vs>(__value)...);
+    }
+
+    template <typename... _Vs>
+    iterator emplace_hint(const_iterator __hint, _Vs &&...__value) {
+        return this->_M_emplace_hint_unique(__hint,
+                                            std::forward<_Vs>(__value)...);
+    }
+
+    template <typename... _Ms>
+    std::pair<iterator, bool> try_emplace(const _Key &__key,
+                                          _Ms &&...__mapped) {
+        return this->_M_try_emplace_key(
+            __key, std::piecewise_construct, std::forward_as_tuple(__key),
+            std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
+    }
+
+    template <typename... _Ms>
+    std::pair<iterator, bool> try_emplace(_Key &&__key, _Ms &&...__mapped) {
+        return this->_M_try_emplace_key(
+            __key, std::piecewise_construct,
+            std::forward_as_tuple(std::move(__key)),
+            std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
+    }
+
+    template <typename... _Ms>
+    iterator try_emplace(const_iterator __hint, const _Key &__key,
+                         _Ms &&...__mapped) {
+        return this->_M_try_emplace_key_hint(
+            __hint, __key, std::piecewise_construct,
+            std::forward_as_tuple(__key),
+            std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
+    }
+
+    template <typename... _Ms>
+    iterator try_emplace(const_iterator __hint, _Key &&__key,
+                         _Ms &&...__mapped) {
+        return this->_M_try_emplace_key_hint(
+            __hint, __key, std::piecewise_construct,
+            std::forward_as_tuple(std::move(__key)),
+            std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
+    }
+
+    using _Base::erase;
+
+    iterator erase(iterator __it) noexcept {
+        return _Base::erase(const_iterator(__it));
+    }
+
+    _LIBPENGCXX_DEFINE_COMPARISON(btree_map);
+};
+
+template <typename _Key, typename _Mapped, typename _Compare = std::less<_Key>,
+          typename _Alloc = std::allocator<std::pair<const _Key, _Mapped>>,
+          std::size_t _NodeBytes = 256>
+struct btree_multimap
+    : _BTreeImpl<std::pair<const _Key, _Mapped>, _BTreeSelectFirst, _Compare,
+                 _Alloc, _NodeBytes, true> {
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<const _Key, _Mapped>;
+    using key_compare = _Compare;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+private:
+    using _Base = _BTreeImpl<value_type, _BTreeSelectFirst, _Compare, _Alloc,
+                             _NodeBytes, true>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::iterator;
+    using typename _Base::node_type;
+
+    btree_multimap() = default;
+
+    explicit btree_multimap(const _Compare &__comp,
+                            const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {}
+
+    explicit btree_multimap(const _Alloc &__alloc)
+        : _Base(_Compare(), __alloc) {}
+
+    btree_multimap(std::initializer_list<value_type> __ilist,
+                   const _Compare &__comp = _Compare(),
+                   const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {
+        this->_M_insert_range_multi(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    btree_multimap(_InputIt __first, _InputIt __last,
+                   const _Compare &__comp = _Compare(),
+                   const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {
+        this->_M_insert_range_multi(__first, __last);
+    }
+
+    // [__first, __last) 必须已按键非递减
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    btree_multimap(sorted_equivalent_t, _InputIt __first, _InputIt __last,
+                   const _Compare &__comp = _Compare())
+        : _Base(__comp) {
+        this->_M_append_sorted(__first, __last);
+    }
+
+    btree_multimap(sorted_equivalent_t,
+                   std::initializer_list<value_type> __ilist,
+                   const _Compare &__comp = _Compare())
+        : _Base(__comp) {
+        this->_M_append_sorted(__ilist.begin(), __ilist.end());
+    }
+
+    btree_multimap(btree_multimap &&) = default;
+
+    btree_multimap &operator=(btree_multimap &&) = default;
+
+    btree_multimap(const btree_multimap &) = default;
+
+    btree_multimap &operator=(const btree_multimap &) = default;
+
+    btree_multimap &operator=(std::initializer_list<value_type> __ilist) {
+        assign(__ilist);
+        return *this;
+    }
+
+    void assign(std::initializer_list<value_type> __ilist) {
+        this->clear();
+        this->_M_insert_range_multi(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(_InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_insert_range_multi(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(sorted_equivalent_t, _InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_append_sorted(__first, __last);
+    }
+
+    iterator insert(const value_type &__value) {
+        return this->_M_emplace_multi(__value);
+    }
+
+    iterator insert(value_type &&__value) {
+        return this->_M_emplace_multi(std::move(__value));
+    }
+
+    iterator insert(const_iterator __hint, const value_type &__value) {
+        return this->_M_emplace_hint_multi(__hint, __value);
+    }
+
+    iterator insert(const_iterator __hint, value_type &&__value) {
+        return this->_M_emplace_hint_multi(__hint, std::move(__value));
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_insert_range_multi(__first, __last);
+    }
+
+    void insert(std::initializer_list<value_type> __ilist) {
+        this->_M_insert_range_multi(__ilist.begin(), __ilist.end());
+    }
+
+    iterator insert(node_type &&__nh) {
+        return this->_M_insert_multi_handle(__nh);
+    }
+
+    template <typename... _Vs>
+    iterator emplace(_Vs &&...__value) {
+        return this->_M_emplace_multi(std::forward<_Vs>(__value)...);
+    }
+
+    template <typename... _Vs>
+    iterator emplace_hint(const_iterator __hint, _Vs &&...__value) {
+        return this->_M_emplace_hint_multi(__hint,
+                                           std::forward<_Vs>(__value)...);
+    }
+
+    using _Base::erase;
+
+    iterator erase(iterator __it) noexcept {
+        return _Base::erase(const_iterator(__it));
+    }
+
+    _LIBPENGCXX_DEFINE_COMPARISON(btree_multimap);
+};
+
+} // namespace Marcus
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <containers/core/_BTree.hpp>
+#include <core/_common.hpp>
+#include <core/_sorted_tag.hpp>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+namespace Marcus {
+
+// 接口与 set 相同的 B 树，_NodeBytes 是叶子节点的目标大小。
+// 插入和删除会搬动元素，使所有迭代器与元素引用失效
+template <typename _Key, typename _Compare = std::less<_Key>,
+          typename _Alloc = std::allocator<_Key>, std::size_t _NodeBytes = 256>
+struct btree_set : _BTreeImpl<const _Key, _BTreeIdentity, _Compare, _Alloc,
+                              _NodeBytes, false> {
+    using key_type = _Key;
+    using value_type = _Key;
+    using key_compare = _Compare;
+    using value_compare = _Compare;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+private:
+    using _Base = _BTreeImpl<const _Key, _BTreeIdentity, _Compare, _Alloc,
+                             _NodeBytes, false>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::iterator;
+    using typename _Base::node_type;
+
+    btree_set() = default;
+
+    explicit btree_set(const _Compare &__comp,
+                       const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {}
+
+    explicit btree_set(const _Alloc &__alloc) : _Base(_Compare(), __alloc) {}
+
+    btree_set(std::initializer_list<_Key> __ilist,
+              const _Compare &__comp = _Compare(),
+              const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {
+        this->_M_insert_range_unique(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    btree_set(_InputIt __first, _InputIt __last,
+              const _Compare &__comp = _Compare(),
+              const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {
+        this->_M_insert_range_unique(__first, __last);
+    }
+
+    // [__first, __last) 必须严格递增
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    btree_set(sorted_unique_t, _InputIt __first, _InputIt __last,
+              const _Compare &__comp = _Compare())
+        : _Base(__comp) {
+        this->_M_append_sorted(__first, __last);
+    }
+
+    btree_set(sorted_unique_t, std::initializer_list<_Key> __ilist,
+              const _Compare &__comp = _Compare())
+        : _Base(__comp) {
+        this->_M_append_sorted(__ilist.begin(), __ilist.end());
+    }
+
+    btree_set(btree_set &&) = default;
+
+    btree_set &operator=(btree_set &&) = default;
+
+    btree_set(const btree_set &) = default;
+
+    btree_set &operator=(const btree_set &) = default;
+
+    btree_set &operator=(std::initializer_list<_Key> __ilist) {
+        assign(__ilist);
+        return *this;
+    }
+
+    void assign(std::initializer_list<_Key> __ilist) {
+        this->clear();
+        this->_M_insert_range_unique(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(_InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_insert_range_unique(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(sorted_unique_t, _InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_append_sorted(__first, __last);
+    }
+
+    _Compare value_comp() const {
+        return this->_M_comp;
+    }
+
+    std::pair<iterator, bool> insert(const _Key &__value) {
+        return this->_M_try_emplace_key(__value, __value);
+    }
+
+    std::pair<iterator, bool> insert(_Key &&__value) {
+        return this->_M_try_emplace_key(__value, std::move(__value));
+    }
+
+    iterator insert(const_iterator __hint, const _Key &__value) {
+        return this->_M_try_emplace_key_hint(__hint, __value, __value);
+    }
+
+    iterator insert(const_iterator __hint, _Key &&__value) {
+        return this->_M_try_emplace_key_hint(__hint, __value,
+                                             std::move(__value));
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_insert_range_unique(__first, __last);
+    }
+
+    void insert(std::initializer_list<_Key> __ilist) {
+        this->_M_insert_range_unique(__ilist.begin(), __ilist.end());
+    }
+
+    // 键已存在时元素留在句柄中
+    std::pair<iterator, bool> insert(node_type &&__nh) {
+        return this->_M_insert_unique_handle(__nh);
+    }
+
+    template <typename... _Vs>
+    std::pair<iterator, bool> emplace(_Vs &&...__value) {
+        return this->_M_emplace_unique(std::forward<_Vs>(__value)...);
+    }
+
+    template <typename... _Vs>
+    iterator emplace_hint(const_iterator __hint, _Vs &&...__value) {
+        return this->_M_emplace_hint_unique(__hint,
+                                            std::forward<_Vs>(__value)...);
+    }
+
+    _LIBPENGCXX_DEFINE_COMPARISON(btree_set);
+};
+
+template <typename _Key, typename _Compare = std::less<_Key>,
+          typename _Alloc = std::allocator<_Key>, std::size_t _NodeBytes = 256>
+struct btree_multiset : _BTreeImpl<const _Key, _BTreeIdentity, _Compare,
+                                   _Alloc, _NodeBytes, true> {
+    using key_type = _Key;
+    using value_type = _Key;
+    using key_compare = _Compare;
+    using value_compare = _Compare;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+private:
+    using _Base = _BTreeImpl<const _Key, _BTreeIdentity, _Compare, _Alloc,
+                             _NodeBytes, true>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::iterator;
+    using typename _Base::node_type;
+
+    btree_multiset() = default;
+
+    explicit btree_multiset(const _Compare &__comp,
+                            const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {}
+
+    explicit btree_multiset(const _Alloc &__alloc)
+        : _Base(_Compare(), __alloc) {}
+
+    btree_multiset(std::initializer_list<_Key> __ilist,
+                   const _Compare &__comp = _Compare(),
+                   const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {
+        this->_M_insert_range_multi(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    btree_multiset(_InputIt __first, _InputIt __last,
+                   const _Compare &__comp = _Compare(),
+                   const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {
+        this->_M_insert_range_multi(__first, __last);
+    }
+
+    // [__first, __last) 必须非递减
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    btree_multiset(sorted_equivalent_t, _InputIt __first, _InputIt __last,
+                   const _Compare &__comp = _Compare())
+        : _Base(__comp) {
+        this->_M_append_sorted(__first, __last);
+    }
+
+    btree_multiset(sorted_equivalent_t, std::initializer_list<_Key> __ilist,
+                   const _Compare &__comp = _Compare())
+        : _Base(__comp) {
+        this->_M_append_sorted(__ilist.begin(), __ilist.end());
+    }
+
+    btree_multiset(btree_multiset &&) = default;
+
+    btree_multiset &operator=(btree_multiset &&) = default;
+
+    btree_multiset(const btree_multiset &) = default;
+
+    btree_multiset &operator=(const btree_multiset &) = default;
+
+    btree_multiset &operator=(std::initializer_list<_Key> __ilist) {
+        assign(__ilist);
+        return *this;
+    }
+
+    void assign(std::initializer_list<_Key> __ilist) {
+        this->clear();
+        this->_M_insert_range_multi(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(_InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_insert_range_multi(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(sorted_equivalent_t, _InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_append_sorted(__first, __last);
+    }
+
+    _Compare value_comp() const {
+        return this->_M_comp;
+    }
+
+    iterator insert(const _Key &__value) {
+        return this->_M_emplace_multi(__value);
+    }
+
+    iterator insert(_Key &&__value) {
+        return this->_M_emplace_multi(std::move(__value));
+    }
+
+    iterator insert(const_iterator __hint, const _Key &__value) {
+        return this->_M_emplace_hint_multi(__hint, __value);
+    }
+
+    iterator insert(const_iterator __hint, _Key &&__value) {
+        return this->_M_emplace_hint_multi(__hint, std::move(__value));
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_insert_range_multi(__first, __last);
+    }
+
+    void insert(std::initializer_list<_Key> __ilist) {
+        this->_M_insert_range_multi(__ilist.begin(), __ilist.end());
+    }
+
+    iterator insert(node_type &&__nh) {
+        return this->_M_insert_multi_handle(__nh);
+    }
+
+    template <typename... _Vs>
+    iterator emplace(_Vs &&...__value) {
+        return this->_M_emplace_multi(std::forward<_Vs>(__value)...);
+    }
+
+    template <typename... _Vs>
+    iterator emplace_hint(const_iterator __hint, _Vs &&...__value) {
+        return this->_M_emplace_hint_multi(__hint,
+                                           std::forward<_Vs>(__value)...);
+    }
+
+    _LIBPENGCXX_DEFINE_COMPARISON(btree_multiset);
+};
+
+} // namespace Marcus
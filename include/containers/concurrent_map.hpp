@@ -0,0 +1,252 @@
+#pragma once
+
+#include <atomic>
+#include <containers/persistent_map.hpp>
+#include <core/_common.hpp>
+#include <core/_epoch.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <utility/optional.hpp>
+#include <utility>
+
+namespace Marcus {
+
+// 读多写少的并发有序映射。每个版本是一棵 persistent_map，写者在互斥锁内
+// 复制出新版本（只复制被改的路径），再用一次原子存储发布；读者不加锁，
+// 也不碰引用计数，只在纪元临界区内读取当前版本。被替换下来的版本交给
+// 基于纪元的回收，等可能还在读它的读者都离开后，在之后的写操作中释放。
+// 读接口返回值的副本；需要遍历或多次读同一版本时用 snapshot()
+template <typename _Key, typename _Mapped, typename _Compare = std::less<_Key>,
+          typename _Alloc = std::allocator<std::pair<const _Key, _Mapped>>>
+struct concurrent_map {
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<const _Key, _Mapped>;
+    using key_compare = _Compare;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+    using snapshot_type = persistent_map<_Key, _Mapped, _Compare, _Alloc>;
+
+private:
+    struct _Version {
+        snapshot_type _M_map;
+        _Version *_M_next_retired = nullptr;
+        std::uint64_t _M_retired_epoch = 0;
+    };
+
+    using _VersionAlloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_Version>;
+    using _VersionTraits = std::allocator_traits<_VersionAlloc>;
+
+    // 读者只读这一行，与写者的状态分开放
+    alignas(64) std::atomic<_Version *> _M_current;
+    alignas(64) std::mutex _M_writer;
+    _Version *_M_retired = nullptr; // 新摘下的在前
+    [[no_unique_address]] _VersionAlloc _M_alloc;
+
+    template <class... _Ts>
+    _Version *_M_new_version(_Ts &&...__args) {
+        _Version *__version = _VersionTraits::allocate(_M_alloc, 1);
+        try {
+            _VersionTraits::construct(_M_alloc, __version,
+                                      std::forward<_Ts>(__args)...);
+        } catch (...) {
+            _VersionTraits::deallocate(_M_alloc, __version, 1);
+            throw;
+        }
+        return __version;
+    }
+
+    void _M_delete_version(_Version *__version) noexcept {
+        _VersionTraits::destroy(_M_alloc, __version);
+        _VersionTraits::deallocate(_M_alloc, __version, 1);
+    }
+
+    // 释放所有读者都已离开的旧版本，调用者持有写锁
+    void _M_collect() noexcept {
+        std::uint64_t __epoch = _EpochDomain::_S_try_advance();
+        _Version **__link = &_M_retired;
+        while (*__link) {
+            _Version *__version = *__link;
+            if (__version->_M_retired_epoch + 2 <= __epoch) {
+                *__link = __version->_M_next_retired;
+                _M_delete_version(__version);
+            } else {
+                __link = &__version->_M_next_retired;
+            }
+        }
+    }
+
+    const _Version *_M_load() const noexcept {
+        return _M_current.load(std::memory_order_seq_cst);
+    }
+
+public:
+    concurrent_map() : concurrent_map(_Compare()) {}
+
+    explicit concurrent_map(const _Compare &__comp,
+                            const _Alloc &__alloc = _Alloc())
+        : _M_alloc(__alloc) {
+        _M_current.store(_M_new_version(snapshot_type(__comp, __alloc)),
+                         std::memory_order_relaxed);
+    }
+
+    concurrent_map(std::initializer_list<value_type> __ilist,
+                   const _Compare &__comp = _Compare(),
+                   const _Alloc &__alloc = _Alloc())
+        : _M_alloc(__alloc) {
+        _M_current.store(
+            _M_new_version(snapshot_type(__ilist, __comp, __alloc)),
+            std::memory_order_relaxed);
+    }
+
+    concurrent_map(const concurrent_map &) = delete;
+
+    concurrent_map &operator=(const concurrent_map &) = delete;
+
+    // 析构时不能再有读者
+    ~concurrent_map() noexcept {
+        while (_M_retired) {
+            _M_delete_version(
+                std::exchange(_M_retired, _M_retired->_M_next_retired));
+        }
+        _M_delete_version(_M_current.load(std::memory_order_relaxed));
+    }
+
+    // 当前版本的 O(1) 快照，之后的写入不影响它
+    snapshot_type snapshot() const {
+        _EpochGuard __guard;
+        return _M_load()->_M_map;
+    }
+
+    std::size_t size() const {
+        _EpochGuard __guard;
+        return _M_load()->_M_map.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    bool contains(const _Kv &__key) const {
+        _EpochGuard __guard;
+        return _M_load()->_M_map.contains(__key);
+    }
+
+    bool contains(const _Key &__key) const {
+        _EpochGuard __guard;
+        return _M_load()->_M_map.contains(__key);
+    }
+
+    // 找到时在临界区内以 const value_type & 调用 __fn，元素不用复制出来
+    template <typename _Kv, class _Fn,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    bool visit(const _Kv &__key, _Fn &&__fn) const {
+        _EpochGuard __guard;
+        return _M_visit(_M_load()->_M_map.find(__key), __fn);
+    }
+
+    template <class _Fn>
+    bool visit(const _Key &__key, _Fn &&__fn) const {
+        _EpochGuard __guard;
+        return _M_visit(_M_load()->_M_map.find(__key), __fn);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    optional<_Mapped> get(const _Kv &__key) const {
+        optional<_Mapped> __result;
+        visit(__key, [&](const value_type &__value) {
+            __result = __value.second;
+        });
+        return __result;
+    }
+
+    optional<_Mapped> get(const _Key &__key) const {
+        optional<_Mapped> __result;
+        visit(__key, [&](const value_type &__value) {
+            __result = __value.second;
+        });
+        return __result;
+    }
+
+    // 在写锁内对新版本调用 __fn(snapshot_type &)，结束后一次性发布，
+    // 一批修改对读者是原子的。__fn 抛出异常时什么都不发布
+    template <class _Fn>
+    decltype(auto) update(_Fn &&__fn) {
+        std::lock_guard<std::mutex> __lock(_M_writer);
+        _Version *__old = _M_current.load(std::memory_order_relaxed);
+        _Version *__next = _M_new_version(__old->_M_map);
+        struct _Publish {
+            concurrent_map *_M_self;
+            _Version *_M_old;
+            _Version *_M_next;
+            int _M_exceptions = std::uncaught_exceptions();
+
+            ~_Publish() noexcept {
+                if (std::uncaught_exceptions() > _M_exceptions ||
+                    _M_next->_M_map.shares_with(_M_old->_M_map)) {
+                    _M_self->_M_delete_version(_M_next);
+                    return;
+                }
+                _M_self->_M_current.store(_M_next, std::memory_order_seq_cst);
+                _M_old->_M_retired_epoch = _EpochDomain::_S_current();
+                _M_old->_M_next_retired = _M_self->_M_retired;
+                _M_self->_M_retired = _M_old;
+                _M_self->_M_collect();
+            }
+        } __publish{this, __old, __next};
+        return __fn(__next->_M_map);
+    }
+
+    bool insert(const value_type &__value) {
+        return update([&](snapshot_type &__map) {
+            return __map.insert(__value);
+        });
+    }
+
+    template <class... _Ts>
+    bool try_emplace(const _Key &__key, _Ts &&...__mapped) {
+        return update([&](snapshot_type &__map) {
+            return __map.try_emplace(__key, std::forward<_Ts>(__mapped)...);
+        });
+    }
+
+    template <class _Mp>
+    bool insert_or_assign(const _Key &__key, _Mp &&__mapped) {
+        return update([&](snapshot_type &__map) {
+            return __map.insert_or_assign(__key, std::forward<_Mp>(__mapped));
+        });
+    }
+
+    std::size_t erase(const _Key &__key) {
+        return update([&](snapshot_type &__map) {
+            return __map.erase(__key);
+        });
+    }
+
+    void clear() {
+        update([](snapshot_type &__map) {
+            __map.clear();
+        });
+    }
+
+private:
+    template <class _It, class _Fn>
+    bool _M_visit(const _It &__it, _Fn &__fn) const {
+        if (__it == _It()) {
+            return false;
+        }
+        __fn(*__it);
+        return true;
+    }
+};
+
+} // namespace Marcus
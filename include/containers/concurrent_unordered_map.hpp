@@ -0,0 +1,583 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <containers/vector.hpp>
+#include <core/_common.hpp>
+#include <core/_epoch.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility/optional.hpp>
+#include <utility>
+
+namespace Marcus {
+
+// 分片的并发哈希表。哈希值的高位选分片，低位选桶；每个分片独占缓存行，
+// 有自己的写锁和链式哈希表。写者在分片锁内修改，读者不加锁，只在纪元
+// 临界区内沿桶链查找。链上的节点发布后不再修改：更新是换上一个新节点，
+// 删除是把节点摘下，扩容是复制出整张新表再换掉表指针；被替换下来的节点
+// 和旧表交给基于纪元的回收。读接口返回值的副本，元素需要可复制
+template <typename _Key, typename _Mapped, typename _Hash = std::hash<_Key>,
+          typename _KeyEqual = std::equal_to<_Key>,
+          typename _Alloc = std::allocator<std::pair<const _Key, _Mapped>>>
+struct concurrent_unordered_map {
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<const _Key, _Mapped>;
+    using hasher = _Hash;
+    using key_equal = _KeyEqual;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+
+private:
+    struct _Node {
+        std::atomic<_Node *> _M_next;
+        std::size_t _M_hash;
+
+        union {
+            value_type _M_value;
+        };
+
+        _Node() noexcept {}
+
+        ~_Node() noexcept {}
+    };
+
+    using _Bucket = std::atomic<_Node *>;
+
+    // 桶数总是 2 的幂，桶数组和掩码一起随表指针发布
+    struct _Table {
+        std::size_t _M_mask;
+        _Bucket *_M_buckets;
+    };
+
+    // 摘下的节点或整张旧表（连同链上的节点），以及摘下时的全局纪元
+    struct _Retired {
+        _Node *_M_node;
+        _Table *_M_table;
+        std::uint64_t _M_epoch;
+    };
+
+    using _NodeAlloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_Node>;
+    using _NodeTraits = std::allocator_traits<_NodeAlloc>;
+    using _TableAlloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_Table>;
+    using _TableTraits = std::allocator_traits<_TableAlloc>;
+    using _BucketAlloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_Bucket>;
+    using _BucketTraits = std::allocator_traits<_BucketAlloc>;
+    using _RetiredAlloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_Retired>;
+
+    // 读者只读 _M_table，写者的状态放到下一个缓存行
+    struct alignas(64) _Shard {
+        std::atomic<_Table *> _M_table{nullptr};
+        alignas(64) std::mutex _M_writer;
+        std::atomic<std::size_t> _M_size{0};
+        vector<_Retired, _RetiredAlloc> _M_retired;
+
+        explicit _Shard(const _Alloc &__alloc) noexcept
+            : _M_retired(_RetiredAlloc(__alloc)) {}
+    };
+
+    using _ShardAlloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_Shard>;
+    using _ShardTraits = std::allocator_traits<_ShardAlloc>;
+
+    static constexpr std::size_t _S_min_buckets = 8;
+    // 攒够这么多再回收，推进纪元要扫一遍所有线程的记录
+    static constexpr std::size_t _S_collect_batch = 32;
+
+    _Shard *_M_shards;
+    std::size_t _M_shard_mask;
+    [[no_unique_address]] _Hash _M_hash;
+    [[no_unique_address]] _KeyEqual _M_eq;
+    [[no_unique_address]] _NodeAlloc _M_alloc;
+
+public:
+    // 默认每个硬件线程 4 个分片
+    static size_type default_shard_count() noexcept {
+        std::size_t __threads = std::thread::hardware_concurrency();
+        return std::bit_ceil(std::clamp<std::size_t>(__threads * 4, 1, 1024));
+    }
+
+    concurrent_unordered_map()
+        : concurrent_unordered_map(default_shard_count()) {}
+
+    // 分片数向上取到 2 的幂
+    explicit concurrent_unordered_map(size_type __shard_count,
+                                      const _Hash &__hash = _Hash(),
+                                      const _KeyEqual &__eq = _KeyEqual(),
+                                      const _Alloc &__alloc = _Alloc())
+        : _M_shard_mask(std::bit_ceil(std::max<std::size_t>(__shard_count, 1)) -
+                        1),
+          _M_hash(__hash),
+          _M_eq(__eq),
+          _M_alloc(__alloc) {
+        _ShardAlloc __shard_alloc(_M_alloc);
+        _M_shards = _ShardTraits::allocate(__shard_alloc, _M_shard_mask + 1);
+        std::size_t __i = 0;
+        try {
+            for (; __i <= _M_shard_mask; ++__i) {
+                _Table *__table = _M_new_table(_S_min_buckets);
+                _Shard *__shard = new (_M_shards + __i) _Shard(__alloc);
+                __shard->_M_table.store(__table, std::memory_order_relaxed);
+            }
+        } catch (...) {
+            _M_destroy_shards(__i);
+            throw;
+        }
+    }
+
+    concurrent_unordered_map(const concurrent_unordered_map &) = delete;
+
+    concurrent_unordered_map &
+    operator=(const concurrent_unordered_map &) = delete;
+
+    // 析构时不能再有读者
+    ~concurrent_unordered_map() noexcept {
+        _M_destroy_shards(_M_shard_mask + 1);
+    }
+
+    size_type shard_count() const noexcept {
+        return _M_shard_mask + 1;
+    }
+
+    hasher hash_function() const {
+        return _M_hash;
+    }
+
+    key_equal key_eq() const {
+        return _M_eq;
+    }
+
+    // 有写者并发时只是近似值
+    size_type size() const noexcept {
+        std::size_t __n = 0;
+        for (std::size_t __i = 0; __i <= _M_shard_mask; ++__i) {
+            __n += _M_shards[__i]._M_size.load(std::memory_order_relaxed);
+        }
+        return __n;
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    bool contains(const _Kv &__key) const {
+        return visit(__key, [](const value_type &) {});
+    }
+
+    bool contains(const _Key &__key) const {
+        return visit(__key, [](const value_type &) {});
+    }
+
+    // 找到时在临界区内以 const value_type & 调用 __fn，元素不用复制出来
+    template <typename _Kv, class _Fn,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    bool visit(const _Kv &__key, _Fn &&__fn) const {
+        return _M_visit(__key, _M_hash_of(__key), __fn);
+    }
+
+    template <class _Fn>
+    bool visit(const _Key &__key, _Fn &&__fn) const {
+        return _M_visit(__key, _M_hash_of(__key), __fn);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    optional<_Mapped> get(const _Kv &__key) const {
+        optional<_Mapped> __result;
+        visit(__key, [&](const value_type &__value) {
+            __result = __value.second;
+        });
+        return __result;
+    }
+
+    optional<_Mapped> get(const _Key &__key) const {
+        optional<_Mapped> __result;
+        visit(__key, [&](const value_type &__value) {
+            __result = __value.second;
+        });
+        return __result;
+    }
+
+    // 逐个分片在临界区内访问所有元素。各分片看到的是各自某一时刻的状态，
+    // 整体不是一个快照
+    template <class _Fn>
+    void for_each(_Fn &&__fn) const {
+        for (std::size_t __i = 0; __i <= _M_shard_mask; ++__i) {
+            _EpochGuard __guard;
+            const _Table *__table = _S_load_table(_M_shards[__i]);
+            for (std::size_t __b = 0; __b <= __table->_M_mask; ++__b) {
+                for (const _Node *__node = _S_load(__table->_M_buckets[__b]);
+                     __node; __node = _S_load(__node->_M_next)) {
+                    __fn(static_cast<const value_type &>(__node->_M_value));
+                }
+            }
+        }
+    }
+
+    // 键存在时返回现有值的副本和 false，否则用 __args 构造映射值插入，
+    // 返回新值的副本和 true。命中时不加锁，也只算一次哈希
+    template <class... _Ts>
+    std::pair<_Mapped, bool> find_or_emplace(const _Key &__key,
+                                             _Ts &&...__args) {
+        std::size_t __h = _M_hash_of(__key);
+        optional<_Mapped> __found;
+        if (_M_visit(__key, __h, [&](const value_type &__value) {
+                __found = __value.second;
+            })) {
+            return {std::move(*__found), false};
+        }
+        _Shard &__shard = _M_shard_of(__h);
+        std::lock_guard<std::mutex> __lock(__shard._M_writer);
+        _Table *__table = __shard._M_table.load(std::memory_order_relaxed);
+        if (_Node *__node = *_M_find_link(__table, __key, __h)) {
+            return {__node->_M_value.second, false};
+        }
+        _Node *__node = _M_insert_new(__shard, __h, std::piecewise_construct,
+                                      std::forward_as_tuple(__key),
+                                      std::forward_as_tuple(
+                                          std::forward<_Ts>(__args)...));
+        return {__node->_M_value.second, true};
+    }
+
+    // 键存在时在分片锁内对新值的副本调用 __fn(mapped_type &)，再原子地
+    // 换上，返回 true；同一键上的 update_fn 互相串行。__fn 抛出异常时
+    // 什么都不改
+    template <class _Fn>
+    bool update_fn(const _Key &__key, _Fn &&__fn) {
+        std::size_t __h = _M_hash_of(__key);
+        _Shard &__shard = _M_shard_of(__h);
+        std::lock_guard<std::mutex> __lock(__shard._M_writer);
+        _Table *__table = __shard._M_table.load(std::memory_order_relaxed);
+        _Bucket *__link = _M_find_link(__table, __key, __h);
+        _Node *__old = __link->load(std::memory_order_relaxed);
+        if (!__old) {
+            return false;
+        }
+        __shard._M_retired.reserve(__shard._M_retired.size() + 1);
+        _Node *__node = _M_new_node(__h, __old->_M_value);
+        try {
+            __fn(__node->_M_value.second);
+        } catch (...) {
+            _M_delete_node(__node);
+            throw;
+        }
+        _M_replace(__shard, __link, __old, __node);
+        return true;
+    }
+
+    bool insert(const value_type &__value) {
+        return try_emplace(__value.first, __value.second);
+    }
+
+    template <class... _Ts>
+    bool try_emplace(const _Key &__key, _Ts &&...__args) {
+        std::size_t __h = _M_hash_of(__key);
+        _Shard &__shard = _M_shard_of(__h);
+        std::lock_guard<std::mutex> __lock(__shard._M_writer);
+        _Table *__table = __shard._M_table.load(std::memory_order_relaxed);
+        if (*_M_find_link(__table, __key, __h)) {
+            return false;
+        }
+        _M_insert_new(__shard, __h, std::piecewise_construct,
+                      std::forward_as_tuple(__key),
+                      std::forward_as_tuple(std::forward<_Ts>(__args)...));
+        return true;
+    }
+
+    // 插入时返回 true，覆盖已有值时返回 false
+    template <class _Mp>
+    bool insert_or_assign(const _Key &__key, _Mp &&__mapped) {
+        std::size_t __h = _M_hash_of(__key);
+        _Shard &__shard = _M_shard_of(__h);
+        std::lock_guard<std::mutex> __lock(__shard._M_writer);
+        _Table *__table = __shard._M_table.load(std::memory_order_relaxed);
+        _Bucket *__link = _M_find_link(__table, __key, __h);
+        if (_Node *__old = __link->load(std::memory_order_relaxed)) {
+            __shard._M_retired.reserve(__shard._M_retired.size() + 1);
+            _Node *__node =
+                _M_new_node(__h, __key, std::forward<_Mp>(__mapped));
+            _M_replace(__shard, __link, __old, __node);
+            return false;
+        }
+        _M_insert_new(__shard, __h, __key, std::forward<_Mp>(__mapped));
+        return true;
+    }
+
+    size_type erase(const _Key &__key) {
+        std::size_t __h = _M_hash_of(__key);
+        _Shard &__shard = _M_shard_of(__h);
+        std::lock_guard<std::mutex> __lock(__shard._M_writer);
+        _Table *__table = __shard._M_table.load(std::memory_order_relaxed);
+        _Bucket *__link = _M_find_link(__table, __key, __h);
+        _Node *__old = __link->load(std::memory_order_relaxed);
+        if (!__old) {
+            return 0;
+        }
+        __shard._M_retired.reserve(__shard._M_retired.size() + 1);
+        __link->store(__old->_M_next.load(std::memory_order_relaxed),
+                      std::memory_order_seq_cst);
+        __shard._M_size.fetch_sub(1, std::memory_order_relaxed);
+        _M_retire(__shard, __old, nullptr);
+        return 1;
+    }
+
+    // 逐个分片换上空表，不是原子的
+    void clear() {
+        for (std::size_t __i = 0; __i <= _M_shard_mask; ++__i) {
+            _Shard &__shard = _M_shards[__i];
+            std::lock_guard<std::mutex> __lock(__shard._M_writer);
+            if (__shard._M_size.load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            __shard._M_retired.reserve(__shard._M_retired.size() + 1);
+            _Table *__empty = _M_new_table(_S_min_buckets);
+            _Table *__old = __shard._M_table.exchange(
+                __empty, std::memory_order_seq_cst);
+            __shard._M_size.store(0, std::memory_order_relaxed);
+            _M_retire(__shard, nullptr, __old);
+        }
+    }
+
+private:
+    // 与 unordered_map 相同的打散：高位选分片，低位选桶
+    static std::size_t _S_mix(std::size_t __h) noexcept {
+#if defined(__SIZEOF_INT128__)
+        __uint128_t __m =
+            static_cast<__uint128_t>(__h) * 0x9e3779b97f4a7c15ull;
+        return static_cast<std::size_t>(__m ^ (__m >> 64));
+#else
+        std::uint64_t __x = __h;
+        __x ^= __x >> 33;
+        __x *= 0xff51afd7ed558ccdull;
+        __x ^= __x >> 33;
+        return static_cast<std::size_t>(__x);
+#endif
+    }
+
+    template <class _Kv>
+    std::size_t _M_hash_of(const _Kv &__key) const {
+        return _S_mix(static_cast<std::size_t>(_M_hash(__key)));
+    }
+
+    _Shard &_M_shard_of(std::size_t __h) const noexcept {
+        constexpr int __shift = std::numeric_limits<std::size_t>::digits / 2;
+        return _M_shards[(__h >> __shift) & _M_shard_mask];
+    }
+
+    // 读者的加载都是 seq_cst：写者先摘节点（换指针）再查纪元登记，
+    // 两边不可能都读到旧值。x86 上与普通加载一样，ARM 上是 ldar
+    static const _Node *_S_load(const _Bucket &__link) noexcept {
+        return __link.load(std::memory_order_seq_cst);
+    }
+
+    static const _Table *_S_load_table(const _Shard &__shard) noexcept {
+        return __shard._M_table.load(std::memory_order_seq_cst);
+    }
+
+    template <class _Kv, class _Fn>
+    bool _M_visit(const _Kv &__key, std::size_t __h, _Fn &&__fn) const {
+        _EpochGuard __guard;
+        const _Table *__table = _S_load_table(_M_shard_of(__h));
+        for (const _Node *__node =
+                 _S_load(__table->_M_buckets[__h & __table->_M_mask]);
+             __node; __node = _S_load(__node->_M_next)) {
+            if (__node->_M_hash == __h && _M_eq(__node->_M_value.first, __key)) {
+                __fn(static_cast<const value_type &>(__node->_M_value));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 返回指向目标节点的链接，没找到时返回链尾的空链接。调用者持有分片锁
+    template <class _Kv>
+    _Bucket *_M_find_link(_Table *__table, const _Kv &__key,
+                          std::size_t __h) const {
+        _Bucket *__link = &__table->_M_buckets[__h & __table->_M_mask];
+        for (_Node *__node; (__node = __link->load(std::memory_order_relaxed));
+             __link = &__node->_M_next) {
+            if (__node->_M_hash == __h && _M_eq(__node->_M_value.first, __key)) {
+                break;
+            }
+        }
+        return __link;
+    }
+
+    template <class... _Ts>
+    _Node *_M_new_node(std::size_t __h, _Ts &&...__value) {
+        _Node *__node = new (_NodeTraits::allocate(_M_alloc, 1)) _Node;
+        try {
+            new (const_cast<std::remove_const_t<value_type> *>(
+                std::addressof(__node->_M_value)))
+                value_type(std::forward<_Ts>(__value)...);
+        } catch (...) {
+            __node->~_Node();
+            _NodeTraits::deallocate(_M_alloc, __node, 1);
+            throw;
+        }
+        __node->_M_next.store(nullptr, std::memory_order_relaxed);
+        __node->_M_hash = __h;
+        return __node;
+    }
+
+    void _M_delete_node(_Node *__node) noexcept {
+        __node->_M_value.~value_type();
+        __node->~_Node();
+        _NodeTraits::deallocate(_M_alloc, __node, 1);
+    }
+
+    _Table *_M_new_table(std::size_t __buckets) {
+        _TableAlloc __table_alloc(_M_alloc);
+        _BucketAlloc __bucket_alloc(_M_alloc);
+        _Table *__table = _TableTraits::allocate(__table_alloc, 1);
+        try {
+            __table->_M_buckets =
+                _BucketTraits::allocate(__bucket_alloc, __buckets);
+        } catch (...) {
+            _TableTraits::deallocate(__table_alloc, __table, 1);
+            throw;
+        }
+        __table->_M_mask = __buckets - 1;
+        for (std::size_t __b = 0; __b < __buckets; ++__b) {
+            new (__table->_M_buckets + __b) _Bucket(nullptr);
+        }
+        return __table;
+    }
+
+    // 连同链上的节点一起释放
+    void _M_delete_table(_Table *__table) noexcept {
+        for (std::size_t __b = 0; __b <= __table->_M_mask; ++__b) {
+            _Node *__node =
+                __table->_M_buckets[__b].load(std::memory_order_relaxed);
+            while (__node) {
+                _Node *__next = __node->_M_next.load(std::memory_order_relaxed);
+                _M_delete_node(__node);
+                __node = __next;
+            }
+        }
+        _TableAlloc __table_alloc(_M_alloc);
+        _BucketAlloc __bucket_alloc(_M_alloc);
+        _BucketTraits::deallocate(__bucket_alloc, __table->_M_buckets,
+                                  __table->_M_mask + 1);
+        _TableTraits::deallocate(__table_alloc, __table, 1);
+    }
+
+    void _M_destroy_shards(std::size_t __count) noexcept {
+        for (std::size_t __i = 0; __i < __count; ++__i) {
+            _Shard &__shard = _M_shards[__i];
+            for (const _Retired &__retired: __shard._M_retired) {
+                _M_free_retired(__retired);
+            }
+            if (_Table *__table =
+                    __shard._M_table.load(std::memory_order_relaxed)) {
+                _M_delete_table(__table);
+            }
+            __shard.~_Shard();
+        }
+        _ShardAlloc __shard_alloc(_M_alloc);
+        _ShardTraits::deallocate(__shard_alloc, _M_shards, _M_shard_mask + 1);
+    }
+
+    void _M_free_retired(const _Retired &__retired) noexcept {
+        if (__retired._M_node) {
+            _M_delete_node(__retired._M_node);
+        } else {
+            _M_delete_table(__retired._M_table);
+        }
+    }
+
+    // 调用者持有分片锁，并已为这条记录预留了空间
+    void _M_retire(_Shard &__shard, _Node *__node, _Table *__table) noexcept {
+        __shard._M_retired.push_back(
+            _Retired{__node, __table, _EpochDomain::_S_current()});
+        if (__shard._M_retired.size() >= _S_collect_batch) {
+            _M_collect(__shard);
+        }
+    }
+
+    // 释放所有读者都已离开的记录
+    void _M_collect(_Shard &__shard) noexcept {
+        std::uint64_t __epoch = _EpochDomain::_S_try_advance();
+        std::size_t __kept = 0;
+        for (std::size_t __i = 0; __i < __shard._M_retired.size(); ++__i) {
+            _Retired __retired = __shard._M_retired[__i];
+            if (__retired._M_epoch + 2 <= __epoch) {
+                _M_free_retired(__retired);
+            } else {
+                __shard._M_retired[__kept++] = __retired;
+            }
+        }
+        __shard._M_retired.resize(__kept);
+    }
+
+    void _M_replace(_Shard &__shard, _Bucket *__link, _Node *__old,
+                    _Node *__node) noexcept {
+        __node->_M_next.store(__old->_M_next.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+        __link->store(__node, std::memory_order_seq_cst);
+        _M_retire(__shard, __old, nullptr);
+    }
+
+    // 负载因子超过 1 时先把分片扩容到两倍，再插到桶链头部。
+    // 调用者持有分片锁，并已确认键不存在
+    template <class... _Ts>
+    _Node *_M_insert_new(_Shard &__shard, std::size_t __h, _Ts &&...__value) {
+        _Table *__table = __shard._M_table.load(std::memory_order_relaxed);
+        std::size_t __size = __shard._M_size.load(std::memory_order_relaxed);
+        if (__size + 1 > __table->_M_mask + 1) {
+            __table = _M_grow(__shard, __table);
+        }
+        _Node *__node = _M_new_node(__h, std::forward<_Ts>(__value)...);
+        _Bucket &__bucket = __table->_M_buckets[__h & __table->_M_mask];
+        __node->_M_next.store(__bucket.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+        __bucket.store(__node, std::memory_order_release);
+        __shard._M_size.store(__size + 1, std::memory_order_relaxed);
+        return __node;
+    }
+
+    // 旧表上可能还有读者，节点不能搬走，只能复制到新表；旧表整张回收。
+    // 按两倍增长，复制的代价摊到每次插入上是 O(1)
+    _Table *_M_grow(_Shard &__shard, _Table *__old) {
+        __shard._M_retired.reserve(__shard._M_retired.size() + 1);
+        _Table *__table = _M_new_table((__old->_M_mask + 1) * 2);
+        try {
+            for (std::size_t __b = 0; __b <= __old->_M_mask; ++__b) {
+                for (_Node *__src =
+                         __old->_M_buckets[__b].load(std::memory_order_relaxed);
+                     __src;
+                     __src = __src->_M_next.load(std::memory_order_relaxed)) {
+                    _Node *__node = _M_new_node(__src->_M_hash, __src->_M_value);
+                    _Bucket &__bucket =
+                        __table->_M_buckets[__node->_M_hash & __table->_M_mask];
+                    __node->_M_next.store(
+                        __bucket.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+                    __bucket.store(__node, std::memory_order_relaxed);
+                }
+            }
+        } catch (...) {
+            _M_delete_table(__table);
+            throw;
+        }
+        __shard._M_table.store(__table, std::memory_order_seq_cst);
+        _M_retire(__shard, nullptr, __old);
+        return __table;
+    }
+};
+
+} // namespace Marcus
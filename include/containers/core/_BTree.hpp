@@ -0,0 +1,1348 @@
+#pragma once
+
+#include <core/_common.hpp>
+#include <core/_relocate.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Marcus {
+
+// set 的键就是元素本身
+struct _BTreeIdentity {
+    template <class _Tp>
+    const _Tp &operator()(const _Tp &__value) const noexcept {
+        return __value;
+    }
+
+    template <class _Tp>
+    static void _S_relocate(_Tp *__dst, _Tp *__src) noexcept {
+        std::construct_at(__dst, std::move(*__src));
+        std::destroy_at(__src);
+    }
+};
+
+// map 的键是 pair 的 first
+struct _BTreeSelectFirst {
+    template <class _Pair>
+    const typename _Pair::first_type &
+    operator()(const _Pair &__value) const noexcept {
+        return __value.first;
+    }
+
+    // 旧对象马上就要析构，可以去掉 first 的 const 把它移走
+    template <class _Pair>
+    static void _S_relocate(_Pair *__dst, _Pair *__src) noexcept {
+        using _Key = std::remove_const_t<typename _Pair::first_type>;
+        std::construct_at(
+            __dst, std::piecewise_construct,
+            std::forward_as_tuple(std::move(const_cast<_Key &>(__src->first))),
+            std::forward_as_tuple(std::move(__src->second)));
+        std::destroy_at(__src);
+    }
+};
+
+template <class _Slot>
+struct _BTreeSlotBuffer {
+    alignas(_Slot) unsigned char _M_buf[sizeof(_Slot)];
+
+    _Slot *_M_ptr() noexcept {
+        return reinterpret_cast<_Slot *>(_M_buf);
+    }
+};
+
+// 叶子节点只有元素，内部节点在后面多出 _S_capacity + 1 个子节点指针。
+// 元素按键有序地连续存放，查找时一个节点只碰一两条缓存行
+template <class _Slot, std::size_t _NodeBytes>
+struct _BTreeNode {
+    // 叶子节点大约占 _NodeBytes 字节，头部是父指针和三个小字段
+    static constexpr std::size_t _S_capacity = std::max<std::size_t>(
+        3, _NodeBytes > 2 * sizeof(void *)
+               ? (_NodeBytes - 2 * sizeof(void *)) / sizeof(_Slot)
+               : 0);
+    static_assert(_S_capacity < std::numeric_limits<std::uint16_t>::max(),
+                  "B-tree node is too large");
+
+    _BTreeNode *_M_parent;
+    std::uint16_t _M_position; // 在父节点中是第几个子节点
+    std::uint16_t _M_count;
+    bool _M_leaf;
+    alignas(_Slot) unsigned char _M_storage[_S_capacity * sizeof(_Slot)];
+
+    _Slot *_M_value(std::size_t __i) noexcept {
+        return reinterpret_cast<_Slot *>(_M_storage) + __i;
+    }
+
+    // 只对内部节点有效
+    _BTreeNode *&_M_child(std::size_t __i) noexcept;
+};
+
+template <class _Slot, std::size_t _NodeBytes>
+struct _BTreeInternal : _BTreeNode<_Slot, _NodeBytes> {
+    _BTreeNode<_Slot, _NodeBytes>
+        *_M_children[_BTreeNode<_Slot, _NodeBytes>::_S_capacity + 1];
+};
+
+template <class _Slot, std::size_t _NodeBytes>
+inline _BTreeNode<_Slot, _NodeBytes> *&
+_BTreeNode<_Slot, _NodeBytes>::_M_child(std::size_t __i) noexcept {
+    return static_cast<_BTreeInternal<_Slot, _NodeBytes> *>(this)
+        ->_M_children[__i];
+}
+
+// (节点, 下标)；end() 是最右叶子的末尾，空树时为 (nullptr, 0)
+template <class _Tp, class _Node>
+struct _BTreeIterator {
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::remove_const_t<_Tp>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = _Tp *;
+    using reference = _Tp &;
+
+    _Node *_M_node = nullptr;
+    std::size_t _M_pos = 0;
+
+    _BTreeIterator() noexcept = default;
+
+    _BTreeIterator(_Node *__node, std::size_t __pos) noexcept
+        : _M_node(__node),
+          _M_pos(__pos) {}
+
+    template <class _Up, class = std::enable_if_t<
+                             std::is_same_v<const _Up, _Tp> &&
+                             !std::is_same_v<_Up, _Tp>>>
+    _BTreeIterator(const _BTreeIterator<_Up, _Node> &__that) noexcept
+        : _M_node(__that._M_node),
+          _M_pos(__that._M_pos) {}
+
+    _BTreeIterator &operator++() noexcept {
+        if (_M_node->_M_leaf) {
+            if (++_M_pos < _M_node->_M_count) [[likely]] {
+                return *this;
+            }
+            // 叶子走完了：往上找第一个右边还有元素的祖先，找不到就停在 end()
+            _Node *__node = _M_node;
+            std::size_t __pos = _M_pos;
+            while (__pos == __node->_M_count && __node->_M_parent) {
+                __pos = __node->_M_position;
+                __node = __node->_M_parent;
+            }
+            if (__pos != __node->_M_count) {
+                _M_node = __node;
+                _M_pos = __pos;
+            }
+        } else {
+            _M_node = _M_node->_M_child(_M_pos + 1);
+            while (!_M_node->_M_leaf) {
+                _M_node = _M_node->_M_child(0);
+            }
+            _M_pos = 0;
+        }
+        return *this;
+    }
+
+    _BTreeIterator operator++(int) noexcept {
+        _BTreeIterator __tmp = *this;
+        ++*this;
+        return __tmp;
+    }
+
+    _BTreeIterator &operator--() noexcept {
+        if (_M_node->_M_leaf) {
+            if (_M_pos != 0) [[likely]] {
+                --_M_pos;
+                return *this;
+            }
+            _Node *__node = _M_node;
+            std::size_t __pos = 0;
+            while (__pos == 0 && __node->_M_parent) {
+                __pos = __node->_M_position;
+                __node = __node->_M_parent;
+            }
+            if (__pos != 0) {
+                _M_node = __node;
+                _M_pos = __pos - 1;
+            }
+        } else {
+            _M_node = _M_node->_M_child(_M_pos);
+            while (!_M_node->_M_leaf) {
+                _M_node = _M_node->_M_child(_M_node->_M_count);
+            }
+            _M_pos = _M_node->_M_count - 1u;
+        }
+        return *this;
+    }
+
+    _BTreeIterator operator--(int) noexcept {
+        _BTreeIterator __tmp = *this;
+        --*this;
+        return __tmp;
+    }
+
+    _Tp &operator*() const noexcept {
+        return *_M_node->_M_value(_M_pos);
+    }
+
+    _Tp *operator->() const noexcept {
+        return _M_node->_M_value(_M_pos);
+    }
+
+    bool operator==(const _BTreeIterator &__that) const noexcept {
+        return _M_node == __that._M_node && _M_pos == __that._M_pos;
+    }
+
+    bool operator!=(const _BTreeIterator &__that) const noexcept {
+        return !(*this == __that);
+    }
+};
+
+// B 树的元素不在独立的节点里，extract 把元素搬进句柄自带的缓冲区
+template <class _Slot, class _KeyOf, class = void>
+struct _BTreeNodeHandle {
+protected:
+    mutable _BTreeSlotBuffer<_Slot> _M_buf;
+    bool _M_engaged = false;
+
+    template <class, class, class, class, std::size_t, bool>
+    friend struct _BTreeImpl;
+
+    void _M_reset() noexcept {
+        if (_M_engaged) {
+            std::destroy_at(_M_buf._M_ptr());
+            _M_engaged = false;
+        }
+    }
+
+public:
+    using value_type = _Slot;
+
+    _BTreeNodeHandle() noexcept = default;
+
+    _BTreeNodeHandle(_BTreeNodeHandle &&__that) noexcept {
+        if (__that._M_engaged) {
+            _KeyOf::_S_relocate(_M_buf._M_ptr(), __that._M_buf._M_ptr());
+            _M_engaged = true;
+            __that._M_engaged = false;
+        }
+    }
+
+    _BTreeNodeHandle &operator=(_BTreeNodeHandle &&__that) noexcept {
+        if (&__that != this) [[likely]] {
+            _M_reset();
+            if (__that._M_engaged) {
+                _KeyOf::_S_relocate(_M_buf._M_ptr(), __that._M_buf._M_ptr());
+                _M_engaged = true;
+                __that._M_engaged = false;
+            }
+        }
+        return *this;
+    }
+
+    ~_BTreeNodeHandle() noexcept {
+        _M_reset();
+    }
+
+    bool empty() const noexcept {
+        return !_M_engaged;
+    }
+
+    explicit operator bool() const noexcept {
+        return _M_engaged;
+    }
+
+    _Slot &value() const noexcept {
+        return *_M_buf._M_ptr();
+    }
+};
+
+template <class _Slot>
+struct _BTreeNodeHandle<_Slot, _BTreeSelectFirst, void>
+    : _BTreeNodeHandle<_Slot, _BTreeSelectFirst, int> {
+    using _BTreeNodeHandle<_Slot, _BTreeSelectFirst, int>::_BTreeNodeHandle;
+
+    typename _Slot::first_type &key() const noexcept {
+        return this->value().first;
+    }
+
+    typename _Slot::second_type &mapped() const noexcept {
+        return this->value().second;
+    }
+};
+
+// 通用的 B 树（值同时存放在内部节点和叶子节点中）。
+// _Tp 是迭代器看到的元素类型（set 为 const _Key），_KeyOf 从元素中取出键；
+// _Multi 为 true 时允许等价的键。插入和删除会搬动元素，使所有迭代器失效
+template <class _Tp, class _KeyOf, class _Compare, class _Alloc,
+          std::size_t _NodeBytes, bool _Multi>
+struct _BTreeImpl {
+protected:
+    using _Slot = std::remove_const_t<_Tp>;
+    using _Node = _BTreeNode<_Slot, _NodeBytes>;
+    using _Internal = _BTreeInternal<_Slot, _NodeBytes>;
+    using _LeafAlloc =
+        typename std::allocator_traits<_Alloc>::template rebind_alloc<_Node>;
+    using _InternalAlloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_Internal>;
+
+    static constexpr std::size_t _S_capacity = _Node::_S_capacity;
+    // 非根节点删除后少于这么多元素时，向兄弟借一个或者和兄弟合并
+    static constexpr std::size_t _S_min = _S_capacity / 2;
+
+    template <class, class, class, class, std::size_t, bool>
+    friend struct _BTreeImpl;
+
+    _Node *_M_root = nullptr;
+    _Node *_M_leftmost = nullptr;
+    _Node *_M_rightmost = nullptr;
+    std::size_t _M_size = 0;
+    [[no_unique_address]] _Compare _M_comp;
+    [[no_unique_address]] _Alloc _M_alloc;
+
+public:
+    using key_type = std::remove_cvref_t<decltype(_KeyOf()(
+        std::declval<const _Slot &>()))>;
+    using key_compare = _Compare;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+    using iterator = _BTreeIterator<_Tp, _Node>;
+    using const_iterator = _BTreeIterator<const _Tp, _Node>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using node_type = _BTreeNodeHandle<_Slot, _KeyOf>;
+
+    // 每个节点最多能放的元素个数
+    static constexpr std::size_t node_capacity = _S_capacity;
+
+    _BTreeImpl() = default;
+
+    explicit _BTreeImpl(const _Compare &__comp,
+                        const _Alloc &__alloc = _Alloc())
+        : _M_comp(__comp),
+          _M_alloc(__alloc) {}
+
+    _BTreeImpl(_BTreeImpl &&__that) noexcept
+        : _M_root(__that._M_root),
+          _M_leftmost(__that._M_leftmost),
+          _M_rightmost(__that._M_rightmost),
+          _M_size(__that._M_size),
+          _M_comp(std::move(__that._M_comp)),
+          _M_alloc(std::move(__that._M_alloc)) {
+        __that._M_reset();
+    }
+
+    _BTreeImpl &operator=(_BTreeImpl &&__that) noexcept {
+        if (&__that != this) [[likely]] {
+            clear();
+            _M_root = __that._M_root;
+            _M_leftmost = __that._M_leftmost;
+            _M_rightmost = __that._M_rightmost;
+            _M_size = __that._M_size;
+            _M_comp = std::move(__that._M_comp);
+            _M_alloc = std::move(__that._M_alloc);
+            __that._M_reset();
+        }
+        return *this;
+    }
+
+    _BTreeImpl(const _BTreeImpl &__that)
+        : _M_comp(__that._M_comp),
+          _M_alloc(std::allocator_traits<_Alloc>::
+                       select_on_container_copy_construction(__that._M_alloc)) {
+        _M_append_sorted(__that.begin(), __that.end());
+    }
+
+    _BTreeImpl &operator=(const _BTreeImpl &__that) {
+        if (&__that != this) [[likely]] {
+            clear();
+            _M_comp = __that._M_comp;
+            _M_append_sorted(__that.begin(), __that.end());
+        }
+        return *this;
+    }
+
+    ~_BTreeImpl() noexcept {
+        clear();
+    }
+
+    iterator begin() noexcept {
+        return iterator(_M_leftmost, 0);
+    }
+
+    iterator end() noexcept {
+        return _M_end();
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(_M_leftmost, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return _M_end();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    bool empty() const noexcept {
+        return _M_size == 0;
+    }
+
+    size_type size() const noexcept {
+        return _M_size;
+    }
+
+    static constexpr size_type max_size() noexcept {
+        return std::numeric_limits<std::ptrdiff_t>::max() / sizeof(_Slot);
+    }
+
+    _Compare key_comp() const {
+        return _M_comp;
+    }
+
+    _Alloc get_allocator() const noexcept {
+        return _M_alloc;
+    }
+
+    void clear() noexcept {
+        if (_M_root != nullptr) {
+            _M_destroy_subtree(_M_root);
+            _M_reset();
+        }
+    }
+
+    void swap(_BTreeImpl &__that) noexcept {
+        std::swap(_M_root, __that._M_root);
+        std::swap(_M_leftmost, __that._M_leftmost);
+        std::swap(_M_rightmost, __that._M_rightmost);
+        std::swap(_M_size, __that._M_size);
+        std::swap(_M_comp, __that._M_comp);
+        std::swap(_M_alloc, __that._M_alloc);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    iterator find(const _Kv &__key) {
+        return _M_find(__key);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    const_iterator find(const _Kv &__key) const {
+        return _M_find(__key);
+    }
+
+    iterator find(const key_type &__key) {
+        return _M_find(__key);
+    }
+
+    const_iterator find(const key_type &__key) const {
+        return _M_find(__key);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    bool contains(const _Kv &__key) const {
+        return _M_find(__key) != _M_end();
+    }
+
+    bool contains(const key_type &__key) const {
+        return _M_find(__key) != _M_end();
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    size_type count(const _Kv &__key) const {
+        return _M_count(__key);
+    }
+
+    size_type count(const key_type &__key) const {
+        return _M_count(__key);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    iterator lower_bound(const _Kv &__key) {
+        return _M_lower(__key);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    const_iterator lower_bound(const _Kv &__key) const {
+        return _M_lower(__key);
+    }
+
+    iterator lower_bound(const key_type &__key) {
+        return _M_lower(__key);
+    }
+
+    const_iterator lower_bound(const key_type &__key) const {
+        return _M_lower(__key);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    iterator upper_bound(const _Kv &__key) {
+        return _M_upper(__key);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    const_iterator upper_bound(const _Kv &__key) const {
+        return _M_upper(__key);
+    }
+
+    iterator upper_bound(const key_type &__key) {
+        return _M_upper(__key);
+    }
+
+    const_iterator upper_bound(const key_type &__key) const {
+        return _M_upper(__key);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    std::pair<iterator, iterator> equal_range(const _Kv &__key) {
+        return _M_equal_range(__key);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    std::pair<const_iterator, const_iterator>
+    equal_range(const _Kv &__key) const {
+        return _M_equal_range(__key);
+    }
+
+    std::pair<iterator, iterator> equal_range(const key_type &__key) {
+        return _M_equal_range(__key);
+    }
+
+    std::pair<const_iterator, const_iterator>
+    equal_range(const key_type &__key) const {
+        return _M_equal_range(__key);
+    }
+
+    iterator erase(const_iterator __it) noexcept {
+        std::destroy_at(__it._M_node->_M_value(__it._M_pos));
+        return _M_erase_hole(__it._M_node, __it._M_pos);
+    }
+
+    iterator erase(const_iterator __first, const_iterator __last) noexcept {
+        if (__first == begin() && __last == end()) {
+            clear();
+            return end();
+        }
+        // 每次删除都可能搬动元素，先数出要删几个
+        return _M_erase_n(
+            __first, static_cast<size_type>(std::distance(__first, __last)));
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    size_type erase(const _Kv &__key) {
+        return _M_erase_key(__key);
+    }
+
+    size_type erase(const key_type &__key) {
+        return _M_erase_key(__key);
+    }
+
+    node_type extract(const_iterator __it) noexcept {
+        node_type __nh;
+        _S_relocate_n(__nh._M_buf._M_ptr(),
+                      __it._M_node->_M_value(__it._M_pos), 1);
+        __nh._M_engaged = true;
+        _M_erase_hole(__it._M_node, __it._M_pos);
+        return __nh;
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, key_type)>
+    node_type extract(const _Kv &__key) {
+        iterator __it = _M_find(__key);
+        return __it != _M_end() ? extract(__it) : node_type();
+    }
+
+    node_type extract(const key_type &__key) {
+        iterator __it = _M_find(__key);
+        return __it != _M_end() ? extract(__it) : node_type();
+    }
+
+    // 把 __src 中的元素直接搬过来（不复制、不经过句柄）；
+    // 唯一键的容器里已有的键留在 __src 中
+    template <bool _OtherMulti>
+    void merge(_BTreeImpl<_Tp, _KeyOf, _Compare, _Alloc, _NodeBytes,
+                          _OtherMulti> &__src) {
+        if (static_cast<void *>(&__src) == static_cast<void *>(this)) {
+            return;
+        }
+        iterator __it = __src.begin();
+        while (__it != __src._M_end()) {
+            iterator __pos;
+            if constexpr (_Multi) {
+                __pos = _M_find_insert_multi(_KeyOf()(*__it));
+            } else {
+                bool __found;
+                std::tie(__pos, __found) =
+                    _M_find_insert_unique(_KeyOf()(*__it));
+                if (__found) {
+                    ++__it;
+                    continue;
+                }
+            }
+            _M_insert_relocated(__pos, __it._M_node->_M_value(__it._M_pos));
+            __it = __src._M_erase_hole(__it._M_node, __it._M_pos);
+        }
+    }
+
+    template <bool _OtherMulti>
+    void merge(_BTreeImpl<_Tp, _KeyOf, _Compare, _Alloc, _NodeBytes,
+                          _OtherMulti> &&__src) {
+        merge(__src);
+    }
+
+protected:
+    static const key_type &_S_key(_Node *__node, size_type __i) noexcept {
+        return _KeyOf()(*__node->_M_value(__i));
+    }
+
+    // 区间可以重叠
+    static void _S_relocate_n(_Slot *__dst, _Slot *__src,
+                              size_type __n) noexcept {
+        if constexpr (is_trivially_relocatable_v<_Slot>) {
+            if (__n != 0) {
+                std::memmove(static_cast<void *>(__dst),
+                             static_cast<const void *>(__src),
+                             __n * sizeof(_Slot));
+            }
+        } else if (__dst < __src) {
+            for (size_type __i = 0; __i != __n; ++__i) {
+                _KeyOf::_S_relocate(__dst + __i, __src + __i);
+            }
+        } else {
+            for (size_type __i = __n; __i != 0; --__i) {
+                _KeyOf::_S_relocate(__dst + __i - 1, __src + __i - 1);
+            }
+        }
+    }
+
+    static void _S_set_child(_Node *__node, size_type __i,
+                             _Node *__child) noexcept {
+        __node->_M_child(__i) = __child;
+        __child->_M_parent = __node;
+        __child->_M_position = static_cast<std::uint16_t>(__i);
+    }
+
+    // (__node, __pos) 可能是叶子末尾，往上找到真正的下一个元素；
+    // 已经是最后一个时返回 (nullptr, 0)
+    static iterator _S_climb(_Node *__node, size_type __pos) noexcept {
+        while (__pos == __node->_M_count && __node->_M_parent) {
+            __pos = __node->_M_position;
+            __node = __node->_M_parent;
+        }
+        return __pos == __node->_M_count ? iterator()
+                                         : iterator(__node, __pos);
+    }
+
+    // 紧挨在 __it 前面的叶子位置
+    static iterator _S_leaf_before(iterator __it) noexcept {
+        if (__it._M_node->_M_leaf) {
+            return __it;
+        }
+        _Node *__node = __it._M_node->_M_child(__it._M_pos);
+        while (!__node->_M_leaf) {
+            __node = __node->_M_child(__node->_M_count);
+        }
+        return iterator(__node, __node->_M_count);
+    }
+
+    iterator _M_end() const noexcept {
+        return iterator(_M_rightmost,
+                        _M_rightmost ? _M_rightmost->_M_count : 0);
+    }
+
+    iterator _M_settle(_Node *__node, size_type __pos) const noexcept {
+        iterator __it = _S_climb(__node, __pos);
+        return __it._M_node ? __it : _M_end();
+    }
+
+    template <class _Kv>
+    size_type _M_node_lower(_Node *__node, const _Kv &__key) const {
+        size_type __lo = 0;
+        size_type __hi = __node->_M_count;
+        while (__lo < __hi) {
+            size_type __mid = (__lo + __hi) / 2;
+            if (_M_comp(_S_key(__node, __mid), __key)) {
+                __lo = __mid + 1;
+            } else {
+                __hi = __mid;
+            }
+        }
+        return __lo;
+    }
+
+    template <class _Kv>
+    size_type _M_node_upper(_Node *__node, const _Kv &__key) const {
+        size_type __lo = 0;
+        size_type __hi = __node->_M_count;
+        while (__lo < __hi) {
+            size_type __mid = (__lo + __hi) / 2;
+            if (_M_comp(__key, _S_key(__node, __mid))) {
+                __hi = __mid;
+            } else {
+                __lo = __mid + 1;
+            }
+        }
+        return __lo;
+    }
+
+    template <class _Kv>
+    iterator _M_lower(const _Kv &__key) const {
+        _Node *__node = _M_root;
+        if (__node == nullptr) {
+            return iterator();
+        }
+        while (true) {
+            size_type __pos = _M_node_lower(__node, __key);
+            if (__node->_M_leaf) {
+                return _M_settle(__node, __pos);
+            }
+            __node = __node->_M_child(__pos);
+        }
+    }
+
+    template <class _Kv>
+    iterator _M_upper(const _Kv &__key) const {
+        _Node *__node = _M_root;
+        if (__node == nullptr) {
+            return iterator();
+        }
+        while (true) {
+            size_type __pos = _M_node_upper(__node, __key);
+            if (__node->_M_leaf) {
+                return _M_settle(__node, __pos);
+            }
+            __node = __node->_M_child(__pos);
+        }
+    }
+
+    template <class _Kv>
+    iterator _M_find(const _Kv &__key) const {
+        if constexpr (_Multi) {
+            iterator __it = _M_lower(__key);
+            return __it == _M_end() || _M_comp(__key, _KeyOf()(*__it))
+                       ? _M_end()
+                       : __it;
+        } else {
+            // 键唯一，在内部节点命中就可以停下
+            _Node *__node = _M_root;
+            if (__node == nullptr) {
+                return iterator();
+            }
+            while (true) {
+                size_type __pos = _M_node_lower(__node, __key);
+                if (__pos != __node->_M_count &&
+                    !_M_comp(__key, _S_key(__node, __pos))) {
+                    return iterator(__node, __pos);
+                }
+                if (__node->_M_leaf) {
+                    return _M_end();
+                }
+                __node = __node->_M_child(__pos);
+            }
+        }
+    }
+
+    template <class _Kv>
+    std::pair<iterator, iterator> _M_equal_range(const _Kv &__key) const {
+        if constexpr (_Multi) {
+            return {_M_lower(__key), _M_upper(__key)};
+        } else {
+            iterator __it = _M_lower(__key);
+            if (__it == _M_end() || _M_comp(__key, _KeyOf()(*__it))) {
+                return {__it, __it};
+            }
+            return {__it, std::next(__it)};
+        }
+    }
+
+    template <class _Kv>
+    size_type _M_count(const _Kv &__key) const {
+        if constexpr (_Multi) {
+            std::pair<iterator, iterator> __range = _M_equal_range(__key);
+            return static_cast<size_type>(
+                std::distance(__range.first, __range.second));
+        } else {
+            return _M_find(__key) != _M_end() ? 1 : 0;
+        }
+    }
+
+    // 唯一键的插入位置：找到等价的元素时返回它和 true，
+    // 否则返回叶子中的插入位置和 false（空树时节点为空）
+    template <class _Kv>
+    std::pair<iterator, bool> _M_find_insert_unique(const _Kv &__key) const {
+        _Node *__node = _M_root;
+        if (__node == nullptr) {
+            return {iterator(), false};
+        }
+        while (true) {
+            size_type __pos = _M_node_lower(__node, __key);
+            if (__pos != __node->_M_count &&
+                !_M_comp(__key, _S_key(__node, __pos))) {
+                return {iterator(__node, __pos), true};
+            }
+            if (__node->_M_leaf) {
+                return {iterator(__node, __pos), false};
+            }
+            __node = __node->_M_child(__pos);
+        }
+    }
+
+    // 提示正确（新元素应该紧挨在 __hint 前面）时只比较一两次
+    template <class _Kv>
+    std::pair<iterator, bool> _M_find_insert_unique(const_iterator __hint,
+                                                    const _Kv &__key) const {
+        if (_M_root != nullptr) {
+            iterator __it(__hint._M_node, __hint._M_pos);
+            if (__it != _M_end() && !_M_comp(__key, _KeyOf()(*__it))) {
+                if (!_M_comp(_KeyOf()(*__it), __key)) {
+                    return {__it, true};
+                }
+            } else if ((__it._M_node == _M_leftmost && __it._M_pos == 0) ||
+                       _M_comp(_KeyOf()(*std::prev(__it)), __key)) {
+                return {_S_leaf_before(__it), false};
+            }
+        }
+        return _M_find_insert_unique(__key);
+    }
+
+    // 等价的键插在已有元素之后
+    template <class _Kv>
+    iterator _M_find_insert_multi(const _Kv &__key) const {
+        _Node *__node = _M_root;
+        if (__node == nullptr) {
+            return iterator();
+        }
+        while (true) {
+            size_type __pos = _M_node_upper(__node, __key);
+            if (__node->_M_leaf) {
+                return iterator(__node, __pos);
+            }
+            __node = __node->_M_child(__pos);
+        }
+    }
+
+    template <class _Kv>
+    iterator _M_find_insert_multi(const_iterator __hint,
+                                  const _Kv &__key) const {
+        if (_M_root != nullptr) {
+            iterator __it(__hint._M_node, __hint._M_pos);
+            if ((__it == _M_end() || !_M_comp(_KeyOf()(*__it), __key)) &&
+                ((__it._M_node == _M_leftmost && __it._M_pos == 0) ||
+                 !_M_comp(__key, _KeyOf()(*std::prev(__it))))) {
+                return _S_leaf_before(__it);
+            }
+        }
+        return _M_find_insert_multi(__key);
+    }
+
+    // 键不存在时才用 __args 构造新元素
+    template <class _Kv, class... _Args>
+    std::pair<iterator, bool> _M_try_emplace_key(const _Kv &__key,
+                                                 _Args &&...__args) {
+        std::pair<iterator, bool> __pos = _M_find_insert_unique(__key);
+        if (__pos.second) {
+            return {__pos.first, false};
+        }
+        return {_M_insert_args(__pos.first, std::forward<_Args>(__args)...),
+                true};
+    }
+
+    template <class _Kv, class... _Args>
+    iterator _M_try_emplace_key_hint(const_iterator __hint, const _Kv &__key,
+                                     _Args &&...__args) {
+        std::pair<iterator, bool> __pos = _M_find_insert_unique(__hint, __key);
+        if (__pos.second) {
+            return __pos.first;
+        }
+        return _M_insert_args(__pos.first, std::forward<_Args>(__args)...);
+    }
+
+    // 键要等构造出元素之后才知道
+    template <class... _Args>
+    std::pair<iterator, bool> _M_emplace_unique(_Args &&...__args) {
+        _BTreeSlotBuffer<_Slot> __tmp;
+        _Slot *__value = std::construct_at(__tmp._M_ptr(),
+                                           std::forward<_Args>(__args)...);
+        std::pair<iterator, bool> __pos;
+        try {
+            __pos = _M_find_insert_unique(_KeyOf()(*__value));
+        } catch (...) {
+            std::destroy_at(__value);
+            throw;
+        }
+        if (__pos.second) {
+            std::destroy_at(__value);
+            return {__pos.first, false};
+        }
+        return {_M_insert_buffered(__pos.first, __value), true};
+    }
+
+    template <class... _Args>
+    iterator _M_emplace_hint_unique(const_iterator __hint, _Args &&...__args) {
+        _BTreeSlotBuffer<_Slot> __tmp;
+        _Slot *__value = std::construct_at(__tmp._M_ptr(),
+                                           std::forward<_Args>(__args)...);
+        std::pair<iterator, bool> __pos;
+        try {
+            __pos = _M_find_insert_unique(__hint, _KeyOf()(*__value));
+        } catch (...) {
+            std::destroy_at(__value);
+            throw;
+        }
+        if (__pos.second) {
+            std::destroy_at(__value);
+            return __pos.first;
+        }
+        return _M_insert_buffered(__pos.first, __value);
+    }
+
+    template <class... _Args>
+    iterator _M_emplace_multi(_Args &&...__args) {
+        _BTreeSlotBuffer<_Slot> __tmp;
+        _Slot *__value = std::construct_at(__tmp._M_ptr(),
+                                           std::forward<_Args>(__args)...);
+        iterator __pos;
+        try {
+            __pos = _M_find_insert_multi(_KeyOf()(*__value));
+        } catch (...) {
+            std::destroy_at(__value);
+            throw;
+        }
+        return _M_insert_buffered(__pos, __value);
+    }
+
+    template <class... _Args>
+    iterator _M_emplace_hint_multi(const_iterator __hint, _Args &&...__args) {
+        _BTreeSlotBuffer<_Slot> __tmp;
+        _Slot *__value = std::construct_at(__tmp._M_ptr(),
+                                           std::forward<_Args>(__args)...);
+        iterator __pos;
+        try {
+            __pos = _M_find_insert_multi(__hint, _KeyOf()(*__value));
+        } catch (...) {
+            std::destroy_at(__value);
+            throw;
+        }
+        return _M_insert_buffered(__pos, __value);
+    }
+
+    // 以 end() 为提示逐个插入，有序的输入每个元素只比较一次
+    template <class _InputIt>
+    void _M_insert_range_unique(_InputIt __first, _InputIt __last) {
+        for (; __first != __last; ++__first) {
+            _M_emplace_hint_unique(end(), *__first);
+        }
+    }
+
+    template <class _InputIt>
+    void _M_insert_range_multi(_InputIt __first, _InputIt __last) {
+        for (; __first != __last; ++__first) {
+            _M_emplace_hint_multi(end(), *__first);
+        }
+    }
+
+    // 调用者保证 [__first, __last) 有序且都不小于已有元素，直接追加到最右边
+    template <class _InputIt>
+    void _M_append_sorted(_InputIt __first, _InputIt __last) {
+        for (; __first != __last; ++__first) {
+            _M_insert_args(_M_end(), *__first);
+        }
+    }
+
+    std::pair<iterator, bool> _M_insert_unique_handle(node_type &__nh) {
+        if (__nh.empty()) {
+            return {_M_end(), false};
+        }
+        std::pair<iterator, bool> __pos =
+            _M_find_insert_unique(_KeyOf()(__nh.value()));
+        if (__pos.second) {
+            return {__pos.first, false};
+        }
+        iterator __it = _M_insert_relocated(__pos.first, __nh._M_buf._M_ptr());
+        __nh._M_engaged = false;
+        return {__it, true};
+    }
+
+    iterator _M_insert_multi_handle(node_type &__nh) {
+        if (__nh.empty()) {
+            return _M_end();
+        }
+        iterator __it = _M_insert_relocated(
+            _M_find_insert_multi(_KeyOf()(__nh.value())),
+            __nh._M_buf._M_ptr());
+        __nh._M_engaged = false;
+        return __it;
+    }
+
+    // __args 可能引用树中的元素，而插入会搬动元素，所以先在栈上构造
+    template <class... _Args>
+    iterator _M_insert_args(iterator __pos, _Args &&...__args) {
+        _BTreeSlotBuffer<_Slot> __tmp;
+        _Slot *__value = std::construct_at(__tmp._M_ptr(),
+                                           std::forward<_Args>(__args)...);
+        return _M_insert_buffered(__pos, __value);
+    }
+
+    iterator _M_insert_buffered(iterator __pos, _Slot *__value) {
+        try {
+            return _M_insert_relocated(__pos, __value);
+        } catch (...) {
+            std::destroy_at(__value);
+            throw;
+        }
+    }
+
+    // 把已经构造好的 *__value 搬到叶子中的位置 __pos。
+    // 分裂节点时分配失败会抛出异常，此时 *__value 原样留给调用者
+    iterator _M_insert_relocated(iterator __pos, _Slot *__value) {
+        _Node *__node = __pos._M_node;
+        size_type __i = __pos._M_pos;
+        if (__node == nullptr) {
+            __node = _M_new_node(true);
+            _M_root = _M_leftmost = _M_rightmost = __node;
+            __i = 0;
+        } else if (__node->_M_count == _S_capacity) {
+            _M_split(__node, __i);
+        }
+        _S_relocate_n(__node->_M_value(__i + 1), __node->_M_value(__i),
+                      __node->_M_count - __i);
+        _S_relocate_n(__node->_M_value(__i), __value, 1);
+        ++__node->_M_count;
+        ++_M_size;
+        return iterator(__node, __i);
+    }
+
+    // 把满节点 __node 一分为二，中间的元素上移到父节点（父节点满了先分裂
+    // 父节点），(__node, __pos) 随之改为插入位置所在的那一半。
+    // 在最右边追加时只给新节点留下新元素，顺序插入能把节点填满
+    void _M_split(_Node *&__node, size_type &__pos) {
+        _Node *__right = _M_new_node(__node->_M_leaf);
+        try {
+            _Node *__parent = __node->_M_parent;
+            if (__parent == nullptr) {
+                __parent = _M_new_node(false);
+                _S_set_child(__parent, 0, __node);
+                _M_root = __parent;
+            } else if (__parent->_M_count == _S_capacity) {
+                size_type __at = __node->_M_position;
+                _M_split(__parent, __at);
+            }
+        } catch (...) {
+            _M_free_node(__right);
+            throw;
+        }
+        _Node *__parent = __node->_M_parent;
+        size_type __count = __node->_M_count;
+        size_type __mid = __pos == __count ? __count - 1 : __count / 2;
+        size_type __moved = __count - __mid - 1;
+        _S_relocate_n(__right->_M_value(0), __node->_M_value(__mid + 1),
+                      __moved);
+        if (!__node->_M_leaf) {
+            for (size_type __i = 0; __i <= __moved; ++__i) {
+                _S_set_child(__right, __i, __node->_M_child(__mid + 1 + __i));
+            }
+        }
+        __right->_M_count = static_cast<std::uint16_t>(__moved);
+
+        size_type __at = __node->_M_position;
+        _S_relocate_n(__parent->_M_value(__at + 1), __parent->_M_value(__at),
+                      __parent->_M_count - __at);
+        for (size_type __i = __parent->_M_count; __i > __at; --__i) {
+            _S_set_child(__parent, __i + 1, __parent->_M_child(__i));
+        }
+        _S_relocate_n(__parent->_M_value(__at), __node->_M_value(__mid), 1);
+        _S_set_child(__parent, __at + 1, __right);
+        ++__parent->_M_count;
+        __node->_M_count = static_cast<std::uint16_t>(__mid);
+
+        if (__node == _M_rightmost) {
+            _M_rightmost = __right;
+        }
+        if (__pos > __mid) {
+            __node = __right;
+            __pos -= __mid + 1;
+        }
+    }
+
+    template <class _Kv>
+    size_type _M_erase_key(const _Kv &__key) {
+        if constexpr (_Multi) {
+            std::pair<iterator, iterator> __range = _M_equal_range(__key);
+            size_type __n = static_cast<size_type>(
+                std::distance(__range.first, __range.second));
+            _M_erase_n(__range.first, __n);
+            return __n;
+        } else {
+            iterator __it = _M_find(__key);
+            if (__it == _M_end()) {
+                return 0;
+            }
+            erase(__it);
+            return 1;
+        }
+    }
+
+    iterator _M_erase_n(const_iterator __first, size_type __n) noexcept {
+        iterator __it(__first._M_node, __first._M_pos);
+        for (; __n != 0; --__n) {
+            __it = erase(__it);
+        }
+        return __it;
+    }
+
+    // (__node, __pos) 处的元素已经析构或被搬走，补上空位并重新平衡，
+    // 返回原来下一个元素的位置
+    iterator _M_erase_hole(_Node *__node, size_type __pos) noexcept {
+        _Node *__leaf = __node;
+        iterator __next;
+        if (__node->_M_leaf) {
+            _S_relocate_n(__node->_M_value(__pos), __node->_M_value(__pos + 1),
+                          __node->_M_count - __pos - 1);
+            --__node->_M_count;
+            __next = _S_climb(__node, __pos);
+        } else {
+            // 用前驱（左子树中最大的元素）补上，后继是右子树中最小的元素
+            __leaf = __node->_M_child(__pos);
+            while (!__leaf->_M_leaf) {
+                __leaf = __leaf->_M_child(__leaf->_M_count);
+            }
+            --__leaf->_M_count;
+            _S_relocate_n(__node->_M_value(__pos),
+                          __leaf->_M_value(__leaf->_M_count), 1);
+            _Node *__succ = __node->_M_child(__pos + 1);
+            while (!__succ->_M_leaf) {
+                __succ = __succ->_M_child(0);
+            }
+            __next = iterator(__succ, 0);
+        }
+        --_M_size;
+        _M_rebalance(__leaf, __next);
+        return __next._M_node ? __next : _M_end();
+    }
+
+    // 从 __node 往上修复元素过少的节点；__next 跟着元素的移动更新
+    void _M_rebalance(_Node *__node, iterator &__next) noexcept {
+        while (__node != _M_root && __node->_M_count < _S_min) {
+            _Node *__parent = __node->_M_parent;
+            size_type __idx = __node->_M_position;
+            if (__idx > 0) {
+                _Node *__left = __parent->_M_child(__idx - 1);
+                if (__left->_M_count > _S_min) {
+                    _M_rotate_right(__left, __node, __next);
+                    return;
+                }
+            }
+            if (__idx < __parent->_M_count) {
+                _Node *__right = __parent->_M_child(__idx + 1);
+                if (__right->_M_count > _S_min) {
+                    _M_rotate_left(__node, __right, __next);
+                    return;
+                }
+            }
+            if (__idx > 0) {
+                _M_merge_nodes(__parent->_M_child(__idx - 1), __node, __next);
+            } else {
+                _M_merge_nodes(__node, __parent->_M_child(1), __next);
+            }
+            __node = __parent;
+        }
+        _Node *__root = _M_root;
+        if (__root->_M_count == 0) {
+            if (__root->_M_leaf) {
+                _M_root = _M_leftmost = _M_rightmost = nullptr;
+            } else {
+                _M_root = __root->_M_child(0);
+                _M_root->_M_parent = nullptr;
+                _M_root->_M_position = 0;
+            }
+            _M_free_node(__root);
+        }
+    }
+
+    // 左兄弟的最后一个元素经父节点转到 __node 的最前面
+    void _M_rotate_right(_Node *__left, _Node *__node,
+                         iterator &__next) noexcept {
+        _Node *__parent = __node->_M_parent;
+        size_type __sep = __left->_M_position;
+        size_type __last = __left->_M_count - 1u;
+        _S_relocate_n(__node->_M_value(1), __node->_M_value(0),
+                      __node->_M_count);
+        _S_relocate_n(__node->_M_value(0), __parent->_M_value(__sep), 1);
+        _S_relocate_n(__parent->_M_value(__sep), __left->_M_value(__last), 1);
+        if (!__node->_M_leaf) {
+            for (size_type __i = __node->_M_count + 1u; __i > 0; --__i) {
+                _S_set_child(__node, __i, __node->_M_child(__i - 1));
+            }
+            _S_set_child(__node, 0, __left->_M_child(__last + 1));
+        }
+        --__left->_M_count;
+        ++__node->_M_count;
+        if (__next._M_node == __node) {
+            ++__next._M_pos;
+        } else if (__next._M_node == __parent && __next._M_pos == __sep) {
+            __next = iterator(__node, 0);
+        } else if (__next._M_node == __left && __next._M_pos == __last) {
+            __next = iterator(__parent, __sep);
+        }
+    }
+
+    // 右兄弟的第一个元素经父节点转到 __node 的最后面
+    void _M_rotate_left(_Node *__node, _Node *__right,
+                        iterator &__next) noexcept {
+        _Node *__parent = __node->_M_parent;
+        size_type __sep = __node->_M_position;
+        size_type __end = __node->_M_count;
+        _S_relocate_n(__node->_M_value(__end), __parent->_M_value(__sep), 1);
+        _S_relocate_n(__parent->_M_value(__sep), __right->_M_value(0), 1);
+        _S_relocate_n(__right->_M_value(0), __right->_M_value(1),
+                      __right->_M_count - 1u);
+        if (!__node->_M_leaf) {
+            _S_set_child(__node, __end + 1, __right->_M_child(0));
+            for (size_type __i = 0; __i < __right->_M_count; ++__i) {
+                _S_set_child(__right, __i, __right->_M_child(__i + 1));
+            }
+        }
+        ++__node->_M_count;
+        --__right->_M_count;
+        if (__next._M_node == __parent && __next._M_pos == __sep) {
+            __next = iterator(__node, __end);
+        } else if (__next._M_node == __right) {
+            if (__next._M_pos == 0) {
+                __next = iterator(__parent, __sep);
+            } else {
+                --__next._M_pos;
+            }
+        }
+    }
+
+    // 把父节点中的分隔元素和 __right 并入 __left，释放 __right
+    void _M_merge_nodes(_Node *__left, _Node *__right,
+                        iterator &__next) noexcept {
+        _Node *__parent = __left->_M_parent;
+        size_type __sep = __left->_M_position;
+        size_type __end = __left->_M_count;
+        _S_relocate_n(__left->_M_value(__end), __parent->_M_value(__sep), 1);
+        _S_relocate_n(__left->_M_value(__end + 1), __right->_M_value(0),
+                      __right->_M_count);
+        if (!__left->_M_leaf) {
+            for (size_type __i = 0; __i <= __right->_M_count; ++__i) {
+                _S_set_child(__left, __end + 1 + __i, __right->_M_child(__i));
+            }
+        }
+        __left->_M_count += 1 + __right->_M_count;
+
+        _S_relocate_n(__parent->_M_value(__sep), __parent->_M_value(__sep + 1),
+                      __parent->_M_count - __sep - 1);
+        for (size_type __i = __sep + 1; __i < __parent->_M_count; ++__i) {
+            _S_set_child(__parent, __i, __parent->_M_child(__i + 1));
+        }
+        --__parent->_M_count;
+
+        if (__next._M_node == __parent && __next._M_pos == __sep) {
+            __next = iterator(__left, __end);
+        } else if (__next._M_node == __right) {
+            __next = iterator(__left, __end + 1 + __next._M_pos);
+        } else if (__next._M_node == __parent && __next._M_pos > __sep) {
+            --__next._M_pos;
+        }
+        if (__right == _M_rightmost) {
+            _M_rightmost = __left;
+        }
+        _M_free_node(__right);
+    }
+
+    _Node *_M_new_node(bool __leaf) {
+        _Node *__node;
+        if (__leaf) {
+            _LeafAlloc __alloc(_M_alloc);
+            __node = ::new (static_cast<void *>(
+                std::allocator_traits<_LeafAlloc>::allocate(__alloc, 1))) _Node;
+        } else {
+            _InternalAlloc __alloc(_M_alloc);
+            __node = ::new (static_cast<void *>(
+                std::allocator_traits<_InternalAlloc>::allocate(__alloc, 1)))
+                _Internal;
+        }
+        __node->_M_parent = nullptr;
+        __node->_M_position = 0;
+        __node->_M_count = 0;
+        __node->_M_leaf = __leaf;
+        return __node;
+    }
+
+    void _M_free_node(_Node *__node) noexcept {
+        if (__node->_M_leaf) {
+            _LeafAlloc __alloc(_M_alloc);
+            std::allocator_traits<_LeafAlloc>::deallocate(__alloc, __node, 1);
+        } else {
+            _InternalAlloc __alloc(_M_alloc);
+            std::allocator_traits<_InternalAlloc>::deallocate(
+                __alloc, static_cast<_Internal *>(__node), 1);
+        }
+    }
+
+    void _M_destroy_subtree(_Node *__node) noexcept {
+        if (!__node->_M_leaf) {
+            for (size_type __i = 0; __i <= __node->_M_count; ++__i) {
+                _M_destroy_subtree(__node->_M_child(__i));
+            }
+        }
+        std::destroy_n(__node->_M_value(0), __node->_M_count);
+        _M_free_node(__node);
+    }
+
+    void _M_reset() noexcept {
+        _M_root = nullptr;
+        _M_leftmost = nullptr;
+        _M_rightmost = nullptr;
+        _M_size = 0;
+    }
+};
+
+} // namespace Marcus
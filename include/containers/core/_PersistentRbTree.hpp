@@ -0,0 +1,669 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <containers/core/_RbTree.hpp>
+#include <containers/small_vector.hpp>
+#include <core/_common.hpp>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Marcus {
+
+// 持久化红黑树的节点。子树在多个版本之间共享，所以没有父指针；
+// _M_refs 是指向本节点的父节点和版本根的个数。计数是原子的，
+// 不同线程可以各自持有、释放同一棵树的快照
+template <class _Tp>
+struct _PersistentRbTreeNode {
+    _PersistentRbTreeNode *_M_left;
+    _PersistentRbTreeNode *_M_right;
+    std::atomic<std::size_t> _M_refs;
+    _RbTreeColor _M_color;
+
+    union {
+        _Tp _M_value;
+    };
+
+    _PersistentRbTreeNode() noexcept {}
+
+    ~_PersistentRbTreeNode() noexcept {}
+};
+
+// 没有父指针，迭代器自己带一个栈：栈顶是当前节点，下面是当前节点
+// 位于其左子树中、还没有访问的祖先。只能向前遍历
+template <class _Tp>
+struct _PersistentRbTreeIterator {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = _Tp;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const _Tp *;
+    using reference = const _Tp &;
+
+    using _Node = _PersistentRbTreeNode<_Tp>;
+
+    small_vector<const _Node *, 32> _M_stack;
+
+    _PersistentRbTreeIterator() = default;
+
+    void _M_push_leftmost(const _Node *__node) {
+        for (; __node; __node = __node->_M_left) {
+            _M_stack.push_back(__node);
+        }
+    }
+
+    reference operator*() const noexcept {
+        return _M_stack.back()->_M_value;
+    }
+
+    pointer operator->() const noexcept {
+        return std::addressof(_M_stack.back()->_M_value);
+    }
+
+    _PersistentRbTreeIterator &operator++() {
+        const _Node *__node = _M_stack.back();
+        _M_stack.pop_back();
+        _M_push_leftmost(__node->_M_right);
+        return *this;
+    }
+
+    _PersistentRbTreeIterator operator++(int) {
+        _PersistentRbTreeIterator __tmp = *this;
+        ++*this;
+        return __tmp;
+    }
+
+    bool operator==(const _PersistentRbTreeIterator &__that) const noexcept {
+        if (_M_stack.empty() || __that._M_stack.empty()) {
+            return _M_stack.empty() == __that._M_stack.empty();
+        }
+        return _M_stack.back() == __that._M_stack.back();
+    }
+
+#if __cpp_impl_three_way_comparison < 201907L
+    bool operator!=(const _PersistentRbTreeIterator &__that) const noexcept {
+        return !(*this == __that);
+    }
+#endif
+};
+
+// 路径复制的红黑树：修改只复制从根到目标的一条路径（O(log n) 个节点），
+// 其余子树与旧版本共享，复制整棵树只是给根加一次引用计数。
+// 插入用 Okasaki 的平衡，删除用 Kahrs 的算法，都是无父指针的递归写法。
+// 节点一旦被别的版本看到就不再修改；本次操作新建、引用计数为 1 的
+// 节点则可以原地改，省掉旋转时的重复复制
+template <class _Key, class _Tp, class _KeyOf, class _Compare, class _Alloc>
+struct _PersistentRbTreeImpl {
+protected:
+    using _Node = _PersistentRbTreeNode<_Tp>;
+    using _NodeAlloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_Node>;
+    using _NodeTraits = std::allocator_traits<_NodeAlloc>;
+
+    _Node *_M_root;
+    std::size_t _M_size;
+    [[no_unique_address]] _Compare _M_comp;
+    [[no_unique_address]] _NodeAlloc _M_alloc;
+
+    // 一个拥有的引用，析构时释放。修改过程中的中间结果都用它传递，
+    // 复制元素或分配节点抛出异常时已经建好的节点不会泄漏
+    struct _Ref {
+        _Node *_M_node;
+        const _PersistentRbTreeImpl *_M_tree;
+
+        _Ref(_Node *__node, const _PersistentRbTreeImpl *__tree) noexcept
+            : _M_node(__node),
+              _M_tree(__tree) {}
+
+        _Ref(_Ref &&__that) noexcept
+            : _M_node(std::exchange(__that._M_node, nullptr)),
+              _M_tree(__that._M_tree) {}
+
+        _Ref &operator=(_Ref &&__that) noexcept {
+            _Ref __old(std::move(*this));
+            _M_node = std::exchange(__that._M_node, nullptr);
+            return *this;
+        }
+
+        ~_Ref() noexcept {
+            if (_M_node) {
+                _M_tree->_M_release(_M_node);
+            }
+        }
+
+        _Node *operator->() const noexcept {
+            return _M_node;
+        }
+
+        _Node *_M_leak() noexcept {
+            return std::exchange(_M_node, nullptr);
+        }
+    };
+
+public:
+    using value_type = _Tp;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = _Compare;
+    using allocator_type = _Alloc;
+    using const_iterator = _PersistentRbTreeIterator<_Tp>;
+    using iterator = const_iterator;
+
+    _PersistentRbTreeImpl() noexcept
+        : _M_root(nullptr),
+          _M_size(0),
+          _M_comp(),
+          _M_alloc() {}
+
+    explicit _PersistentRbTreeImpl(const _Compare &__comp,
+                                   const _Alloc &__alloc = _Alloc()) noexcept
+        : _M_root(nullptr),
+          _M_size(0),
+          _M_comp(__comp),
+          _M_alloc(__alloc) {}
+
+    // 快照：共享整棵树，O(1)
+    _PersistentRbTreeImpl(const _PersistentRbTreeImpl &__that) noexcept
+        : _M_root(__that._M_root),
+          _M_size(__that._M_size),
+          _M_comp(__that._M_comp),
+          _M_alloc(__that._M_alloc) {
+        _S_acquire(_M_root);
+    }
+
+    _PersistentRbTreeImpl(_PersistentRbTreeImpl &&__that) noexcept
+        : _M_root(std::exchange(__that._M_root, nullptr)),
+          _M_size(std::exchange(__that._M_size, 0)),
+          _M_comp(__that._M_comp),
+          _M_alloc(__that._M_alloc) {}
+
+    _PersistentRbTreeImpl &
+    operator=(const _PersistentRbTreeImpl &__that) noexcept {
+        _S_acquire(__that._M_root);
+        _M_reset(__that._M_root);
+        _M_size = __that._M_size;
+        _M_comp = __that._M_comp;
+        _M_alloc = __that._M_alloc;
+        return *this;
+    }
+
+    _PersistentRbTreeImpl &operator=(_PersistentRbTreeImpl &&__that) noexcept {
+        if (this != &__that) {
+            _M_reset(std::exchange(__that._M_root, nullptr));
+            _M_size = std::exchange(__that._M_size, 0);
+            _M_comp = __that._M_comp;
+            _M_alloc = __that._M_alloc;
+        }
+        return *this;
+    }
+
+    ~_PersistentRbTreeImpl() noexcept {
+        if (_M_root) {
+            _M_release(_M_root);
+        }
+    }
+
+    void swap(_PersistentRbTreeImpl &__that) noexcept {
+        std::swap(_M_root, __that._M_root);
+        std::swap(_M_size, __that._M_size);
+        std::swap(_M_comp, __that._M_comp);
+        std::swap(_M_alloc, __that._M_alloc);
+    }
+
+    void clear() noexcept {
+        _M_reset(nullptr);
+        _M_size = 0;
+    }
+
+    std::size_t size() const noexcept {
+        return _M_size;
+    }
+
+    bool empty() const noexcept {
+        return _M_size == 0;
+    }
+
+    static constexpr std::size_t max_size() noexcept {
+        return std::numeric_limits<std::ptrdiff_t>::max() / sizeof(_Node);
+    }
+
+    _Compare key_comp() const noexcept {
+        return _M_comp;
+    }
+
+    _Alloc get_allocator() const noexcept {
+        return _Alloc(_M_alloc);
+    }
+
+    // 两个对象是否是同一版本（或其未修改的快照）
+    bool shares_with(const _PersistentRbTreeImpl &__that) const noexcept {
+        return _M_root == __that._M_root;
+    }
+
+    const_iterator begin() const {
+        const_iterator __it;
+        __it._M_push_leftmost(_M_root);
+        return __it;
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator();
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+protected:
+    static void _S_acquire(_Node *__node) noexcept {
+        if (__node) {
+            __node->_M_refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void _M_reset(_Node *__root) noexcept {
+        _Node *__old = std::exchange(_M_root, __root);
+        if (__old) {
+            _M_release(__old);
+        }
+    }
+
+    // 去掉一个引用，归零时连同只被它引用的子树一起释放
+    void _M_release(_Node *__node) const noexcept {
+        while (__node &&
+               __node->_M_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            _Node *__left = __node->_M_left;
+            _Node *__right = __node->_M_right;
+            __node->_M_value.~_Tp();
+            __node->~_Node();
+            _NodeAlloc __alloc(_M_alloc);
+            _NodeTraits::deallocate(__alloc, __node, 1);
+            if (__left) {
+                _M_release(__left);
+            }
+            __node = __right;
+        }
+    }
+
+    _Ref _M_null() const noexcept {
+        return _Ref(nullptr, this);
+    }
+
+    _Ref _M_share(_Node *__node) const noexcept {
+        _S_acquire(__node);
+        return _Ref(__node, this);
+    }
+
+    static bool _S_is_red(const _Node *__node) noexcept {
+        return __node && __node->_M_color == _S_red;
+    }
+
+    static bool _S_is_black(const _Node *__node) noexcept {
+        return __node && __node->_M_color == _S_black;
+    }
+
+    template <class... _Ts>
+    _Ref _M_create(_RbTreeColor __color, _Ref __left, _Ref __right,
+                   _Ts &&...__value) const {
+        _NodeAlloc __alloc(_M_alloc);
+        _Node *__node = new (_NodeTraits::allocate(__alloc, 1)) _Node;
+        try {
+            new (const_cast<std::remove_const_t<_Tp> *>(
+                std::addressof(__node->_M_value)))
+                _Tp(std::forward<_Ts>(__value)...);
+        } catch (...) {
+            __node->~_Node();
+            _NodeTraits::deallocate(__alloc, __node, 1);
+            throw;
+        }
+        __node->_M_left = __left._M_leak();
+        __node->_M_right = __right._M_leak();
+        __node->_M_refs.store(1, std::memory_order_relaxed);
+        __node->_M_color = __color;
+        return _Ref(__node, this);
+    }
+
+    // 以 __node 的元素和给定的颜色、子树组成节点。只有本次操作持有的
+    // 节点原地修改，其他版本可见的节点复制一份
+    _Ref _M_with(_Ref __node, _RbTreeColor __color, _Ref __left,
+                 _Ref __right) const {
+        if (__node->_M_refs.load(std::memory_order_acquire) == 1) {
+            _Ref __old_left(__node->_M_left, this);
+            _Ref __old_right(__node->_M_right, this);
+            __node->_M_left = __left._M_leak();
+            __node->_M_right = __right._M_leak();
+            __node->_M_color = __color;
+            return __node;
+        }
+        return _M_create(__color, std::move(__left), std::move(__right),
+                         __node->_M_value);
+    }
+
+    _Ref _M_recolor(_Ref __node, _RbTreeColor __color) const {
+        if (!__node._M_node || __node->_M_color == __color) {
+            return __node;
+        }
+        _Ref __left = _M_share(__node->_M_left);
+        _Ref __right = _M_share(__node->_M_right);
+        return _M_with(std::move(__node), __color, std::move(__left),
+                       std::move(__right));
+    }
+
+    // 把 (__a, __x, __b) 组成黑节点，消除子节点和孙节点连续为红的情况
+    _Ref _M_balance(_Ref __a, _Ref __x, _Ref __b) const {
+        if (_S_is_red(__a._M_node) && _S_is_red(__b._M_node)) {
+            _Ref __l = _M_recolor(std::move(__a), _S_black);
+            _Ref __r = _M_recolor(std::move(__b), _S_black);
+            return _M_with(std::move(__x), _S_red, std::move(__l),
+                           std::move(__r));
+        }
+        if (_S_is_red(__a._M_node)) {
+            _Ref __al = _M_share(__a->_M_left);
+            _Ref __ar = _M_share(__a->_M_right);
+            if (_S_is_red(__al._M_node)) {
+                _Ref __l = _M_recolor(std::move(__al), _S_black);
+                _Ref __r = _M_with(std::move(__x), _S_black, std::move(__ar),
+                                   std::move(__b));
+                return _M_with(std::move(__a), _S_red, std::move(__l),
+                               std::move(__r));
+            }
+            if (_S_is_red(__ar._M_node)) {
+                _Ref __b1 = _M_share(__ar->_M_left);
+                _Ref __c = _M_share(__ar->_M_right);
+                _Ref __l = _M_with(std::move(__a), _S_black, std::move(__al),
+                                   std::move(__b1));
+                _Ref __r = _M_with(std::move(__x), _S_black, std::move(__c),
+                                   std::move(__b));
+                return _M_with(std::move(__ar), _S_red, std::move(__l),
+                               std::move(__r));
+            }
+        } else if (_S_is_red(__b._M_node)) {
+            _Ref __bl = _M_share(__b->_M_left);
+            _Ref __br = _M_share(__b->_M_right);
+            if (_S_is_red(__br._M_node)) {
+                _Ref __l = _M_with(std::move(__x), _S_black, std::move(__a),
+                                   std::move(__bl));
+                _Ref __r = _M_recolor(std::move(__br), _S_black);
+                return _M_with(std::move(__b), _S_red, std::move(__l),
+                               std::move(__r));
+            }
+            if (_S_is_red(__bl._M_node)) {
+                _Ref __b1 = _M_share(__bl->_M_left);
+                _Ref __c = _M_share(__bl->_M_right);
+                _Ref __l = _M_with(std::move(__x), _S_black, std::move(__a),
+                                   std::move(__b1));
+                _Ref __r = _M_with(std::move(__b), _S_black, std::move(__c),
+                                   std::move(__br));
+                return _M_with(std::move(__bl), _S_red, std::move(__l),
+                               std::move(__r));
+            }
+        }
+        return _M_with(std::move(__x), _S_black, std::move(__a),
+                       std::move(__b));
+    }
+
+    // 调用者已确认键不存在
+    _Ref _M_insert(_Node *__tree, _Ref &__fresh) const {
+        if (!__tree) {
+            return std::move(__fresh);
+        }
+        _Ref __self = _M_share(__tree);
+        _Ref __left = _M_null();
+        _Ref __right = _M_null();
+        if (_M_comp(_KeyOf()(__fresh->_M_value), _KeyOf()(__tree->_M_value))) {
+            __left = _M_insert(__tree->_M_left, __fresh);
+            __right = _M_share(__tree->_M_right);
+        } else {
+            __left = _M_share(__tree->_M_left);
+            __right = _M_insert(__tree->_M_right, __fresh);
+        }
+        if (__tree->_M_color == _S_black) {
+            return _M_balance(std::move(__left), std::move(__self),
+                              std::move(__right));
+        }
+        return _M_with(std::move(__self), _S_red, std::move(__left),
+                       std::move(__right));
+    }
+
+    // 复制到键为 __fresh 的节点的路径，并用 __fresh 替换该节点
+    _Ref _M_replace(_Node *__tree, _Ref &__fresh) const {
+        const auto &__key = _KeyOf()(__fresh->_M_value);
+        _Ref __self = _M_share(__tree);
+        _Ref __left = _M_null();
+        _Ref __right = _M_null();
+        if (_M_comp(__key, _KeyOf()(__tree->_M_value))) {
+            __left = _M_replace(__tree->_M_left, __fresh);
+            __right = _M_share(__tree->_M_right);
+        } else if (_M_comp(_KeyOf()(__tree->_M_value), __key)) {
+            __left = _M_share(__tree->_M_left);
+            __right = _M_replace(__tree->_M_right, __fresh);
+        } else {
+            __left = _M_share(__tree->_M_left);
+            __right = _M_share(__tree->_M_right);
+            return _M_with(std::move(__fresh), __tree->_M_color,
+                           std::move(__left), std::move(__right));
+        }
+        return _M_with(std::move(__self), __tree->_M_color, std::move(__left),
+                       std::move(__right));
+    }
+
+    // 左子树删掉一个节点后黑高少了 1，借右边补回来
+    _Ref _M_balance_left(_Ref __left, _Ref __x, _Ref __right) const {
+        if (_S_is_red(__left._M_node)) {
+            _Ref __l = _M_recolor(std::move(__left), _S_black);
+            return _M_with(std::move(__x), _S_red, std::move(__l),
+                           std::move(__right));
+        }
+        if (_S_is_black(__right._M_node)) {
+            _Ref __r = _M_recolor(std::move(__right), _S_red);
+            return _M_balance(std::move(__left), std::move(__x),
+                              std::move(__r));
+        }
+        assert(_S_is_red(__right._M_node) && _S_is_black(__right->_M_left));
+        _Ref __rl = _M_share(__right->_M_left);
+        _Ref __c = _M_share(__right->_M_right);
+        _Ref __a = _M_share(__rl->_M_left);
+        _Ref __b = _M_share(__rl->_M_right);
+        _Ref __l = _M_with(std::move(__x), _S_black, std::move(__left),
+                           std::move(__a));
+        _Ref __c1 = _M_recolor(std::move(__c), _S_red);
+        _Ref __r = _M_balance(std::move(__b), std::move(__right),
+                              std::move(__c1));
+        return _M_with(std::move(__rl), _S_red, std::move(__l), std::move(__r));
+    }
+
+    _Ref _M_balance_right(_Ref __left, _Ref __x, _Ref __right) const {
+        if (_S_is_red(__right._M_node)) {
+            _Ref __r = _M_recolor(std::move(__right), _S_black);
+            return _M_with(std::move(__x), _S_red, std::move(__left),
+                           std::move(__r));
+        }
+        if (_S_is_black(__left._M_node)) {
+            _Ref __l = _M_recolor(std::move(__left), _S_red);
+            return _M_balance(std::move(__l), std::move(__x),
+                              std::move(__right));
+        }
+        assert(_S_is_red(__left._M_node) && _S_is_black(__left->_M_right));
+        _Ref __a = _M_share(__left->_M_left);
+        _Ref __lr = _M_share(__left->_M_right);
+        _Ref __b = _M_share(__lr->_M_left);
+        _Ref __c = _M_share(__lr->_M_right);
+        _Ref __a1 = _M_recolor(std::move(__a), _S_red);
+        _Ref __l = _M_balance(std::move(__a1), std::move(__left),
+                              std::move(__b));
+        _Ref __r = _M_with(std::move(__x), _S_black, std::move(__c),
+                           std::move(__right));
+        return _M_with(std::move(__lr), _S_red, std::move(__l), std::move(__r));
+    }
+
+    // 把被删节点的两棵子树（黑高相同）拼成一棵
+    _Ref _M_fuse(_Ref __a, _Ref __b) const {
+        if (!__a._M_node) {
+            return __b;
+        }
+        if (!__b._M_node) {
+            return __a;
+        }
+        if (__a->_M_color != __b->_M_color) {
+            if (__b->_M_color == _S_red) {
+                _Ref __c = _M_share(__b->_M_left);
+                _Ref __d = _M_share(__b->_M_right);
+                _Ref __l = _M_fuse(std::move(__a), std::move(__c));
+                return _M_with(std::move(__b), _S_red, std::move(__l),
+                               std::move(__d));
+            }
+            _Ref __a1 = _M_share(__a->_M_left);
+            _Ref __a2 = _M_share(__a->_M_right);
+            _Ref __r = _M_fuse(std::move(__a2), std::move(__b));
+            return _M_with(std::move(__a), _S_red, std::move(__a1),
+                           std::move(__r));
+        }
+        _RbTreeColor __color = __a->_M_color;
+        _Ref __a1 = _M_share(__a->_M_left);
+        _Ref __a2 = _M_share(__a->_M_right);
+        _Ref __c = _M_share(__b->_M_left);
+        _Ref __d = _M_share(__b->_M_right);
+        _Ref __s = _M_fuse(std::move(__a2), std::move(__c));
+        if (_S_is_red(__s._M_node)) {
+            _Ref __s1 = _M_share(__s->_M_left);
+            _Ref __s2 = _M_share(__s->_M_right);
+            _Ref __l = _M_with(std::move(__a), __color, std::move(__a1),
+                               std::move(__s1));
+            _Ref __r = _M_with(std::move(__b), __color, std::move(__s2),
+                               std::move(__d));
+            return _M_with(std::move(__s), _S_red, std::move(__l),
+                           std::move(__r));
+        }
+        if (__color == _S_red) {
+            _Ref __r = _M_with(std::move(__b), _S_red, std::move(__s),
+                               std::move(__d));
+            return _M_with(std::move(__a), _S_red, std::move(__a1),
+                           std::move(__r));
+        }
+        _Ref __r = _M_with(std::move(__b), _S_black, std::move(__s),
+                           std::move(__d));
+        return _M_balance_left(std::move(__a1), std::move(__a), std::move(__r));
+    }
+
+    // 调用者已确认键存在。删除黑节点的一侧黑高少 1，由上层补平
+    template <class _Kv>
+    _Ref _M_erase(_Node *__tree, const _Kv &__key) const {
+        _Ref __self = _M_share(__tree);
+        if (_M_comp(__key, _KeyOf()(__tree->_M_value))) {
+            _Ref __left = _M_erase(__tree->_M_left, __key);
+            _Ref __right = _M_share(__tree->_M_right);
+            if (_S_is_black(__tree->_M_left)) {
+                return _M_balance_left(std::move(__left), std::move(__self),
+                                       std::move(__right));
+            }
+            return _M_with(std::move(__self), _S_red, std::move(__left),
+                           std::move(__right));
+        }
+        if (_M_comp(_KeyOf()(__tree->_M_value), __key)) {
+            _Ref __left = _M_share(__tree->_M_left);
+            _Ref __right = _M_erase(__tree->_M_right, __key);
+            if (_S_is_black(__tree->_M_right)) {
+                return _M_balance_right(std::move(__left), std::move(__self),
+                                        std::move(__right));
+            }
+            return _M_with(std::move(__self), _S_red, std::move(__left),
+                           std::move(__right));
+        }
+        return _M_fuse(_M_share(__tree->_M_left), _M_share(__tree->_M_right));
+    }
+
+    template <class _Kv>
+    const_iterator _M_find(const _Kv &__key) const {
+        const_iterator __it = _M_lower_bound(__key);
+        if (__it != end() && _M_comp(__key, _KeyOf()(*__it))) {
+            return end();
+        }
+        return __it;
+    }
+
+    template <class _Kv>
+    const_iterator _M_lower_bound(const _Kv &__key) const {
+        const_iterator __it;
+        for (const _Node *__node = _M_root; __node;) {
+            if (_M_comp(_KeyOf()(__node->_M_value), __key)) {
+                __node = __node->_M_right;
+            } else {
+                __it._M_stack.push_back(__node);
+                __node = __node->_M_left;
+            }
+        }
+        return __it;
+    }
+
+    template <class _Kv>
+    const_iterator _M_upper_bound(const _Kv &__key) const {
+        const_iterator __it;
+        for (const _Node *__node = _M_root; __node;) {
+            if (_M_comp(__key, _KeyOf()(__node->_M_value))) {
+                __it._M_stack.push_back(__node);
+                __node = __node->_M_left;
+            } else {
+                __node = __node->_M_right;
+            }
+        }
+        return __it;
+    }
+
+    template <class _Kv>
+    const _Node *_M_find_node(const _Kv &__key) const noexcept {
+        const _Node *__node = _M_root;
+        while (__node) {
+            if (_M_comp(__key, _KeyOf()(__node->_M_value))) {
+                __node = __node->_M_left;
+            } else if (_M_comp(_KeyOf()(__node->_M_value), __key)) {
+                __node = __node->_M_right;
+            } else {
+                break;
+            }
+        }
+        return __node;
+    }
+
+    void _M_commit(_Ref __root) noexcept {
+        _M_reset(__root._M_leak());
+    }
+
+    // 键不存在时插入 __fresh，否则 __replace 为真时替换原元素
+    bool _M_insert_node(_Ref __fresh, bool __replace) {
+        if (_M_find_node(_KeyOf()(__fresh->_M_value))) {
+            if (__replace) {
+                _M_commit(_M_replace(_M_root, __fresh));
+            }
+            return false;
+        }
+        _M_commit(_M_recolor(_M_insert(_M_root, __fresh), _S_black));
+        ++_M_size;
+        return true;
+    }
+
+    template <class... _Ts>
+    _Ref _M_new_leaf(_Ts &&...__value) const {
+        return _M_create(_S_red, _M_null(), _M_null(),
+                         std::forward<_Ts>(__value)...);
+    }
+
+    template <class _Kv>
+    std::size_t _M_erase_key(const _Kv &__key) {
+        if (!_M_find_node(__key)) {
+            return 0;
+        }
+        _M_commit(_M_recolor(_M_erase(_M_root, __key), _S_black));
+        --_M_size;
+        return 1;
+    }
+};
+
+} // namespace Marcus
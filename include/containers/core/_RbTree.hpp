@@ -1,9 +1,14 @@
 #pragma once
 
+#include <bit>
 #include <cassert>
 #include <core/_common.hpp>
+#include <cstdint>
+#include <future>
 #include <iterator>
 #include <memory>
+#include <system_error>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
@@ -17,16 +22,101 @@ enum _RbTreeChildDir {
     _S_right,
 };
 
+enum _RbTreeSetOp {
+    _S_set_union,
+    _S_set_intersection,
+    _S_set_difference,
+};
+
+struct _RbTreeNode;
+
+struct _RbTreeRoot {
+    _RbTreeNode *_M_root;
+    std::size_t _M_size;       // 缓存的节点个数，使 size() 为 O(1)
+    _RbTreeNode *_M_rightmost; // 缓存的最大节点，--end() 和 end() 处的提示插入为 O(1)
+};
+
+// 紧凑的节点布局：只有三个指针。节点按指针对齐，父指针的低两位总是 0：
+// 第 0 位存颜色，第 1 位标记根节点。根节点没有父节点，这个字段存的是
+// 所在树的 _RbTreeRoot，这样从根节点也能找到指向它的那个指针
 struct _RbTreeNode {
     _RbTreeNode *_M_left;
     _RbTreeNode *_M_right;
-    _RbTreeNode *_M_parent;
-    _RbTreeNode **_M_pparent; // 父节点中指向本节点指针的指针
-    _RbTreeColor _M_color;
+    std::uintptr_t _M_parent_color;
+
+    static constexpr std::uintptr_t _S_color_bit = 1;
+    static constexpr std::uintptr_t _S_root_bit = 2;
+    static constexpr std::uintptr_t _S_ptr_mask = ~std::uintptr_t(3);
+
+    // 根节点返回 nullptr
+    _RbTreeNode *_M_parent() const noexcept {
+        return _M_parent_color & _S_root_bit
+                   ? nullptr
+                   : reinterpret_cast<_RbTreeNode *>(_M_parent_color &
+                                                     _S_ptr_mask);
+    }
+
+    _RbTreeColor _M_color() const noexcept {
+        return _RbTreeColor(_M_parent_color & _S_color_bit);
+    }
+
+    bool _M_is_root() const noexcept {
+        return _M_parent_color & _S_root_bit;
+    }
+
+    void _M_set_parent(_RbTreeNode *__parent) noexcept {
+        _M_parent_color = reinterpret_cast<std::uintptr_t>(__parent) |
+                          (_M_parent_color & _S_color_bit);
+    }
+
+    void _M_set_root(_RbTreeRoot *__block) noexcept {
+        _M_parent_color = reinterpret_cast<std::uintptr_t>(__block) |
+                          _S_root_bit | (_M_parent_color & _S_color_bit);
+    }
+
+    // 接替 __other 在树中的位置：父指针（或根标记）照抄，颜色不变
+    void _M_take_parent(const _RbTreeNode *__other) noexcept {
+        _M_parent_color = (__other->_M_parent_color & ~_S_color_bit) |
+                          (_M_parent_color & _S_color_bit);
+    }
+
+    void _M_set_color(_RbTreeColor __color) noexcept {
+        _M_parent_color = (_M_parent_color & ~_S_color_bit) | __color;
+    }
+
+    // 父节点中指向本节点的指针，根节点的在 _RbTreeRoot 里
+    _RbTreeNode *&_M_slot() noexcept {
+        if (_M_parent_color & _S_root_bit) {
+            return reinterpret_cast<_RbTreeRoot *>(_M_parent_color &
+                                                   _S_ptr_mask)
+                ->_M_root;
+        }
+        _RbTreeNode *__parent = this->_M_parent();
+        return __parent->_M_left == this ? __parent->_M_left
+                                         : __parent->_M_right;
+    }
+
+    // 只对根节点有效：_RbTreeRoot::_M_root 的地址，也就是 end() 的状态
+    _RbTreeNode **_M_root_slot() const noexcept {
+        assert(this->_M_is_root());
+        return &reinterpret_cast<_RbTreeRoot *>(_M_parent_color & _S_ptr_mask)
+                    ->_M_root;
+    }
+};
+
+static_assert(alignof(_RbTreeNode) >= 4 && alignof(_RbTreeRoot) >= 4,
+              "_RbTreeNode keeps two tag bits in the parent pointer");
+
+// 顺序统计模式的节点：多存一个子树大小，nth / rank / distance 为 O(log n)
+struct _RbTreeSizedNode : _RbTreeNode {
+    std::size_t _M_count; // 以本节点为根的子树中的节点个数
 };
 
-template <class _Tp>
-struct _RbTreeNodeImpl : _RbTreeNode {
+template <class _Tp, bool _Sized = false>
+struct _RbTreeNodeImpl
+    : std::conditional_t<_Sized, _RbTreeSizedNode, _RbTreeNode> {
+    static constexpr bool _S_sized = _Sized;
+
     union {
         _Tp _M_value;
     }; // union 可以阻止里面成员的自动初始化，方便不支持 _Tp() 默认构造的类型
@@ -103,29 +193,28 @@ public:
                 _M_node = _M_node->_M_left;
             }
         } else { // 如果当前节点没有右子节点，后继节点是其最近的祖先节点，且该祖先节点的左子树包含当前节点
-            while (_M_node->_M_parent != nullptr &&
-                   _M_node->_M_pparent == &_M_node->_M_parent->_M_right) {
-                _M_node = _M_node->_M_parent;
+            _RbTreeNode *__parent = _M_node->_M_parent();
+            while (__parent != nullptr && _M_node == __parent->_M_right) {
+                _M_node = __parent;
+                __parent = _M_node->_M_parent();
             }
             // 如果回溯到根节点，说明当前节点是最大节点，后继为end()
-            if (_M_node->_M_parent == nullptr) {
+            if (__parent == nullptr) {
+                _M_proot = _M_node->_M_root_slot();
                 _M_off_by_one = true;
                 return;
             }
-            _M_node = _M_node->_M_parent;
+            _M_node = __parent;
         }
     }
 
     // 找到前驱节点
     void operator--() noexcept { // --__it
-        // 为了支持 --end()
+        // 为了支持 --end()，_M_proot 指向 _RbTreeRoot 的第一个成员
         if (_M_off_by_one) {
             _M_off_by_one = false;
-            _M_node = *_M_proot;
+            _M_node = reinterpret_cast<_RbTreeRoot *>(_M_proot)->_M_rightmost;
             assert(_M_node);
-            while (_M_node->_M_right != nullptr) {
-                _M_node = _M_node->_M_right;
-            }
             return;
         }
         assert(_M_node);
@@ -135,15 +224,17 @@ public:
                 _M_node = _M_node->_M_right;
             }
         } else { // 如果当前节点没有左子节点，前驱节点是其最近的祖先节点，且该祖先节点的右子树包含当前节点
-            while (_M_node->_M_parent != nullptr &&
-                   _M_node->_M_pparent == &_M_node->_M_parent->_M_left) {
-                _M_node = _M_node->_M_parent;
+            _RbTreeNode *__parent = _M_node->_M_parent();
+            while (__parent != nullptr && _M_node == __parent->_M_left) {
+                _M_node = __parent;
+                __parent = _M_node->_M_parent();
             }
-            if (_M_node->_M_parent == nullptr) {
+            if (__parent == nullptr) {
+                _M_proot = _M_node->_M_root_slot();
                 _M_off_by_one = true;
                 return;
             }
-            _M_node = _M_node->_M_parent;
+            _M_node = __parent;
         }
     }
 
@@ -243,114 +334,147 @@ public:
     using pointer = _Tp *;
 };
 
-struct _RbTreeRoot {
-    _RbTreeNode *_M_root;
-};
-
 struct _RbTreeBase {
 protected:
     _RbTreeRoot *_M_block;
 
     explicit _RbTreeBase(_RbTreeRoot *__block) : _M_block(__block) {}
 
+    template <class, class, class, class, class>
+    friend struct _RbTreeNodeHandle;
+
+    // __alloc 已经是 _Type 的分配器时直接用，不再复制一份
     template <class _Type, class _Alloc>
-    static _Type *_M_allocate(_Alloc __alloc) {
-        typename std::allocator_traits<_Alloc>::template rebind_alloc<_Type>
-            __rebind_alloc(__alloc);
-        return std::allocator_traits<_Alloc>::template rebind_traits<
-            _Type>::allocate(__rebind_alloc, sizeof(_Type));
+    static _Type *_M_allocate(_Alloc &__alloc) {
+        using _Traits =
+            typename std::allocator_traits<_Alloc>::template rebind_traits<
+                _Type>;
+        if constexpr (std::is_same_v<typename _Traits::allocator_type,
+                                     _Alloc>) {
+            return _Traits::allocate(__alloc, 1);
+        } else {
+            typename _Traits::allocator_type __rebind_alloc(__alloc);
+            return _Traits::allocate(__rebind_alloc, 1);
+        }
     }
 
     template <class _Type, class _Alloc>
-    static void _M_deallocate(_Alloc __alloc, void *__ptr) noexcept {
-        typename std::allocator_traits<_Alloc>::template rebind_alloc<_Type>
-            __rebind_alloc(__alloc);
-        std::allocator_traits<_Alloc>::template rebind_traits<
-            _Type>::deallocate(__rebind_alloc, static_cast<_Type *>(__ptr),
-                               sizeof(_Type));
+    static void _M_deallocate(_Alloc &__alloc, void *__ptr) noexcept {
+        using _Traits =
+            typename std::allocator_traits<_Alloc>::template rebind_traits<
+                _Type>;
+        if constexpr (std::is_same_v<typename _Traits::allocator_type,
+                                     _Alloc>) {
+            _Traits::deallocate(__alloc, static_cast<_Type *>(__ptr), 1);
+        } else {
+            typename _Traits::allocator_type __rebind_alloc(__alloc);
+            _Traits::deallocate(__rebind_alloc, static_cast<_Type *>(__ptr), 1);
+        }
+    }
+
+    // 以下带 _Sized 参数的函数在顺序统计模式下同时维护子树大小
+    static std::size_t _S_count(_RbTreeNode *__node) noexcept {
+        return __node ? static_cast<_RbTreeSizedNode *>(__node)->_M_count : 0;
+    }
+
+    static void _S_set_count(_RbTreeNode *__node, std::size_t __n) noexcept {
+        static_cast<_RbTreeSizedNode *>(__node)->_M_count = __n;
+    }
+
+    static void _S_recount(_RbTreeNode *__node) noexcept {
+        _S_set_count(__node, _S_count(__node->_M_left) +
+                                 _S_count(__node->_M_right) + 1);
     }
 
+    template <bool _Sized>
     static void _M_rotate_left(_RbTreeNode *__node) noexcept {
         _RbTreeNode *__right = __node->_M_right;
+        __node->_M_slot() = __right;
+        __right->_M_take_parent(__node);
         __node->_M_right = __right->_M_left;
         if (__right->_M_left != nullptr) {
-            __right->_M_left->_M_parent = __node;
-            __right->_M_left->_M_pparent = &__node->_M_right;
+            __right->_M_left->_M_set_parent(__node);
         }
-        __right->_M_parent = __node->_M_parent;
-        __right->_M_pparent = __node->_M_pparent;
-        *__node->_M_pparent = __right;
         __right->_M_left = __node;
-        __node->_M_parent = __right;
-        __node->_M_pparent = &__right->_M_left;
+        __node->_M_set_parent(__right);
+        if constexpr (_Sized) {
+            _S_set_count(__right, _S_count(__node));
+            _S_recount(__node);
+        }
     }
 
+    template <bool _Sized>
     static void _M_rotate_right(_RbTreeNode *__node) noexcept {
         _RbTreeNode *__left = __node->_M_left;
+        __node->_M_slot() = __left;
+        __left->_M_take_parent(__node);
         __node->_M_left = __left->_M_right;
         if (__left->_M_right != nullptr) {
-            __left->_M_right->_M_parent = __node;
-            __left->_M_right->_M_pparent = &__node->_M_left;
+            __left->_M_right->_M_set_parent(__node);
         }
-        __left->_M_parent = __node->_M_parent;
-        __left->_M_pparent = __node->_M_pparent;
-        *__node->_M_pparent = __left;
         __left->_M_right = __node;
-        __node->_M_parent = __left;
-        __node->_M_pparent = &__left->_M_right;
+        __node->_M_set_parent(__left);
+        if constexpr (_Sized) {
+            _S_set_count(__left, _S_count(__node));
+            _S_recount(__node);
+        }
     }
 
-    static void _M_fix_violation(_RbTreeNode *__node) noexcept {
+    // 返回 true 表示根节点由红变黑，整棵树的黑高加一
+    template <bool _Sized>
+    static bool _M_fix_violation(_RbTreeNode *__node) noexcept {
         while (true) {
-            _RbTreeNode *__parent = __node->_M_parent;
+            _RbTreeNode *__parent = __node->_M_parent();
             if (__parent == nullptr) { // 根节点的 __parent 总是 nullptr
                 // 情况 0: __node == root
-                __node->_M_color = _S_black;
-                return;
+                bool __grew = __node->_M_color() == _S_red;
+                __node->_M_set_color(_S_black);
+                return __grew;
             }
-            if (__node->_M_color == _S_black ||
-                __parent->_M_color == _S_black) {
-                return;
+            if (__node->_M_color() == _S_black ||
+                __parent->_M_color() == _S_black) {
+                return false;
             }
             _RbTreeNode *__uncle;
-            _RbTreeNode *__grandpa = __parent->_M_parent;
+            _RbTreeNode *__grandpa = __parent->_M_parent();
             assert(__grandpa);
             _RbTreeChildDir __parent_dir =
-                __parent->_M_pparent == &__grandpa->_M_left ? _S_left
-                                                            : _S_right;
+                __parent == __grandpa->_M_left ? _S_left : _S_right;
             if (__parent_dir == _S_left) {
                 __uncle = __grandpa->_M_right;
             } else {
-                assert(__parent->_M_pparent == &__grandpa->_M_right);
+                assert(__parent == __grandpa->_M_right);
                 __uncle = __grandpa->_M_left;
             }
             _RbTreeChildDir __node_dir =
-                __node->_M_pparent == &__parent->_M_left ? _S_left : _S_right;
-            if (__uncle != nullptr && __uncle->_M_color == _S_red) {
+                __node == __parent->_M_left ? _S_left : _S_right;
+            if (__uncle != nullptr && __uncle->_M_color() == _S_red) {
                 // 情况 1: 叔叔是红色人士
-                __parent->_M_color = _S_black;
-                __uncle->_M_color = _S_black;
-                __grandpa->_M_color = _S_red;
+                __parent->_M_set_color(_S_black);
+                __uncle->_M_set_color(_S_black);
+                __grandpa->_M_set_color(_S_red);
                 __node = __grandpa;
             } else if (__node_dir == __parent_dir) {
                 if (__node_dir == _S_right) {
-                    assert(__node->_M_pparent == &__parent->_M_right);
+                    assert(__node == __parent->_M_right);
                     // 情况 2: 叔叔是黑色人士（RR）
-                    _RbTreeBase::_M_rotate_left(__grandpa);
+                    _RbTreeBase::_M_rotate_left<_Sized>(__grandpa);
                 } else {
                     // 情况 3: 叔叔是黑色人士（LL）
-                    _RbTreeBase::_M_rotate_right(__grandpa);
+                    _RbTreeBase::_M_rotate_right<_Sized>(__grandpa);
                 }
-                std::swap(__parent->_M_color, __grandpa->_M_color);
+                // 旋转前 __parent 为红、__grandpa 为黑，交换颜色
+                __parent->_M_set_color(_S_black);
+                __grandpa->_M_set_color(_S_red);
                 __node = __grandpa;
             } else {
                 if (__node_dir == _S_right) {
-                    assert(__node->_M_pparent == &__parent->_M_right);
+                    assert(__node == __parent->_M_right);
                     // 情况 4: 叔叔是黑色人士（LR）
-                    _RbTreeBase::_M_rotate_left(__parent);
+                    _RbTreeBase::_M_rotate_left<_Sized>(__parent);
                 } else {
                     // 情况 5: 叔叔是黑色人士（RL）
-                    _RbTreeBase::_M_rotate_right(__parent);
+                    _RbTreeBase::_M_rotate_right<_Sized>(__parent);
                 }
                 __node = __parent;
             }
@@ -368,13 +492,41 @@ protected:
     }
 
     _RbTreeNode *_M_max_node() const noexcept {
-        _RbTreeNode *__current = _M_block->_M_root;
-        if (__current != nullptr) {
-            while (__current->_M_right != nullptr) {
-                __current = __current->_M_right;
+        return _M_block->_M_rightmost;
+    }
+
+    // 中序后继，没有则返回 nullptr
+    static _RbTreeNode *_S_next_node(_RbTreeNode *__node) noexcept {
+        if (__node->_M_right != nullptr) {
+            __node = __node->_M_right;
+            while (__node->_M_left != nullptr) {
+                __node = __node->_M_left;
             }
+            return __node;
         }
-        return __current;
+        _RbTreeNode *__parent = __node->_M_parent();
+        while (__parent != nullptr && __node == __parent->_M_right) {
+            __node = __parent;
+            __parent = __node->_M_parent();
+        }
+        return __parent;
+    }
+
+    // 中序前驱，没有则返回 nullptr
+    static _RbTreeNode *_S_prev_node(_RbTreeNode *__node) noexcept {
+        if (__node->_M_left != nullptr) {
+            __node = __node->_M_left;
+            while (__node->_M_right != nullptr) {
+                __node = __node->_M_right;
+            }
+            return __node;
+        }
+        _RbTreeNode *__parent = __node->_M_parent();
+        while (__parent != nullptr && __node == __parent->_M_left) {
+            __node = __parent;
+            __parent = __node->_M_parent();
+        }
+        return __parent;
     }
 
     template <class _NodeImpl, class _Tv, class _Compare>
@@ -439,113 +591,180 @@ protected:
 
     static void _M_transplant(_RbTreeNode *__node,
                               _RbTreeNode *__replace) noexcept {
-        *__node->_M_pparent = __replace;
+        __node->_M_slot() = __replace;
         if (__replace != nullptr) {
-            __replace->_M_parent = __node->_M_parent;
-            __replace->_M_pparent = __node->_M_pparent;
+            __replace->_M_take_parent(__node);
         }
     }
 
-    static void _M_delete_fixup(_RbTreeNode *__node) noexcept {
-        if (__node == nullptr) {
-            return;
-        }
-        while (__node->_M_parent != nullptr && __node->_M_color == _S_black) {
-            _RbTreeChildDir __dir =
-                __node->_M_pparent == &__node->_M_parent->_M_left ? _S_left
-                                                                  : _S_right;
-            _RbTreeNode *__sibling = __dir == _S_left
-                                         ? __node->_M_parent->_M_right
-                                         : __node->_M_parent->_M_left;
-            if (__sibling->_M_color == _S_red) {
-                __sibling->_M_color = _S_black;
-                __node->_M_parent->_M_color = _S_red;
-                if (__dir == _S_left) {
-                    _RbTreeBase::_M_rotate_left(__node->_M_parent);
-                } else {
-                    _RbTreeBase::_M_rotate_right(__node->_M_parent);
+    static bool _S_is_black(_RbTreeNode *__node) noexcept {
+        return __node == nullptr || __node->_M_color() == _S_black;
+    }
+
+    // __node 可能为 nullptr（被删除的是叶子），因此需要单独传入其父节点
+    template <bool _Sized>
+    static void _M_delete_fixup(_RbTreeNode *__node,
+                                _RbTreeNode *__parent) noexcept {
+        while (__parent != nullptr && _RbTreeBase::_S_is_black(__node)) {
+            if (__node == __parent->_M_left) {
+                _RbTreeNode *__sibling = __parent->_M_right;
+                if (__sibling->_M_color() == _S_red) {
+                    __sibling->_M_set_color(_S_black);
+                    __parent->_M_set_color(_S_red);
+                    _RbTreeBase::_M_rotate_left<_Sized>(__parent);
+                    __sibling = __parent->_M_right;
                 }
-                __sibling = __dir == _S_left ? __node->_M_parent->_M_right
-                                             : __node->_M_parent->_M_left;
-            }
-            if (__sibling->_M_left->_M_color == _S_black &&
-                __sibling->_M_right->_M_color == _S_black) {
-                __sibling->_M_color = _S_red;
-                __node = __node->_M_parent;
+                if (_RbTreeBase::_S_is_black(__sibling->_M_left) &&
+                    _RbTreeBase::_S_is_black(__sibling->_M_right)) {
+                    __sibling->_M_set_color(_S_red);
+                    __node = __parent;
+                    __parent = __node->_M_parent();
+                    continue;
+                }
+                if (_RbTreeBase::_S_is_black(__sibling->_M_right)) {
+                    __sibling->_M_left->_M_set_color(_S_black);
+                    __sibling->_M_set_color(_S_red);
+                    _RbTreeBase::_M_rotate_right<_Sized>(__sibling);
+                    __sibling = __parent->_M_right;
+                }
+                __sibling->_M_set_color(__parent->_M_color());
+                __parent->_M_set_color(_S_black);
+                if (__sibling->_M_right != nullptr) {
+                    __sibling->_M_right->_M_set_color(_S_black);
+                }
+                _RbTreeBase::_M_rotate_left<_Sized>(__parent);
             } else {
-                if (__dir == _S_left &&
-                    __sibling->_M_right->_M_color == _S_black) {
-                    __sibling->_M_left->_M_color = _S_black;
-                    __sibling->_M_color = _S_red;
-                    _RbTreeBase::_M_rotate_right(__sibling);
-                    __sibling = __node->_M_parent->_M_right;
-                } else if (__dir == _S_right &&
-                           __sibling->_M_left->_M_color == _S_black) {
-                    __sibling->_M_right->_M_color = _S_black;
-                    __sibling->_M_color = _S_red;
-                    _RbTreeBase::_M_rotate_left(__sibling);
-                    __sibling = __node->_M_parent->_M_left;
+                _RbTreeNode *__sibling = __parent->_M_left;
+                if (__sibling->_M_color() == _S_red) {
+                    __sibling->_M_set_color(_S_black);
+                    __parent->_M_set_color(_S_red);
+                    _RbTreeBase::_M_rotate_right<_Sized>(__parent);
+                    __sibling = __parent->_M_left;
                 }
-                __sibling->_M_color = __node->_M_parent->_M_color;
-                __node->_M_parent->_M_color = _S_black;
-                if (__dir == _S_left) {
-                    __sibling->_M_right->_M_color = _S_black;
-                    _RbTreeBase::_M_rotate_left(__node->_M_parent);
-                } else {
-                    __sibling->_M_left->_M_color = _S_black;
-                    _RbTreeBase::_M_rotate_right(__node->_M_parent);
+                if (_RbTreeBase::_S_is_black(__sibling->_M_left) &&
+                    _RbTreeBase::_S_is_black(__sibling->_M_right)) {
+                    __sibling->_M_set_color(_S_red);
+                    __node = __parent;
+                    __parent = __node->_M_parent();
+                    continue;
                 }
-                // while (__node->_M_parent != nullptr) {
-                //     __node = __node->_M_parent;
-                // }
-                break;
+                if (_RbTreeBase::_S_is_black(__sibling->_M_left)) {
+                    __sibling->_M_right->_M_set_color(_S_black);
+                    __sibling->_M_set_color(_S_red);
+                    _RbTreeBase::_M_rotate_left<_Sized>(__sibling);
+                    __sibling = __parent->_M_left;
+                }
+                __sibling->_M_set_color(__parent->_M_color());
+                __parent->_M_set_color(_S_black);
+                if (__sibling->_M_left != nullptr) {
+                    __sibling->_M_left->_M_set_color(_S_black);
+                }
+                _RbTreeBase::_M_rotate_right<_Sized>(__parent);
             }
+            return;
+        }
+        if (__node != nullptr) {
+            __node->_M_set_color(_S_black);
         }
-        __node->_M_color = _S_black;
     }
 
-    // 如果树中已存在相同值的节点，则不插入（用于set、map）
+    template <bool _Sized>
     static void _M_erase_node(_RbTreeNode *__node) noexcept {
-        if (__node->_M_left == nullptr) {
-            _RbTreeNode *__right = __node->_M_right;
-            _RbTreeColor __color = __node->_M_color;
-            _RbTreeBase::_M_transplant(__node, __right);
-            if (__color == _S_black) {
-                _RbTreeBase::_M_delete_fixup(__right);
+        _RbTreeNode *__child;
+        _RbTreeNode *__child_parent;
+        _RbTreeColor __color;
+        if constexpr (_Sized) {
+            // 实际摘掉的位置（有两个孩子时是后继节点）以上的子树都少一个
+            _RbTreeNode *__removed = __node;
+            if (__node->_M_left != nullptr && __node->_M_right != nullptr) {
+                __removed = __node->_M_right;
+                while (__removed->_M_left != nullptr) {
+                    __removed = __removed->_M_left;
+                }
             }
-        } else if (__node->_M_right == nullptr) {
-            _RbTreeNode *__left = __node->_M_left;
-            _RbTreeColor __color = __node->_M_color;
-            _RbTreeBase::_M_transplant(__node, __left);
-            if (__color == _S_black) {
-                _RbTreeBase::_M_delete_fixup(__left);
+            for (_RbTreeNode *__p = __removed->_M_parent(); __p != nullptr;
+                 __p = __p->_M_parent()) {
+                _S_set_count(__p, _S_count(__p) - 1);
             }
+        }
+        if (__node->_M_left == nullptr) {
+            __child = __node->_M_right;
+            __child_parent = __node->_M_parent();
+            __color = __node->_M_color();
+            _RbTreeBase::_M_transplant(__node, __child);
+        } else if (__node->_M_right == nullptr) {
+            __child = __node->_M_left;
+            __child_parent = __node->_M_parent();
+            __color = __node->_M_color();
+            _RbTreeBase::_M_transplant(__node, __child);
         } else {
             _RbTreeNode *__replace = __node->_M_right;
             while (__replace->_M_left != nullptr) {
                 __replace = __replace->_M_left;
             }
-            _RbTreeNode *__right = __replace->_M_right;
-            _RbTreeColor __color = __replace->_M_color;
-            if (__replace->_M_parent == __node) {
-                if (__right != nullptr) {
-                    __right->_M_parent = __replace;
-                    __right->_M_pparent = &__replace->_M_right;
-                }
+            __child = __replace->_M_right;
+            __color = __replace->_M_color();
+            if (__replace->_M_parent() == __node) {
+                __child_parent = __replace;
             } else {
-                _RbTreeBase::_M_transplant(__replace, __right);
+                __child_parent = __replace->_M_parent();
+                _RbTreeBase::_M_transplant(__replace, __child);
                 __replace->_M_right = __node->_M_right;
-                __replace->_M_right->_M_parent = __replace;
-                __replace->_M_right->_M_pparent = &__replace->_M_right;
+                __replace->_M_right->_M_set_parent(__replace);
             }
             _RbTreeBase::_M_transplant(__node, __replace);
             __replace->_M_left = __node->_M_left;
-            __replace->_M_left->_M_parent = __replace;
-            __replace->_M_left->_M_pparent = &__replace->_M_left;
-            if (__color == _S_black) {
-                _RbTreeBase::_M_delete_fixup(__right);
+            __replace->_M_left->_M_set_parent(__replace);
+            __replace->_M_set_color(__node->_M_color());
+            if constexpr (_Sized) {
+                _S_set_count(__replace, _S_count(__node));
             }
         }
+        if (__color == _S_black) {
+            _RbTreeBase::_M_delete_fixup<_Sized>(__child, __child_parent);
+        }
+    }
+
+    // 把新节点挂到 *__pparent（__parent 的某个空孩子）上并再平衡
+    template <bool _Sized>
+    void _M_link_new_node(_RbTreeNode *__node, _RbTreeNode *__parent,
+                          _RbTreeNode **__pparent) noexcept {
+        __node->_M_left = nullptr;
+        __node->_M_right = nullptr;
+        if (__parent == nullptr) {
+            __node->_M_parent_color = 0;
+            __node->_M_set_root(_M_block);
+        } else {
+            __node->_M_parent_color =
+                reinterpret_cast<std::uintptr_t>(__parent);
+        }
+        __node->_M_set_color(_S_red);
+        *__pparent = __node;
+        if (__parent == nullptr ||
+            (__parent == _M_block->_M_rightmost &&
+             __pparent == &__parent->_M_right)) {
+            _M_block->_M_rightmost = __node;
+        }
+        if constexpr (_Sized) {
+            _S_set_count(__node, 1);
+            for (; __parent != nullptr; __parent = __parent->_M_parent()) {
+                _S_set_count(__parent, _S_count(__parent) + 1);
+            }
+        }
+        _RbTreeBase::_M_fix_violation<_Sized>(__node);
+        ++_M_block->_M_size;
+    }
+
+    // __prev 和 __next 是中序相邻的两个节点（可以有一个为空），把新节点
+    // 夹在它们中间：__prev 没有右孩子就挂在它右边，否则 __next 一定没有左孩子
+    template <bool _Sized>
+    void _M_link_between(_RbTreeNode *__prev, _RbTreeNode *__next,
+                         _RbTreeNode *__node) noexcept {
+        if (__prev != nullptr && __prev->_M_right == nullptr) {
+            this->_M_link_new_node<_Sized>(__node, __prev, &__prev->_M_right);
+        } else {
+            this->_M_link_new_node<_Sized>(__node, __next, &__next->_M_left);
+        }
     }
 
     // 允许插入重复值节点（multiset、multimap）
@@ -568,14 +787,8 @@ protected:
             return __parent;
         }
 
-        __node->_M_left = nullptr;
-        __node->_M_right = nullptr;
-        __node->_M_color = _S_red;
-
-        __node->_M_parent = __parent;
-        __node->_M_pparent = __pparent;
-        *__pparent = __node;
-        _RbTreeBase::_M_fix_violation(__node);
+        this->_M_link_new_node<_NodeImpl::_S_sized>(__node, __parent,
+                                                    __pparent);
         return nullptr;
     }
 
@@ -598,14 +811,366 @@ protected:
             __pparent = &__parent->_M_right;
         }
 
-        __node->_M_left = nullptr;
-        __node->_M_right = nullptr;
-        __node->_M_color = _S_red;
+        this->_M_link_new_node<_NodeImpl::_S_sized>(__node, __parent,
+                                                    __pparent);
+    }
 
-        __node->_M_parent = __parent;
-        __node->_M_pparent = __pparent;
-        *__pparent = __node;
-        _RbTreeBase::_M_fix_violation(__node);
+    // 带提示的插入：__hint 为 nullptr 表示 end()。新节点恰好落在 __hint
+    // 和它的前驱之间（或 __hint 和它的后继之间）时直接挂上去，不用从根往下找；
+    // 否则退回普通插入。按顺序追加时只需要 O(1) 次比较
+    template <class _NodeImpl, class _Compare>
+    _RbTreeNode *_M_single_insert_node_hint(_RbTreeNode *__hint,
+                                            _RbTreeNode *__node,
+                                            _Compare __comp) {
+        auto &__value = static_cast<_NodeImpl *>(__node)->_M_value;
+        if (__hint == nullptr) {
+            _RbTreeNode *__max = _M_block->_M_rightmost;
+            if (__max != nullptr &&
+                __comp(static_cast<_NodeImpl *>(__max)->_M_value, __value)) {
+                this->_M_link_between<_NodeImpl::_S_sized>(__max, nullptr,
+                                                           __node);
+                return nullptr;
+            }
+        } else if (__comp(__value,
+                          static_cast<_NodeImpl *>(__hint)->_M_value)) {
+            _RbTreeNode *__prev = _RbTreeBase::_S_prev_node(__hint);
+            if (__prev == nullptr ||
+                __comp(static_cast<_NodeImpl *>(__prev)->_M_value, __value)) {
+                this->_M_link_between<_NodeImpl::_S_sized>(__prev, __hint,
+                                                           __node);
+                return nullptr;
+            }
+        } else if (__comp(static_cast<_NodeImpl *>(__hint)->_M_value,
+                          __value)) {
+            _RbTreeNode *__next = _RbTreeBase::_S_next_node(__hint);
+            if (__next == nullptr ||
+                __comp(__value, static_cast<_NodeImpl *>(__next)->_M_value)) {
+                this->_M_link_between<_NodeImpl::_S_sized>(__hint, __next,
+                                                           __node);
+                return nullptr;
+            }
+        } else {
+            return __hint;
+        }
+        return this->_M_single_insert_node<_NodeImpl>(__node, __comp);
+    }
+
+    // 等价的值插在尽量靠近 __hint 之前的位置
+    template <class _NodeImpl, class _Compare>
+    void _M_multi_insert_node_hint(_RbTreeNode *__hint, _RbTreeNode *__node,
+                                   _Compare __comp) {
+        auto &__value = static_cast<_NodeImpl *>(__node)->_M_value;
+        if (__hint == nullptr) {
+            _RbTreeNode *__max = _M_block->_M_rightmost;
+            if (__max != nullptr &&
+                !__comp(__value, static_cast<_NodeImpl *>(__max)->_M_value)) {
+                this->_M_link_between<_NodeImpl::_S_sized>(__max, nullptr,
+                                                           __node);
+                return;
+            }
+        } else if (!__comp(static_cast<_NodeImpl *>(__hint)->_M_value,
+                           __value)) {
+            _RbTreeNode *__prev = _RbTreeBase::_S_prev_node(__hint);
+            if (__prev == nullptr ||
+                !__comp(__value, static_cast<_NodeImpl *>(__prev)->_M_value)) {
+                this->_M_link_between<_NodeImpl::_S_sized>(__prev, __hint,
+                                                           __node);
+                return;
+            }
+        } else {
+            _RbTreeNode *__next = _RbTreeBase::_S_next_node(__hint);
+            if (__next == nullptr ||
+                !__comp(static_cast<_NodeImpl *>(__next)->_M_value, __value)) {
+                this->_M_link_between<_NodeImpl::_S_sized>(__hint, __next,
+                                                           __node);
+                return;
+            }
+        }
+        this->_M_multi_insert_node<_NodeImpl>(__node, __comp);
+    }
+
+    template <bool _Sized>
+    void _M_unlink_node(_RbTreeNode *__node) noexcept {
+        if (__node == _M_block->_M_rightmost) {
+            _M_block->_M_rightmost = _RbTreeBase::_S_prev_node(__node);
+        }
+        _RbTreeBase::_M_erase_node<_Sized>(__node);
+        --_M_block->_M_size;
+    }
+
+    // 从 __head 开始的链表（用 _M_right 串起来）中序取出 __n 个节点，
+    // 每次取中间的作为子树根，左右子树大小最多差一
+    template <bool _Sized>
+    static _RbTreeNode *_S_build_balanced(_RbTreeNode *&__head, std::size_t __n,
+                                          std::size_t __depth,
+                                          std::size_t __red_depth) noexcept {
+        if (__n == 0) {
+            return nullptr;
+        }
+        std::size_t __left_n = __n / 2;
+        _RbTreeNode *__left = _S_build_balanced<_Sized>(
+            __head, __left_n, __depth + 1, __red_depth);
+        _RbTreeNode *__node = __head;
+        __head = __head->_M_right;
+        __node->_M_set_color(__depth == __red_depth ? _S_red : _S_black);
+        __node->_M_left = __left;
+        if (__left) {
+            __left->_M_set_parent(__node);
+        }
+        _RbTreeNode *__right = _S_build_balanced<_Sized>(
+            __head, __n - __left_n - 1, __depth + 1, __red_depth);
+        __node->_M_right = __right;
+        if (__right) {
+            __right->_M_set_parent(__node);
+        }
+        if constexpr (_Sized) {
+            _S_set_count(__node, __n);
+        }
+        return __node;
+    }
+
+    // 用已排好序的节点链表替换整棵树，O(n)。
+    // 这样建出的树除了最深一层都是满的，最深一层不满时把它染红，
+    // 其余全黑，所有路径的黑高都相同，也不会出现连续的红节点
+    template <bool _Sized>
+    void _M_link_sorted_chain(_RbTreeNode *__head, std::size_t __n) noexcept {
+        std::size_t __red_depth = std::size_t(-1);
+        if ((__n + 1) & __n) { // __n + 1 不是 2 的幂，最深一层不满
+            __red_depth = std::size_t(std::bit_width(__n)) - 1;
+        }
+        _RbTreeNode *__root =
+            _S_build_balanced<_Sized>(__head, __n, 0, __red_depth);
+        if (__root) {
+            __root->_M_set_root(_M_block);
+        }
+        _M_block->_M_root = __root;
+        _M_block->_M_size = __n;
+        while (__root != nullptr && __root->_M_right != nullptr) {
+            __root = __root->_M_right;
+        }
+        _M_block->_M_rightmost = __root;
+    }
+
+    // 以下是 split / join 原语，操作的是脱离了 _RbTreeRoot 的子树：
+    // 根节点为黑色、父指针为空，同时记下它的黑高（空树为 0）
+    struct _RbTreeSubtree {
+        _RbTreeNode *_M_root;
+        int _M_black_height;
+    };
+
+    // 用 _M_right 串起来的节点链表，可以在尾部 O(1) 追加
+    struct _RbTreeChain {
+        _RbTreeNode *_M_head = nullptr;
+        _RbTreeNode **_M_tail = &_M_head;
+        std::size_t _M_count = 0;
+
+        void _M_push(_RbTreeNode *__node) noexcept {
+            __node->_M_right = nullptr;
+            *_M_tail = __node;
+            _M_tail = &__node->_M_right;
+            ++_M_count;
+        }
+
+        // 按中序追加整棵子树
+        void _M_push_tree(_RbTreeNode *__node) noexcept {
+            while (__node != nullptr) {
+                this->_M_push_tree(__node->_M_left);
+                _RbTreeNode *__right = __node->_M_right;
+                this->_M_push(__node);
+                __node = __right;
+            }
+        }
+
+        void _M_splice(_RbTreeChain &__that) noexcept {
+            if (__that._M_head != nullptr) {
+                *_M_tail = __that._M_head;
+                _M_tail = __that._M_tail;
+                _M_count += __that._M_count;
+            }
+        }
+    };
+
+    static int _S_black_height(_RbTreeNode *__node) noexcept {
+        int __h = 0;
+        for (; __node != nullptr; __node = __node->_M_left) {
+            __h += __node->_M_color() == _S_black;
+        }
+        return __h;
+    }
+
+    // 摘下整棵树，*this 变为空树
+    _RbTreeSubtree _M_release_tree() noexcept {
+        _RbTreeNode *__root = _M_block->_M_root;
+        _M_block->_M_root = nullptr;
+        _M_block->_M_size = 0;
+        _M_block->_M_rightmost = nullptr;
+        if (__root == nullptr) {
+            return {nullptr, 0};
+        }
+        __root->_M_set_parent(nullptr);
+        return {__root, _S_black_height(__root)};
+    }
+
+    // 把子树装回 *this（必须是空树）
+    void _M_adopt_tree(_RbTreeSubtree __tree, std::size_t __n) noexcept {
+        _RbTreeNode *__root = __tree._M_root;
+        _M_block->_M_root = __root;
+        _M_block->_M_size = __n;
+        if (__root != nullptr) {
+            __root->_M_set_root(_M_block);
+        }
+        while (__root != nullptr && __root->_M_right != nullptr) {
+            __root = __root->_M_right;
+        }
+        _M_block->_M_rightmost = __root;
+    }
+
+    // 拆开根节点：返回根，左右子树的根若为红则染黑，保持子树根为黑
+    static _RbTreeNode *_S_expose(_RbTreeSubtree __tree, _RbTreeSubtree &__left,
+                                  _RbTreeSubtree &__right) noexcept {
+        _RbTreeNode *__root = __tree._M_root;
+        __left = {__root->_M_left, __tree._M_black_height - 1};
+        __right = {__root->_M_right, __tree._M_black_height - 1};
+        for (_RbTreeSubtree *__child: {&__left, &__right}) {
+            if (__child->_M_root != nullptr) {
+                __child->_M_root->_M_set_parent(nullptr);
+                if (__child->_M_root->_M_color() == _S_red) {
+                    __child->_M_root->_M_set_color(_S_black);
+                    ++__child->_M_black_height;
+                }
+            }
+        }
+        return __root;
+    }
+
+    // 以 __key 为分界把两棵树连起来，__left 的所有元素在 __key 之前，
+    // __right 的所有元素在 __key 之后。沿较高一棵树的边下降到黑高相同的
+    // 黑节点处挂上红色的 __key，再向上修复，复杂度 O(黑高之差 + 1)
+    template <bool _Sized>
+    static _RbTreeSubtree _S_join(_RbTreeSubtree __left, _RbTreeNode *__key,
+                                  _RbTreeSubtree __right) noexcept {
+        if (__left._M_black_height == __right._M_black_height) {
+            __key->_M_parent_color = 0;
+            __key->_M_set_color(_S_black);
+            __key->_M_left = __left._M_root;
+            __key->_M_right = __right._M_root;
+            if (__left._M_root != nullptr) {
+                __left._M_root->_M_set_parent(__key);
+            }
+            if (__right._M_root != nullptr) {
+                __right._M_root->_M_set_parent(__key);
+            }
+            if constexpr (_Sized) {
+                _S_recount(__key);
+            }
+            return {__key, __left._M_black_height + 1};
+        }
+        bool __descend_right =
+            __left._M_black_height > __right._M_black_height;
+        _RbTreeSubtree __tall = __descend_right ? __left : __right;
+        _RbTreeSubtree __short = __descend_right ? __right : __left;
+        std::size_t __added = 0;
+        if constexpr (_Sized) {
+            __added = _S_count(__short._M_root) + 1;
+        }
+        _RbTreeNode *__parent = nullptr;
+        _RbTreeNode *__node = __tall._M_root;
+        int __h = __tall._M_black_height;
+        while (__node != nullptr && (__node->_M_color() == _S_red ||
+                                     __h != __short._M_black_height)) {
+            if (__node->_M_color() == _S_black) {
+                --__h;
+            }
+            if constexpr (_Sized) {
+                _S_set_count(__node, _S_count(__node) + __added);
+            }
+            __parent = __node;
+            __node = __descend_right ? __node->_M_right : __node->_M_left;
+        }
+        assert(__parent != nullptr);
+        __key->_M_parent_color = 0;
+        __key->_M_set_parent(__parent);
+        __key->_M_set_color(_S_red);
+        if (__descend_right) {
+            __parent->_M_right = __key;
+            __key->_M_left = __node;
+            __key->_M_right = __short._M_root;
+        } else {
+            __parent->_M_left = __key;
+            __key->_M_left = __short._M_root;
+            __key->_M_right = __node;
+        }
+        if (__node != nullptr) {
+            __node->_M_set_parent(__key);
+        }
+        if (__short._M_root != nullptr) {
+            __short._M_root->_M_set_parent(__key);
+        }
+        if constexpr (_Sized) {
+            _S_recount(__key);
+        }
+        // 借一个临时的 _RbTreeRoot，让旋转可以替换根节点
+        _RbTreeRoot __block{__tall._M_root, 0, nullptr};
+        __tall._M_root->_M_set_root(&__block);
+        bool __grew = _RbTreeBase::_M_fix_violation<_Sized>(__key);
+        __block._M_root->_M_set_parent(nullptr);
+        return {__block._M_root, __tall._M_black_height + __grew};
+    }
+
+    // 摘下最大的节点，其余部分放回 __tree
+    template <bool _Sized>
+    static _RbTreeNode *_S_split_last(_RbTreeSubtree &__tree) noexcept {
+        _RbTreeSubtree __left, __right;
+        _RbTreeNode *__root = _S_expose(__tree, __left, __right);
+        if (__right._M_root == nullptr) {
+            __tree = __left;
+            return __root;
+        }
+        _RbTreeNode *__last = _S_split_last<_Sized>(__right);
+        __tree = _S_join<_Sized>(__left, __root, __right);
+        return __last;
+    }
+
+    // 没有分界节点的 join
+    template <bool _Sized>
+    static _RbTreeSubtree _S_join2(_RbTreeSubtree __left,
+                                   _RbTreeSubtree __right) noexcept {
+        if (__left._M_root == nullptr) {
+            return __right;
+        }
+        _RbTreeNode *__key = _S_split_last<_Sized>(__left);
+        return _S_join<_Sized>(__left, __key, __right);
+    }
+
+    // 按 __value 把 __tree 拆成小于和大于它的两部分，
+    // 返回与它等价的节点（不属于任何一边），没有则返回 nullptr
+    template <bool _Sized, class _NodeImpl, class _Tv, class _Compare>
+    static _RbTreeNode *_S_split(_RbTreeSubtree __tree, _Tv &&__value,
+                                 _Compare const &__comp,
+                                 _RbTreeSubtree &__less,
+                                 _RbTreeSubtree &__greater) noexcept {
+        if (__tree._M_root == nullptr) {
+            __less = __greater = {nullptr, 0};
+            return nullptr;
+        }
+        _RbTreeSubtree __left, __right;
+        _RbTreeNode *__root = _S_expose(__tree, __left, __right);
+        auto &__root_value = static_cast<_NodeImpl *>(__root)->_M_value;
+        _RbTreeNode *__match;
+        if (__comp(__value, __root_value)) {
+            __match = _S_split<_Sized, _NodeImpl>(__left, __value, __comp,
+                                                  __less, __left);
+            __greater = _S_join<_Sized>(__left, __root, __right);
+        } else if (__comp(__root_value, __value)) {
+            __match = _S_split<_Sized, _NodeImpl>(__right, __value, __comp,
+                                                  __right, __greater);
+            __less = _S_join<_Sized>(__left, __root, __right);
+        } else {
+            __match = __root;
+            __less = __left;
+            __greater = __right;
+        }
+        return __match;
     }
 };
 
@@ -614,35 +1179,65 @@ template <class _Tp, class _Compare, class _Alloc, class _NodeImpl,
 struct _RbTreeNodeHandle {
 protected:
     _NodeImpl *_M_node;
-    [[no_unique_address]] _Alloc _M_alloc;
 
-    _RbTreeNodeHandle(_NodeImpl *__node, _Alloc __alloc) noexcept
+    // 只在 _M_node 非空时构造，空句柄不要求分配器可默认构造
+    union {
+        _Alloc _M_alloc;
+    };
+
+    _RbTreeNodeHandle(_NodeImpl *__node, const _Alloc &__alloc) noexcept
         : _M_node(__node),
           _M_alloc(__alloc) {}
 
+    // 调用者保证 *this 为空
+    void _M_take(_RbTreeNodeHandle &__that) noexcept {
+        if (__that._M_node) {
+            ::new (static_cast<void *>(std::addressof(_M_alloc)))
+                _Alloc(std::move(__that._M_alloc));
+            _M_node = __that._M_release();
+        }
+    }
+
+    // 交出节点，句柄变为空
+    _NodeImpl *_M_release() noexcept {
+        _M_alloc.~_Alloc();
+        return std::exchange(_M_node, nullptr);
+    }
+
     template <class, class, class, class>
     friend struct _RbTreeImpl;
 
 public:
     _RbTreeNodeHandle() noexcept : _M_node(nullptr) {}
 
-    _RbTreeNodeHandle(_RbTreeNodeHandle &&__that) noexcept
-        : _M_node(__that._M_node) {
-        __that._M_node = nullptr;
+    _RbTreeNodeHandle(_RbTreeNodeHandle &&__that) noexcept : _M_node(nullptr) {
+        _M_take(__that);
     }
 
     _RbTreeNodeHandle &operator=(_RbTreeNodeHandle &&__that) noexcept {
-        std::swap(_M_node, __that._M_node);
+        _RbTreeNodeHandle __tmp(std::move(__that));
+        __that._M_take(*this);
+        _M_take(__tmp);
         return *this;
     }
 
+    bool empty() const noexcept {
+        return _M_node == nullptr;
+    }
+
+    explicit operator bool() const noexcept {
+        return _M_node != nullptr;
+    }
+
     _Tp &value() const noexcept {
         return static_cast<_NodeImpl *>(_M_node)->_M_value;
     }
 
     ~_RbTreeNodeHandle() noexcept {
         if (_M_node) {
+            _M_node->_M_destruct();
             _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, _M_node);
+            _M_alloc.~_Alloc();
         }
     }
 };
@@ -652,6 +1247,9 @@ struct _RbTreeNodeHandle<
     _Tp, _Compare, _Alloc, _NodeImpl,
     decltype((void)static_cast<typename _Compare::_RbTreeIsMap *>(nullptr))>
     : _RbTreeNodeHandle<_Tp, _Compare, _Alloc, _NodeImpl, void *> {
+    using _RbTreeNodeHandle<_Tp, _Compare, _Alloc, _NodeImpl,
+                            void *>::_RbTreeNodeHandle;
+
     typename _Tp::first_type &key() const noexcept {
         return this->value().first;
     }
@@ -665,13 +1263,16 @@ template <class _Tp, class _Compare, class _Alloc,
           class _NodeImpl = _RbTreeNodeImpl<_Tp>>
 struct _RbTreeImpl : protected _RbTreeBase {
 protected:
+    // 保存节点类型的分配器，分配节点时不用每次重新绑定
+    using _NodeAlloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_NodeImpl>;
+
     [[no_unique_address]] _Compare _M_comp;
-    [[no_unique_address]] _Alloc _M_alloc;
+    [[no_unique_address]] _NodeAlloc _M_alloc;
 
 public:
-    _RbTreeImpl() noexcept
-        : _RbTreeBase(_RbTreeBase::_M_allocate<_RbTreeRoot>(_M_alloc)) {
-        _M_block->_M_root = nullptr;
+    _RbTreeImpl() : _RbTreeBase(nullptr) {
+        _M_init_block();
     }
 
     ~_RbTreeImpl() noexcept {
@@ -679,35 +1280,140 @@ public:
         _RbTreeBase::_M_deallocate<_RbTreeRoot>(_M_alloc, _M_block);
     }
 
-    explicit _RbTreeImpl(_Compare __comp) noexcept
-        : _RbTreeBase(_RbTreeBase::_M_allocate<_RbTreeRoot>(_M_alloc)),
+    explicit _RbTreeImpl(_Compare __comp)
+        : _RbTreeBase(nullptr),
           _M_comp(__comp) {
-        _M_block->_M_root = nullptr;
+        _M_init_block();
     }
 
-    explicit _RbTreeImpl(_Alloc alloc, _Compare __comp = _Compare()) noexcept
-        : _RbTreeBase(_RbTreeBase::_M_allocate<_RbTreeRoot>(_M_alloc)),
-          _M_alloc(alloc),
-          _M_comp(__comp) {
-        _M_block->_M_root = nullptr;
+    // 根块从 _M_alloc 分配，必须等 _M_alloc 构造完成后再分配
+    explicit _RbTreeImpl(const _Alloc &alloc, _Compare __comp = _Compare())
+        : _RbTreeBase(nullptr),
+          _M_comp(__comp),
+          _M_alloc(alloc) {
+        _M_init_block();
     }
 
-    _RbTreeImpl(_RbTreeImpl &&__that) noexcept : _RbTreeBase(__that._M_block) {
-        __that._M_block = _RbTreeBase::_M_allocate<_RbTreeRoot>(_M_alloc);
-        __that._M_block->_M_root = nullptr;
+    // 被移走的一方要换一个空的根块，它从同一个分配器里分配，
+    // 所以比较器和分配器是复制过来的
+    _RbTreeImpl(_RbTreeImpl &&__that) noexcept(
+        std::is_nothrow_copy_constructible_v<_Compare> &&
+        std::is_nothrow_copy_constructible_v<_NodeAlloc>)
+        : _RbTreeBase(__that._M_block),
+          _M_comp(__that._M_comp),
+          _M_alloc(__that._M_alloc) {
+        __that._M_init_block();
     }
 
     _RbTreeImpl &operator=(_RbTreeImpl &&__that) noexcept {
         std::swap(_M_block, __that._M_block);
+        std::swap(_M_comp, __that._M_comp);
+        std::swap(_M_alloc, __that._M_alloc);
         return *this;
     }
 
+    _Alloc get_allocator() const noexcept {
+        return _Alloc(_M_alloc);
+    }
+
+private:
+    void _M_init_block() {
+        _M_block = _RbTreeBase::_M_allocate<_RbTreeRoot>(_M_alloc);
+        _M_block->_M_root = nullptr;
+        _M_block->_M_size = 0;
+        _M_block->_M_rightmost = nullptr;
+    }
+
 protected:
+    struct _EmptyCopyTag {};
+
+    // 拷贝构造先建一棵空树：比较器照搬，分配器按
+    // select_on_container_copy_construction 取得，元素由派生类插入
+    _RbTreeImpl(_EmptyCopyTag, const _RbTreeImpl &__that)
+        : _RbTreeBase(nullptr),
+          _M_comp(__that._M_comp),
+          _M_alloc(std::allocator_traits<_NodeAlloc>::
+                       select_on_container_copy_construction(__that._M_alloc)) {
+        _M_init_block();
+    }
+
+    // 空树插入一段区间：先把所有元素构造成节点，按输入顺序串成链表，
+    // 同时检查是否有序（_Unique 时丢掉和前一个相等的节点，保留第一个）。
+    // 有序就 O(n) 直接连成平衡树，否则再逐个插入这些节点。
+    // _Trusted 表示调用者保证有序（sorted_unique / sorted_equivalent），
+    // 只在调试模式下检查
+    template <bool _Unique, bool _Trusted, class _InputIt>
+    void _M_build_from_range(_InputIt __first, _InputIt __last) {
+        assert(this->empty());
+        _RbTreeNode *__head = nullptr;
+        _RbTreeNode **__tail = &__head;
+        _NodeImpl *__prev = nullptr;
+        size_t __count = 0;
+        bool __sorted = true;
+        try {
+            for (; __first != __last; ++__first) {
+                _NodeImpl *__node =
+                    _RbTreeBase::_M_allocate<_NodeImpl>(_M_alloc);
+                __node->_M_construct(*__first);
+                if constexpr (_Trusted) {
+                    assert(!__prev ||
+                           (_Unique ? _M_comp(__prev->_M_value,
+                                              __node->_M_value)
+                                    : !_M_comp(__node->_M_value,
+                                               __prev->_M_value)));
+                } else if (__prev && __sorted) {
+                    if (_M_comp(__node->_M_value, __prev->_M_value)) {
+                        __sorted = false;
+                    } else if (_Unique &&
+                               !_M_comp(__prev->_M_value, __node->_M_value)) {
+                        __node->_M_destruct();
+                        _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __node);
+                        continue;
+                    }
+                }
+                __node->_M_right = nullptr;
+                *__tail = __node;
+                __tail = &__node->_M_right;
+                __prev = __node;
+                ++__count;
+            }
+        } catch (...) {
+            while (__head) {
+                _RbTreeNode *__next = __head->_M_right;
+                static_cast<_NodeImpl *>(__head)->_M_destruct();
+                _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __head);
+                __head = __next;
+            }
+            throw;
+        }
+        if (__sorted) {
+            this->_M_link_sorted_chain<_NodeImpl::_S_sized>(__head, __count);
+            return;
+        }
+        while (__head) {
+            _RbTreeNode *__next = __head->_M_right;
+            if constexpr (_Unique) {
+                if (this->_M_single_insert_node<_NodeImpl>(__head, _M_comp)) {
+                    static_cast<_NodeImpl *>(__head)->_M_destruct();
+                    _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __head);
+                }
+            } else {
+                this->_M_multi_insert_node<_NodeImpl>(__head, _M_comp);
+            }
+            __head = __next;
+        }
+    }
+
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     void _M_single_insert(_InputIt __first, _InputIt __last) {
+        if (this->empty()) {
+            this->_M_build_from_range<true, false>(__first, __last);
+            return;
+        }
+        // 以 end() 为提示，追加在最大值之后的有序区间只需 O(1) 次比较
         while (__first != __last) {
-            this->_M_single_insert(*__first);
+            this->_M_single_emplace_hint(this->end(), *__first);
             ++__first;
         }
     }
@@ -715,12 +1421,23 @@ protected:
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     void _M_multi_insert(_InputIt __first, _InputIt __last) {
+        if (this->empty()) {
+            this->_M_build_from_range<false, false>(__first, __last);
+            return;
+        }
         while (__first != __last) {
-            this->_M_multi_insert(*__first);
+            this->_M_multi_emplace_hint(this->end(), *__first);
             ++__first;
         }
     }
 
+    // 调用者保证 [__first, __last) 已按 _M_comp 排好序
+    template <bool _Unique, class _InputIt>
+    void _M_assign_sorted(_InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_build_from_range<_Unique, true>(__first, __last);
+    }
+
 public:
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
@@ -747,6 +1464,31 @@ protected:
             this->_M_find_node<_NodeImpl>(__value, _M_comp));
     }
 
+    // 按键查找边界，供 map 在比较器不透明时使用
+    template <class _Tv>
+    const_iterator _M_lower(_Tv &&__value) const noexcept {
+        return this->_M_prevent_end(
+            this->_M_lower_bound<_NodeImpl>(__value, _M_comp));
+    }
+
+    template <class _Tv>
+    iterator _M_lower(_Tv &&__value) noexcept {
+        return this->_M_prevent_end(
+            this->_M_lower_bound<_NodeImpl>(__value, _M_comp));
+    }
+
+    template <class _Tv>
+    const_iterator _M_upper(_Tv &&__value) const noexcept {
+        return this->_M_prevent_end(
+            this->_M_upper_bound<_NodeImpl>(__value, _M_comp));
+    }
+
+    template <class _Tv>
+    iterator _M_upper(_Tv &&__value) noexcept {
+        return this->_M_prevent_end(
+            this->_M_upper_bound<_NodeImpl>(__value, _M_comp));
+    }
+
     template <class... _Ts>
     iterator _M_multi_emplace(_Ts &&...__value) {
         _NodeImpl *__node = _RbTreeBase::_M_allocate<_NodeImpl>(_M_alloc);
@@ -771,12 +1513,54 @@ protected:
         }
     }
 
+    // __hint 为 end() 时返回 nullptr
+    static _RbTreeNode *_S_hint_node(const_iterator __hint) noexcept {
+        return __hint._M_off_by_one ? nullptr : __hint._M_node;
+    }
+
+    template <class... _Ts>
+    iterator _M_multi_emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        _NodeImpl *__node = _RbTreeBase::_M_allocate<_NodeImpl>(_M_alloc);
+        __node->_M_construct(std::forward<_Ts>(__value)...);
+        this->_M_multi_insert_node_hint<_NodeImpl>(_S_hint_node(__hint),
+                                                   __node, _M_comp);
+        return __node;
+    }
+
+    template <class... _Ts>
+    std::pair<iterator, bool> _M_single_emplace_hint(const_iterator __hint,
+                                                     _Ts &&...__value) {
+        _RbTreeNode *__node = _RbTreeBase::_M_allocate<_NodeImpl>(_M_alloc);
+        static_cast<_NodeImpl *>(__node)->_M_construct(
+            std::forward<_Ts>(__value)...);
+        _RbTreeNode *__conflict = this->_M_single_insert_node_hint<_NodeImpl>(
+            _S_hint_node(__hint), __node, _M_comp);
+        if (__conflict) {
+            static_cast<_NodeImpl *>(__node)->_M_destruct();
+            _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __node);
+            return {__conflict, false};
+        } else {
+            return {__node, true};
+        }
+    }
+
+    // 后序释放整棵子树，不做任何再平衡
+    void _M_destroy_subtree(_RbTreeNode *__node) noexcept {
+        while (__node != nullptr) {
+            this->_M_destroy_subtree(__node->_M_right);
+            _RbTreeNode *__left = __node->_M_left;
+            static_cast<_NodeImpl *>(__node)->_M_destruct();
+            _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __node);
+            __node = __left;
+        }
+    }
+
 public:
     void clear() noexcept {
-        iterator __it = this->begin();
-        while (__it != this->end()) {
-            __it = this->erase(__it);
-        }
+        this->_M_destroy_subtree(_M_block->_M_root);
+        _M_block->_M_root = nullptr;
+        _M_block->_M_size = 0;
+        _M_block->_M_rightmost = nullptr;
     }
 
     iterator erase(const_iterator __it) noexcept {
@@ -784,31 +1568,44 @@ public:
         iterator __tmp(__it);
         ++__tmp;
         _RbTreeNode *__node = __it._M_node;
-        _RbTreeImpl::_M_erase_node(__node);
+        this->_M_unlink_node<_NodeImpl::_S_sized>(__node);
         static_cast<_NodeImpl *>(__node)->_M_destruct();
         _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __node);
         return __tmp;
     }
 
-    using node_type = _RbTreeNodeHandle<_Tp, _Compare, _Alloc, _NodeImpl>;
+    using node_type = _RbTreeNodeHandle<_Tp, _Compare, _NodeAlloc, _NodeImpl>;
 
-    template <class... _Ts>
     std::pair<iterator, bool> insert(node_type __nh) {
+        if (__nh.empty()) {
+            return {this->end(), false};
+        }
         _NodeImpl *__node = __nh._M_node;
         _RbTreeNode *__conflict =
             this->_M_single_insert_node<_NodeImpl>(__node, _M_comp);
         if (__conflict) {
-            static_cast<_NodeImpl *>(__node)->_M_destruct();
-            return {__conflict, false};
+            return {__conflict, false}; // __nh 析构时释放节点
         } else {
+            __nh._M_release();
             return {__node, true};
         }
     }
 
+protected:
+    iterator _M_multi_insert(node_type __nh) {
+        if (__nh.empty()) {
+            return this->end();
+        }
+        _NodeImpl *__node = __nh._M_release();
+        this->_M_multi_insert_node<_NodeImpl>(__node, _M_comp);
+        return __node;
+    }
+
+public:
     node_type extract(const_iterator __it) noexcept {
         _RbTreeNode *__node = __it._M_node;
-        _RbTreeImpl::_M_erase_node(__node);
-        return {__node, _M_alloc};
+        this->_M_unlink_node<_NodeImpl::_S_sized>(__node);
+        return {static_cast<_NodeImpl *>(__node), _M_alloc};
     }
 
 protected:
@@ -816,7 +1613,7 @@ protected:
     size_t _M_single_erase(_Tv &&__value) noexcept {
         _RbTreeNode *__node = this->_M_find_node<_NodeImpl>(__value, _M_comp);
         if (__node != nullptr) {
-            this->_M_erase_node(__node);
+            this->_M_unlink_node<_NodeImpl::_S_sized>(__node);
             static_cast<_NodeImpl *>(__node)->_M_destruct();
             _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __node);
             return 1;
@@ -850,25 +1647,29 @@ public:
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     iterator lower_bound(_Tv &&__value) noexcept {
-        return this->_M_lower_bound<_NodeImpl>(__value, _M_comp);
+        return this->_M_prevent_end(
+            this->_M_lower_bound<_NodeImpl>(__value, _M_comp));
     }
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     const_iterator lower_bound(_Tv &&__value) const noexcept {
-        return this->_M_lower_bound<_NodeImpl>(__value, _M_comp);
+        return this->_M_prevent_end(
+            this->_M_lower_bound<_NodeImpl>(__value, _M_comp));
     }
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     iterator upper_bound(_Tv &&__value) noexcept {
-        return this->_M_upper_bound<_NodeImpl>(__value, _M_comp);
+        return this->_M_prevent_end(
+            this->_M_upper_bound<_NodeImpl>(__value, _M_comp));
     }
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     const_iterator upper_bound(_Tv &&__value) const noexcept {
-        return this->_M_upper_bound<_NodeImpl>(__value, _M_comp);
+        return this->_M_prevent_end(
+            this->_M_upper_bound<_NodeImpl>(__value, _M_comp));
     }
 
     template <class _Tv,
@@ -913,16 +1714,369 @@ public:
         return {this->lower_bound(__value), this->upper_bound(__value)};
     }
 
+    // 顺序统计：第 __k 小的元素（从 0 开始），__k == size() 时为 end()
+    iterator nth(size_t __k) noexcept
+        requires _NodeImpl::_S_sized
+    {
+        return this->_M_prevent_end(this->_M_nth_node(__k));
+    }
+
+    const_iterator nth(size_t __k) const noexcept
+        requires _NodeImpl::_S_sized
+    {
+        return this->_M_prevent_end(this->_M_nth_node(__k));
+    }
+
+    // 迭代器的下标，end() 为 size()
+    size_t rank(const_iterator __it) const noexcept
+        requires _NodeImpl::_S_sized
+    {
+        _RbTreeNode *__node = _S_hint_node(__it);
+        if (__node == nullptr) {
+            return this->size();
+        }
+        size_t __rank = _S_count(__node->_M_left);
+        while (!__node->_M_is_root()) {
+            _RbTreeNode *__parent = __node->_M_parent();
+            if (__parent->_M_right == __node) {
+                __rank += _S_count(__parent->_M_left) + 1;
+            }
+            __node = __parent;
+        }
+        return __rank;
+    }
+
+    // 小于 __value 的元素个数，即 lower_bound 的下标
+    template <class _Tv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
+    size_t rank(_Tv &&__value) const noexcept
+        requires _NodeImpl::_S_sized
+    {
+        return this->_M_rank(__value);
+    }
+
+    size_t rank(const _Tp &__value) const noexcept
+        requires _NodeImpl::_S_sized
+    {
+        return this->_M_rank(__value);
+    }
+
+    // 不同于 std::distance，只需 O(log n)
+    std::ptrdiff_t distance(const_iterator __first,
+                            const_iterator __last) const noexcept
+        requires _NodeImpl::_S_sized
+    {
+        return std::ptrdiff_t(this->rank(__last)) -
+               std::ptrdiff_t(this->rank(__first));
+    }
+
 protected:
+    _RbTreeNode *_M_nth_node(size_t __k) const noexcept {
+        assert(__k <= this->size());
+        _RbTreeNode *__node = _M_block->_M_root;
+        while (__node != nullptr) {
+            size_t __left = _S_count(__node->_M_left);
+            if (__k < __left) {
+                __node = __node->_M_left;
+            } else if (__k == __left) {
+                return __node;
+            } else {
+                __k -= __left + 1;
+                __node = __node->_M_right;
+            }
+        }
+        return nullptr;
+    }
+
+    template <class _Tv>
+    size_t _M_rank(_Tv &&__value) const noexcept {
+        size_t __rank = 0;
+        _RbTreeNode *__node = _M_block->_M_root;
+        while (__node != nullptr) {
+            if (_M_comp(static_cast<_NodeImpl *>(__node)->_M_value, __value)) {
+                __rank += _S_count(__node->_M_left) + 1;
+                __node = __node->_M_right;
+            } else {
+                __node = __node->_M_left;
+            }
+        }
+        return __rank;
+    }
+
     template <class _Tv>
     size_t _M_multi_count(_Tv &&__value) const noexcept {
-        const_iterator __it = this->lower_bound(__value);
-        return __it != end() ? std::distance(__it, this->upper_bound()) : 0;
+        if constexpr (_NodeImpl::_S_sized) {
+            return this->_M_rank_upper(__value) - this->_M_rank(__value);
+        } else {
+            const_iterator __it = this->lower_bound(__value);
+            return __it != end()
+                       ? std::distance(__it, this->upper_bound(__value))
+                       : 0;
+        }
+    }
+
+    // 不大于 __value 的元素个数，即 upper_bound 的下标
+    template <class _Tv>
+    size_t _M_rank_upper(_Tv &&__value) const noexcept {
+        size_t __rank = 0;
+        _RbTreeNode *__node = _M_block->_M_root;
+        while (__node != nullptr) {
+            if (_M_comp(__value, static_cast<_NodeImpl *>(__node)->_M_value)) {
+                __node = __node->_M_left;
+            } else {
+                __rank += _S_count(__node->_M_left) + 1;
+                __node = __node->_M_right;
+            }
+        }
+        return __rank;
+    }
+
+    // 两边的黑高都至少这么大（约 1000 个节点以上）时才分给另一个线程
+    static constexpr int _S_parallel_black_height = 10;
+
+    // 并集和差集在 __other 不到 *this 的这么多分之一时逐个处理
+    static constexpr size_t _S_join_min_ratio = 32;
+
+    // merge 的来源不到 *this 的这么多分之一时逐个插入，否则归并后重建
+    static constexpr size_t _S_merge_rebuild_ratio = 8;
+
+    // 基于 split / join 的集合运算：按 __b 的根拆开 __a，两半递归后再
+    // join 回去，总共 O(m log(n/m + 1)) 次比较。__a 中的元素优先保留。
+    // 丢弃的节点先放进 __dropped，等所有线程结束后再在调用线程里释放，
+    // 分配器不需要是线程安全的
+    template <_RbTreeSetOp _Op>
+    _RbTreeSubtree _M_set_op(_RbTreeSubtree __a, _RbTreeSubtree __b,
+                             _RbTreeChain &__dropped,
+                             int __spawn) const noexcept {
+        constexpr bool _Sized = _NodeImpl::_S_sized;
+        if (__a._M_root == nullptr || __b._M_root == nullptr) {
+            if constexpr (_Op == _S_set_union) {
+                return __a._M_root != nullptr ? __a : __b;
+            } else if constexpr (_Op == _S_set_intersection) {
+                __dropped._M_push_tree(__a._M_root);
+                __dropped._M_push_tree(__b._M_root);
+                return {nullptr, 0};
+            } else {
+                __dropped._M_push_tree(__b._M_root);
+                return __a;
+            }
+        }
+        _RbTreeSubtree __b_less, __b_greater;
+        _RbTreeNode *__key = _S_expose(__b, __b_less, __b_greater);
+        _RbTreeSubtree __a_less, __a_greater;
+        _RbTreeNode *__match = _S_split<_Sized, _NodeImpl>(
+            __a, static_cast<_NodeImpl *>(__key)->_M_value, _M_comp,
+            __a_less, __a_greater);
+        _RbTreeSubtree __less, __greater;
+        _RbTreeChain __less_dropped;
+        auto __do_less = [&] {
+            return this->_M_set_op<_Op>(__a_less, __b_less, __less_dropped,
+                                        __spawn - 1);
+        };
+        std::future<_RbTreeSubtree> __task;
+        if (__spawn > 0 &&
+            __a._M_black_height >= _S_parallel_black_height &&
+            __b._M_black_height >= _S_parallel_black_height) {
+            try {
+                __task = std::async(std::launch::async, __do_less);
+            } catch (std::system_error const &) {
+                // 开不了线程就在本线程里算
+            }
+        }
+        __greater = this->_M_set_op<_Op>(__a_greater, __b_greater, __dropped,
+                                         __spawn - 1);
+        __less = __task.valid() ? __task.get() : __do_less();
+        __dropped._M_splice(__less_dropped);
+        if constexpr (_Op == _S_set_union) {
+            if (__match != nullptr) {
+                __dropped._M_push(__key);
+                __key = __match;
+            }
+            return _S_join<_Sized>(__less, __key, __greater);
+        } else if constexpr (_Op == _S_set_intersection) {
+            __dropped._M_push(__key);
+            if (__match != nullptr) {
+                return _S_join<_Sized>(__less, __match, __greater);
+            }
+            return _S_join2<_Sized>(__less, __greater);
+        } else {
+            __dropped._M_push(__key);
+            if (__match != nullptr) {
+                __dropped._M_push(__match);
+            }
+            return _S_join2<_Sized>(__less, __greater);
+        }
+    }
+
+    // 结果留在 *this 中，__other 被清空；两边的节点直接复用，
+    // 只有被丢弃的节点会释放。要求两边的分配器相等。
+    // 比较器抛出异常时拆开的树无法恢复，直接 std::terminate
+    template <_RbTreeSetOp _Op>
+    void _M_set_operation(_RbTreeImpl &__other) noexcept {
+        if (&__other == this) {
+            if constexpr (_Op == _S_set_difference) {
+                this->clear();
+            }
+            return;
+        }
+        assert(this->_M_alloc_equal(__other));
+        _RbTreeChain __dropped;
+        if (_Op != _S_set_intersection &&
+            __other.size() * _S_join_min_ratio <= this->size()) {
+            // __other 小得多时，把它的节点逐个插入（或逐个删除对应的节点）
+            // 比 split / join 更快
+            _RbTreeChain __nodes;
+            __nodes._M_push_tree(__other._M_release_tree()._M_root);
+            _RbTreeNode *__node = __nodes._M_head;
+            while (__node != nullptr) {
+                _RbTreeNode *__next = __node->_M_right;
+                if constexpr (_Op == _S_set_union) {
+                    if (this->_M_single_insert_node<_NodeImpl>(__node,
+                                                               _M_comp)) {
+                        __dropped._M_push(__node);
+                    }
+                } else {
+                    _RbTreeNode *__hit = this->_M_find_node<_NodeImpl>(
+                        static_cast<_NodeImpl *>(__node)->_M_value, _M_comp);
+                    if (__hit != nullptr) {
+                        this->_M_unlink_node<_NodeImpl::_S_sized>(__hit);
+                        __dropped._M_push(__hit);
+                    }
+                    __dropped._M_push(__node);
+                }
+                __node = __next;
+            }
+        } else {
+            size_t __total = this->size() + __other.size();
+            _RbTreeSubtree __a = this->_M_release_tree();
+            _RbTreeSubtree __b = __other._M_release_tree();
+            // 每分叉一层线程数翻倍，分到和硬件线程数相当为止
+            int __spawn =
+                int(std::bit_width(std::thread::hardware_concurrency())) - 1;
+            _RbTreeSubtree __result =
+                this->_M_set_op<_Op>(__a, __b, __dropped, __spawn);
+            this->_M_adopt_tree(__result, __total - __dropped._M_count);
+        }
+        this->_M_destroy_chain(__dropped._M_head);
+    }
+
+    void _M_destroy_chain(_RbTreeNode *__node) noexcept {
+        while (__node != nullptr) {
+            _RbTreeNode *__next = __node->_M_right;
+            static_cast<_NodeImpl *>(__node)->_M_destruct();
+            _RbTreeBase::_M_deallocate<_NodeImpl>(_M_alloc, __node);
+            __node = __next;
+        }
+    }
+
+    // 两边的节点是否可以互相搬动
+    bool _M_alloc_equal(const _RbTreeImpl &__other) const noexcept {
+        if constexpr (std::allocator_traits<
+                          _NodeAlloc>::is_always_equal::value) {
+            return true;
+        } else {
+            return _M_alloc == __other._M_alloc;
+        }
+    }
+
+    // 分配器不相等时节点不能直接搬，逐个用 *this 的分配器重新构造
+    // （移动元素），再从 __source 中释放原节点。分配失败时已搬过去的
+    // 元素留在 *this 中，其余的仍在 __source 中
+    template <bool _Unique>
+    void _M_merge_by_value(_RbTreeImpl &__source) {
+        _RbTreeNode *__node = __source._M_min_node();
+        while (__node != nullptr) {
+            _RbTreeNode *__next = _RbTreeBase::_S_next_node(__node);
+            auto &__value = static_cast<_NodeImpl *>(__node)->_M_value;
+            if (!_Unique ||
+                this->_M_find_node<_NodeImpl>(__value, _M_comp) == nullptr) {
+                _NodeImpl *__copy =
+                    _RbTreeBase::_M_allocate<_NodeImpl>(_M_alloc);
+                __copy->_M_construct(std::move(__value));
+                this->_M_multi_insert_node<_NodeImpl>(__copy, _M_comp);
+                __source._M_unlink_node<_NodeImpl::_S_sized>(__node);
+                static_cast<_NodeImpl *>(__node)->_M_destruct();
+                _RbTreeBase::_M_deallocate<_NodeImpl>(__source._M_alloc,
+                                                      __node);
+            }
+            __node = __next;
+        }
+    }
+
+    // 把 __source 的节点直接搬过来。两边都比较大时把两棵树按中序展开，
+    // 线性归并后重新建树，O(n + m)；否则逐个插入，O(m log(n + m))。
+    // _Unique 时已有的键留在 __source 中，仍然保持有序，同样 O(m) 重建
+    template <bool _Unique>
+    void _M_merge(_RbTreeImpl &__source) {
+        if (&__source == this || __source.empty()) {
+            return;
+        }
+        if (!this->_M_alloc_equal(__source)) {
+            this->_M_merge_by_value<_Unique>(__source);
+            return;
+        }
+        constexpr bool _Sized = _NodeImpl::_S_sized;
+        _RbTreeChain __from;
+        __from._M_push_tree(__source._M_release_tree()._M_root);
+        _RbTreeChain __kept;
+        if (__from._M_count * _S_merge_rebuild_ratio < this->size()) {
+            _RbTreeNode *__node = __from._M_head;
+            while (__node != nullptr) {
+                _RbTreeNode *__next = __node->_M_right;
+                if constexpr (_Unique) {
+                    if (this->_M_single_insert_node<_NodeImpl>(__node,
+                                                               _M_comp)) {
+                        __kept._M_push(__node);
+                    }
+                } else {
+                    this->_M_multi_insert_node<_NodeImpl>(__node, _M_comp);
+                }
+                __node = __next;
+            }
+        } else {
+            _RbTreeChain __into;
+            __into._M_push_tree(this->_M_release_tree()._M_root);
+            _RbTreeChain __merged;
+            _RbTreeNode *__a = __into._M_head;
+            _RbTreeNode *__b = __from._M_head;
+            _RbTreeNode *__last = nullptr;
+            size_t __rest = __into._M_count;
+            auto __value = [](_RbTreeNode *__node) -> auto & {
+                return static_cast<_NodeImpl *>(__node)->_M_value;
+            };
+            while (__b != nullptr) {
+                // 等价时 *this 的元素在前
+                if (__a != nullptr && !_M_comp(__value(__b), __value(__a))) {
+                    _RbTreeNode *__next = __a->_M_right;
+                    __merged._M_push(__a);
+                    __last = __a;
+                    __a = __next;
+                    --__rest;
+                    continue;
+                }
+                _RbTreeNode *__next = __b->_M_right;
+                if (_Unique && __last != nullptr &&
+                    !_M_comp(__value(__last), __value(__b))) {
+                    __kept._M_push(__b);
+                } else {
+                    __merged._M_push(__b);
+                    __last = __b;
+                }
+                __b = __next;
+            }
+            if (__a != nullptr) { // 剩下的都来自 *this，原样接上
+                *__merged._M_tail = __a;
+                __merged._M_count += __rest;
+            }
+            this->_M_link_sorted_chain<_Sized>(__merged._M_head,
+                                               __merged._M_count);
+        }
+        __source._M_link_sorted_chain<_Sized>(__kept._M_head, __kept._M_count);
     }
 
     template <class _Tv>
     bool _M_contains(_Tv &&__value) const noexcept {
-        return this->template _M_find_node<_NodeImpl>(__value, _M_comp) !=
+        return this->_M_find_node<_NodeImpl>(__value, _M_comp) !=
                nullptr;
     }
 
@@ -992,19 +2146,17 @@ public:
             }
             __os << ' ';
 # endif
-            __os << (__node->_M_color == _S_black ? 'B' : 'R');
+            __os << (__node->_M_color() == _S_black ? 'B' : 'R');
             __os << ' ';
             if (__node->_M_left) {
-                if (__node->_M_left->_M_parent != __node ||
-                    __node->_M_left->_M_pparent != &__node->_M_left) {
+                if (__node->_M_left->_M_parent() != __node) {
                     __os << '*';
                 }
             }
             _M_print(__os, __node->_M_left);
             __os << ' ';
             if (__node->_M_right) {
-                if (__node->_M_right->_M_parent != __node ||
-                    __node->_M_right->_M_pparent != &__node->_M_right) {
+                if (__node->_M_right->_M_parent() != __node) {
                     __os << '*';
                 }
             }
@@ -1027,6 +2179,6 @@ public:
     }
 
     size_t size() const noexcept {
-        return std::distance(this->begin(), this->end());
+        return this->_M_block->_M_size;
     }
 };
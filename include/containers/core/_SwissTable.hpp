@@ -0,0 +1,796 @@
+#pragma once
+
+#include <bit>
+#include <core/_common.hpp>
+#include <core/_relocate.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if !defined(_LIBPENGCXX_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+# define _LIBPENGCXX_SWISS_SSE2 1
+# include <emmintrin.h>
+#else
+# define _LIBPENGCXX_SWISS_SSE2 0
+#endif
+
+namespace Marcus {
+
+// SwissTable 风格的开放寻址哈希表。
+//
+// 每个槽位对应一个控制字节：最高位为 0 表示有元素，低 7 位存放哈希值的 H2 部分；
+// 否则是空位、墓碑或者末尾的哨兵。控制字节按 16 个一组用 SSE2 一次比较完，
+// 大多数查找只需要一次分组比较加一次键比较。
+//
+// 内存布局（一次分配）：
+//
+//     [槽位 x cap][控制字节 x cap][哨兵][前 15 个控制字节的副本]
+//
+// cap 总是 2^k - 1，末尾的副本让从任意位置开始读 16 个控制字节都不会越界。
+using _SwissCtrl = std::int8_t;
+
+inline constexpr _SwissCtrl _SwissEmpty = -128;   // 0b10000000
+inline constexpr _SwissCtrl _SwissDeleted = -2;   // 0b11111110
+inline constexpr _SwissCtrl _SwissSentinel = -1;  // 0b11111111
+
+// 分组比较的结果：第 i 位为 1 表示组内第 i 个控制字节命中
+struct _SwissBitMask {
+    std::uint32_t _M_bits;
+
+    explicit operator bool() const noexcept {
+        return _M_bits != 0;
+    }
+
+    unsigned _M_lowest() const noexcept {
+        return static_cast<unsigned>(std::countr_zero(_M_bits));
+    }
+
+    unsigned _M_leading_zeros() const noexcept {
+        return static_cast<unsigned>(std::countl_zero(_M_bits)) - 16;
+    }
+
+    // 用 range-for 依次取出每个命中的下标
+    unsigned operator*() const noexcept {
+        return _M_lowest();
+    }
+
+    _SwissBitMask &operator++() noexcept {
+        _M_bits &= _M_bits - 1;
+        return *this;
+    }
+
+    bool operator!=(const _SwissBitMask &__that) const noexcept {
+        return _M_bits != __that._M_bits;
+    }
+
+    _SwissBitMask begin() const noexcept {
+        return *this;
+    }
+
+    _SwissBitMask end() const noexcept {
+        return {0};
+    }
+};
+
+struct _SwissGroup {
+    static constexpr std::size_t _S_width = 16;
+
+#if _LIBPENGCXX_SWISS_SSE2
+    __m128i _M_ctrl;
+
+    explicit _SwissGroup(const _SwissCtrl *__ctrl) noexcept
+        : _M_ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(__ctrl))) {
+    }
+
+    _SwissBitMask _M_match(_SwissCtrl __h2) const noexcept {
+        return {static_cast<std::uint32_t>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_set1_epi8(__h2), _M_ctrl)))};
+    }
+
+    // 空位和墓碑都小于哨兵 -1
+    _SwissBitMask _M_match_empty_or_deleted() const noexcept {
+        return {static_cast<std::uint32_t>(_mm_movemask_epi8(
+            _mm_cmpgt_epi8(_mm_set1_epi8(_SwissSentinel), _M_ctrl)))};
+    }
+#else
+    _SwissCtrl _M_ctrl[_S_width];
+
+    explicit _SwissGroup(const _SwissCtrl *__ctrl) noexcept {
+        std::memcpy(_M_ctrl, __ctrl, _S_width);
+    }
+
+    _SwissBitMask _M_match(_SwissCtrl __h2) const noexcept {
+        std::uint32_t __bits = 0;
+        for (std::size_t __i = 0; __i != _S_width; ++__i) {
+            __bits |= std::uint32_t(_M_ctrl[__i] == __h2) << __i;
+        }
+        return {__bits};
+    }
+
+    _SwissBitMask _M_match_empty_or_deleted() const noexcept {
+        std::uint32_t __bits = 0;
+        for (std::size_t __i = 0; __i != _S_width; ++__i) {
+            __bits |= std::uint32_t(_M_ctrl[__i] < _SwissSentinel) << __i;
+        }
+        return {__bits};
+    }
+#endif
+
+    _SwissBitMask _M_match_empty() const noexcept {
+        return _M_match(_SwissEmpty);
+    }
+
+    std::size_t _M_count_leading_empty_or_deleted() const noexcept {
+        return static_cast<std::size_t>(
+            std::countr_one(_M_match_empty_or_deleted()._M_bits));
+    }
+};
+
+// set 的键就是元素本身
+struct _SwissIdentity {
+    template <class _Tp>
+    const _Tp &operator()(const _Tp &__value) const noexcept {
+        return __value;
+    }
+
+    template <class _Tp>
+    static void _S_relocate(_Tp *__dst, _Tp *__src) noexcept {
+        std::construct_at(__dst, std::move(*__src));
+        std::destroy_at(__src);
+    }
+};
+
+// map 的键是 pair 的 first
+struct _SwissSelectFirst {
+    template <class _Pair>
+    const typename _Pair::first_type &
+    operator()(const _Pair &__value) const noexcept {
+        return __value.first;
+    }
+
+    // pair<const K, V> 的 first 是 const 的，搬家时旧对象马上就要析构，
+    // 所以可以放心地去掉 const 把它移走
+    template <class _Pair>
+    static void _S_relocate(_Pair *__dst, _Pair *__src) noexcept {
+        using _Key = std::remove_const_t<typename _Pair::first_type>;
+        std::construct_at(
+            __dst, std::piecewise_construct,
+            std::forward_as_tuple(std::move(const_cast<_Key &>(__src->first))),
+            std::forward_as_tuple(std::move(__src->second)));
+        std::destroy_at(__src);
+    }
+};
+
+template <class _Tp>
+struct _SwissTableIterator {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::remove_const_t<_Tp>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = _Tp *;
+    using reference = _Tp &;
+
+    const _SwissCtrl *_M_ctrl = nullptr;
+    _Tp *_M_slot = nullptr;
+
+    _SwissTableIterator() noexcept = default;
+
+    _SwissTableIterator(const _SwissCtrl *__ctrl, _Tp *__slot) noexcept
+        : _M_ctrl(__ctrl),
+          _M_slot(__slot) {}
+
+    template <class _Up, class = std::enable_if_t<
+                             std::is_same_v<const _Up, _Tp> &&
+                             !std::is_same_v<_Up, _Tp>>>
+    _SwissTableIterator(const _SwissTableIterator<_Up> &__that) noexcept
+        : _M_ctrl(__that._M_ctrl),
+          _M_slot(__that._M_slot) {}
+
+    // 跳过空位和墓碑，停在下一个元素或者哨兵上
+    void _M_skip_empty() noexcept {
+        while (*_M_ctrl < _SwissSentinel) {
+            std::size_t __shift =
+                _SwissGroup(_M_ctrl)._M_count_leading_empty_or_deleted();
+            _M_ctrl += __shift;
+            _M_slot += __shift;
+        }
+    }
+
+    _SwissTableIterator &operator++() noexcept {
+        ++_M_ctrl;
+        ++_M_slot;
+        _M_skip_empty();
+        return *this;
+    }
+
+    _SwissTableIterator operator++(int) noexcept {
+        _SwissTableIterator __tmp = *this;
+        ++*this;
+        return __tmp;
+    }
+
+    _Tp &operator*() const noexcept {
+        return *_M_slot;
+    }
+
+    _Tp *operator->() const noexcept {
+        return _M_slot;
+    }
+
+    bool operator==(const _SwissTableIterator &__that) const noexcept {
+        return _M_ctrl == __that._M_ctrl;
+    }
+
+    bool operator!=(const _SwissTableIterator &__that) const noexcept {
+        return _M_ctrl != __that._M_ctrl;
+    }
+};
+
+template <class _Tp>
+struct _SwissSlotBuffer {
+    alignas(_Tp) unsigned char _M_buf[sizeof(_Tp)];
+
+    _Tp *_M_ptr() noexcept {
+        return reinterpret_cast<_Tp *>(_M_buf);
+    }
+};
+
+// _Tp 是迭代器看到的元素类型（set 为 const _Key），_KeyOf 从元素中取出键
+template <class _Tp, class _KeyOf, class _Hash, class _KeyEqual, class _Alloc>
+struct _SwissTableImpl {
+protected:
+    using _Slot = std::remove_const_t<_Tp>;
+    using _SlotAlloc =
+        typename std::allocator_traits<_Alloc>::template rebind_alloc<_Slot>;
+
+    static constexpr std::size_t _S_npos = std::size_t(-1);
+    static constexpr std::size_t _S_min_capacity = _SwissGroup::_S_width - 1;
+
+    _SwissCtrl *_M_ctrl = nullptr;
+    _Slot *_M_slots = nullptr;
+    std::size_t _M_cap = 0;
+    std::size_t _M_size = 0;
+    std::size_t _M_growth_left = 0; // 触发扩容前还能占用的空位数（墓碑不计）
+    [[no_unique_address]] _Hash _M_hash;
+    [[no_unique_address]] _KeyEqual _M_eq;
+    [[no_unique_address]] _SlotAlloc _M_alloc;
+
+public:
+    using iterator = _SwissTableIterator<_Tp>;
+    using const_iterator = _SwissTableIterator<const _Tp>;
+    using size_type = std::size_t;
+
+    _SwissTableImpl() noexcept = default;
+
+    explicit _SwissTableImpl(std::size_t __bucket_count,
+                             const _Hash &__hash = _Hash(),
+                             const _KeyEqual &__eq = _KeyEqual(),
+                             const _Alloc &__alloc = _Alloc())
+        : _M_hash(__hash),
+          _M_eq(__eq),
+          _M_alloc(__alloc) {
+        if (__bucket_count != 0) {
+            _M_resize(_S_normalize_capacity(__bucket_count));
+        }
+    }
+
+    _SwissTableImpl(_SwissTableImpl &&__that) noexcept
+        : _M_ctrl(__that._M_ctrl),
+          _M_slots(__that._M_slots),
+          _M_cap(__that._M_cap),
+          _M_size(__that._M_size),
+          _M_growth_left(__that._M_growth_left),
+          _M_hash(std::move(__that._M_hash)),
+          _M_eq(std::move(__that._M_eq)),
+          _M_alloc(std::move(__that._M_alloc)) {
+        __that._M_reset();
+    }
+
+    _SwissTableImpl &operator=(_SwissTableImpl &&__that) noexcept {
+        if (&__that != this) [[likely]] {
+            _M_destroy();
+            _M_ctrl = __that._M_ctrl;
+            _M_slots = __that._M_slots;
+            _M_cap = __that._M_cap;
+            _M_size = __that._M_size;
+            _M_growth_left = __that._M_growth_left;
+            _M_hash = std::move(__that._M_hash);
+            _M_eq = std::move(__that._M_eq);
+            _M_alloc = std::move(__that._M_alloc);
+            __that._M_reset();
+        }
+        return *this;
+    }
+
+    _SwissTableImpl(const _SwissTableImpl &__that)
+        : _M_hash(__that._M_hash),
+          _M_eq(__that._M_eq),
+          _M_alloc(__that._M_alloc) {
+        _M_copy_from(__that);
+    }
+
+    _SwissTableImpl &operator=(const _SwissTableImpl &__that) {
+        if (&__that != this) [[likely]] {
+            clear();
+            _M_hash = __that._M_hash;
+            _M_eq = __that._M_eq;
+            _M_copy_from(__that);
+        }
+        return *this;
+    }
+
+    ~_SwissTableImpl() noexcept {
+        _M_destroy();
+    }
+
+    iterator begin() noexcept {
+        if (_M_size == 0) {
+            return end();
+        }
+        iterator __it(_M_ctrl, _M_slots);
+        __it._M_skip_empty();
+        return __it;
+    }
+
+    iterator end() noexcept {
+        return iterator(_M_ctrl + _M_cap, _M_slots + _M_cap);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_cast<_SwissTableImpl *>(this)->begin();
+    }
+
+    const_iterator end() const noexcept {
+        return const_cast<_SwissTableImpl *>(this)->end();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    bool empty() const noexcept {
+        return _M_size == 0;
+    }
+
+    std::size_t size() const noexcept {
+        return _M_size;
+    }
+
+    static constexpr std::size_t max_size() noexcept {
+        return std::numeric_limits<std::ptrdiff_t>::max() / sizeof(_Slot);
+    }
+
+    // 每个槽位就是一个“桶”
+    std::size_t bucket_count() const noexcept {
+        return _M_cap;
+    }
+
+    float load_factor() const noexcept {
+        return _M_cap ? static_cast<float>(_M_size) / static_cast<float>(_M_cap)
+                      : 0.0f;
+    }
+
+    // 固定为 7/8，超过就扩容
+    float max_load_factor() const noexcept {
+        return 0.875f;
+    }
+
+    _Hash hash_function() const {
+        return _M_hash;
+    }
+
+    _KeyEqual key_eq() const {
+        return _M_eq;
+    }
+
+    _Alloc get_allocator() const noexcept {
+        return _Alloc(_M_alloc);
+    }
+
+    void clear() noexcept {
+        if (_M_cap == 0) {
+            return;
+        }
+        _M_destroy_slots();
+        _M_reset_ctrl();
+        _M_size = 0;
+        _M_growth_left = _S_growth_limit(_M_cap);
+    }
+
+    // 保证插入到 __n 个元素之前都不会扩容
+    void reserve(std::size_t __n) {
+        std::size_t __cap = _S_capacity_for(__n);
+        if (__cap > _M_cap) {
+            _M_resize(__cap);
+        }
+    }
+
+    // 重建为至少 __n 个桶的表，同时清掉所有墓碑；__n 为 0 时收缩到刚好够用
+    void rehash(std::size_t __n) {
+        if (__n == 0 && _M_size == 0) {
+            _M_destroy();
+            _M_reset();
+            return;
+        }
+        _M_resize(std::max(_S_normalize_capacity(__n),
+                           _S_capacity_for(_M_size)));
+    }
+
+    void swap(_SwissTableImpl &__that) noexcept {
+        std::swap(_M_ctrl, __that._M_ctrl);
+        std::swap(_M_slots, __that._M_slots);
+        std::swap(_M_cap, __that._M_cap);
+        std::swap(_M_size, __that._M_size);
+        std::swap(_M_growth_left, __that._M_growth_left);
+        std::swap(_M_hash, __that._M_hash);
+        std::swap(_M_eq, __that._M_eq);
+        std::swap(_M_alloc, __that._M_alloc);
+    }
+
+    iterator erase(const_iterator __it) noexcept {
+        std::size_t __idx = static_cast<std::size_t>(
+            const_cast<_Slot *>(__it._M_slot) - _M_slots);
+        _M_erase_at(__idx);
+        iterator __next = _M_iterator_at(__idx);
+        __next._M_skip_empty();
+        return __next;
+    }
+
+    iterator erase(const_iterator __first, const_iterator __last) noexcept {
+        while (__first != __last) {
+            __first = erase(__first);
+        }
+        return _M_iterator_at(static_cast<std::size_t>(
+            const_cast<_Slot *>(__last._M_slot) - _M_slots));
+    }
+
+protected:
+    // 把 std::hash 之类质量一般的哈希值打散：高位用于定位分组，低 7 位作为 H2
+    static std::size_t _S_mix(std::size_t __h) noexcept {
+#if defined(__SIZEOF_INT128__)
+        __uint128_t __m =
+            static_cast<__uint128_t>(__h) * 0x9e3779b97f4a7c15ull;
+        return static_cast<std::size_t>(__m ^ (__m >> 64));
+#else
+        std::uint64_t __x = __h;
+        __x ^= __x >> 33;
+        __x *= 0xff51afd7ed558ccdull;
+        __x ^= __x >> 33;
+        return static_cast<std::size_t>(__x);
+#endif
+    }
+
+    // 混入表地址，避免按一张表的遍历顺序插入另一张表时探测序列扎堆
+    static std::size_t _S_h1(std::size_t __h, const _SwissCtrl *__ctrl) noexcept {
+        return (__h >> 7) ^ (reinterpret_cast<std::uintptr_t>(__ctrl) >> 12);
+    }
+
+    static _SwissCtrl _S_h2(std::size_t __h) noexcept {
+        return static_cast<_SwissCtrl>(__h & 0x7f);
+    }
+
+    static bool _S_is_full(_SwissCtrl __ctrl) noexcept {
+        return __ctrl >= 0;
+    }
+
+    // 最多能放 cap * 7/8 个元素
+    static std::size_t _S_growth_limit(std::size_t __cap) noexcept {
+        return __cap - __cap / 8;
+    }
+
+    static std::size_t _S_normalize_capacity(std::size_t __n) noexcept {
+        return std::max(std::bit_ceil(__n + 1) - 1, _S_min_capacity);
+    }
+
+    static std::size_t _S_capacity_for(std::size_t __n) noexcept {
+        std::size_t __cap = _S_min_capacity;
+        while (_S_growth_limit(__cap) < __n) {
+            __cap = __cap * 2 + 1;
+        }
+        return __cap;
+    }
+
+    // 槽位和控制字节一起分配，按 _Slot 的个数计
+    static std::size_t _S_alloc_count(std::size_t __cap) noexcept {
+        return __cap + (__cap + _SwissGroup::_S_width + sizeof(_Slot) - 1) /
+                           sizeof(_Slot);
+    }
+
+    // 写控制字节，前 15 个同时写到哨兵后面的副本里
+    static void _S_set_ctrl(_SwissCtrl *__ctrl, std::size_t __cap,
+                            std::size_t __idx, _SwissCtrl __value) noexcept {
+        constexpr std::size_t __cloned = _SwissGroup::_S_width - 1;
+        __ctrl[__idx] = __value;
+        __ctrl[((__idx - __cloned) & __cap) + __cloned] = __value;
+    }
+
+    static void _S_transfer(_Slot *__dst, _Slot *__src) noexcept {
+        if constexpr (is_trivially_relocatable_v<_Slot>) {
+            std::memcpy(static_cast<void *>(__dst),
+                        static_cast<const void *>(__src), sizeof(_Slot));
+        } else {
+            _KeyOf::_S_relocate(__dst, __src);
+        }
+    }
+
+    // 三角探测：依次检查相隔 16, 32, 48, ... 的分组，能走遍 2^k 个分组
+    static std::size_t _S_find_first_non_full(const _SwissCtrl *__ctrl,
+                                              std::size_t __cap,
+                                              std::size_t __h) noexcept {
+        std::size_t __pos = _S_h1(__h, __ctrl) & __cap;
+        std::size_t __step = 0;
+        while (true) {
+            _SwissBitMask __mask =
+                _SwissGroup(__ctrl + __pos)._M_match_empty_or_deleted();
+            if (__mask) [[likely]] {
+                return (__pos + __mask._M_lowest()) & __cap;
+            }
+            __step += _SwissGroup::_S_width;
+            __pos = (__pos + __step) & __cap;
+        }
+    }
+
+    template <class _Kv>
+    std::size_t _M_hash_of(const _Kv &__key) const {
+        return _S_mix(static_cast<std::size_t>(_M_hash(__key)));
+    }
+
+    template <class _Kv>
+    std::size_t _M_find_index(const _Kv &__key, std::size_t __h) const {
+        if (_M_cap == 0) [[unlikely]] {
+            return _S_npos;
+        }
+        _SwissCtrl __h2 = _S_h2(__h);
+        std::size_t __pos = _S_h1(__h, _M_ctrl) & _M_cap;
+        std::size_t __step = 0;
+        while (true) {
+            _SwissGroup __group(_M_ctrl + __pos);
+            for (unsigned __i: __group._M_match(__h2)) {
+                std::size_t __idx = (__pos + __i) & _M_cap;
+                if (_M_eq(__key, _KeyOf()(_M_slots[__idx]))) [[likely]] {
+                    return __idx;
+                }
+            }
+            if (__group._M_match_empty()) [[likely]] {
+                return _S_npos;
+            }
+            __step += _SwissGroup::_S_width;
+            __pos = (__pos + __step) & _M_cap;
+        }
+    }
+
+    iterator _M_iterator_at(std::size_t __idx) noexcept {
+        return iterator(_M_ctrl + __idx, _M_slots + __idx);
+    }
+
+    template <class _Kv>
+    iterator _M_find(const _Kv &__key) {
+        std::size_t __idx = _M_find_index(__key, _M_hash_of(__key));
+        return __idx == _S_npos ? end() : _M_iterator_at(__idx);
+    }
+
+    template <class _Kv>
+    const_iterator _M_find(const _Kv &__key) const {
+        return const_cast<_SwissTableImpl *>(this)->_M_find(__key);
+    }
+
+    template <class _Kv>
+    bool _M_contains(const _Kv &__key) const {
+        return _M_find_index(__key, _M_hash_of(__key)) != _S_npos;
+    }
+
+    // 键不存在时才用 __args 构造新元素
+    template <class _Kv, class... _Args>
+    std::pair<iterator, bool> _M_try_emplace_key(const _Kv &__key,
+                                                 _Args &&...__args) {
+        std::size_t __h = _M_hash_of(__key);
+        std::size_t __idx = _M_find_index(__key, __h);
+        if (__idx != _S_npos) {
+            return {_M_iterator_at(__idx), false};
+        }
+        if (_M_growth_left == 0) [[unlikely]] {
+            // 扩容会搬动元素，而 __args 可能引用表内的元素，所以先在栈上构造
+            _SwissSlotBuffer<_Slot> __tmp;
+            std::construct_at(__tmp._M_ptr(), std::forward<_Args>(__args)...);
+            return {_M_insert_relocated(__h, __tmp._M_ptr()), true};
+        }
+        __idx = _S_find_first_non_full(_M_ctrl, _M_cap, __h);
+        std::construct_at(_M_slots + __idx, std::forward<_Args>(__args)...);
+        _M_commit_insert(__idx, __h);
+        return {_M_iterator_at(__idx), true};
+    }
+
+    // 键要等构造出元素之后才知道
+    template <class... _Args>
+    std::pair<iterator, bool> _M_emplace(_Args &&...__args) {
+        _SwissSlotBuffer<_Slot> __tmp;
+        _Slot *__value = std::construct_at(__tmp._M_ptr(),
+                                           std::forward<_Args>(__args)...);
+        std::size_t __h;
+        std::size_t __idx;
+        try {
+            __h = _M_hash_of(_KeyOf()(*__value));
+            __idx = _M_find_index(_KeyOf()(*__value), __h);
+        } catch (...) {
+            std::destroy_at(__value);
+            throw;
+        }
+        if (__idx != _S_npos) {
+            std::destroy_at(__value);
+            return {_M_iterator_at(__idx), false};
+        }
+        return {_M_insert_relocated(__h, __value), true};
+    }
+
+    // 把已经构造好、确定不在表中的 *__value 搬进表里
+    iterator _M_insert_relocated(std::size_t __h, _Slot *__value) {
+        if (_M_growth_left == 0) [[unlikely]] {
+            try {
+                _M_rehash_for_insert();
+            } catch (...) {
+                std::destroy_at(__value);
+                throw;
+            }
+        }
+        std::size_t __idx = _S_find_first_non_full(_M_ctrl, _M_cap, __h);
+        _S_transfer(_M_slots + __idx, __value);
+        _M_commit_insert(__idx, __h);
+        return _M_iterator_at(__idx);
+    }
+
+    void _M_commit_insert(std::size_t __idx, std::size_t __h) noexcept {
+        _M_growth_left -= _M_ctrl[__idx] == _SwissEmpty;
+        _S_set_ctrl(_M_ctrl, _M_cap, __idx, _S_h2(__h));
+        ++_M_size;
+    }
+
+    // 批量插入：能预先知道个数时只扩容一次
+    template <class _InputIt>
+    void _M_insert_range(_InputIt __first, _InputIt __last) {
+        if constexpr (std::is_base_of_v<
+                          std::forward_iterator_tag,
+                          typename std::iterator_traits<
+                              _InputIt>::iterator_category>) {
+            reserve(_M_size +
+                    static_cast<std::size_t>(std::distance(__first, __last)));
+        }
+        for (; __first != __last; ++__first) {
+            _M_emplace(*__first);
+        }
+    }
+
+    template <class _Kv>
+    std::size_t _M_erase_key(const _Kv &__key) {
+        std::size_t __idx = _M_find_index(__key, _M_hash_of(__key));
+        if (__idx == _S_npos) {
+            return 0;
+        }
+        _M_erase_at(__idx);
+        return 1;
+    }
+
+    void _M_erase_at(std::size_t __idx) noexcept {
+        std::destroy_at(_M_slots + __idx);
+        --_M_size;
+        // 如果这个位置前后加起来不足 16 个连续的非空位置，那么任何探测序列
+        // 都会在同一个分组里先看到空位，不会越过它，可以直接置为空位
+        std::size_t __before = (__idx - _SwissGroup::_S_width) & _M_cap;
+        _SwissBitMask __empty_after =
+            _SwissGroup(_M_ctrl + __idx)._M_match_empty();
+        _SwissBitMask __empty_before =
+            _SwissGroup(_M_ctrl + __before)._M_match_empty();
+        bool __was_never_full = __empty_before && __empty_after &&
+                                __empty_after._M_lowest() +
+                                        __empty_before._M_leading_zeros() <
+                                    _SwissGroup::_S_width;
+        _S_set_ctrl(_M_ctrl, _M_cap, __idx,
+                    __was_never_full ? _SwissEmpty : _SwissDeleted);
+        _M_growth_left += __was_never_full;
+    }
+
+    // 没有空位可用了：墓碑很多时原地大小重建，否则容量翻倍
+    void _M_rehash_for_insert() {
+        if (_M_cap > _S_min_capacity && _M_size * 32 <= _M_cap * 25) {
+            _M_resize(_M_cap);
+        } else {
+            _M_resize(_M_cap ? _M_cap * 2 + 1 : _S_min_capacity);
+        }
+    }
+
+    void _M_resize(std::size_t __new_cap) {
+        _SwissCtrl *__old_ctrl = _M_ctrl;
+        _Slot *__old_slots = _M_slots;
+        std::size_t __old_cap = _M_cap;
+
+        _M_slots = _M_alloc.allocate(_S_alloc_count(__new_cap));
+        _M_ctrl = reinterpret_cast<_SwissCtrl *>(_M_slots + __new_cap);
+        _M_cap = __new_cap;
+        _M_reset_ctrl();
+        _M_growth_left = _S_growth_limit(__new_cap) - _M_size;
+
+        for (std::size_t __i = 0; __i != __old_cap; ++__i) {
+            if (_S_is_full(__old_ctrl[__i])) {
+                std::size_t __h = _M_hash_of(_KeyOf()(__old_slots[__i]));
+                std::size_t __idx =
+                    _S_find_first_non_full(_M_ctrl, _M_cap, __h);
+                _S_set_ctrl(_M_ctrl, _M_cap, __idx, _S_h2(__h));
+                _S_transfer(_M_slots + __idx, __old_slots + __i);
+            }
+        }
+        if (__old_cap != 0) {
+            _M_alloc.deallocate(__old_slots, _S_alloc_count(__old_cap));
+        }
+    }
+
+    void _M_reset_ctrl() noexcept {
+        std::memset(_M_ctrl, static_cast<unsigned char>(_SwissEmpty),
+                    _M_cap + _SwissGroup::_S_width);
+        _M_ctrl[_M_cap] = _SwissSentinel;
+    }
+
+    void _M_copy_from(const _SwissTableImpl &__that) {
+        reserve(__that._M_size);
+        for (std::size_t __i = 0; __i != __that._M_cap; ++__i) {
+            if (_S_is_full(__that._M_ctrl[__i])) {
+                const _Slot &__value = __that._M_slots[__i];
+                std::size_t __h = _M_hash_of(_KeyOf()(__value));
+                std::size_t __idx =
+                    _S_find_first_non_full(_M_ctrl, _M_cap, __h);
+                std::construct_at(_M_slots + __idx, __value);
+                _M_commit_insert(__idx, __h);
+            }
+        }
+    }
+
+    void _M_destroy_slots() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<_Slot>) {
+            for (std::size_t __i = 0; __i != _M_cap; ++__i) {
+                if (_S_is_full(_M_ctrl[__i])) {
+                    std::destroy_at(_M_slots + __i);
+                }
+            }
+        }
+    }
+
+    void _M_destroy() noexcept {
+        if (_M_cap != 0) {
+            _M_destroy_slots();
+            _M_alloc.deallocate(_M_slots, _S_alloc_count(_M_cap));
+        }
+    }
+
+    void _M_reset() noexcept {
+        _M_ctrl = nullptr;
+        _M_slots = nullptr;
+        _M_cap = 0;
+        _M_size = 0;
+        _M_growth_left = 0;
+    }
+
+    // 两张表元素相同（与插入顺序无关）
+    bool _M_equal(const _SwissTableImpl &__that) const {
+        if (_M_size != __that._M_size) {
+            return false;
+        }
+        for (const _Tp &__value: *this) {
+            const_iterator __it = __that._M_find(_KeyOf()(__value));
+            if (__it == __that.end() || !(*__it == __value)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace Marcus
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <core/_relocate.hpp>
 #include <cstddef>
 #include <initializer_list>
 #include <iterator>
@@ -393,6 +394,30 @@ private:
         _start._current = _start._first;
     }
 
+    // 元素已被重定位走（或从未构造）：只释放多余的块，不调用析构
+    void _forget_elements() noexcept {
+        for (pointer *__node = _start._node + 1; __node <= _finish._node;
+             ++__node) {
+            _deallocate_block(*__node);
+        }
+        _finish = _start;
+    }
+
+    // 把 [__first, __last) 搬到未初始化的 __dest，按两边块内的连续段整体复制
+    static iterator _relocate_segments(iterator __first, iterator __last,
+                                       iterator __dest) noexcept {
+        while (__first != __last) {
+            const difference_type __n =
+                std::min({__last - __first, __first._last - __first._current,
+                          __dest._last - __dest._current});
+            _uninitialized_relocate(__first._current, __first._current + __n,
+                                    __dest._current);
+            __first += __n;
+            __dest += __n;
+        }
+        return __dest;
+    }
+
     size_type _capacity_front() const noexcept {
         if (!_map) {
             return 0;
@@ -907,13 +932,27 @@ public:
         deque __tmp(get_allocator());
         __tmp._create_map_and_nodes(__old_size + __count);
 
-        auto __dest = std::uninitialized_move(
-            std::make_move_iterator(begin()),
-            std::make_move_iterator(_get_iterator(__pos)), __tmp.begin());
-        std::uninitialized_fill_n(__dest, __count, __value);
-        std::uninitialized_move(std::make_move_iterator(_get_iterator(__pos)),
-                                std::make_move_iterator(end()),
-                                __tmp.begin() + __offset + __count);
+        if constexpr (is_trivially_relocatable_v<_Tp>) {
+            iterator __mid = __tmp.begin() + __offset;
+            try {
+                std::uninitialized_fill_n(__mid, __count, __value);
+            } catch (...) {
+                __tmp._forget_elements();
+                throw;
+            }
+            _relocate_segments(begin(), _get_iterator(__pos), __tmp.begin());
+            _relocate_segments(_get_iterator(__pos), end(), __mid + __count);
+            _forget_elements();
+        } else {
+            auto __dest = std::uninitialized_move(
+                std::make_move_iterator(begin()),
+                std::make_move_iterator(_get_iterator(__pos)), __tmp.begin());
+            std::uninitialized_fill_n(__dest, __count, __value);
+            std::uninitialized_move(
+                std::make_move_iterator(_get_iterator(__pos)),
+                std::make_move_iterator(end()),
+                __tmp.begin() + __offset + __count);
+        }
         this->swap(__tmp);
         return begin() + __offset;
     }
@@ -943,14 +982,30 @@ public:
             deque __tmp(get_allocator());
             __tmp._create_map_and_nodes(__old_size + __count);
 
-            auto __dest = std::uninitialized_move(
-                std::make_move_iterator(begin()),
-                std::make_move_iterator(_get_iterator(__pos)), __tmp.begin());
-            std::uninitialized_copy(__first, __last, __dest);
-            std::uninitialized_move(
-                std::make_move_iterator(_get_iterator(__pos)),
-                std::make_move_iterator(end()),
-                __tmp.begin() + __offset + __count);
+            if constexpr (is_trivially_relocatable_v<_Tp>) {
+                iterator __mid = __tmp.begin() + __offset;
+                try {
+                    std::uninitialized_copy(__first, __last, __mid);
+                } catch (...) {
+                    __tmp._forget_elements();
+                    throw;
+                }
+                _relocate_segments(begin(), _get_iterator(__pos),
+                                   __tmp.begin());
+                _relocate_segments(_get_iterator(__pos), end(),
+                                   __mid + __count);
+                _forget_elements();
+            } else {
+                auto __dest = std::uninitialized_move(
+                    std::make_move_iterator(begin()),
+                    std::make_move_iterator(_get_iterator(__pos)),
+                    __tmp.begin());
+                std::uninitialized_copy(__first, __last, __dest);
+                std::uninitialized_move(
+                    std::make_move_iterator(_get_iterator(__pos)),
+                    std::make_move_iterator(end()),
+                    __tmp.begin() + __offset + __count);
+            }
 
             this->swap(__tmp);
             return begin() + __offset;
@@ -0,0 +1,864 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <containers/vector.hpp>
+#include <core/_common.hpp>
+#include <core/_sorted_tag.hpp>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace Marcus {
+
+// 同时遍历键数组和值数组的迭代器，解引用得到 pair<const _Key &, _Mapped &>。
+// _Mapped 带 const 时是 const_iterator。
+template <class _Key, class _Mapped>
+struct _FlatMapIterator {
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::pair<_Key, std::remove_const_t<_Mapped>>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const _Key &, _Mapped &>;
+
+    // operator-> 返回的代理，reference 本身是临时对象
+    struct pointer {
+        reference _M_ref;
+
+        reference *operator->() noexcept {
+            return std::addressof(_M_ref);
+        }
+    };
+
+    const _Key *_M_key = nullptr;
+    _Mapped *_M_mapped = nullptr;
+
+    _FlatMapIterator() = default;
+
+    _FlatMapIterator(const _Key *__key, _Mapped *__mapped) noexcept
+        : _M_key(__key),
+          _M_mapped(__mapped) {}
+
+    template <class _Mp, std::enable_if_t<std::is_same_v<const _Mp, _Mapped> &&
+                                              !std::is_same_v<_Mp, _Mapped>,
+                                          int> = 0>
+    _FlatMapIterator(const _FlatMapIterator<_Key, _Mp> &__that) noexcept
+        : _M_key(__that._M_key),
+          _M_mapped(__that._M_mapped) {}
+
+    reference operator*() const noexcept {
+        return {*_M_key, *_M_mapped};
+    }
+
+    pointer operator->() const noexcept {
+        return pointer{**this};
+    }
+
+    reference operator[](difference_type __n) const noexcept {
+        return {_M_key[__n], _M_mapped[__n]};
+    }
+
+    _FlatMapIterator &operator++() noexcept {
+        ++_M_key;
+        ++_M_mapped;
+        return *this;
+    }
+
+    _FlatMapIterator operator++(int) noexcept {
+        _FlatMapIterator __tmp = *this;
+        ++*this;
+        return __tmp;
+    }
+
+    _FlatMapIterator &operator--() noexcept {
+        --_M_key;
+        --_M_mapped;
+        return *this;
+    }
+
+    _FlatMapIterator operator--(int) noexcept {
+        _FlatMapIterator __tmp = *this;
+        --*this;
+        return __tmp;
+    }
+
+    _FlatMapIterator &operator+=(difference_type __n) noexcept {
+        _M_key += __n;
+        _M_mapped += __n;
+        return *this;
+    }
+
+    _FlatMapIterator &operator-=(difference_type __n) noexcept {
+        _M_key -= __n;
+        _M_mapped -= __n;
+        return *this;
+    }
+
+    _FlatMapIterator operator+(difference_type __n) const noexcept {
+        return _FlatMapIterator(_M_key + __n, _M_mapped + __n);
+    }
+
+    friend _FlatMapIterator operator+(difference_type __n,
+                                      const _FlatMapIterator &__it) noexcept {
+        return __it + __n;
+    }
+
+    _FlatMapIterator operator-(difference_type __n) const noexcept {
+        return _FlatMapIterator(_M_key - __n, _M_mapped - __n);
+    }
+
+    difference_type operator-(const _FlatMapIterator &__that) const noexcept {
+        return _M_key - __that._M_key;
+    }
+
+    bool operator==(const _FlatMapIterator &__that) const noexcept {
+        return _M_key == __that._M_key;
+    }
+
+    std::strong_ordering
+    operator<=>(const _FlatMapIterator &__that) const noexcept {
+        return _M_key <=> __that._M_key;
+    }
+};
+
+// flat_map / flat_multimap 的公共实现：键和值分别存放在两个连续容器里，
+// 键数组始终有序，两个数组下标一一对应。
+// 查找是在键数组上二分，插入和删除是 O(n) 的搬移。
+// _KeyCont 和 _MappedCont 必须是连续存储的序列容器（比如 Marcus::vector）。
+template <class _Key, class _Mapped, class _Compare, class _KeyCont,
+          class _MappedCont>
+struct _FlatMapImpl {
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<_Key, _Mapped>;
+    using key_compare = _Compare;
+    using reference = std::pair<const _Key &, _Mapped &>;
+    using const_reference = std::pair<const _Key &, const _Mapped &>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using iterator = _FlatMapIterator<_Key, _Mapped>;
+    using const_iterator = _FlatMapIterator<_Key, const _Mapped>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using key_container_type = _KeyCont;
+    using mapped_container_type = _MappedCont;
+
+    struct containers {
+        _KeyCont keys;
+        _MappedCont values;
+    };
+
+protected:
+    _KeyCont _M_keys;
+    _MappedCont _M_values;
+    [[no_unique_address]] _Compare _M_comp;
+
+    _FlatMapImpl() = default;
+
+    explicit _FlatMapImpl(_Compare __comp) : _M_comp(__comp) {}
+
+public:
+    iterator begin() noexcept {
+        return _M_make_iter(0);
+    }
+
+    iterator end() noexcept {
+        return _M_make_iter(size());
+    }
+
+    const_iterator begin() const noexcept {
+        return _M_make_iter(0);
+    }
+
+    const_iterator end() const noexcept {
+        return _M_make_iter(size());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    bool empty() const noexcept {
+        return _M_keys.empty();
+    }
+
+    size_type size() const noexcept {
+        return _M_keys.size();
+    }
+
+    void clear() noexcept {
+        _M_keys.clear();
+        _M_values.clear();
+    }
+
+    void reserve(size_type __n) {
+        _M_keys.reserve(__n);
+        _M_values.reserve(__n);
+    }
+
+    void shrink_to_fit() {
+        _M_keys.shrink_to_fit();
+        _M_values.shrink_to_fit();
+    }
+
+    const _KeyCont &keys() const noexcept {
+        return _M_keys;
+    }
+
+    const _MappedCont &values() const noexcept {
+        return _M_values;
+    }
+
+    // 取走底层的两个数组，容器变为空
+    containers extract() && {
+        containers __result{std::move(_M_keys), std::move(_M_values)};
+        clear();
+        return __result;
+    }
+
+    // 直接换上两个数组，调用者保证键已经有序（multimap）或有序且唯一（map）
+    void replace(_KeyCont &&__keys, _MappedCont &&__values) {
+        assert(__keys.size() == __values.size());
+        _M_keys = std::move(__keys);
+        _M_values = std::move(__values);
+    }
+
+    _Compare key_comp() const noexcept {
+        return _M_comp;
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    iterator lower_bound(const _Kv &__key) noexcept {
+        return _M_make_iter(_M_lower_index(__key));
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const_iterator lower_bound(const _Kv &__key) const noexcept {
+        return _M_make_iter(_M_lower_index(__key));
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    iterator upper_bound(const _Kv &__key) noexcept {
+        return _M_make_iter(_M_upper_index(__key));
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const_iterator upper_bound(const _Kv &__key) const noexcept {
+        return _M_make_iter(_M_upper_index(__key));
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    std::pair<iterator, iterator> equal_range(const _Kv &__key) noexcept {
+        return {lower_bound(__key), upper_bound(__key)};
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    std::pair<const_iterator, const_iterator>
+    equal_range(const _Kv &__key) const noexcept {
+        return {lower_bound(__key), upper_bound(__key)};
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    iterator find(const _Kv &__key) noexcept {
+        return _M_make_iter(_M_find_index(__key));
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const_iterator find(const _Kv &__key) const noexcept {
+        return _M_make_iter(_M_find_index(__key));
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    bool contains(const _Kv &__key) const noexcept {
+        return _M_find_index(__key) != size();
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    size_type count(const _Kv &__key) const noexcept {
+        return _M_upper_index(__key) - _M_lower_index(__key);
+    }
+
+    iterator lower_bound(const _Key &__key) noexcept {
+        return _M_make_iter(_M_lower_index(__key));
+    }
+
+    const_iterator lower_bound(const _Key &__key) const noexcept {
+        return _M_make_iter(_M_lower_index(__key));
+    }
+
+    iterator upper_bound(const _Key &__key) noexcept {
+        return _M_make_iter(_M_upper_index(__key));
+    }
+
+    const_iterator upper_bound(const _Key &__key) const noexcept {
+        return _M_make_iter(_M_upper_index(__key));
+    }
+
+    std::pair<iterator, iterator> equal_range(const _Key &__key) noexcept {
+        return {lower_bound(__key), upper_bound(__key)};
+    }
+
+    std::pair<const_iterator, const_iterator>
+    equal_range(const _Key &__key) const noexcept {
+        return {lower_bound(__key), upper_bound(__key)};
+    }
+
+    iterator find(const _Key &__key) noexcept {
+        return _M_make_iter(_M_find_index(__key));
+    }
+
+    const_iterator find(const _Key &__key) const noexcept {
+        return _M_make_iter(_M_find_index(__key));
+    }
+
+    bool contains(const _Key &__key) const noexcept {
+        return _M_find_index(__key) != size();
+    }
+
+    size_type count(const _Key &__key) const noexcept {
+        return _M_upper_index(__key) - _M_lower_index(__key);
+    }
+
+    iterator erase(const_iterator __it) {
+        size_type __i = __it._M_key - _M_keys.data();
+        _M_keys.erase(_M_keys.begin() + __i);
+        _M_values.erase(_M_values.begin() + __i);
+        return _M_make_iter(__i);
+    }
+
+    iterator erase(iterator __it) {
+        return erase(const_iterator(__it));
+    }
+
+    iterator erase(const_iterator __first, const_iterator __last) {
+        size_type __i = __first._M_key - _M_keys.data();
+        size_type __j = __last._M_key - _M_keys.data();
+        _M_keys.erase(_M_keys.begin() + __i, _M_keys.begin() + __j);
+        _M_values.erase(_M_values.begin() + __i, _M_values.begin() + __j);
+        return _M_make_iter(__i);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    size_type erase(const _Kv &__key) {
+        return _M_erase_key(__key);
+    }
+
+    size_type erase(const _Key &__key) {
+        return _M_erase_key(__key);
+    }
+
+    void swap(_FlatMapImpl &__that) noexcept {
+        using std::swap;
+        swap(_M_keys, __that._M_keys);
+        swap(_M_values, __that._M_values);
+        swap(_M_comp, __that._M_comp);
+    }
+
+protected:
+    iterator _M_make_iter(size_type __i) noexcept {
+        return iterator(_M_keys.data() + __i, _M_values.data() + __i);
+    }
+
+    const_iterator _M_make_iter(size_type __i) const noexcept {
+        return const_iterator(_M_keys.data() + __i, _M_values.data() + __i);
+    }
+
+    template <class _Kv>
+    size_type _M_lower_index(const _Kv &__key) const noexcept {
+        return std::lower_bound(_M_keys.begin(), _M_keys.end(), __key,
+                                _M_comp) -
+               _M_keys.begin();
+    }
+
+    template <class _Kv>
+    size_type _M_upper_index(const _Kv &__key) const noexcept {
+        return std::upper_bound(_M_keys.begin(), _M_keys.end(), __key,
+                                _M_comp) -
+               _M_keys.begin();
+    }
+
+    template <class _Kv>
+    size_type _M_find_index(const _Kv &__key) const noexcept {
+        size_type __i = _M_lower_index(__key);
+        if (__i != size() && !_M_comp(__key, _M_keys[__i])) {
+            return __i;
+        }
+        return size();
+    }
+
+    template <class _Kv>
+    size_type _M_erase_key(const _Kv &__key) {
+        size_type __i = _M_lower_index(__key);
+        size_type __j = _M_upper_index(__key);
+        if (__i != __j) {
+            _M_keys.erase(_M_keys.begin() + __i, _M_keys.begin() + __j);
+            _M_values.erase(_M_values.begin() + __i, _M_values.begin() + __j);
+        }
+        return __j - __i;
+    }
+
+    // 在下标 __i 处插入，值构造失败时撤销键的插入
+    template <class _Kv, class... _Ms>
+    iterator _M_emplace_at(size_type __i, _Kv &&__key, _Ms &&...__mapped) {
+        _M_keys.emplace(_M_keys.begin() + __i, std::forward<_Kv>(__key));
+        try {
+            _M_values.emplace(_M_values.begin() + __i,
+                              std::forward<_Ms>(__mapped)...);
+        } catch (...) {
+            _M_keys.erase(_M_keys.begin() + __i);
+            throw;
+        }
+        return _M_make_iter(__i);
+    }
+
+    template <class _Kv, class... _Ms>
+    std::pair<iterator, bool> _M_try_emplace(_Kv &&__key, _Ms &&...__mapped) {
+        size_type __i = _M_lower_index(__key);
+        if (__i != size() && !_M_comp(__key, _M_keys[__i])) {
+            return {_M_make_iter(__i), false};
+        }
+        return {_M_emplace_at(__i, std::forward<_Kv>(__key),
+                              std::forward<_Ms>(__mapped)...),
+                true};
+    }
+
+    template <class... _Ts>
+    std::pair<iterator, bool> _M_single_emplace(_Ts &&...__value) {
+        value_type __tmp(std::forward<_Ts>(__value)...);
+        return _M_try_emplace(std::move(__tmp.first), std::move(__tmp.second));
+    }
+
+    template <class... _Ts>
+    iterator _M_multi_emplace(_Ts &&...__value) {
+        value_type __tmp(std::forward<_Ts>(__value)...);
+        return _M_emplace_at(_M_upper_index(__tmp.first),
+                             std::move(__tmp.first), std::move(__tmp.second));
+    }
+
+    // 批量插入：先把新元素收集到一个 pair 数组里排好序（_Unique 时去重），
+    // 再和已有的两个数组做一次线性归并。等价的键以已有元素为先，
+    // 新元素之间以输入顺序为先，和逐个 insert 的结果一致。
+    template <bool _Unique, class _InputIt>
+    void _M_insert_range(_InputIt __first, _InputIt __last,
+                         bool __sorted = false) {
+        vector<value_type> __tmp;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<
+                                            _InputIt>::iterator_category>) {
+            __tmp.reserve(std::distance(__first, __last));
+        }
+        for (; __first != __last; ++__first) {
+            __tmp.emplace_back(*__first);
+        }
+        _M_insert_sorted<_Unique>(__tmp, __sorted);
+    }
+
+    // 用两个（未排序的）数组构造
+    template <bool _Unique>
+    void _M_assign_containers(_KeyCont &&__keys, _MappedCont &&__values,
+                              bool __sorted) {
+        assert(__keys.size() == __values.size());
+        if (__sorted) {
+            replace(std::move(__keys), std::move(__values));
+            return;
+        }
+        vector<value_type> __tmp;
+        __tmp.reserve(__keys.size());
+        for (size_type __i = 0; __i != __keys.size(); ++__i) {
+            __tmp.emplace_back(std::move(__keys[__i]),
+                               std::move(__values[__i]));
+        }
+        clear();
+        _M_insert_sorted<_Unique>(__tmp, false);
+    }
+
+    template <bool _Unique>
+    void _M_insert_sorted(vector<value_type> &__tmp, bool __sorted) {
+        auto __key_less = [this](const value_type &__lhs,
+                                 const value_type &__rhs) {
+            return _M_comp(__lhs.first, __rhs.first);
+        };
+        if (!__sorted) {
+            std::stable_sort(__tmp.begin(), __tmp.end(), __key_less);
+        }
+        if constexpr (_Unique) {
+            auto __new_end = std::unique(
+                __tmp.begin(), __tmp.end(),
+                [this](const value_type &__lhs, const value_type &__rhs) {
+                    return !_M_comp(__lhs.first, __rhs.first);
+                });
+            __tmp.erase(__new_end, __tmp.end());
+        }
+        if (__tmp.empty()) {
+            return;
+        }
+        size_type __n = size();
+        // 新元素全部排在已有元素之后（包括原来为空）时直接追加
+        if (__n == 0 || _M_comp(_M_keys.back(), __tmp.front().first) ||
+            (!_Unique && !_M_comp(__tmp.front().first, _M_keys.back()))) {
+            _M_append(__tmp.begin(), __tmp.end());
+            return;
+        }
+        _KeyCont __keys;
+        _MappedCont __values;
+        __keys.reserve(__n + __tmp.size());
+        __values.reserve(__n + __tmp.size());
+        try {
+            size_type __i = 0;
+            auto __it = __tmp.begin();
+            while (__i != __n && __it != __tmp.end()) {
+                if (_M_comp(__it->first, _M_keys[__i])) {
+                    __keys.push_back(std::move(__it->first));
+                    __values.push_back(std::move(__it->second));
+                    ++__it;
+                } else if (_Unique && !_M_comp(_M_keys[__i], __it->first)) {
+                    ++__it; // 键已存在
+                } else {
+                    __keys.push_back(std::move(_M_keys[__i]));
+                    __values.push_back(std::move(_M_values[__i]));
+                    ++__i;
+                }
+            }
+            for (; __i != __n; ++__i) {
+                __keys.push_back(std::move(_M_keys[__i]));
+                __values.push_back(std::move(_M_values[__i]));
+            }
+            for (; __it != __tmp.end(); ++__it) {
+                __keys.push_back(std::move(__it->first));
+                __values.push_back(std::move(__it->second));
+            }
+        } catch (...) {
+            clear(); // 已有元素可能已经被移走了
+            throw;
+        }
+        _M_keys = std::move(__keys);
+        _M_values = std::move(__values);
+    }
+
+    template <class _It>
+    void _M_append(_It __first, _It __last) {
+        reserve(size() + (__last - __first));
+        try {
+            for (; __first != __last; ++__first) {
+                _M_keys.push_back(std::move(__first->first));
+                _M_values.push_back(std::move(__first->second));
+            }
+        } catch (...) {
+            if (_M_keys.size() != _M_values.size()) {
+                _M_keys.pop_back();
+            }
+            throw;
+        }
+    }
+};
+
+template <class _Key, class _Mapped, class _Compare = std::less<_Key>,
+          class _KeyCont = vector<_Key>, class _MappedCont = vector<_Mapped>>
+struct flat_map
+    : _FlatMapImpl<_Key, _Mapped, _Compare, _KeyCont, _MappedCont> {
+private:
+    using _Base = _FlatMapImpl<_Key, _Mapped, _Compare, _KeyCont, _MappedCont>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::iterator;
+    using typename _Base::size_type;
+    using typename _Base::value_type;
+
+    flat_map() = default;
+
+    explicit flat_map(_Compare __comp) : _Base(__comp) {}
+
+    // 从未排序的区间构造：排序并去重一次，重复的键保留第一个
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    flat_map(_InputIt __first, _InputIt __last, _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_insert_range<true>(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    flat_map(sorted_unique_t, _InputIt __first, _InputIt __last,
+             _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_insert_range<true>(__first, __last, true);
+    }
+
+    flat_map(std::initializer_list<value_type> __ilist,
+             _Compare __comp = _Compare())
+        : flat_map(__ilist.begin(), __ilist.end(), __comp) {}
+
+    flat_map(_KeyCont __keys, _MappedCont __values,
+             _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_containers<true>(std::move(__keys),
+                                                  std::move(__values), false);
+    }
+
+    flat_map(sorted_unique_t, _KeyCont __keys, _MappedCont __values,
+             _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_containers<true>(std::move(__keys),
+                                                  std::move(__values), true);
+    }
+
+    flat_map &operator=(std::initializer_list<value_type> __ilist) {
+        this->clear();
+        this->template _M_insert_range<true>(__ilist.begin(), __ilist.end());
+        return *this;
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const _Mapped &at(const _Kv &__key) const {
+        return this->_M_at(__key);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    _Mapped &at(const _Kv &__key) {
+        return const_cast<_Mapped &>(this->_M_at(__key));
+    }
+
+    const _Mapped &at(const _Key &__key) const {
+        return this->_M_at(__key);
+    }
+
+    _Mapped &at(const _Key &__key) {
+        return const_cast<_Mapped &>(this->_M_at(__key));
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    _Mapped &operator[](const _Kv &__key) {
+        return this->_M_try_emplace(__key).first->second;
+    }
+
+    _Mapped &operator[](const _Key &__key) {
+        return this->_M_try_emplace(__key).first->second;
+    }
+
+    _Mapped &operator[](_Key &&__key) {
+        return this->_M_try_emplace(std::move(__key)).first->second;
+    }
+
+    std::pair<iterator, bool> insert(const value_type &__value) {
+        return this->_M_try_emplace(__value.first, __value.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type &&__value) {
+        return this->_M_try_emplace(std::move(__value.first),
+                                    std::move(__value.second));
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->template _M_insert_range<true>(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(sorted_unique_t, _InputIt __first, _InputIt __last) {
+        this->template _M_insert_range<true>(__first, __last, true);
+    }
+
+    void insert(std::initializer_list<value_type> __ilist) {
+        this->template _M_insert_range<true>(__ilist.begin(), __ilist.end());
+    }
+
+    template <class _Mp,
+              typename = std::enable_if_t<std::is_assignable_v<_Mapped &, _Mp>>>
+    std::pair<iterator, bool> insert_or_assign(const _Key &__key,
+                                               _Mp &&__mapped) {
+        std::pair<iterator, bool> __result =
+            this->_M_try_emplace(__key, std::forward<_Mp>(__mapped));
+        if (!__result.second) {
+            __result.first->second = std::forward<_Mp>(__mapped);
+        }
+        return __result;
+    }
+
+    template <class _Mp,
+              typename = std::enable_if_t<std::is_assignable_v<_Mapped &, _Mp>>>
+    std::pair<iterator, bool> insert_or_assign(_Key &&__key, _Mp &&__mapped) {
+        std::pair<iterator, bool> __result =
+            this->_M_try_emplace(std::move(__key), std::forward<_Mp>(__mapped));
+        if (!__result.second) {
+            __result.first->second = std::forward<_Mp>(__mapped);
+        }
+        return __result;
+    }
+
+    template <class... _Ts>
+    std::pair<iterator, bool> emplace(_Ts &&...__value) {
+        return this->_M_single_emplace(std::forward<_Ts>(__value)...);
+    }
+
+    template <class... _Ms>
+    std::pair<iterator, bool> try_emplace(const _Key &__key, _Ms &&...__mapped) {
+        return this->_M_try_emplace(__key, std::forward<_Ms>(__mapped)...);
+    }
+
+    template <class... _Ms>
+    std::pair<iterator, bool> try_emplace(_Key &&__key, _Ms &&...__mapped) {
+        return this->_M_try_emplace(std::move(__key),
+                                    std::forward<_Ms>(__mapped)...);
+    }
+
+    template <class _Kv, class... _Ms,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    std::pair<iterator, bool> try_emplace(_Kv &&__key, _Ms &&...__mapped) {
+        return this->_M_try_emplace(std::forward<_Kv>(__key),
+                                    std::forward<_Ms>(__mapped)...);
+    }
+
+    _LIBPENGCXX_DEFINE_COMPARISON(flat_map);
+
+private:
+    template <class _Kv>
+    const _Mapped &_M_at(const _Kv &__key) const {
+        size_type __i = this->_M_find_index(__key);
+        if (__i == this->size()) [[unlikely]] {
+            throw std::out_of_range("flat_map::at");
+        }
+        return this->_M_values[__i];
+    }
+};
+
+template <class _Key, class _Mapped, class _Compare = std::less<_Key>,
+          class _KeyCont = vector<_Key>, class _MappedCont = vector<_Mapped>>
+struct flat_multimap
+    : _FlatMapImpl<_Key, _Mapped, _Compare, _KeyCont, _MappedCont> {
+private:
+    using _Base = _FlatMapImpl<_Key, _Mapped, _Compare, _KeyCont, _MappedCont>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::iterator;
+    using typename _Base::size_type;
+    using typename _Base::value_type;
+
+    flat_multimap() = default;
+
+    explicit flat_multimap(_Compare __comp) : _Base(__comp) {}
+
+    // 从未排序的区间构造：稳定排序一次，等价键保持输入顺序
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    flat_multimap(_InputIt __first, _InputIt __last,
+                  _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_insert_range<false>(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    flat_multimap(sorted_equivalent_t, _InputIt __first, _InputIt __last,
+                  _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_insert_range<false>(__first, __last, true);
+    }
+
+    flat_multimap(std::initializer_list<value_type> __ilist,
+                  _Compare __comp = _Compare())
+        : flat_multimap(__ilist.begin(), __ilist.end(), __comp) {}
+
+    flat_multimap(_KeyCont __keys, _MappedCont __values,
+                  _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_containers<false>(std::move(__keys),
+                                                   std::move(__values), false);
+    }
+
+    flat_multimap(sorted_equivalent_t, _KeyCont __keys, _MappedCont __values,
+                  _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_containers<false>(std::move(__keys),
+                                                   std::move(__values), true);
+    }
+
+    flat_multimap &operator=(std::initializer_list<value_type> __ilist) {
+        this->clear();
+        this->template _M_insert_range<false>(__ilist.begin(), __ilist.end());
+        return *this;
+    }
+
+    iterator insert(const value_type &__value) {
+        return this->_M_multi_emplace(__value);
+    }
+
+    iterator insert(value_type &&__value) {
+        return this->_M_multi_emplace(std::move(__value));
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->template _M_insert_range<false>(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(sorted_equivalent_t, _InputIt __first, _InputIt __last) {
+        this->template _M_insert_range<false>(__first, __last, true);
+    }
+
+    void insert(std::initializer_list<value_type> __ilist) {
+        this->template _M_insert_range<false>(__ilist.begin(), __ilist.end());
+    }
+
+    template <class... _Ts>
+    iterator emplace(_Ts &&...__value) {
+        return this->_M_multi_emplace(std::forward<_Ts>(__value)...);
+    }
+
+    _LIBPENGCXX_DEFINE_COMPARISON(flat_multimap);
+};
+
+} // namespace Marcus
@@ -0,0 +1,479 @@
+#pragma once
+
+#include <algorithm>
+#include <containers/vector.hpp>
+#include <core/_common.hpp>
+#include <core/_sorted_tag.hpp>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace Marcus {
+
+// flat_set / flat_multiset 的公共实现：键存放在一个有序的连续容器里，
+// 查找是二分，插入和删除是 O(n) 的搬移。元素不可修改，iterator 即 const_iterator。
+template <class _Key, class _Compare, class _KeyCont>
+struct _FlatSetImpl {
+    using key_type = _Key;
+    using value_type = _Key;
+    using key_compare = _Compare;
+    using value_compare = _Compare;
+    using reference = _Key &;
+    using const_reference = const _Key &;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using const_iterator = typename _KeyCont::const_iterator;
+    using iterator = const_iterator;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using reverse_iterator = const_reverse_iterator;
+    using container_type = _KeyCont;
+
+protected:
+    _KeyCont _M_keys;
+    [[no_unique_address]] _Compare _M_comp;
+
+    _FlatSetImpl() = default;
+
+    explicit _FlatSetImpl(_Compare __comp) : _M_comp(__comp) {}
+
+public:
+    const_iterator begin() const noexcept {
+        return _M_keys.cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return _M_keys.cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    bool empty() const noexcept {
+        return _M_keys.empty();
+    }
+
+    size_type size() const noexcept {
+        return _M_keys.size();
+    }
+
+    void clear() noexcept {
+        _M_keys.clear();
+    }
+
+    void reserve(size_type __n) {
+        _M_keys.reserve(__n);
+    }
+
+    void shrink_to_fit() {
+        _M_keys.shrink_to_fit();
+    }
+
+    const _KeyCont &keys() const noexcept {
+        return _M_keys;
+    }
+
+    // 取走底层数组，容器变为空
+    _KeyCont extract() && {
+        _KeyCont __result = std::move(_M_keys);
+        clear();
+        return __result;
+    }
+
+    // 直接换上一个数组，调用者保证它已经有序（multiset）或有序且唯一（set）
+    void replace(_KeyCont &&__keys) {
+        _M_keys = std::move(__keys);
+    }
+
+    _Compare key_comp() const noexcept {
+        return _M_comp;
+    }
+
+    _Compare value_comp() const noexcept {
+        return _M_comp;
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const_iterator lower_bound(const _Kv &__key) const noexcept {
+        return std::lower_bound(begin(), end(), __key, _M_comp);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const_iterator upper_bound(const _Kv &__key) const noexcept {
+        return std::upper_bound(begin(), end(), __key, _M_comp);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    std::pair<const_iterator, const_iterator>
+    equal_range(const _Kv &__key) const noexcept {
+        return std::equal_range(begin(), end(), __key, _M_comp);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const_iterator find(const _Kv &__key) const noexcept {
+        return _M_find(__key);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    bool contains(const _Kv &__key) const noexcept {
+        return _M_find(__key) != end();
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    size_type count(const _Kv &__key) const noexcept {
+        auto __range = equal_range(__key);
+        return __range.second - __range.first;
+    }
+
+    const_iterator lower_bound(const _Key &__key) const noexcept {
+        return std::lower_bound(begin(), end(), __key, _M_comp);
+    }
+
+    const_iterator upper_bound(const _Key &__key) const noexcept {
+        return std::upper_bound(begin(), end(), __key, _M_comp);
+    }
+
+    std::pair<const_iterator, const_iterator>
+    equal_range(const _Key &__key) const noexcept {
+        return std::equal_range(begin(), end(), __key, _M_comp);
+    }
+
+    const_iterator find(const _Key &__key) const noexcept {
+        return _M_find(__key);
+    }
+
+    bool contains(const _Key &__key) const noexcept {
+        return _M_find(__key) != end();
+    }
+
+    size_type count(const _Key &__key) const noexcept {
+        auto __range = equal_range(__key);
+        return __range.second - __range.first;
+    }
+
+    const_iterator erase(const_iterator __it) {
+        return _M_keys.erase(__it);
+    }
+
+    const_iterator erase(const_iterator __first, const_iterator __last) {
+        return _M_keys.erase(__first, __last);
+    }
+
+    template <class _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    size_type erase(const _Kv &__key) {
+        return _M_erase_key(__key);
+    }
+
+    size_type erase(const _Key &__key) {
+        return _M_erase_key(__key);
+    }
+
+    void swap(_FlatSetImpl &__that) noexcept {
+        using std::swap;
+        swap(_M_keys, __that._M_keys);
+        swap(_M_comp, __that._M_comp);
+    }
+
+protected:
+    template <class _Kv>
+    const_iterator _M_find(const _Kv &__key) const noexcept {
+        const_iterator __it = lower_bound(__key);
+        if (__it != end() && !_M_comp(__key, *__it)) {
+            return __it;
+        }
+        return end();
+    }
+
+    template <class _Kv>
+    size_type _M_erase_key(const _Kv &__key) {
+        auto __range = equal_range(__key);
+        size_type __n = __range.second - __range.first;
+        _M_keys.erase(__range.first, __range.second);
+        return __n;
+    }
+
+    template <class... _Ts>
+    std::pair<const_iterator, bool> _M_single_emplace(_Ts &&...__value) {
+        _Key __key(std::forward<_Ts>(__value)...);
+        const_iterator __it = lower_bound(__key);
+        if (__it != end() && !_M_comp(__key, *__it)) {
+            return {__it, false};
+        }
+        return {_M_keys.insert(__it, std::move(__key)), true};
+    }
+
+    template <class... _Ts>
+    const_iterator _M_multi_emplace(_Ts &&...__value) {
+        _Key __key(std::forward<_Ts>(__value)...);
+        return _M_keys.insert(upper_bound(__key), std::move(__key));
+    }
+
+    // 批量插入：新元素稳定排序（_Unique 时去重）后和已有元素线性归并，
+    // 等价的元素以已有的为先，结果和逐个 insert 一致
+    template <bool _Unique, class _InputIt>
+    void _M_insert_range(_InputIt __first, _InputIt __last,
+                         bool __sorted = false) {
+        _KeyCont __tmp;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<
+                                            _InputIt>::iterator_category>) {
+            __tmp.reserve(std::distance(__first, __last));
+        }
+        for (; __first != __last; ++__first) {
+            __tmp.emplace_back(*__first);
+        }
+        _M_insert_sorted<_Unique>(__tmp, __sorted);
+    }
+
+    template <bool _Unique>
+    void _M_insert_sorted(_KeyCont &__tmp, bool __sorted) {
+        if (!__sorted) {
+            std::stable_sort(__tmp.begin(), __tmp.end(), _M_comp);
+        }
+        if constexpr (_Unique) {
+            auto __new_end = std::unique(__tmp.begin(), __tmp.end(),
+                                         [this](const _Key &__lhs,
+                                                const _Key &__rhs) {
+                                             return !_M_comp(__lhs, __rhs);
+                                         });
+            __tmp.erase(__new_end, __tmp.end());
+        }
+        if (__tmp.empty()) {
+            return;
+        }
+        if (_M_keys.empty()) {
+            _M_keys = std::move(__tmp);
+            return;
+        }
+        // 新元素全部排在已有元素之后时直接追加
+        if (_M_comp(_M_keys.back(), __tmp.front()) ||
+            (!_Unique && !_M_comp(__tmp.front(), _M_keys.back()))) {
+            _M_keys.reserve(_M_keys.size() + __tmp.size());
+            for (_Key &__key: __tmp) {
+                _M_keys.push_back(std::move(__key));
+            }
+            return;
+        }
+        _KeyCont __keys;
+        __keys.reserve(_M_keys.size() + __tmp.size());
+        auto __it = _M_keys.begin();
+        auto __jt = __tmp.begin();
+        try {
+            while (__it != _M_keys.end() && __jt != __tmp.end()) {
+                if (_M_comp(*__jt, *__it)) {
+                    __keys.push_back(std::move(*__jt++));
+                } else if (_Unique && !_M_comp(*__it, *__jt)) {
+                    ++__jt; // 已存在
+                } else {
+                    __keys.push_back(std::move(*__it++));
+                }
+            }
+            for (; __it != _M_keys.end(); ++__it) {
+                __keys.push_back(std::move(*__it));
+            }
+            for (; __jt != __tmp.end(); ++__jt) {
+                __keys.push_back(std::move(*__jt));
+            }
+        } catch (...) {
+            clear(); // 已有元素可能已经被移走了
+            throw;
+        }
+        _M_keys = std::move(__keys);
+    }
+};
+
+template <class _Key, class _Compare = std::less<_Key>,
+          class _KeyCont = vector<_Key>>
+struct flat_set : _FlatSetImpl<_Key, _Compare, _KeyCont> {
+private:
+    using _Base = _FlatSetImpl<_Key, _Compare, _KeyCont>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::iterator;
+
+    flat_set() = default;
+
+    explicit flat_set(_Compare __comp) : _Base(__comp) {}
+
+    // 从未排序的区间构造：排序并去重一次
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    flat_set(_InputIt __first, _InputIt __last, _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_insert_range<true>(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    flat_set(sorted_unique_t, _InputIt __first, _InputIt __last,
+             _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_insert_range<true>(__first, __last, true);
+    }
+
+    flat_set(std::initializer_list<_Key> __ilist, _Compare __comp = _Compare())
+        : flat_set(__ilist.begin(), __ilist.end(), __comp) {}
+
+    explicit flat_set(_KeyCont __keys, _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_insert_sorted<true>(__keys, false);
+    }
+
+    flat_set(sorted_unique_t, _KeyCont __keys, _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->replace(std::move(__keys));
+    }
+
+    flat_set &operator=(std::initializer_list<_Key> __ilist) {
+        this->clear();
+        this->template _M_insert_range<true>(__ilist.begin(), __ilist.end());
+        return *this;
+    }
+
+    std::pair<iterator, bool> insert(const _Key &__value) {
+        return this->_M_single_emplace(__value);
+    }
+
+    std::pair<iterator, bool> insert(_Key &&__value) {
+        return this->_M_single_emplace(std::move(__value));
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->template _M_insert_range<true>(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(sorted_unique_t, _InputIt __first, _InputIt __last) {
+        this->template _M_insert_range<true>(__first, __last, true);
+    }
+
+    void insert(std::initializer_list<_Key> __ilist) {
+        this->template _M_insert_range<true>(__ilist.begin(), __ilist.end());
+    }
+
+    template <class... _Ts>
+    std::pair<iterator, bool> emplace(_Ts &&...__value) {
+        return this->_M_single_emplace(std::forward<_Ts>(__value)...);
+    }
+
+    _LIBPENGCXX_DEFINE_COMPARISON(flat_set);
+};
+
+template <class _Key, class _Compare = std::less<_Key>,
+          class _KeyCont = vector<_Key>>
+struct flat_multiset : _FlatSetImpl<_Key, _Compare, _KeyCont> {
+private:
+    using _Base = _FlatSetImpl<_Key, _Compare, _KeyCont>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::iterator;
+
+    flat_multiset() = default;
+
+    explicit flat_multiset(_Compare __comp) : _Base(__comp) {}
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    flat_multiset(_InputIt __first, _InputIt __last,
+                  _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_insert_range<false>(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    flat_multiset(sorted_equivalent_t, _InputIt __first, _InputIt __last,
+                  _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_insert_range<false>(__first, __last, true);
+    }
+
+    flat_multiset(std::initializer_list<_Key> __ilist,
+                  _Compare __comp = _Compare())
+        : flat_multiset(__ilist.begin(), __ilist.end(), __comp) {}
+
+    explicit flat_multiset(_KeyCont __keys, _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_insert_sorted<false>(__keys, false);
+    }
+
+    flat_multiset(sorted_equivalent_t, _KeyCont __keys,
+                  _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->replace(std::move(__keys));
+    }
+
+    flat_multiset &operator=(std::initializer_list<_Key> __ilist) {
+        this->clear();
+        this->template _M_insert_range<false>(__ilist.begin(), __ilist.end());
+        return *this;
+    }
+
+    iterator insert(const _Key &__value) {
+        return this->_M_multi_emplace(__value);
+    }
+
+    iterator insert(_Key &&__value) {
+        return this->_M_multi_emplace(std::move(__value));
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->template _M_insert_range<false>(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(sorted_equivalent_t, _InputIt __first, _InputIt __last) {
+        this->template _M_insert_range<false>(__first, __last, true);
+    }
+
+    void insert(std::initializer_list<_Key> __ilist) {
+        this->template _M_insert_range<false>(__ilist.begin(), __ilist.end());
+    }
+
+    template <class... _Ts>
+    iterator emplace(_Ts &&...__value) {
+        return this->_M_multi_emplace(std::forward<_Ts>(__value)...);
+    }
+
+    _LIBPENGCXX_DEFINE_COMPARISON(flat_multiset);
+};
+
+} // namespace Marcus
@@ -52,17 +52,16 @@ private:
         Alloc>::template rebind_alloc<ForwardListValueNode<T>>;
 
     Node _dummy;
-    [[no_unique_address]] Alloc _alloc;
+    // 保存节点类型的分配器，分配节点时不用每次重新绑定
+    [[no_unique_address]] AllocNode _alloc;
 
     Node *newNode() {
-        AllocNode allocNode(_alloc);
-        return std::allocator_traits<AllocNode>::allocate(allocNode, 1);
+        return std::allocator_traits<AllocNode>::allocate(_alloc, 1);
     }
 
     void deleteNode(Node *node) noexcept {
-        AllocNode allocNode(_alloc);
         std::allocator_traits<AllocNode>::deallocate(
-            allocNode, static_cast<ForwardListValueNode<T> *>(node), 1);
+            _alloc, static_cast<ForwardListValueNode<T> *>(node), 1);
     }
 
     void destroyAndDeallocateNode(Node *node) noexcept {
@@ -778,7 +777,7 @@ public:
     }
 
     Alloc get_allocator() const noexcept {
-        return _alloc;
+        return Alloc(_alloc);
     }
 
     bool operator==(const forward_list &other) const noexcept {
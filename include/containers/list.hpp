@@ -51,17 +51,16 @@ private:
 
     ListNode _dummy;
     std::size_t _size;
-    [[no_unique_address]] Alloc _alloc;
+    // 保存节点类型的分配器，分配节点时不用每次重新绑定
+    [[no_unique_address]] AllocNode _alloc;
 
     ListNode *newNode() {
-        AllocNode allocNode(_alloc);
-        return std::allocator_traits<AllocNode>::allocate(allocNode, 1);
+        return std::allocator_traits<AllocNode>::allocate(_alloc, 1);
     }
 
     void deleteNode(ListNode *node) noexcept {
-        AllocNode allocNode(_alloc);
         std::allocator_traits<AllocNode>::deallocate(
-            allocNode, static_cast<ListValueNode<T> *>(node), 1);
+            _alloc, static_cast<ListValueNode<T> *>(node), 1);
     }
 
 public:
@@ -84,9 +83,10 @@ public:
     }
 
     list &operator=(list &&other) {
+        clear(); // 旧节点要还给旧的分配器
         _alloc = std::move(other._alloc);
-        clear();
         _uninit_move_assign(std::move(other));
+        return *this;
     }
 
 private:
@@ -112,6 +112,7 @@ public:
 
     list &operator=(const list &other) {
         assign(other.cbegin(), other.cend());
+        return *this;
     }
 
     bool empty() const noexcept {
@@ -556,7 +557,7 @@ public:
     }
 
     Alloc get_allocator() const noexcept {
-        return _alloc;
+        return Alloc(_alloc);
     }
 
     _LIBPENGCXX_DEFINE_COMPARISON(list);
@@ -2,6 +2,7 @@
 
 #include <containers/core/_RbTree.hpp>
 #include <core/_common.hpp>
+#include <core/_sorted_tag.hpp>
 #include <cstddef>
 #include <initializer_list>
 #include <stdexcept>
@@ -31,7 +32,11 @@ public:
         return this->_M_comp(__lhs.first, __rhs.first);
     }
 
-    struct _RBTreeIsMap;
+    _Compare key_comp() const noexcept {
+        return _M_comp;
+    }
+
+    struct _RbTreeIsMap;
 };
 
 template <typename _Compare, typename _Value>
@@ -59,14 +64,26 @@ struct _RbTreeValueCompare<
     }
 
     using is_transparent = typename _Compare::is_transparent;
+
+    _Compare key_comp() const noexcept {
+        return _M_comp;
+    }
+
+    struct _RbTreeIsMap;
 };
 
+template <typename _Key, typename _Mapped, typename _Compare, typename _Alloc,
+          bool _OrderStatistic>
+struct multimap;
+
 template <typename _Key, typename _Mapped, typename _Compare = std::less<_Key>,
-          typename _Alloc = std::allocator<std::pair<const _Key, _Mapped>>>
+          typename _Alloc = std::allocator<std::pair<const _Key, _Mapped>>,
+          bool _OrderStatistic = false>
 struct map
     : _RbTreeImpl<std::pair<const _Key, _Mapped>,
                   _RbTreeValueCompare<_Compare, std::pair<const _Key, _Mapped>>,
-                  _Alloc> {
+                  _Alloc, _RbTreeNodeImpl<std::pair<const _Key, _Mapped>,
+                                          _OrderStatistic>> {
     using key_type = _Key;
     using mapped_type = _Mapped;
     using value_type = std::pair<const _Key, _Mapped>;
@@ -75,44 +92,65 @@ struct map
 
 private:
     using _ValueComp = _RbTreeValueCompare<_Compare, value_type>;
+    using _Base = _RbTreeImpl<value_type, _ValueComp, _Alloc,
+                              _RbTreeNodeImpl<value_type, _OrderStatistic>>;
+    using _Multimap =
+        multimap<_Key, _Mapped, _Compare, _Alloc, _OrderStatistic>;
 
 public:
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::iterator;
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::const_iterator;
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::node_type;
+    using typename _Base::iterator;
+    using typename _Base::const_iterator;
+    using typename _Base::node_type;
 
     map() = default;
 
-    explicit map(_Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {}
+    explicit map(_Compare __comp) : _Base(__comp) {}
+
+    explicit map(const _Alloc &__alloc, _Compare __comp = _Compare())
+        : _Base(__alloc, __comp) {}
 
     map(std::initializer_list<value_type> __ilist) {
-        _M_single_insert(__ilist.begin(), __ilist.end());
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
     }
 
     explicit map(std::initializer_list<value_type> __ilist, _Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {
-        _M_single_insert(__ilist.begin(), __ilist.end());
+        : _Base(__comp) {
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
     }
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     explicit map(_InputIt __first, _InputIt __last) {
-        _M_single_insert(__first, __last);
+        this->_M_single_insert(__first, __last);
     }
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     explicit map(_InputIt __first, _InputIt __last, _Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {
-        _M_single_insert(__first, __last);
+        : _Base(__comp) {
+        this->_M_single_insert(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    map(sorted_unique_t, _InputIt __first, _InputIt __last,
+        _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_sorted<true>(__first, __last);
+    }
+
+    map(sorted_unique_t, std::initializer_list<value_type> __ilist,
+        _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_sorted<true>(__ilist.begin(), __ilist.end());
     }
 
     map(map &&) = default;
 
     map &operator=(map &&) = default;
 
-    map(const map &__other) : _RbTreeImpl<value_type, _ValueComp, _Alloc>() {
+    map(const map &__other)
+        : _Base(typename _Base::_EmptyCopyTag{}, __other) {
         this->_M_single_insert(__other.begin(), __other.end());
     }
 
@@ -134,7 +172,7 @@ public:
     }
 
     _Compare key_comp() const noexcept {
-        return this->_M_comp->_M_comp;
+        return this->_M_comp.key_comp();
     }
 
     _ValueComp value_comp() const noexcept {
@@ -161,6 +199,44 @@ public:
         return this->_M_find(__key);
     }
 
+    using _Base::lower_bound;
+    using _Base::upper_bound;
+    using _Base::equal_range;
+
+    iterator lower_bound(const _Key &__key) noexcept {
+        return this->_M_lower(__key);
+    }
+
+    const_iterator lower_bound(const _Key &__key) const noexcept {
+        return this->_M_lower(__key);
+    }
+
+    iterator upper_bound(const _Key &__key) noexcept {
+        return this->_M_upper(__key);
+    }
+
+    const_iterator upper_bound(const _Key &__key) const noexcept {
+        return this->_M_upper(__key);
+    }
+
+    std::pair<iterator, iterator> equal_range(const _Key &__key) noexcept {
+        return {this->_M_lower(__key), this->_M_upper(__key)};
+    }
+
+    std::pair<const_iterator, const_iterator>
+    equal_range(const _Key &__key) const noexcept {
+        return {this->_M_lower(__key), this->_M_upper(__key)};
+    }
+
+    using _Base::rank;
+
+    // 只在 _OrderStatistic 为 true 时可用
+    std::size_t rank(const _Key &__key) const noexcept
+        requires _OrderStatistic
+    {
+        return this->_M_rank(__key);
+    }
+
     std::pair<iterator, bool> insert(value_type &&__value) {
         return this->_M_single_emplace(std::move(__value));
     }
@@ -274,22 +350,67 @@ public:
             std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
     }
 
+    // 带提示的插入：新键紧挨着 __hint 时 O(1) 链接，
+    // 按顺序追加时传 end() 即可
+    template <typename... Vs>
+    iterator emplace_hint(const_iterator __hint, Vs &&...__value) {
+        return this->_M_single_emplace_hint(__hint,
+                                            std::forward<Vs>(__value)...)
+            .first;
+    }
+
+    iterator insert(const_iterator __hint, value_type &&__value) {
+        return this->_M_single_emplace_hint(__hint, std::move(__value)).first;
+    }
+
+    iterator insert(const_iterator __hint, const value_type &__value) {
+        return this->_M_single_emplace_hint(__hint, __value).first;
+    }
+
+    template <typename... _Ms>
+    iterator try_emplace(const_iterator __hint, _Key &&__key,
+                         _Ms &&...__mapped) {
+        return this
+            ->_M_single_emplace_hint(
+                __hint, std::piecewise_construct,
+                std::forward_as_tuple(std::move(__key)),
+                std::forward_as_tuple(std::forward<_Ms>(__mapped)...))
+            .first;
+    }
+
+    template <typename... _Ms>
+    iterator try_emplace(const_iterator __hint, const _Key &__key,
+                         _Ms &&...__mapped) {
+        return this
+            ->_M_single_emplace_hint(
+                __hint, std::piecewise_construct, std::forward_as_tuple(__key),
+                std::forward_as_tuple(std::forward<_Ms>(__mapped)...))
+            .first;
+    }
+
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
-    iterator insert(_InputIt __first, _InputIt __last) {
-        return this->_M_single_insert(__first, __last);
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_single_insert(__first, __last);
     }
 
-    using _RbTreeImpl<value_type, _ValueComp, _Alloc>::assign;
+    using _Base::assign;
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
-    iterator assign(_InputIt __first, _InputIt __last) {
+    void assign(_InputIt __first, _InputIt __last) {
         this->clear();
-        return this->_M_single_insert(__first, __last);
+        this->_M_single_insert(__first, __last);
+    }
+
+    // [__first, __last) 必须已按键严格递增，O(n) 建树
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(sorted_unique_t, _InputIt __first, _InputIt __last) {
+        this->template _M_assign_sorted<true>(__first, __last);
     }
 
-    using _RbTreeImpl<value_type, _ValueComp, _Alloc>::erase;
+    using _Base::erase;
 
     template <typename _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(
                                 _ValueComp, _Kv, value_type)>
@@ -321,6 +442,10 @@ public:
         return this->_M_contains(__key);
     }
 
+    using _Base::insert;
+
+    using _Base::extract;
+
     template <typename _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(
                                 _ValueComp, _Kv, value_type)>
     node_type extract(_Kv &&__key) {
@@ -332,14 +457,82 @@ public:
         iterator __it = this->_M_find(__key);
         return __it != this->end() ? this->extract(__it) : node_type();
     }
+
+    // 分配器相等时直接搬动节点，不重新分配，否则逐个移动元素；
+    // 键已存在的元素留在 __source 中
+    void merge(map &__source) {
+        this->template _M_merge<true>(__source);
+    }
+
+    void merge(map &&__source) {
+        this->template _M_merge<true>(__source);
+    }
+
+    void merge(_Multimap &__source) {
+        this->template _M_merge<true>(__source);
+    }
+
+    void merge(_Multimap &&__source) {
+        this->template _M_merge<true>(__source);
+    }
+
+    // 集合运算，结果留在 *this 中，键相同时保留 *this 的值。
+    // 右值版本在分配器相等时直接复用两边的节点，__other 被清空；复杂度
+    // O(m log(n/m + 1))，m <= n 为两边的大小，两边都很大时
+    // 递归的两半交给不同的线程。const 版本先用 *this 的分配器拷贝
+    // __other，拷贝出来的节点才能接到 *this 上
+    void set_union(map &&__other) {
+        this->template _M_set_operation_from<_S_set_union>(__other);
+    }
+
+    void set_union(const map &__other) {
+        this->set_union(_M_copy_sharing_alloc(__other));
+    }
+
+    void set_intersection(map &&__other) {
+        this->template _M_set_operation_from<_S_set_intersection>(__other);
+    }
+
+    void set_intersection(const map &__other) {
+        this->set_intersection(_M_copy_sharing_alloc(__other));
+    }
+
+    void set_difference(map &&__other) {
+        this->template _M_set_operation_from<_S_set_difference>(__other);
+    }
+
+    void set_difference(const map &__other) {
+        this->set_difference(_M_copy_sharing_alloc(__other));
+    }
+
+private:
+    // 分配器不相等时 __other 的节点不能直接接过来，先拷贝一份
+    template <_RbTreeSetOp _Op>
+    void _M_set_operation_from(map &__other) {
+        if (this->_M_alloc_equal(__other)) {
+            this->template _M_set_operation<_Op>(__other);
+        } else {
+            map __copy = _M_copy_sharing_alloc(__other);
+            __other.clear();
+            this->template _M_set_operation<_Op>(__copy);
+        }
+    }
+
+    map _M_copy_sharing_alloc(const map &__other) const {
+        map __copy(this->get_allocator(), __other.key_comp());
+        __copy.template _M_assign_sorted<true>(__other.begin(), __other.end());
+        return __copy;
+    }
 };
 
 template <typename _Key, typename _Mapped, typename _Compare = std::less<_Key>,
-          typename _Alloc = std::allocator<std::pair<const _Key, _Mapped>>>
+          typename _Alloc = std::allocator<std::pair<const _Key, _Mapped>>,
+          bool _OrderStatistic = false>
 struct multimap
     : _RbTreeImpl<std::pair<const _Key, _Mapped>,
                   _RbTreeValueCompare<_Compare, std::pair<const _Key, _Mapped>>,
-                  _Alloc> {
+                  _Alloc, _RbTreeNodeImpl<std::pair<const _Key, _Mapped>,
+                                          _OrderStatistic>> {
     using key_type = _Key;
     using mapped_type = _Mapped;
     using value_type = std::pair<const _Key, _Mapped>;
@@ -348,38 +541,57 @@ struct multimap
 
 private:
     using _ValueComp = _RbTreeValueCompare<_Compare, value_type>;
+    using _Base = _RbTreeImpl<value_type, _ValueComp, _Alloc,
+                              _RbTreeNodeImpl<value_type, _OrderStatistic>>;
+    using _Map = map<_Key, _Mapped, _Compare, _Alloc, _OrderStatistic>;
 
 public:
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::iterator;
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::const_iterator;
-    using typename _RbTreeImpl<value_type, _ValueComp, _Alloc>::node_type;
+    using typename _Base::iterator;
+    using typename _Base::const_iterator;
+    using typename _Base::node_type;
 
     multimap() = default;
 
-    explicit multimap(_Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {}
+    explicit multimap(_Compare __comp) : _Base(__comp) {}
+
+    explicit multimap(const _Alloc &__alloc, _Compare __comp = _Compare())
+        : _Base(__alloc, __comp) {}
 
     multimap(std::initializer_list<value_type> __ilist) {
-        _M_multi_insert(__ilist.begin(), __ilist.end());
+        this->_M_multi_insert(__ilist.begin(), __ilist.end());
     }
 
     explicit multimap(std::initializer_list<value_type> __ilist,
                       _Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {
-        _M_multi_insert(__ilist.begin(), __ilist.end());
+        : _Base(__comp) {
+        this->_M_multi_insert(__ilist.begin(), __ilist.end());
     }
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     explicit multimap(_InputIt __first, _InputIt __last) {
-        _M_multi_insert(__first, __last);
+        this->_M_multi_insert(__first, __last);
     }
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     explicit multimap(_InputIt __first, _InputIt __last, _Compare __comp)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>(__comp) {
-        _M_multi_insert(__first, __last);
+        : _Base(__comp) {
+        this->_M_multi_insert(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    multimap(sorted_equivalent_t, _InputIt __first, _InputIt __last,
+             _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_sorted<false>(__first, __last);
+    }
+
+    multimap(sorted_equivalent_t, std::initializer_list<value_type> __ilist,
+             _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_sorted<false>(__ilist.begin(), __ilist.end());
     }
 
     multimap(multimap &&) = default;
@@ -387,13 +599,13 @@ public:
     multimap &operator=(multimap &&) = default;
 
     multimap(const multimap &__other)
-        : _RbTreeImpl<value_type, _ValueComp, _Alloc>() {
+        : _Base(typename _Base::_EmptyCopyTag{}, __other) {
         this->_M_multi_insert(__other.begin(), __other.end());
     }
 
     multimap &operator=(const multimap &__other) {
         if (&__other != this) {
-            return assign(__other.begin(), __other.end());
+            this->assign(__other.begin(), __other.end());
         }
         return *this;
     }
@@ -409,7 +621,7 @@ public:
     }
 
     _Compare key_comp() const noexcept {
-        return this->_M_comp->_M_comp;
+        return this->_M_comp.key_comp();
     }
 
     _ValueComp value_comp() const noexcept {
@@ -436,17 +648,70 @@ public:
         return this->_M_find(__key);
     }
 
-    std::pair<iterator, bool> insert(value_type &&__value) {
-        return this->_M_single_emplace(std::move(__value));
+    using _Base::lower_bound;
+    using _Base::upper_bound;
+    using _Base::equal_range;
+
+    iterator lower_bound(const _Key &__key) noexcept {
+        return this->_M_lower(__key);
     }
 
-    std::pair<iterator, bool> insert(const value_type &__value) {
-        return this->_M_single_emplace(__value);
+    const_iterator lower_bound(const _Key &__key) const noexcept {
+        return this->_M_lower(__key);
+    }
+
+    iterator upper_bound(const _Key &__key) noexcept {
+        return this->_M_upper(__key);
+    }
+
+    const_iterator upper_bound(const _Key &__key) const noexcept {
+        return this->_M_upper(__key);
     }
 
+    std::pair<iterator, iterator> equal_range(const _Key &__key) noexcept {
+        return {this->_M_lower(__key), this->_M_upper(__key)};
+    }
+
+    std::pair<const_iterator, const_iterator>
+    equal_range(const _Key &__key) const noexcept {
+        return {this->_M_lower(__key), this->_M_upper(__key)};
+    }
+
+    using _Base::rank;
+
+    // 只在 _OrderStatistic 为 true 时可用
+    std::size_t rank(const _Key &__key) const noexcept
+        requires _OrderStatistic
+    {
+        return this->_M_rank(__key);
+    }
+
+    iterator insert(value_type &&__value) {
+        return this->_M_multi_emplace(std::move(__value));
+    }
+
+    iterator insert(const value_type &__value) {
+        return this->_M_multi_emplace(__value);
+    }
+
+    template <typename... _Ts>
+    iterator emplace(_Ts &&...__value) {
+        return this->_M_multi_emplace(std::forward<_Ts>(__value)...);
+    }
+
+    // 等价的键插在尽量靠近 __hint 之前的位置
     template <typename... _Ts>
-    std::pair<iterator, bool> emplace(_Ts &&...__value) {
-        return this->_M_single_emplace(std::forward<_Ts>(__value)...);
+    iterator emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        return this->_M_multi_emplace_hint(__hint,
+                                           std::forward<_Ts>(__value)...);
+    }
+
+    iterator insert(const_iterator __hint, value_type &&__value) {
+        return this->_M_multi_emplace_hint(__hint, std::move(__value));
+    }
+
+    iterator insert(const_iterator __hint, const value_type &__value) {
+        return this->_M_multi_emplace_hint(__hint, __value);
     }
 
     template <typename... _Ts>
@@ -465,20 +730,27 @@ public:
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
-    iterator insert(_InputIt __first, _InputIt __last) {
-        return this->_M_single_insert(__first, __last);
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_multi_insert(__first, __last);
     }
 
-    using _RbTreeImpl<value_type, _ValueComp, _Alloc>::assign;
+    using _Base::assign;
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
-    iterator assign(_InputIt __first, _InputIt __last) {
+    void assign(_InputIt __first, _InputIt __last) {
         this->clear();
-        return this->_M_single_insert(__first, __last);
+        this->_M_multi_insert(__first, __last);
+    }
+
+    // [__first, __last) 必须已按键排好序，O(n) 建树
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(sorted_equivalent_t, _InputIt __first, _InputIt __last) {
+        this->template _M_assign_sorted<false>(__first, __last);
     }
 
-    using _RbTreeImpl<value_type, _ValueComp, _Alloc>::erase;
+    using _Base::erase;
 
     template <typename _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(
                                 _ValueComp, _Kv, value_type)>
@@ -510,6 +782,12 @@ public:
         return this->_M_contains(__key);
     }
 
+    iterator insert(node_type __nh) {
+        return this->_M_multi_insert(std::move(__nh));
+    }
+
+    using _Base::extract;
+
     template <typename _Kv, _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(
                                 _ValueComp, _Kv, value_type)>
     node_type extract(_Kv &&__key) {
@@ -521,6 +799,23 @@ public:
         iterator __it = this->_M_find(__key);
         return __it != this->end() ? this->extract(__it) : node_type();
     }
+
+    // 分配器相等时直接搬动节点，不重新分配，否则逐个移动元素
+    void merge(multimap &__source) {
+        this->template _M_merge<false>(__source);
+    }
+
+    void merge(multimap &&__source) {
+        this->template _M_merge<false>(__source);
+    }
+
+    void merge(_Map &__source) {
+        this->template _M_merge<false>(__source);
+    }
+
+    void merge(_Map &&__source) {
+        this->template _M_merge<false>(__source);
+    }
 };
 
 } // namespace Marcus
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <containers/core/_BTree.hpp>
+#include <containers/core/_PersistentRbTree.hpp>
+#include <core/_common.hpp>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace Marcus {
+
+// 持久化（不可变、结构共享）的有序映射。复制是 O(1) 的快照，之后对任一
+// 对象的修改只复制 O(log n) 个节点，其余子树仍与其他版本共享，各版本
+// 互不影响。元素只能读，修改通过 insert / insert_or_assign / erase 整体
+// 替换。迭代器只能向前，修改会使本对象的迭代器失效，快照的迭代器不受影响
+template <typename _Key, typename _Mapped, typename _Compare = std::less<_Key>,
+          typename _Alloc = std::allocator<std::pair<const _Key, _Mapped>>>
+struct persistent_map
+    : _PersistentRbTreeImpl<_Key, std::pair<const _Key, _Mapped>,
+                            _BTreeSelectFirst, _Compare, _Alloc> {
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<const _Key, _Mapped>;
+    using key_compare = _Compare;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+private:
+    using _Base = _PersistentRbTreeImpl<_Key, value_type, _BTreeSelectFirst,
+                                        _Compare, _Alloc>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::iterator;
+
+    persistent_map() = default;
+
+    explicit persistent_map(const _Compare &__comp,
+                            const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {}
+
+    explicit persistent_map(const _Alloc &__alloc)
+        : _Base(_Compare(), __alloc) {}
+
+    persistent_map(std::initializer_list<value_type> __ilist,
+                   const _Compare &__comp = _Compare(),
+                   const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {
+        insert(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    persistent_map(_InputIt __first, _InputIt __last,
+                   const _Compare &__comp = _Compare(),
+                   const _Alloc &__alloc = _Alloc())
+        : _Base(__comp, __alloc) {
+        insert(__first, __last);
+    }
+
+    persistent_map(persistent_map &&) = default;
+
+    persistent_map &operator=(persistent_map &&) = default;
+
+    persistent_map(const persistent_map &) = default;
+
+    persistent_map &operator=(const persistent_map &) = default;
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const _Mapped &at(const _Kv &__key) const {
+        auto *__node = this->_M_find_node(__key);
+        if (__node == nullptr) [[unlikely]] {
+            throw std::out_of_range("persistent_map::at");
+        }
+        return __node->_M_value.second;
+    }
+
+    const _Mapped &at(const _Key &__key) const {
+        auto *__node = this->_M_find_node(__key);
+        if (__node == nullptr) [[unlikely]] {
+            throw std::out_of_range("persistent_map::at");
+        }
+        return __node->_M_value.second;
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const_iterator find(const _Kv &__key) const {
+        return this->_M_find(__key);
+    }
+
+    const_iterator find(const _Key &__key) const {
+        return this->_M_find(__key);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    bool contains(const _Kv &__key) const noexcept {
+        return this->_M_find_node(__key) != nullptr;
+    }
+
+    bool contains(const _Key &__key) const noexcept {
+        return this->_M_find_node(__key) != nullptr;
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    std::size_t count(const _Kv &__key) const noexcept {
+        return this->_M_find_node(__key) != nullptr;
+    }
+
+    std::size_t count(const _Key &__key) const noexcept {
+        return this->_M_find_node(__key) != nullptr;
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const_iterator lower_bound(const _Kv &__key) const {
+        return this->_M_lower_bound(__key);
+    }
+
+    const_iterator lower_bound(const _Key &__key) const {
+        return this->_M_lower_bound(__key);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    const_iterator upper_bound(const _Kv &__key) const {
+        return this->_M_upper_bound(__key);
+    }
+
+    const_iterator upper_bound(const _Key &__key) const {
+        return this->_M_upper_bound(__key);
+    }
+
+    // 以下修改函数返回是否新插入（删除时返回删掉的个数）而不是迭代器：
+    // 新版本的迭代器要从根重新找一遍，需要时再用 find
+    bool insert(const value_type &__value) {
+        if (this->_M_find_node(__value.first)) {
+            return false;
+        }
+        return this->_M_insert_node(this->_M_new_leaf(__value), false);
+    }
+
+    bool insert(value_type &&__value) {
+        if (this->_M_find_node(__value.first)) {
+            return false;
+        }
+        return this->_M_insert_node(this->_M_new_leaf(std::move(__value)),
+                                    false);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        for (; __first != __last; ++__first) {
+            insert(*__first);
+        }
+    }
+
+    void insert(std::initializer_list<value_type> __ilist) {
+        insert(__ilist.begin(), __ilist.end());
+    }
+
+    template <class... _Ts>
+    bool emplace(_Ts &&...__value) {
+        return this->_M_insert_node(
+            this->_M_new_leaf(std::forward<_Ts>(__value)...), false);
+    }
+
+    template <class... _Ts>
+    bool try_emplace(const _Key &__key, _Ts &&...__mapped) {
+        if (this->_M_find_node(__key)) {
+            return false;
+        }
+        return this->_M_insert_node(
+            this->_M_new_leaf(std::piecewise_construct,
+                              std::forward_as_tuple(__key),
+                              std::forward_as_tuple(
+                                  std::forward<_Ts>(__mapped)...)),
+            false);
+    }
+
+    template <class... _Ts>
+    bool try_emplace(_Key &&__key, _Ts &&...__mapped) {
+        if (this->_M_find_node(__key)) {
+            return false;
+        }
+        return this->_M_insert_node(
+            this->_M_new_leaf(std::piecewise_construct,
+                              std::forward_as_tuple(std::move(__key)),
+                              std::forward_as_tuple(
+                                  std::forward<_Ts>(__mapped)...)),
+            false);
+    }
+
+    // 键已存在时复制到它的路径并换成新元素
+    template <class _Mp>
+    bool insert_or_assign(const _Key &__key, _Mp &&__mapped) {
+        return this->_M_insert_node(
+            this->_M_new_leaf(__key, std::forward<_Mp>(__mapped)), true);
+    }
+
+    template <class _Mp>
+    bool insert_or_assign(_Key &&__key, _Mp &&__mapped) {
+        return this->_M_insert_node(
+            this->_M_new_leaf(std::move(__key), std::forward<_Mp>(__mapped)),
+            true);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Kv, _Key)>
+    std::size_t erase(const _Kv &__key) {
+        return this->_M_erase_key(__key);
+    }
+
+    std::size_t erase(const _Key &__key) {
+        return this->_M_erase_key(__key);
+    }
+
+    _LIBPENGCXX_DEFINE_COMPARISON(persistent_map);
+};
+
+} // namespace Marcus
@@ -2,14 +2,28 @@
 
 #include <containers/core/_RbTree.hpp>
 #include <core/_common.hpp>
+#include <core/_sorted_tag.hpp>
+#include <initializer_list>
 
 namespace Marcus {
 
+template <typename _Tp, typename _Compare, typename _Alloc,
+          bool _OrderStatistic>
+struct multiset;
+
 template <typename _Tp, typename _Compare = std::less<_Tp>,
-          typename _Alloc = std::allocator<_Tp>>
-struct set : _RbTreeImpl<const _Tp, _Compare, _Alloc> {
-    using typename _RbTreeImpl<const _Tp, _Compare, _Alloc>::const_iterator;
-    using typename _RbTreeImpl<const _Tp, _Compare, _Alloc>::node_type;
+          typename _Alloc = std::allocator<_Tp>, bool _OrderStatistic = false>
+struct set
+    : _RbTreeImpl<const _Tp, _Compare, _Alloc,
+                  _RbTreeNodeImpl<const _Tp, _OrderStatistic>> {
+private:
+    using _Base = _RbTreeImpl<const _Tp, _Compare, _Alloc,
+                              _RbTreeNodeImpl<const _Tp, _OrderStatistic>>;
+    using _Multiset = multiset<_Tp, _Compare, _Alloc, _OrderStatistic>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::node_type;
     using iterator = const_iterator;
     using value_type = _Tp;
     using size_type = std::size_t;
@@ -17,14 +31,43 @@ struct set : _RbTreeImpl<const _Tp, _Compare, _Alloc> {
 
     set() = default;
 
-    explicit set(_Compare __comp)
-        : _RbTreeImpl<const _Tp, _Compare, _Alloc>(__comp) {}
+    explicit set(_Compare __comp) : _Base(__comp) {}
+
+    explicit set(const _Alloc &__alloc, _Compare __comp = _Compare())
+        : _Base(__alloc, __comp) {}
+
+    set(std::initializer_list<_Tp> __ilist, _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->_M_single_insert(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    set(_InputIt __first, _InputIt __last, _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->_M_single_insert(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    set(sorted_unique_t, _InputIt __first, _InputIt __last,
+        _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_sorted<true>(__first, __last);
+    }
+
+    set(sorted_unique_t, std::initializer_list<_Tp> __ilist,
+        _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_sorted<true>(__ilist.begin(), __ilist.end());
+    }
 
     set(set &&) = default;
 
     set &operator=(set &&) = default;
 
-    set(const set &__other) : _RbTreeImpl<const _Tp, _Compare, _Alloc>() {
+    set(const set &__other)
+        : _Base(typename _Base::_EmptyCopyTag{}, __other) {
         this->_M_single_insert(__other.begin(), __other.end());
     }
 
@@ -72,22 +115,46 @@ struct set : _RbTreeImpl<const _Tp, _Compare, _Alloc> {
         return this->_M_single_emplace(std::forward<_Ts>(__value)...);
     }
 
+    // 带提示的插入：新值紧挨着 __hint 时 O(1) 链接，
+    // 按顺序追加时传 end() 即可
+    template <typename... _Ts>
+    iterator emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        return this->_M_single_emplace_hint(__hint,
+                                            std::forward<_Ts>(__value)...)
+            .first;
+    }
+
+    iterator insert(const_iterator __hint, _Tp &&__value) {
+        return this->_M_single_emplace_hint(__hint, std::move(__value)).first;
+    }
+
+    iterator insert(const_iterator __hint, const _Tp &__value) {
+        return this->_M_single_emplace_hint(__hint, __value).first;
+    }
+
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     void insert(_InputIt __first, _InputIt __last) {
         return this->_M_single_insert(__first, __last);
     }
 
-    using _RbTreeImpl<const _Tp, _Compare, _Alloc>::assign;
+    using _Base::assign;
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     void assign(_InputIt __first, _InputIt __last) {
         this->clear();
-        return this->_M_single_insert(__first, __last);
+        this->_M_single_insert(__first, __last);
     }
 
-    using _RbTreeImpl<const _Tp, _Compare, _Alloc>::erase;
+    // [__first, __last) 必须已排好序，O(n) 建树
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(sorted_unique_t, _InputIt __first, _InputIt __last) {
+        this->template _M_assign_sorted<true>(__first, __last);
+    }
+
+    using _Base::erase;
 
     template <typename _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
@@ -119,6 +186,10 @@ struct set : _RbTreeImpl<const _Tp, _Compare, _Alloc> {
         return this->_M_contains(__value);
     }
 
+    using _Base::insert;
+
+    using _Base::extract;
+
     template <typename _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     node_type extract(_Tv &&__value) {
@@ -130,13 +201,86 @@ struct set : _RbTreeImpl<const _Tp, _Compare, _Alloc> {
         iterator __it = this->_M_find(__value);
         return __it != this->end() ? this->extract(__it) : node_type();
     }
+
+    // 分配器相等时直接搬动节点，不重新分配，否则逐个移动元素；
+    // 键已存在的元素留在 __source 中
+    void merge(set &__source) {
+        this->template _M_merge<true>(__source);
+    }
+
+    void merge(set &&__source) {
+        this->template _M_merge<true>(__source);
+    }
+
+    void merge(_Multiset &__source) {
+        this->template _M_merge<true>(__source);
+    }
+
+    void merge(_Multiset &&__source) {
+        this->template _M_merge<true>(__source);
+    }
+
+    // 集合运算，结果留在 *this 中。右值版本在分配器相等时直接复用两边的节点，
+    // __other 被清空；复杂度 O(m log(n/m + 1))，m <= n 为两边的大小，
+    // 两边都很大时递归的两半交给不同的线程。const 版本先用 *this 的分配器
+    // 拷贝 __other，拷贝出来的节点才能接到 *this 上
+    void set_union(set &&__other) {
+        this->template _M_set_operation_from<_S_set_union>(__other);
+    }
+
+    void set_union(const set &__other) {
+        this->set_union(_M_copy_sharing_alloc(__other));
+    }
+
+    void set_intersection(set &&__other) {
+        this->template _M_set_operation_from<_S_set_intersection>(__other);
+    }
+
+    void set_intersection(const set &__other) {
+        this->set_intersection(_M_copy_sharing_alloc(__other));
+    }
+
+    void set_difference(set &&__other) {
+        this->template _M_set_operation_from<_S_set_difference>(__other);
+    }
+
+    void set_difference(const set &__other) {
+        this->set_difference(_M_copy_sharing_alloc(__other));
+    }
+
+private:
+    // 分配器不相等时 __other 的节点不能直接接过来，先拷贝一份
+    template <_RbTreeSetOp _Op>
+    void _M_set_operation_from(set &__other) {
+        if (this->_M_alloc_equal(__other)) {
+            this->template _M_set_operation<_Op>(__other);
+        } else {
+            set __copy = _M_copy_sharing_alloc(__other);
+            __other.clear();
+            this->template _M_set_operation<_Op>(__copy);
+        }
+    }
+
+    set _M_copy_sharing_alloc(const set &__other) const {
+        set __copy(this->get_allocator(), __other._M_comp);
+        __copy.template _M_assign_sorted<true>(__other.begin(), __other.end());
+        return __copy;
+    }
 };
 
 template <typename _Tp, typename _Compare = std::less<_Tp>,
-          typename _Alloc = std::allocator<_Tp>>
-struct multiset : _RbTreeImpl<const _Tp, _Compare, _Alloc> {
-    using typename _RbTreeImpl<const _Tp, _Compare, _Alloc>::const_iterator;
-    using typename _RbTreeImpl<const _Tp, _Compare, _Alloc>::node_type;
+          typename _Alloc = std::allocator<_Tp>, bool _OrderStatistic = false>
+struct multiset
+    : _RbTreeImpl<const _Tp, _Compare, _Alloc,
+                  _RbTreeNodeImpl<const _Tp, _OrderStatistic>> {
+private:
+    using _Base = _RbTreeImpl<const _Tp, _Compare, _Alloc,
+                              _RbTreeNodeImpl<const _Tp, _OrderStatistic>>;
+    using _Set = set<_Tp, _Compare, _Alloc, _OrderStatistic>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::node_type;
     using iterator = const_iterator;
     using value_type = _Tp;
     using size_type = std::size_t;
@@ -144,15 +288,43 @@ struct multiset : _RbTreeImpl<const _Tp, _Compare, _Alloc> {
 
     multiset() = default;
 
-    explicit multiset(_Compare __comp)
-        : _RbTreeImpl<const _Tp, _Compare, _Alloc>(__comp) {}
+    explicit multiset(_Compare __comp) : _Base(__comp) {}
+
+    explicit multiset(const _Alloc &__alloc, _Compare __comp = _Compare())
+        : _Base(__alloc, __comp) {}
+
+    multiset(std::initializer_list<_Tp> __ilist, _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->_M_multi_insert(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    multiset(_InputIt __first, _InputIt __last, _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->_M_multi_insert(__first, __last);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    multiset(sorted_equivalent_t, _InputIt __first, _InputIt __last,
+             _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_sorted<false>(__first, __last);
+    }
+
+    multiset(sorted_equivalent_t, std::initializer_list<_Tp> __ilist,
+             _Compare __comp = _Compare())
+        : _Base(__comp) {
+        this->template _M_assign_sorted<false>(__ilist.begin(), __ilist.end());
+    }
 
     multiset(multiset &&) = default;
 
     multiset &operator=(multiset &&) = default;
 
     multiset(const multiset &__other)
-        : _RbTreeImpl<const _Tp, _Compare, _Alloc>() {
+        : _Base(typename _Base::_EmptyCopyTag{}, __other) {
         this->_M_multi_insert(__other.begin(), __other.end());
     }
 
@@ -200,22 +372,44 @@ struct multiset : _RbTreeImpl<const _Tp, _Compare, _Alloc> {
         return this->_M_multi_emplace(std::forward<_Ts>(__value)...);
     }
 
+    // 等价的值插在尽量靠近 __hint 之前的位置
+    template <typename... _Ts>
+    iterator emplace_hint(const_iterator __hint, _Ts &&...__value) {
+        return this->_M_multi_emplace_hint(__hint,
+                                           std::forward<_Ts>(__value)...);
+    }
+
+    iterator insert(const_iterator __hint, _Tp &&__value) {
+        return this->_M_multi_emplace_hint(__hint, std::move(__value));
+    }
+
+    iterator insert(const_iterator __hint, const _Tp &__value) {
+        return this->_M_multi_emplace_hint(__hint, __value);
+    }
+
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     void insert(_InputIt __first, _InputIt __last) {
         return this->_M_multi_insert(__first, __last);
     }
 
-    using _RbTreeImpl<const _Tp, _Compare, _Alloc>::assign;
+    using _Base::assign;
 
     template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
                                                      _InputIt)>
     void assign(_InputIt __first, _InputIt __last) {
         this->clear();
-        return this->_M_multi_insert(__first, __last);
+        this->_M_multi_insert(__first, __last);
+    }
+
+    // [__first, __last) 必须已排好序，O(n) 建树
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(sorted_equivalent_t, _InputIt __first, _InputIt __last) {
+        this->template _M_assign_sorted<false>(__first, __last);
     }
 
-    using _RbTreeImpl<const _Tp, _Compare, _Alloc>::erase;
+    using _Base::erase;
 
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
@@ -247,6 +441,12 @@ struct multiset : _RbTreeImpl<const _Tp, _Compare, _Alloc> {
         return this->_M_contains(__value);
     }
 
+    iterator insert(node_type __nh) {
+        return this->_M_multi_insert(std::move(__nh));
+    }
+
+    using _Base::extract;
+
     template <class _Tv,
               _LIBPENGCXX_REQUIRES_TRANSPARENT_COMPARE(_Compare, _Tv, _Tp)>
     node_type extract(_Tv &&__value) {
@@ -258,6 +458,23 @@ struct multiset : _RbTreeImpl<const _Tp, _Compare, _Alloc> {
         iterator __it = this->_M_find(__value);
         return __it != this->end() ? this->extract(__it) : node_type();
     }
+
+    // 分配器相等时直接搬动节点，不重新分配，否则逐个移动元素
+    void merge(multiset &__source) {
+        this->template _M_merge<false>(__source);
+    }
+
+    void merge(multiset &&__source) {
+        this->template _M_merge<false>(__source);
+    }
+
+    void merge(_Set &__source) {
+        this->template _M_merge<false>(__source);
+    }
+
+    void merge(_Set &&__source) {
+        this->template _M_merge<false>(__source);
+    }
 };
 
 } // namespace Marcus
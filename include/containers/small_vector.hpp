@@ -0,0 +1,621 @@
+#pragma once
+
+#include <containers/vector.hpp>
+#include <core/_common.hpp>
+#include <core/_relocate.hpp>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace Marcus {
+
+// 前 _N 个元素直接存在对象内部，超过 _N 才向分配器要堆内存。
+// 接口与 Marcus::vector 一致；注意移动一个未溢出的 small_vector 需要逐个搬动元素，
+// 并且移动后迭代器失效。
+template <typename _Tp, std::size_t _N, typename _Alloc = std::allocator<_Tp>,
+          typename _Growth = vector_growth_x2>
+struct small_vector {
+    static_assert(_N > 0, "use Marcus::vector for an empty inline buffer");
+
+public:
+    using value_type = _Tp;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = _Tp *;
+    using const_pointer = const _Tp *;
+    using reference = _Tp &;
+    using const_reference = const _Tp &;
+    using iterator = _Tp *;
+    using const_iterator = const _Tp *;
+    using reverse_iterator = std::reverse_iterator<_Tp *>;
+    using const_reverse_iterator = std::reverse_iterator<const _Tp *>;
+    using growth_policy = _Growth;
+
+    static constexpr std::size_t inline_capacity = _N;
+
+private:
+    _Tp *_data;
+    std::size_t _size;
+    std::size_t _cap;
+    [[no_unique_address]] _Alloc _alloc;
+    alignas(_Tp) unsigned char _buf[_N * sizeof(_Tp)];
+
+    _Tp *_inline_data() noexcept {
+        return reinterpret_cast<_Tp *>(_buf);
+    }
+
+    bool _is_inline() const noexcept {
+        return _data == reinterpret_cast<const _Tp *>(_buf);
+    }
+
+    void _reset_inline() noexcept {
+        _data = _inline_data();
+        _size = 0;
+        _cap = _N;
+    }
+
+    // 销毁所有元素并归还堆内存，回到空的内联状态
+    void _release() noexcept {
+        clear();
+        if (!_is_inline()) {
+            _alloc.deallocate(_data, _cap);
+        }
+        _reset_inline();
+    }
+
+    // 从 _other 接管元素：堆上的直接偷指针，内联的逐个重定位过来
+    void _steal(small_vector &_other) noexcept(_is_nothrow_relocatable_v<_Tp>) {
+        if (_other._is_inline()) {
+            _uninitialized_relocate(_other._data, _other._data + _other._size,
+                                    _data);
+            _size = _other._size;
+        } else {
+            _data = _other._data;
+            _size = _other._size;
+            _cap = _other._cap;
+        }
+        _other._reset_inline();
+    }
+
+public:
+    small_vector() noexcept {
+        _reset_inline();
+    }
+
+    explicit small_vector(const _Alloc &alloc) noexcept : _alloc(alloc) {
+        _reset_inline();
+    }
+
+    small_vector(std::initializer_list<_Tp> _list,
+                 const _Alloc &alloc = _Alloc())
+        : small_vector(_list.begin(), _list.end(), alloc) {}
+
+    explicit small_vector(std::size_t _n, const _Alloc &alloc = _Alloc())
+        : _alloc(alloc) {
+        _reset_inline();
+        reserve(_n);
+        for (std::size_t _i = 0; _i != _n; ++_i) {
+            std::construct_at(&_data[_i]);
+            ++_size;
+        }
+    }
+
+    small_vector(std::size_t _n, const _Tp &val,
+                 const _Alloc &alloc = _Alloc())
+        : _alloc(alloc) {
+        _reset_inline();
+        reserve(_n);
+        for (std::size_t _i = 0; _i != _n; ++_i) {
+            std::construct_at(&_data[_i], val);
+            ++_size;
+        }
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(
+        std::random_access_iterator, _InputIt)>
+    small_vector(_InputIt _first, _InputIt _last,
+                 const _Alloc &alloc = _Alloc())
+        : _alloc(alloc) {
+        _reset_inline();
+        std::size_t _n = _last - _first;
+        reserve(_n);
+        for (std::size_t _i = 0; _i != _n; ++_i) {
+            std::construct_at(&_data[_i], *_first);
+            ++_first;
+            ++_size;
+        }
+    }
+
+    small_vector(small_vector &&_other) noexcept(
+        _is_nothrow_relocatable_v<_Tp>)
+        : _alloc(std::move(_other._alloc)) {
+        _reset_inline();
+        _steal(_other);
+    }
+
+    small_vector &operator=(small_vector &&_other) noexcept(
+        _is_nothrow_relocatable_v<_Tp>) {
+        if (&_other == this) [[unlikely]] {
+            return *this;
+        }
+        _release();
+        _alloc = std::move(_other._alloc);
+        _steal(_other);
+        return *this;
+    }
+
+    small_vector(const small_vector &_other) : _alloc(_other._alloc) {
+        _reset_inline();
+        reserve(_other._size);
+        for (std::size_t _i = 0; _i != _other._size; ++_i) {
+            std::construct_at(&_data[_i], std::as_const(_other._data[_i]));
+            ++_size;
+        }
+    }
+
+    small_vector &operator=(const small_vector &_other) {
+        if (&_other == this) [[unlikely]] {
+            return *this;
+        }
+        assign(_other.begin(), _other.end());
+        return *this;
+    }
+
+    small_vector &operator=(std::initializer_list<_Tp> _list) {
+        assign(_list.begin(), _list.end());
+        return *this;
+    }
+
+    void swap(small_vector &_other) noexcept(_is_nothrow_relocatable_v<_Tp>) {
+        if (!_is_inline() && !_other._is_inline()) {
+            std::swap(_data, _other._data);
+            std::swap(_size, _other._size);
+            std::swap(_cap, _other._cap);
+            std::swap(_alloc, _other._alloc);
+            return;
+        }
+        small_vector _tmp(std::move(_other));
+        _other = std::move(*this);
+        *this = std::move(_tmp);
+    }
+
+    void clear() noexcept {
+        for (std::size_t _i = 0; _i != _size; _i++) {
+            std::destroy_at(&_data[_i]);
+        }
+        _size = 0;
+    }
+
+    void resize(std::size_t _n) {
+        if (_n < _size) {
+            for (std::size_t _i = _n; _i != _size; _i++) {
+                std::destroy_at(&_data[_i]);
+            }
+        } else if (_n > _size) {
+            _grow(_n);
+            for (std::size_t _i = _size; _i != _n; _i++) {
+                std::construct_at(&_data[_i]);
+            }
+        }
+        _size = _n;
+    }
+
+    void resize(std::size_t _n, const _Tp &val) {
+        if (_n < _size) {
+            for (std::size_t _i = _n; _i != _size; _i++) {
+                std::destroy_at(&_data[_i]);
+            }
+        } else if (_n > _cap) {
+            // val 可能引用自身的元素，扩容前先复制一份
+            const _Tp _copy(val);
+            _grow(_n);
+            for (std::size_t _i = _size; _i != _n; _i++) {
+                std::construct_at(&_data[_i], _copy);
+            }
+        } else if (_n > _size) {
+            for (std::size_t _i = _size; _i != _n; _i++) {
+                std::construct_at(&_data[_i], val);
+            }
+        }
+        _size = _n;
+    }
+
+    // 元素个数不超过 _N 时搬回内联缓冲区
+    void shrink_to_fit() {
+        if (_is_inline() || _cap == _size) {
+            return;
+        }
+        _reallocate(_size);
+    }
+
+    void reserve(std::size_t _n) {
+        if (_n <= _cap) {
+            return;
+        }
+        _reallocate(_n);
+    }
+
+private:
+    void _grow(std::size_t _n) {
+        if (_n <= _cap) {
+            return;
+        }
+        _reallocate(_Growth::grow(_cap, _n));
+    }
+
+    // 向分配器要至少 _n 个元素的堆内存，实际容量写进 _got
+    _Tp *_allocate_heap(std::size_t _n, std::size_t &_got) {
+        if constexpr (_growth_allocates_at_least<_Growth>) {
+            auto _res = _allocate_at_least(_alloc, _n);
+            _got = _res.count;
+            return _res.ptr;
+        } else {
+            _got = _n;
+            return _alloc.allocate(_n);
+        }
+    }
+
+    // 换到能放下 _n 个元素的缓冲区：_n 不超过 _N 时用内联缓冲区。
+    // 分配或搬动元素抛出时 *this 保持不变
+    void _reallocate(std::size_t _n) {
+        _Tp *_new_data;
+        std::size_t _new_cap;
+        if (_n <= _N) {
+            _new_data = _inline_data();
+            _new_cap = _N;
+        } else {
+            _new_data = _allocate_heap(_n, _new_cap);
+        }
+        if (_new_data == _data) {
+            return;
+        }
+        try {
+            _uninitialized_relocate(_data, _data + _size, _new_data);
+        } catch (...) {
+            if (_n > _N) {
+                _alloc.deallocate(_new_data, _new_cap);
+            }
+            throw;
+        }
+        if (!_is_inline()) {
+            _alloc.deallocate(_data, _cap);
+        }
+        _data = _new_data;
+        _cap = _new_cap;
+    }
+
+    // 满了以后追加：参数可能引用自身的元素，所以先在新缓冲区里构造
+    // 新元素，再把旧元素搬过去
+    template <typename... Args>
+    _Tp &_emplace_back_realloc(Args &&..._args) {
+        std::size_t _new_cap;
+        _Tp *_new_data =
+            _allocate_heap(_Growth::grow(_cap, _size + 1), _new_cap);
+        _Tp *_p = _new_data + _size;
+        try {
+            std::construct_at(_p, std::forward<Args>(_args)...);
+        } catch (...) {
+            _alloc.deallocate(_new_data, _new_cap);
+            throw;
+        }
+        try {
+            _uninitialized_relocate(_data, _data + _size, _new_data);
+        } catch (...) {
+            std::destroy_at(_p);
+            _alloc.deallocate(_new_data, _new_cap);
+            throw;
+        }
+        if (!_is_inline()) {
+            _alloc.deallocate(_data, _cap);
+        }
+        _data = _new_data;
+        _cap = _new_cap;
+        _size = _size + 1;
+        return *_p;
+    }
+
+    // 在 _j 处插入从 _first 开始的 _n 个元素，_first 不能指向自身
+    template <typename _It>
+    _Tp *_insert_n(std::size_t _j, _It _first, std::size_t _n) {
+        _grow(_size + _n);
+        _make_gap(_j, _n);
+        _size += _n;
+        for (std::size_t _i = _j; _i != _j + _n; _i++) {
+            std::construct_at(&_data[_i], *_first);
+            ++_first;
+        }
+        return _data + _j;
+    }
+
+    // 把 [_j, _size) 整体后移 _n 位，空出未初始化的 [_j, _j + _n)
+    void _make_gap(std::size_t _j, std::size_t _n) {
+        _relocate_overlapping(_data + _j, _data + _size, _data + _j + _n);
+    }
+
+public:
+    std::size_t capacity() const noexcept {
+        return _cap;
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+    // 元素是否已经溢出到堆上
+    bool is_heap_allocated() const noexcept {
+        return !_is_inline();
+    }
+
+    static constexpr std::size_t max_size() noexcept {
+        return std::numeric_limits<std::size_t>::max() / sizeof(_Tp);
+    }
+
+    const _Tp &operator[](std::size_t _i) const noexcept {
+        return _data[_i];
+    }
+
+    _Tp &operator[](std::size_t _i) noexcept {
+        return _data[_i];
+    }
+
+    const _Tp &at(std::size_t _i) const {
+        if (_i >= _size) [[unlikely]] {
+            throw std::out_of_range("small_vector::at");
+        }
+        return _data[_i];
+    }
+
+    _Tp &at(std::size_t _i) {
+        if (_i >= _size) [[unlikely]] {
+            throw std::out_of_range("small_vector::at");
+        }
+        return _data[_i];
+    }
+
+    const _Tp &front() const noexcept {
+        return *_data;
+    }
+
+    _Tp &front() noexcept {
+        return *_data;
+    }
+
+    const _Tp &back() const noexcept {
+        return _data[_size - 1];
+    }
+
+    _Tp &back() noexcept {
+        return _data[_size - 1];
+    }
+
+    void push_back(const _Tp &val) {
+        emplace_back(val);
+    }
+
+    void push_back(_Tp &&val) {
+        emplace_back(std::move(val));
+    }
+
+    template <typename... Args>
+    _Tp &emplace_back(Args &&..._args) {
+        if (_size == _cap) [[unlikely]] {
+            return _emplace_back_realloc(std::forward<Args>(_args)...);
+        }
+        _Tp *_p = &_data[_size];
+        std::construct_at(_p, std::forward<Args>(_args)...);
+        _size = _size + 1;
+        return *_p;
+    }
+
+    _Tp *data() noexcept {
+        return _data;
+    }
+
+    const _Tp *data() const noexcept {
+        return _data;
+    }
+
+    const _Tp *cdata() const noexcept {
+        return _data;
+    }
+
+    _Tp *begin() noexcept {
+        return _data;
+    }
+
+    _Tp *end() noexcept {
+        return _data + _size;
+    }
+
+    const _Tp *begin() const noexcept {
+        return _data;
+    }
+
+    const _Tp *end() const noexcept {
+        return _data + _size;
+    }
+
+    const _Tp *cbegin() const noexcept {
+        return _data;
+    }
+
+    const _Tp *cend() const noexcept {
+        return _data + _size;
+    }
+
+    std::reverse_iterator<_Tp *> rbegin() noexcept {
+        return std::make_reverse_iterator(_data + _size);
+    }
+
+    std::reverse_iterator<_Tp *> rend() noexcept {
+        return std::make_reverse_iterator(_data);
+    }
+
+    std::reverse_iterator<const _Tp *> rbegin() const noexcept {
+        return std::make_reverse_iterator(_data + _size);
+    }
+
+    std::reverse_iterator<const _Tp *> rend() const noexcept {
+        return std::make_reverse_iterator(_data);
+    }
+
+    std::reverse_iterator<const _Tp *> crbegin() const noexcept {
+        return std::make_reverse_iterator(_data + _size);
+    }
+
+    std::reverse_iterator<const _Tp *> crend() const noexcept {
+        return std::make_reverse_iterator(_data);
+    }
+
+    void pop_back() noexcept {
+        _size -= 1;
+        std::destroy_at(&_data[_size]);
+    }
+
+    _Tp *
+    erase(const _Tp *_it) noexcept(std::is_nothrow_move_assignable_v<_Tp>) {
+        return erase(_it, _it + 1);
+    }
+
+    // [_first, _last)
+    _Tp *
+    erase(const _Tp *_first,
+          const _Tp *_last) noexcept(std::is_nothrow_move_assignable_v<_Tp>) {
+        std::size_t diff = _last - _first;
+        if constexpr (is_trivially_relocatable_v<_Tp>) {
+            std::size_t _i = _first - _data;
+            for (std::size_t _j = _i; _j != _i + diff; _j++) {
+                std::destroy_at(&_data[_j]);
+            }
+            _relocate_overlapping(_data + _i + diff, _data + _size,
+                                  _data + _i);
+            _size -= diff;
+        } else {
+            for (std::size_t _j = _last - _data; _j != _size; _j++) {
+                _data[_j - diff] = std::move(_data[_j]);
+            }
+            _size -= diff;
+            for (std::size_t _j = _size; _j != _size + diff; _j++) {
+                std::destroy_at(&_data[_j]);
+            }
+        }
+        return const_cast<_Tp *>(_first);
+    }
+
+    void assign(std::size_t _n, const _Tp &val) {
+        clear();
+        reserve(_n);
+        for (std::size_t _i = 0; _i != _n; _i++) {
+            std::construct_at(&_data[_i], val);
+            ++_size;
+        }
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(
+        std::random_access_iterator, _InputIt)>
+    void assign(_InputIt _first, _InputIt _last) {
+        clear();
+        std::size_t _n = _last - _first;
+        reserve(_n);
+        for (std::size_t _i = 0; _i != _n; _i++) {
+            std::construct_at(&_data[_i], *_first);
+            ++_first;
+            ++_size;
+        }
+    }
+
+    void assign(std::initializer_list<_Tp> _list) {
+        assign(_list.begin(), _list.end());
+    }
+
+    template <typename... Args>
+    _Tp *emplace(const _Tp *_it, Args &&...args) {
+        std::size_t _j = _it - _data;
+        if (_j == _size) {
+            emplace_back(std::forward<Args>(args)...);
+            return _data + _j;
+        }
+        // 参数可能引用自身的元素，先构造出来再挪位置
+        _Tp _tmp(std::forward<Args>(args)...);
+        _grow(_size + 1);
+        _make_gap(_j, 1);
+        std::construct_at(&_data[_j], std::move(_tmp));
+        _size += 1;
+        return _data + _j;
+    }
+
+    _Tp *insert(const _Tp *_it, _Tp &&val) {
+        return emplace(_it, std::move(val));
+    }
+
+    _Tp *insert(const _Tp *_it, const _Tp &val) {
+        return emplace(_it, val);
+    }
+
+    _Tp *insert(const _Tp *_it, std::size_t _n, const _Tp &val) {
+        std::size_t _j = _it - _data;
+        if (_n == 0) [[unlikely]] {
+            return const_cast<_Tp *>(_it);
+        }
+        const _Tp _copy(val);
+        _grow(_size + _n);
+        _make_gap(_j, _n);
+        _size += _n;
+        for (std::size_t _i = _j; _i != _j + _n; _i++) {
+            std::construct_at(&_data[_i], _copy);
+        }
+        return _data + _j;
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(
+        std::random_access_iterator, _InputIt)>
+    _Tp *insert(const _Tp *_it, _InputIt _first, _InputIt _last) {
+        std::size_t _j = _it - _data;
+        std::size_t _n = _last - _first;
+        if (_n == 0) [[unlikely]] {
+            return const_cast<_Tp *>(_it);
+        }
+        // 区间取自自身时，扩容和挪位置都会动到它，先复制出来
+        if constexpr (std::is_lvalue_reference_v<
+                          std::iter_reference_t<_InputIt>> &&
+                      std::is_same_v<
+                          std::remove_cvref_t<std::iter_reference_t<_InputIt>>,
+                          _Tp>) {
+            const _Tp *_src = std::addressof(*_first);
+            if (!std::less<const _Tp *>()(_src, _data) &&
+                std::less<const _Tp *>()(_src, _data + _size)) [[unlikely]] {
+                small_vector _tmp(_first, _last, _alloc);
+                return _insert_n(_j, std::make_move_iterator(_tmp.begin()),
+                                 _n);
+            }
+        }
+        return _insert_n(_j, _first, _n);
+    }
+
+    _Tp *insert(const _Tp *_it, std::initializer_list<_Tp> _list) {
+        return insert(_it, _list.begin(), _list.end());
+    }
+
+    ~small_vector() noexcept {
+        clear();
+        if (!_is_inline()) {
+            _alloc.deallocate(_data, _cap);
+        }
+    }
+
+    _Alloc get_allocator() const noexcept {
+        return _alloc;
+    }
+
+    _LIBPENGCXX_DEFINE_COMPARISON(small_vector);
+};
+
+} // namespace Marcus
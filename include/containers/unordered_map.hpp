@@ -0,0 +1,293 @@
+#pragma once
+
+#include <containers/core/_SwissTable.hpp>
+#include <core/_common.hpp>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+
+namespace Marcus {
+
+// 开放寻址哈希表，插入、扩容和 erase 都会使迭代器与元素引用失效
+template <typename _Key, typename _Mapped, typename _Hash = std::hash<_Key>,
+          typename _KeyEqual = std::equal_to<_Key>,
+          typename _Alloc = std::allocator<std::pair<const _Key, _Mapped>>>
+struct unordered_map
+    : _SwissTableImpl<std::pair<const _Key, _Mapped>, _SwissSelectFirst, _Hash,
+                      _KeyEqual, _Alloc> {
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<const _Key, _Mapped>;
+    using hasher = _Hash;
+    using key_equal = _KeyEqual;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+private:
+    using _Base =
+        _SwissTableImpl<value_type, _SwissSelectFirst, _Hash, _KeyEqual, _Alloc>;
+
+public:
+    using typename _Base::const_iterator;
+    using typename _Base::iterator;
+
+    unordered_map() = default;
+
+    explicit unordered_map(size_type __bucket_count,
+                           const _Hash &__hash = _Hash(),
+                           const _KeyEqual &__eq = _KeyEqual(),
+                           const _Alloc &__alloc = _Alloc())
+        : _Base(__bucket_count, __hash, __eq, __alloc) {}
+
+    unordered_map(std::initializer_list<value_type> __ilist,
+                  size_type __bucket_count = 0, const _Hash &__hash = _Hash(),
+                  const _KeyEqual &__eq = _KeyEqual(),
+                  const _Alloc &__alloc = _Alloc())
+        : _Base(__bucket_count, __hash, __eq, __alloc) {
+        this->_M_insert_range(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    unordered_map(_InputIt __first, _InputIt __last,
+                  size_type __bucket_count = 0, const _Hash &__hash = _Hash(),
+                  const _KeyEqual &__eq = _KeyEqual(),
+                  const _Alloc &__alloc = _Alloc())
+        : _Base(__bucket_count, __hash, __eq, __alloc) {
+        this->_M_insert_range(__first, __last);
+    }
+
+    unordered_map(unordered_map &&) = default;
+
+    unordered_map &operator=(unordered_map &&) = default;
+
+    unordered_map(const unordered_map &) = default;
+
+    unordered_map &operator=(const unordered_map &) = default;
+
+    unordered_map &operator=(std::initializer_list<value_type> __ilist) {
+        this->assign(__ilist);
+        return *this;
+    }
+
+    void assign(std::initializer_list<value_type> __ilist) {
+        this->clear();
+        this->_M_insert_range(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(_InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_insert_range(__first, __last);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    iterator find(const _Kv &__key) {
+        return this->_M_find(__key);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    const_iterator find(const _Kv &__key) const {
+        return this->_M_find(__key);
+    }
+
+    iterator find(const _Key &__key) {
+        return this->_M_find(__key);
+    }
+
+    const_iterator find(const _Key &__key) const {
+        return this->_M_find(__key);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    bool contains(const _Kv &__key) const {
+        return this->_M_contains(__key);
+    }
+
+    bool contains(const _Key &__key) const {
+        return this->_M_contains(__key);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    size_type count(const _Kv &__key) const {
+        return this->_M_contains(__key) ? 1 : 0;
+    }
+
+    size_type count(const _Key &__key) const {
+        return this->_M_contains(__key) ? 1 : 0;
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    std::pair<iterator, iterator> equal_range(const _Kv &__key) {
+        iterator __it = this->_M_find(__key);
+        return {__it, __it == this->end() ? __it : std::next(__it)};
+    }
+
+    std::pair<iterator, iterator> equal_range(const _Key &__key) {
+        iterator __it = this->_M_find(__key);
+        return {__it, __it == this->end() ? __it : std::next(__it)};
+    }
+
+    std::pair<const_iterator, const_iterator>
+    equal_range(const _Key &__key) const {
+        const_iterator __it = this->_M_find(__key);
+        return {__it, __it == this->end() ? __it : std::next(__it)};
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    const _Mapped &at(const _Kv &__key) const {
+        const_iterator __it = this->_M_find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("unordered_map::at");
+        }
+        return __it->second;
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    _Mapped &at(const _Kv &__key) {
+        iterator __it = this->_M_find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("unordered_map::at");
+        }
+        return __it->second;
+    }
+
+    const _Mapped &at(const _Key &__key) const {
+        const_iterator __it = this->_M_find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("unordered_map::at");
+        }
+        return __it->second;
+    }
+
+    _Mapped &at(const _Key &__key) {
+        iterator __it = this->_M_find(__key);
+        if (__it == this->end()) [[unlikely]] {
+            throw std::out_of_range("unordered_map::at");
+        }
+        return __it->second;
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    _Mapped &operator[](const _Kv &__key) {
+        return this
+            ->_M_try_emplace_key(__key, std::piecewise_construct,
+                                 std::forward_as_tuple(__key),
+                                 std::forward_as_tuple())
+            .first->second;
+    }
+
+    _Mapped &operator[](const _Key &__key) {
+        return this
+            ->_M_try_emplace_key(__key, std::piecewise_construct,
+                                 std::forward_as_tuple(__key),
+                                 std::forward_as_tuple())
+            .first->second;
+    }
+
+    _Mapped &operator[](_Key &&__key) {
+        return this
+            ->_M_try_emplace_key(__key, std::piecewise_construct,
+                                 std::forward_as_tuple(std::move(__key)),
+                                 std::forward_as_tuple())
+            .first->second;
+    }
+
+    std::pair<iterator, bool> insert(value_type &&__value) {
+        return this->_M_try_emplace_key(__value.first, std::move(__value));
+    }
+
+    std::pair<iterator, bool> insert(const value_type &__value) {
+        return this->_M_try_emplace_key(__value.first, __value);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_insert_range(__first, __last);
+    }
+
+    void insert(std::initializer_list<value_type> __ilist) {
+        this->_M_insert_range(__ilist.begin(), __ilist.end());
+    }
+
+    template <typename _Mp,
+              typename = std::enable_if_t<std::is_convertible_v<_Mp, _Mapped>>>
+    std::pair<iterator, bool> insert_or_assign(const _Key &__key,
+                                               _Mp &&__mapped) {
+        std::pair<iterator, bool> __result = this->_M_try_emplace_key(
+            __key, std::piecewise_construct, std::forward_as_tuple(__key),
+            std::forward_as_tuple(std::forward<_Mp>(__mapped)));
+        if (!__result.second) {
+            __result.first->second = std::forward<_Mp>(__mapped);
+        }
+        return __result;
+    }
+
+    template <typename _Mp,
+              typename = std::enable_if_t<std::is_convertible_v<_Mp, _Mapped>>>
+    std::pair<iterator, bool> insert_or_assign(_Key &&__key, _Mp &&__mapped) {
+        std::pair<iterator, bool> __result = this->_M_try_emplace_key(
+            __key, std::piecewise_construct,
+            std::forward_as_tuple(std::move(__key)),
+            std::forward_as_tuple(std::forward<_Mp>(__mapped)));
+        if (!__result.second) {
+            __result.first->second = std::forward<_Mp>(__mapped);
+        }
+        return __result;
+    }
+
+    template <typename... Vs>
+    std::pair<iterator, bool> emplace(Vs &&...__value) {
+        return this->_M_emplace(std::forward<Vs>(__value)...);
+    }
+
+    template <typename... _Ms>
+    std::pair<iterator, bool> try_emplace(_Key &&__key, _Ms &&...__mapped) {
+        return this->_M_try_emplace_key(
+            __key, std::piecewise_construct,
+            std::forward_as_tuple(std::move(__key)),
+            std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
+    }
+
+    template <typename... _Ms>
+    std::pair<iterator, bool> try_emplace(const _Key &__key,
+                                          _Ms &&...__mapped) {
+        return this->_M_try_emplace_key(
+            __key, std::piecewise_construct, std::forward_as_tuple(__key),
+            std::forward_as_tuple(std::forward<_Ms>(__mapped)...));
+    }
+
+    using _Base::erase;
+
+    iterator erase(iterator __it) noexcept {
+        return _Base::erase(const_iterator(__it));
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    size_type erase(const _Kv &__key) {
+        return this->_M_erase_key(__key);
+    }
+
+    size_type erase(const _Key &__key) {
+        return this->_M_erase_key(__key);
+    }
+
+    bool operator==(const unordered_map &__that) const {
+        return this->_M_equal(__that);
+    }
+};
+
+} // namespace Marcus
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <containers/core/_SwissTable.hpp>
+#include <core/_common.hpp>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+
+namespace Marcus {
+
+// 开放寻址哈希集合，插入、扩容和 erase 都会使迭代器与元素引用失效
+template <typename _Tp, typename _Hash = std::hash<_Tp>,
+          typename _KeyEqual = std::equal_to<_Tp>,
+          typename _Alloc = std::allocator<_Tp>>
+struct unordered_set
+    : _SwissTableImpl<const _Tp, _SwissIdentity, _Hash, _KeyEqual, _Alloc> {
+    using key_type = _Tp;
+    using value_type = _Tp;
+    using hasher = _Hash;
+    using key_equal = _KeyEqual;
+    using allocator_type = _Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+private:
+    using _Base =
+        _SwissTableImpl<const _Tp, _SwissIdentity, _Hash, _KeyEqual, _Alloc>;
+
+public:
+    using typename _Base::const_iterator;
+    using iterator = const_iterator;
+
+    unordered_set() = default;
+
+    explicit unordered_set(size_type __bucket_count,
+                           const _Hash &__hash = _Hash(),
+                           const _KeyEqual &__eq = _KeyEqual(),
+                           const _Alloc &__alloc = _Alloc())
+        : _Base(__bucket_count, __hash, __eq, __alloc) {}
+
+    unordered_set(std::initializer_list<_Tp> __ilist,
+                  size_type __bucket_count = 0, const _Hash &__hash = _Hash(),
+                  const _KeyEqual &__eq = _KeyEqual(),
+                  const _Alloc &__alloc = _Alloc())
+        : _Base(__bucket_count, __hash, __eq, __alloc) {
+        this->_M_insert_range(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    unordered_set(_InputIt __first, _InputIt __last,
+                  size_type __bucket_count = 0, const _Hash &__hash = _Hash(),
+                  const _KeyEqual &__eq = _KeyEqual(),
+                  const _Alloc &__alloc = _Alloc())
+        : _Base(__bucket_count, __hash, __eq, __alloc) {
+        this->_M_insert_range(__first, __last);
+    }
+
+    unordered_set(unordered_set &&) = default;
+
+    unordered_set &operator=(unordered_set &&) = default;
+
+    unordered_set(const unordered_set &) = default;
+
+    unordered_set &operator=(const unordered_set &) = default;
+
+    unordered_set &operator=(std::initializer_list<_Tp> __ilist) {
+        this->assign(__ilist);
+        return *this;
+    }
+
+    void assign(std::initializer_list<_Tp> __ilist) {
+        this->clear();
+        this->_M_insert_range(__ilist.begin(), __ilist.end());
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void assign(_InputIt __first, _InputIt __last) {
+        this->clear();
+        this->_M_insert_range(__first, __last);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    const_iterator find(const _Kv &__value) const {
+        return this->_M_find(__value);
+    }
+
+    const_iterator find(const _Tp &__value) const {
+        return this->_M_find(__value);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    bool contains(const _Kv &__value) const {
+        return this->_M_contains(__value);
+    }
+
+    bool contains(const _Tp &__value) const {
+        return this->_M_contains(__value);
+    }
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    size_type count(const _Kv &__value) const {
+        return this->_M_contains(__value) ? 1 : 0;
+    }
+
+    size_type count(const _Tp &__value) const {
+        return this->_M_contains(__value) ? 1 : 0;
+    }
+
+    std::pair<const_iterator, const_iterator>
+    equal_range(const _Tp &__value) const {
+        const_iterator __it = this->_M_find(__value);
+        return {__it, __it == this->end() ? __it : std::next(__it)};
+    }
+
+    std::pair<iterator, bool> insert(_Tp &&__value) {
+        return this->_M_try_emplace_key(__value, std::move(__value));
+    }
+
+    std::pair<iterator, bool> insert(const _Tp &__value) {
+        return this->_M_try_emplace_key(__value, __value);
+    }
+
+    template <_LIBPENGCXX_REQUIRES_ITERATOR_CATEGORY(std::input_iterator,
+                                                     _InputIt)>
+    void insert(_InputIt __first, _InputIt __last) {
+        this->_M_insert_range(__first, __last);
+    }
+
+    void insert(std::initializer_list<_Tp> __ilist) {
+        this->_M_insert_range(__ilist.begin(), __ilist.end());
+    }
+
+    template <typename... _Ts>
+    std::pair<iterator, bool> emplace(_Ts &&...__value) {
+        return this->_M_emplace(std::forward<_Ts>(__value)...);
+    }
+
+    using _Base::erase;
+
+    template <typename _Kv,
+              _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual)>
+    size_type erase(const _Kv &__value) {
+        return this->_M_erase_key(__value);
+    }
+
+    size_type erase(const _Tp &__value) {
+        return this->_M_erase_key(__value);
+    }
+
+    bool operator==(const unordered_set &__that) const {
+        return this->_M_equal(__that);
+    }
+};
+
+} // namespace Marcus
@@ -1,13 +1,91 @@
 #pragma once
 
 #include <core/_common.hpp>
+#include <bit>
+#include <core/_relocate.hpp>
 #include <initializer_list>
 #include <limits>
 #include <memory>
 
 namespace Marcus {
 
-template <typename _Tp, typename _Alloc = std::allocator<_Tp>>
+// vector 的增长策略：grow(当前容量, 至少需要的容量) 返回新容量。
+// push_back / insert / resize 需要扩容时使用；reserve(n) 不经过增长策略。
+
+// 翻倍：摊还次数最少，但峰值内存最多可达所需的 3 倍（新旧缓冲区同时存在）
+struct vector_growth_x2 {
+    static constexpr std::size_t grow(std::size_t __cap,
+                                      std::size_t __need) noexcept {
+        return std::max(__need, __cap * 2);
+    }
+};
+
+// 1.5 倍：释放掉的旧缓冲区之和最终能容纳新的缓冲区，峰值内存约为所需的 2.5 倍
+struct vector_growth_x1_5 {
+    static constexpr std::size_t grow(std::size_t __cap,
+                                      std::size_t __need) noexcept {
+        return std::max(__need, __cap + __cap / 2);
+    }
+};
+
+// 每次固定多 _Step 个元素：内存最省，但 push_back 退化为摊还 O(n)
+template <std::size_t _Step>
+struct vector_growth_fixed {
+    static_assert(_Step > 0);
+
+    static constexpr std::size_t grow(std::size_t __cap,
+                                      std::size_t __need) noexcept {
+        return std::max(__need, __cap + _Step);
+    }
+};
+
+// 在 _Base 的基础上向分配器要“至少”这么多：分配器所在的大小档位多出来的
+// 字节也算进容量里，见 _allocate_at_least
+template <class _Base = vector_growth_x1_5>
+struct vector_growth_at_least : _Base {
+    static constexpr bool allocate_at_least = true;
+};
+
+template <class _Growth>
+concept _growth_allocates_at_least = _Growth::allocate_at_least;
+
+// 按 jemalloc / tcmalloc 的大小档位向上取整：128 字节以内按 16 对齐，
+// 之后每个 2 的幂区间平分为 4 档
+inline std::size_t _malloc_good_size(std::size_t __bytes) noexcept {
+    if (__bytes <= 128) {
+        return std::max<std::size_t>((__bytes + 15) & ~std::size_t(15), 16);
+    }
+    std::size_t __step = std::bit_floor(__bytes - 1) / 4;
+    return (__bytes + __step - 1) & ~(__step - 1);
+}
+
+template <class _Pointer>
+struct _allocation_result {
+    _Pointer ptr;
+    std::size_t count;
+};
+
+// 分配器提供 allocate_at_least (C++23) 时直接用它的结果，
+// 否则按常见的 malloc 大小档位多要一点，反正这部分字节本来也会被浪费
+template <class _Alloc>
+auto _allocate_at_least(_Alloc &__alloc, std::size_t __n) {
+    using _Pointer = typename std::allocator_traits<_Alloc>::pointer;
+    if constexpr (requires { __alloc.allocate_at_least(__n); }) {
+        auto __res = __alloc.allocate_at_least(__n);
+        return _allocation_result<_Pointer>{__res.ptr, __res.count};
+    } else {
+        using _Tp = typename std::allocator_traits<_Alloc>::value_type;
+        std::size_t __count = __n;
+        if (__n <= std::numeric_limits<std::size_t>::max() / 2 / sizeof(_Tp)) {
+            __count = _malloc_good_size(__n * sizeof(_Tp)) / sizeof(_Tp);
+        }
+        return _allocation_result<_Pointer>{__alloc.allocate(__count),
+                                            __count};
+    }
+}
+
+template <typename _Tp, typename _Alloc = std::allocator<_Tp>,
+          typename _Growth = vector_growth_x2>
 struct vector {
 public:
     using value_type = _Tp;
@@ -22,6 +100,7 @@ public:
     using const_iterator = const _Tp *;
     using reverse_iterator = std::reverse_iterator<_Tp *>;
     using const_reverse_iterator = std::reverse_iterator<const _Tp *>;
+    using growth_policy = _Growth;
 
 private:
     _Tp *_data;
@@ -36,6 +115,12 @@ public:
         _cap = 0;
     }
 
+    explicit vector(const _Alloc &alloc) noexcept : _alloc(alloc) {
+        _data = nullptr;
+        _size = 0;
+        _cap = 0;
+    }
+
     vector(std::initializer_list<_Tp> _list, const _Alloc &alloc = _Alloc())
         : vector(_list.begin(), _list.end(), alloc) {}
 
@@ -51,6 +136,7 @@ public:
     vector(std::size_t _n, const _Tp &val, const _Alloc &alloc = _Alloc())
         : _alloc(alloc) {
         _data = _alloc.allocate(_n);
+        _cap = _size = _n;
         for (std::size_t _i = 0; _i != _n; _i++) {
             std::construct_at(&_data[_i], val);
         }
@@ -102,6 +188,10 @@ public:
         if (_cap != 0) {
             _alloc.deallocate(_data, _cap);
         }
+        if constexpr (std::allocator_traits<
+                          _Alloc>::propagate_on_container_move_assignment::value) {
+            _alloc = std::move(_other._alloc);
+        }
         _data = _other._data;
         _size = _other._size;
         _cap = _other._cap;
@@ -173,7 +263,7 @@ public:
             }
             _size = _n;
         } else if (_n > _size) {
-            reserve(_n);
+            _grow(_n);
             for (std::size_t _i = _size; _i != _n; _i++) {
                 std::construct_at(&_data[_i]);
             }
@@ -188,7 +278,7 @@ public:
             }
             _size = _n;
         } else if (_n > _size) {
-            reserve(_n);
+            _grow(_n);
             for (std::size_t _i = _size; _i != _n; _i++) {
                 std::construct_at(&_data[_i], val);
             }
@@ -197,51 +287,64 @@ public:
     }
 
     void shrink_to_fit() noexcept {
-        auto _old_data = _data;
-        auto _old_cap = _cap;
-        _cap = _size;
-        if (_size == 0) {
-            _data = nullptr;
-        } else {
-            _data = _alloc.allocate(_size);
+        if (_cap == _size) {
+            return;
         }
+        // 按大小档位取整的话容量仍然大于 _size，之后每次调用都会重新分配
+        _reallocate(_size, true);
+    }
 
-        if (_old_cap != 0) [[likely]] {
-            for (std::size_t _i = 0; _i != _size; _i++) {
-                std::construct_at(&_data[_i],
-                                  std::move_if_noexcept(_old_data[_i]));
-                std::destroy_at(&_old_data[_i]);
-            }
-            _alloc.deallocate(_old_data, _old_cap);
+    void reserve(std::size_t _n) {
+        if (_n <= _cap) {
+            return;
         }
+        _reallocate(_n);
     }
 
-    void reserve(std::size_t _n) {
-        if (_n < _cap) {
+private:
+    // 容量不足 _n 时按增长策略扩容
+    void _grow(std::size_t _n) {
+        if (_n <= _cap) {
             return;
         }
-        _n = std::max(_n, _cap * 2);
-        auto _old_data = _data;
-        auto _old_cap = _cap;
-        if (_n == 0) {
-            _data = nullptr;
-            _cap = 0;
-        } else {
-            _data = _alloc.allocate(_n);
-            _cap = _n;
+        _reallocate(_Growth::grow(_cap, _n));
+    }
+
+    // 换到容量为 _n 的新缓冲区；可平凡重定位的元素整体 memcpy 过去。
+    // _exact 时容量恰好为 _n，不按大小档位取整。
+    // 分配或搬动元素抛出时 *this 保持不变
+    void _reallocate(std::size_t _n, bool _exact = false) {
+        _Tp *_new_data = nullptr;
+        std::size_t _new_cap = 0;
+        if (_n != 0 && _growth_allocates_at_least<_Growth> && !_exact) {
+            auto _res = _allocate_at_least(_alloc, _n);
+            _new_data = _res.ptr;
+            _new_cap = _res.count;
+        } else if (_n != 0) {
+            _new_data = _alloc.allocate(_n);
+            _new_cap = _n;
         }
-        if (_old_cap != 0) {
-            for (std::size_t _i = 0; _i != _size; _i++) {
-                std::construct_at(&_data[_i],
-                                  std::move_if_noexcept(_old_data[_i]));
-            }
-            for (std::size_t _i = 0; _i != _size; _i++) {
-                std::destroy_at(&_old_data[_i]);
+        if (_cap != 0) {
+            try {
+                _uninitialized_relocate(_data, _data + _size, _new_data);
+            } catch (...) {
+                if (_new_cap != 0) {
+                    _alloc.deallocate(_new_data, _new_cap);
+                }
+                throw;
             }
-            _alloc.deallocate(_old_data, _old_cap);
+            _alloc.deallocate(_data, _cap);
         }
+        _data = _new_data;
+        _cap = _new_cap;
+    }
+
+    // 把 [_j, _size) 整体后移 _n 位，空出未初始化的 [_j, _j + _n)
+    void _make_gap(std::size_t _j, std::size_t _n) {
+        _relocate_overlapping(_data + _j, _data + _size, _data + _j + _n);
     }
 
+public:
     std::size_t capacity() const noexcept {
         return _cap;
     }
@@ -297,16 +400,16 @@ public:
     }
 
     void push_back(const _Tp &val) {
-        if (_size + 1 >= _cap) [[unlikely]] {
-            reserve(_size + 1);
+        if (_size == _cap) [[unlikely]] {
+            _grow(_size + 1);
         }
         std::construct_at(&_data[_size], val);
         _size = _size + 1;
     }
 
     void push_back(_Tp &&val) {
-        if (_size + 1 >= _cap) [[unlikely]] {
-            reserve(_size + 1);
+        if (_size == _cap) [[unlikely]] {
+            _grow(_size + 1);
         }
         std::construct_at(&_data[_size], std::move(val));
         _size = _size + 1;
@@ -314,8 +417,8 @@ public:
 
     template <typename... Args>
     _Tp &emplace_back(Args &&..._args) {
-        if (_size + 1 >= _cap) [[unlikely]] {
-            reserve(_size + 1);
+        if (_size == _cap) [[unlikely]] {
+            _grow(_size + 1);
         }
         _Tp *_p = &_data[_size];
         std::construct_at(_p, std::forward<Args>(_args)...);
@@ -391,11 +494,17 @@ public:
     _Tp *
     erase(const _Tp *_it) noexcept(std::is_nothrow_move_assignable_v<_Tp>) {
         std::size_t _i = _it - _data;
-        for (std::size_t _j = _i + 1; _j != _size; _j++) {
-            _data[_j - 1] = std::move(_data[_j]);
+        if constexpr (is_trivially_relocatable_v<_Tp>) {
+            std::destroy_at(&_data[_i]);
+            _relocate_overlapping(_data + _i + 1, _data + _size, _data + _i);
+            _size -= 1;
+        } else {
+            for (std::size_t _j = _i + 1; _j != _size; _j++) {
+                _data[_j - 1] = std::move(_data[_j]);
+            }
+            _size -= 1;
+            std::destroy_at(&_data[_size]);
         }
-        _size -= 1;
-        std::destroy_at(&_data[_size]);
         return const_cast<_Tp *>(_it);
     }
 
@@ -404,12 +513,22 @@ public:
     erase(const _Tp *_first,
           const _Tp *_last) noexcept(std::is_nothrow_move_assignable_v<_Tp>) {
         std::size_t diff = _last - _first;
-        for (std::size_t _j = _last - _data; _j != _size; _j++) {
-            _data[_j - diff] = std::move(_data[_j]);
-        }
-        _size -= diff;
-        for (std::size_t _j = _size; _j != _size + diff; _j++) {
-            std::destroy_at(&_data[_j]);
+        if constexpr (is_trivially_relocatable_v<_Tp>) {
+            std::size_t _i = _first - _data;
+            for (std::size_t _j = _i; _j != _i + diff; _j++) {
+                std::destroy_at(&_data[_j]);
+            }
+            _relocate_overlapping(_data + _i + diff, _data + _size,
+                                  _data + _i);
+            _size -= diff;
+        } else {
+            for (std::size_t _j = _last - _data; _j != _size; _j++) {
+                _data[_j - diff] = std::move(_data[_j]);
+            }
+            _size -= diff;
+            for (std::size_t _j = _size; _j != _size + diff; _j++) {
+                std::destroy_at(&_data[_j]);
+            }
         }
         return const_cast<_Tp *>(_first);
     }
@@ -443,12 +562,9 @@ public:
     template <typename... Args>
     _Tp *emplace(const _Tp *_it, Args &&...args) {
         std::size_t _j = _it - _data; // _j : insert index
-        reserve(_size + 1);
+        _grow(_size + 1);
         // shift backward
-        for (std::size_t _i = _size; _i != _j; _i--) {
-            std::construct_at(&_data[_i], std::move(_data[_i - 1]));
-            std::destroy_at(&_data[_i - 1]);
-        }
+        _make_gap(_j, 1);
         _size += 1;
         std::construct_at(&_data[_j], std::forward<Args>(args)...);
         return _data + _j;
@@ -456,11 +572,8 @@ public:
 
     _Tp *insert(const _Tp *_it, _Tp &&val) {
         std::size_t _j = _it - _data;
-        reserve(_size + 1);
-        for (std::size_t _i = _size; _i != _j; _i--) {
-            std::construct_at(&_data[_i], std::move(_data[_i - 1]));
-            std::destroy_at(&_data[_i - 1]);
-        }
+        _grow(_size + 1);
+        _make_gap(_j, 1);
         _size += 1;
         std::construct_at(&_data[_j], std::move(val));
         return _data + _j;
@@ -468,11 +581,8 @@ public:
 
     _Tp *insert(const _Tp *_it, const _Tp &val) {
         std::size_t _j = _it - _data;
-        reserve(_size + 1);
-        for (std::size_t _i = _size; _i != _j; _i--) {
-            std::construct_at(&_data[_i], std::move(_data[_i - 1]));
-            std::destroy_at(&_data[_i - 1]);
-        }
+        _grow(_size + 1);
+        _make_gap(_j, 1);
         _size += 1;
         std::construct_at(&_data[_j], val);
         return _data + _j;
@@ -483,11 +593,8 @@ public:
         if (_n == 0) [[unlikely]] {
             return const_cast<_Tp *>(_it);
         }
-        reserve(_size + _n);
-        for (std::size_t _i = _size; _i != _j; _i--) {
-            std::construct_at(&_data[_i + _n - 1], std::move(_data[_i - 1]));
-            std::destroy_at(&_data[_i - 1]);
-        }
+        _grow(_size + _n);
+        _make_gap(_j, _n);
         _size += _n;
         for (std::size_t _i = _j; _i != _j + _n; _i++) {
             std::construct_at(&_data[_i], val);
@@ -503,11 +610,8 @@ public:
         if (_n == 0) [[unlikely]] {
             return const_cast<_Tp *>(_it);
         }
-        reserve(_size + _n);
-        for (std::size_t _i = _size; _i != _j; _i--) {
-            std::construct_at(&_data[_i + _n - 1], std::move(_data[_i - 1]));
-            std::destroy_at(&_data[_i - 1]);
-        }
+        _grow(_size + _n);
+        _make_gap(_j, _n);
         _size += _n;
         for (std::size_t _i = _j; _i != _j + _n; _i++) {
             std::construct_at(&_data[_i], *_first);
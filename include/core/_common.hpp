@@ -28,6 +28,10 @@
                            std::declval<_Tv>(), std::declval<_Tp>()) = \
                            std::declval<_Compare##Tp>()(std::declval<_Tp>(), \
                                                         std::declval<_Tv>()))
+#define _LIBPENGCXX_REQUIRES_TRANSPARENT_HASH(_Hash, _KeyEqual) \
+    class _Hash##Tp = _Hash, class _KeyEqual##Tp = _KeyEqual, \
+          class = typename _Hash##Tp::is_transparent, \
+          class = typename _KeyEqual##Tp::is_transparent
 
 // #define _LIBPENGCXX_THROW_OUT_OF_RANGE(__i, __n) throw
 // std::runtime_error("out of range at index " + std::to_string(__i) + ", size "
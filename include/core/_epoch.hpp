@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Marcus {
+
+// 基于纪元的内存回收（EBR）。读者进入临界区时登记当前的全局纪元，离开时
+// 清零；写者把摘下的对象和摘下时的纪元 e 一起挂起，等全局纪元到达 e + 2
+// 再释放。全局纪元只在所有活跃读者都登记了当前纪元时才前进，所以前进
+// 两次以后，摘下时还在读的读者一定都已经离开。
+// 每个线程占用一条记录，独占一个缓存行；线程退出后记录留给后来的线程复用
+struct alignas(64) _EpochRecord {
+    std::atomic<std::uint64_t> _M_epoch{0}; // 0 表示不在临界区
+    std::atomic<bool> _M_in_use{true};
+    _EpochRecord *_M_next = nullptr;
+    unsigned _M_nesting = 0; // 只由所属线程读写
+};
+
+struct _EpochDomain {
+    static inline std::atomic<std::uint64_t> _S_global{1};
+    static inline std::atomic<_EpochRecord *> _S_records{nullptr};
+
+    static _EpochRecord *_S_acquire_record() {
+        for (_EpochRecord *__rec = _S_records.load(std::memory_order_acquire);
+             __rec; __rec = __rec->_M_next) {
+            bool __expected = false;
+            if (!__rec->_M_in_use.load(std::memory_order_relaxed) &&
+                __rec->_M_in_use.compare_exchange_strong(__expected, true)) {
+                return __rec;
+            }
+        }
+        _EpochRecord *__rec = new _EpochRecord;
+        __rec->_M_next = _S_records.load(std::memory_order_relaxed);
+        while (!_S_records.compare_exchange_weak(__rec->_M_next, __rec,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+        }
+        return __rec;
+    }
+
+    struct _ThreadSlot {
+        _EpochRecord *_M_record = _S_acquire_record();
+
+        ~_ThreadSlot() noexcept {
+            _M_record->_M_in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    static _EpochRecord *_S_local() {
+        thread_local _ThreadSlot __slot;
+        return __slot._M_record;
+    }
+
+    // 可以嵌套，只有最外层登记纪元
+    static void _S_enter() {
+        _EpochRecord *__rec = _S_local();
+        if (__rec->_M_nesting++ == 0) {
+            // 登记和之后对共享指针的读取都是 seq_cst：写者先换指针再查
+            // 登记，两边不可能都读到旧值
+            __rec->_M_epoch.exchange(_S_global.load(std::memory_order_relaxed),
+                                     std::memory_order_seq_cst);
+        }
+    }
+
+    static void _S_leave() noexcept {
+        _EpochRecord *__rec = _S_local();
+        if (--__rec->_M_nesting == 0) {
+            __rec->_M_epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    // 所有活跃读者都在当前纪元时前进一步，返回前进后（或未变）的全局纪元
+    static std::uint64_t _S_try_advance() noexcept {
+        std::uint64_t __global = _S_global.load(std::memory_order_seq_cst);
+        for (_EpochRecord *__rec = _S_records.load(std::memory_order_acquire);
+             __rec; __rec = __rec->_M_next) {
+            std::uint64_t __epoch =
+                __rec->_M_epoch.load(std::memory_order_seq_cst);
+            if (__epoch != 0 && __epoch != __global) {
+                return __global;
+            }
+        }
+        if (_S_global.compare_exchange_strong(__global, __global + 1)) {
+            return __global + 1;
+        }
+        return __global;
+    }
+
+    static std::uint64_t _S_current() noexcept {
+        return _S_global.load(std::memory_order_seq_cst);
+    }
+};
+
+struct _EpochGuard {
+    _EpochGuard() {
+        _EpochDomain::_S_enter();
+    }
+
+    _EpochGuard(_EpochGuard &&) = delete;
+
+    ~_EpochGuard() noexcept {
+        _EpochDomain::_S_leave();
+    }
+};
+
+} // namespace Marcus
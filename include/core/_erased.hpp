@@ -0,0 +1,191 @@
+#pragma once
+
+#include <core/_relocate.hpp>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace Marcus {
+
+// 类型擦除的公共部分，Function、MoveOnlyFunction、inplace_function 和 any
+// 都建立在它上面。对象放在 _Size 字节的缓冲区里，放不下时（允许的话）
+// 放到堆上，缓冲区里只存指针。每种被擦除的类型有一张编译期生成的操作表，
+// 对象里只存指向它的指针，不用虚函数，也不用 RTTI 查找；使用者可以从
+// _ErasedOps 派生，在表里追加自己的操作（比如调用）
+template <std::size_t _Size, std::size_t _Align>
+union _ErasedBuffer {
+    void *_M_ptr;
+    alignas(_Align) unsigned char _M_buf[_Size ? _Size : 1];
+};
+
+template <class _Buffer>
+struct _ErasedOps {
+    // 为空表示不可复制
+    void (*_M_copy)(_Buffer &__dst, const _Buffer &__src);
+    // 为空表示按字节复制缓冲区就是移动：对象在堆上，或者可平凡重定位
+    void (*_M_relocate)(_Buffer &__dst, _Buffer &__src) noexcept;
+    // 为空表示析构什么都不用做
+    void (*_M_destroy)(_Buffer &__buf) noexcept;
+    const std::type_info *_M_type;
+};
+
+// _Table 是 _ErasedOps<_Buffer> 或它的派生类，空对象的 _M_table 为空
+template <std::size_t _Size, std::size_t _Align, bool _AllowHeap, class _Table>
+struct _Erased {
+    using _Buffer = _ErasedBuffer<_Size, _Align>;
+    using _Ops = _ErasedOps<_Buffer>;
+
+    // 移动必须是 noexcept，可能抛异常的类型不放进缓冲区
+    template <class _Tp>
+    static constexpr bool _S_is_local = sizeof(_Tp) <= _Size &&
+                                        alignof(_Tp) <= _Align &&
+                                        _is_nothrow_relocatable_v<_Tp>;
+
+    template <class _Tp>
+    static _Tp *_S_get(_Buffer &__buf) noexcept {
+        if constexpr (_S_is_local<_Tp>) {
+            return std::launder(reinterpret_cast<_Tp *>(__buf._M_buf));
+        } else {
+            return static_cast<_Tp *>(__buf._M_ptr);
+        }
+    }
+
+    template <class _Tp>
+    static const _Tp *_S_get(const _Buffer &__buf) noexcept {
+        return _S_get<_Tp>(const_cast<_Buffer &>(__buf));
+    }
+
+    template <class _Tp>
+    static void _S_copy(_Buffer &__dst, const _Buffer &__src) {
+        if constexpr (_S_is_local<_Tp>) {
+            ::new (static_cast<void *>(__dst._M_buf)) _Tp(*_S_get<_Tp>(__src));
+        } else {
+            __dst._M_ptr = new _Tp(*_S_get<_Tp>(__src));
+        }
+    }
+
+    template <class _Tp>
+    static void _S_relocate(_Buffer &__dst, _Buffer &__src) noexcept {
+        _Tp *__obj = _S_get<_Tp>(__src);
+        _uninitialized_relocate(__obj, __obj + 1,
+                                reinterpret_cast<_Tp *>(__dst._M_buf));
+    }
+
+    template <class _Tp>
+    static void _S_destroy(_Buffer &__buf) noexcept {
+        if constexpr (_S_is_local<_Tp>) {
+            _S_get<_Tp>(__buf)->~_Tp();
+        } else {
+            delete _S_get<_Tp>(__buf);
+        }
+    }
+
+    // _Tp 的公共操作，用来初始化 _Table 的基类部分
+    template <class _Tp>
+    static constexpr _Ops _S_ops() noexcept {
+        _Ops __ops{nullptr, nullptr, nullptr, &typeid(_Tp)};
+        if constexpr (std::is_copy_constructible_v<_Tp>) {
+            __ops._M_copy = &_S_copy<_Tp>;
+        }
+        if constexpr (_S_is_local<_Tp> && !is_trivially_relocatable_v<_Tp>) {
+            __ops._M_relocate = &_S_relocate<_Tp>;
+        }
+        if constexpr (!_S_is_local<_Tp> ||
+                      !std::is_trivially_destructible_v<_Tp>) {
+            __ops._M_destroy = &_S_destroy<_Tp>;
+        }
+        return __ops;
+    }
+
+    _Buffer _M_buf;
+    const _Table *_M_table = nullptr;
+
+    _Erased() noexcept = default;
+
+    // 只在 _Table 有 _M_copy 时可用，不可复制的使用者不要复制
+    _Erased(const _Erased &__that) {
+        if (__that._M_table) {
+            __that._M_table->_M_copy(_M_buf, __that._M_buf);
+            _M_table = __that._M_table;
+        }
+    }
+
+    _Erased(_Erased &&__that) noexcept {
+        _M_take(__that);
+    }
+
+    _Erased &operator=(const _Erased &__that) {
+        if (this != &__that) {
+            _Erased __tmp(__that);
+            reset();
+            _M_take(__tmp);
+        }
+        return *this;
+    }
+
+    _Erased &operator=(_Erased &&__that) noexcept {
+        if (this != &__that) {
+            reset();
+            _M_take(__that);
+        }
+        return *this;
+    }
+
+    ~_Erased() noexcept {
+        reset();
+    }
+
+    // 调用者保证当前为空；构造抛出异常时保持为空
+    template <class _Tp, class... _CArgs>
+    void _M_emplace(const _Table *__table, _CArgs &&...__args) {
+        static_assert(_AllowHeap || _S_is_local<_Tp>,
+                      "type does not fit the inline storage");
+        if constexpr (_S_is_local<_Tp>) {
+            ::new (static_cast<void *>(_M_buf._M_buf))
+                _Tp(std::forward<_CArgs>(__args)...);
+        } else {
+            _M_buf._M_ptr = new _Tp(std::forward<_CArgs>(__args)...);
+        }
+        _M_table = __table;
+    }
+
+    void _M_take(_Erased &__that) noexcept {
+        if (__that._M_table && __that._M_table->_M_relocate) {
+            __that._M_table->_M_relocate(_M_buf, __that._M_buf);
+        } else {
+            _M_buf = __that._M_buf;
+        }
+        _M_table = std::exchange(__that._M_table, nullptr);
+    }
+
+    void reset() noexcept {
+        if (_M_table && _M_table->_M_destroy) {
+            _M_table->_M_destroy(_M_buf);
+        }
+        _M_table = nullptr;
+    }
+
+    void swap(_Erased &__that) noexcept {
+        _Erased __tmp(std::move(__that));
+        __that = std::move(*this);
+        *this = std::move(__tmp);
+    }
+
+    const std::type_info &_M_type() const noexcept {
+        return _M_table ? *_M_table->_M_type : typeid(void);
+    }
+
+    template <class _Tp>
+    _Tp *_M_get() noexcept {
+        return _S_get<_Tp>(_M_buf);
+    }
+
+    template <class _Tp>
+    const _Tp *_M_get() const noexcept {
+        return _S_get<_Tp>(_M_buf);
+    }
+};
+
+} // namespace Marcus
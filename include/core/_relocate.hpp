@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace Marcus {
+
+// 可平凡重定位：把对象按字节搬到新地址、并且不再对旧地址调用析构，
+// 等价于“移动构造到新地址 + 析构旧对象”。
+// 平凡可复制的类型默认满足；其他类型（如只持有 unique_ptr 的结构体）可以特化：
+//
+//     template <>
+//     struct Marcus::is_trivially_relocatable<MyType> : std::true_type {};
+template <class _Tp>
+struct is_trivially_relocatable : std::is_trivially_copyable<_Tp> {};
+
+template <class _Tp>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<_Tp>::value;
+
+// pair 的两个成员都可平凡重定位时 pair 也可以，first 是否为 const 无关紧要
+template <class _T1, class _T2>
+struct is_trivially_relocatable<std::pair<_T1, _T2>>
+    : std::bool_constant<
+          is_trivially_relocatable_v<std::remove_const_t<_T1>> &&
+          is_trivially_relocatable_v<std::remove_const_t<_T2>>> {};
+
+template <class _Tp>
+inline constexpr bool _is_nothrow_relocatable_v =
+    is_trivially_relocatable_v<_Tp> ||
+    std::is_nothrow_move_constructible_v<_Tp>;
+
+// 把 [__first, __last) 搬到未初始化且不重叠的 __dest，源对象的生命周期随之结束。
+// 移动构造可能抛出时分两遍：先全部构造到 __dest（能复制的类型复制过去），
+// 中途抛出就销毁已构造的部分，源区间保持不变；全部成功后再销毁源对象
+template <class _Tp>
+void _uninitialized_relocate(_Tp *__first, _Tp *__last,
+                             _Tp *__dest) noexcept(_is_nothrow_relocatable_v<_Tp>) {
+    if constexpr (is_trivially_relocatable_v<_Tp>) {
+        if (__first != __last) {
+            std::memcpy(static_cast<void *>(__dest),
+                        static_cast<const void *>(__first),
+                        static_cast<std::size_t>(__last - __first) *
+                            sizeof(_Tp));
+        }
+    } else if constexpr (std::is_nothrow_move_constructible_v<_Tp>) {
+        for (; __first != __last; ++__first, ++__dest) {
+            std::construct_at(__dest, std::move(*__first));
+            std::destroy_at(__first);
+        }
+    } else {
+        _Tp *__cur = __dest;
+        try {
+            for (_Tp *__src = __first; __src != __last; ++__src, ++__cur) {
+                std::construct_at(__cur, std::move_if_noexcept(*__src));
+            }
+        } catch (...) {
+            std::destroy(__dest, __cur);
+            throw;
+        }
+        std::destroy(__first, __last);
+    }
+}
+
+// 同一块内存中把 [__first, __last) 整体搬到以 __dest 开头的位置，区间可以重叠；
+// __dest 之后原本不属于源区间的部分必须是未初始化的
+template <class _Tp>
+void _relocate_overlapping(_Tp *__first, _Tp *__last,
+                           _Tp *__dest) noexcept(_is_nothrow_relocatable_v<_Tp>) {
+    if constexpr (is_trivially_relocatable_v<_Tp>) {
+        if (__first != __last) {
+            std::memmove(static_cast<void *>(__dest),
+                         static_cast<const void *>(__first),
+                         static_cast<std::size_t>(__last - __first) *
+                             sizeof(_Tp));
+        }
+    } else if (__dest < __first) {
+        for (; __first != __last; ++__first, ++__dest) {
+            std::construct_at(__dest, std::move(*__first));
+            std::destroy_at(__first);
+        }
+    } else if (__dest > __first) {
+        _Tp *__d_last = __dest + (__last - __first);
+        while (__last != __first) {
+            --__last;
+            --__d_last;
+            std::construct_at(__d_last, std::move(*__last));
+            std::destroy_at(__last);
+        }
+    }
+}
+
+} // namespace Marcus
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace Marcus {
+
+// 构造或插入时告诉容器：输入已经按比较器排好序，可以跳过排序。
+// sorted_unique 还保证没有等价的键，sorted_equivalent 允许重复。
+struct sorted_unique_t {
+    explicit sorted_unique_t() = default;
+};
+
+inline constexpr sorted_unique_t sorted_unique{};
+
+struct sorted_equivalent_t {
+    explicit sorted_equivalent_t() = default;
+};
+
+inline constexpr sorted_equivalent_t sorted_equivalent{};
+
+} // namespace Marcus
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Marcus {
+
+// 单调增长的内存区：分配只是移动指针，deallocate 什么也不做，
+// 所有内存在 release() 或析构时一次性归还。
+// 可以先用调用者提供的缓冲区（比如栈上数组），用完再向系统申请，
+// 每次申请的大块是上一次的两倍。不加锁。
+// 按请求复用时用 reset()：它留下最大的那个大块给下一轮用。
+struct monotonic_arena {
+    static constexpr std::size_t _S_default_chunk = 1024;
+
+    monotonic_arena() noexcept = default;
+
+    explicit monotonic_arena(std::size_t __initial_size) noexcept
+        : _M_initial_size(std::max(__initial_size, sizeof(_Chunk) * 2)),
+          _M_next_size(_M_initial_size) {}
+
+    monotonic_arena(void *__buffer, std::size_t __size) noexcept
+        : _M_buffer(static_cast<char *>(__buffer)),
+          _M_buffer_size(__size),
+          _M_cur(_M_buffer),
+          _M_end(_M_buffer + __size),
+          _M_initial_size(std::max(__size, _S_default_chunk)),
+          _M_next_size(_M_initial_size) {}
+
+    monotonic_arena(monotonic_arena &&) = delete;
+
+    monotonic_arena &operator=(monotonic_arena &&) = delete;
+
+    ~monotonic_arena() noexcept {
+        release();
+    }
+
+    void *allocate(std::size_t __bytes,
+                   std::size_t __align = alignof(std::max_align_t)) {
+        // 先排除过大的请求，下面对齐后的长度和大块的大小都不会溢出
+        if (__bytes > std::numeric_limits<std::size_t>::max() - __align -
+                          sizeof(_Chunk)) [[unlikely]] {
+            throw std::bad_alloc();
+        }
+        std::uintptr_t __cur = reinterpret_cast<std::uintptr_t>(_M_cur);
+        std::uintptr_t __aligned = (__cur + __align - 1) & ~(__align - 1);
+        if (_M_cur && __aligned - __cur + __bytes <=
+                          std::size_t(_M_end - _M_cur)) [[likely]] {
+            _M_cur += __aligned - __cur + __bytes;
+            return reinterpret_cast<void *>(__aligned);
+        }
+        return _M_allocate_slow(__bytes, __align);
+    }
+
+    void deallocate(void *, std::size_t,
+                    std::size_t = alignof(std::max_align_t)) noexcept {}
+
+    // 归还所有向系统申请的大块，回到只有初始缓冲区的状态
+    void release() noexcept {
+        _S_free_chunks(_M_chunks);
+        _S_free_chunks(_M_spare);
+        _M_chunks = _M_spare = nullptr;
+        _M_rewind();
+    }
+
+    // 之前分配出去的内存全部失效，但留着最近（也是最大）的大块，
+    // 下一轮用完初始缓冲区后直接从它开始分配
+    void reset() noexcept {
+        if (_M_chunks) {
+            _S_free_chunks(_M_spare);
+            _M_spare = _M_chunks;
+            _M_chunks = _M_chunks->_M_next;
+            _M_spare->_M_next = nullptr;
+            _S_free_chunks(_M_chunks);
+            _M_chunks = nullptr;
+        }
+        _M_rewind();
+    }
+
+    // 当前从系统申请的字节数，不含初始缓冲区
+    std::size_t bytes_reserved() const noexcept {
+        std::size_t __total = 0;
+        for (_Chunk *__chunk = _M_chunks; __chunk; __chunk = __chunk->_M_next) {
+            __total += __chunk->_M_bytes;
+        }
+        return __total + (_M_spare ? _M_spare->_M_bytes : 0);
+    }
+
+private:
+    struct alignas(std::max_align_t) _Chunk {
+        _Chunk *_M_next;
+        std::size_t _M_bytes;
+    };
+
+    static void _S_free_chunks(_Chunk *__chunk) noexcept {
+        while (__chunk) {
+            _Chunk *__next = __chunk->_M_next;
+            ::operator delete(static_cast<void *>(__chunk), __chunk->_M_bytes);
+            __chunk = __next;
+        }
+    }
+
+    void _M_rewind() noexcept {
+        _M_cur = _M_buffer;
+        _M_end = _M_buffer + _M_buffer_size;
+        _M_next_size = _M_initial_size;
+    }
+
+    void *_M_allocate_slow(std::size_t __bytes, std::size_t __align) {
+        std::size_t __need = sizeof(_Chunk) + __bytes + __align;
+        _Chunk *__chunk;
+        if (_M_spare && _M_spare->_M_bytes >= __need) {
+            __chunk = std::exchange(_M_spare, nullptr);
+        } else {
+            std::size_t __size = std::max(_M_next_size, __need);
+            __chunk = static_cast<_Chunk *>(::operator new(__size));
+            __chunk->_M_bytes = __size;
+        }
+        __chunk->_M_next = _M_chunks;
+        _M_chunks = __chunk;
+        _M_cur = reinterpret_cast<char *>(__chunk + 1);
+        _M_end = reinterpret_cast<char *>(__chunk) + __chunk->_M_bytes;
+        _M_next_size = std::max(_M_next_size, __chunk->_M_bytes);
+        if (_M_next_size <= std::numeric_limits<std::size_t>::max() / 2) {
+            _M_next_size *= 2;
+        }
+        return allocate(__bytes, __align);
+    }
+
+    char *_M_buffer = nullptr;
+    std::size_t _M_buffer_size = 0;
+    char *_M_cur = nullptr;
+    char *_M_end = nullptr;
+    std::size_t _M_initial_size = _S_default_chunk;
+    std::size_t _M_next_size = _S_default_chunk;
+    _Chunk *_M_chunks = nullptr;
+    _Chunk *_M_spare = nullptr; // reset() 留下来的大块
+};
+
+// 从 monotonic_arena 分配的分配器，所有容器和 allocate_shared 都能用。
+// deallocate 是空操作，元素可平凡析构时销毁容器不需要任何开销。
+// 分配器只保存 arena 的指针，arena 必须比使用它的容器活得更久。
+template <class _Tp>
+struct arena_allocator {
+    using value_type = _Tp;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <class _Up>
+    struct rebind {
+        using other = arena_allocator<_Up>;
+    };
+
+    arena_allocator(monotonic_arena &__arena) noexcept : _M_arena(&__arena) {}
+
+    template <class _Up>
+    arena_allocator(const arena_allocator<_Up> &__that) noexcept
+        : _M_arena(__that._M_arena) {}
+
+    _Tp *allocate(std::size_t __n) {
+        if (__n > std::size_t(-1) / sizeof(_Tp)) [[unlikely]] {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<_Tp *>(
+            _M_arena->allocate(__n * sizeof(_Tp), alignof(_Tp)));
+    }
+
+    void deallocate(_Tp *, std::size_t) noexcept {}
+
+    monotonic_arena *arena() const noexcept {
+        return _M_arena;
+    }
+
+    template <class _Up>
+    bool operator==(const arena_allocator<_Up> &__that) const noexcept {
+        return _M_arena == __that._M_arena;
+    }
+
+    template <class _Up>
+    bool operator!=(const arena_allocator<_Up> &__that) const noexcept {
+        return _M_arena != __that._M_arena;
+    }
+
+private:
+    template <class>
+    friend struct arena_allocator;
+
+    monotonic_arena *_M_arena;
+};
+
+} // namespace Marcus
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Marcus {
+
+// 定长块内存池：按 16 字节分档，每档从成块申请的内存里切出槽位，
+// 释放的槽位挂在该档的空闲链表上，下次分配直接复用。
+// 超过 _S_max_block 字节或者超对齐的请求直接交给 ::operator new。
+// 不加锁：同一个池只能在一个线程里使用。
+struct node_pool {
+    static constexpr std::size_t _S_granularity = 16;
+    static constexpr std::size_t _S_max_block = 512;
+    static constexpr std::size_t _S_max_chunk = std::size_t(64) << 10;
+
+    node_pool() noexcept = default;
+
+    node_pool(node_pool &&) = delete;
+
+    node_pool &operator=(node_pool &&) = delete;
+
+    ~node_pool() noexcept {
+        release();
+    }
+
+    void *allocate(std::size_t __bytes,
+                   std::size_t __align = alignof(std::max_align_t)) {
+        if (__bytes > _S_max_block || __align > _S_granularity) [[unlikely]] {
+            return ::operator new(__bytes, std::align_val_t(__align));
+        }
+        _Bucket &__bucket = _M_buckets[_S_index(__bytes)];
+        if (_FreeSlot *__slot = __bucket._M_free) [[likely]] {
+            __bucket._M_free = __slot->_M_next;
+            return __slot;
+        }
+        std::size_t __size = _S_block_size(__bytes);
+        if (__bucket._M_end - __bucket._M_cur < std::ptrdiff_t(__size)) {
+            _M_refill(__bucket, __size);
+        }
+        void *__ptr = __bucket._M_cur;
+        __bucket._M_cur += __size;
+        return __ptr;
+    }
+
+    void deallocate(void *__ptr, std::size_t __bytes,
+                    std::size_t __align = alignof(std::max_align_t)) noexcept {
+        if (__bytes > _S_max_block || __align > _S_granularity) [[unlikely]] {
+            ::operator delete(__ptr, __bytes, std::align_val_t(__align));
+            return;
+        }
+        _Bucket &__bucket = _M_buckets[_S_index(__bytes)];
+        _FreeSlot *__slot = static_cast<_FreeSlot *>(__ptr);
+        __slot->_M_next = __bucket._M_free;
+        __bucket._M_free = __slot;
+    }
+
+    // 一次性归还所有大块，之前分配出去的槽位全部失效
+    void release() noexcept {
+        while (_M_chunks) {
+            _Chunk *__next = _M_chunks->_M_next;
+            ::operator delete(static_cast<void *>(_M_chunks),
+                              _M_chunks->_M_bytes);
+            _M_chunks = __next;
+        }
+        for (_Bucket &__bucket: _M_buckets) {
+            __bucket = _Bucket();
+        }
+    }
+
+    // 当前从系统申请的字节数
+    std::size_t bytes_reserved() const noexcept {
+        std::size_t __total = 0;
+        for (_Chunk *__chunk = _M_chunks; __chunk; __chunk = __chunk->_M_next) {
+            __total += __chunk->_M_bytes;
+        }
+        return __total;
+    }
+
+private:
+    struct _FreeSlot {
+        _FreeSlot *_M_next;
+    };
+
+    struct alignas(_S_granularity) _Chunk {
+        _Chunk *_M_next;
+        std::size_t _M_bytes;
+    };
+
+    struct _Bucket {
+        _FreeSlot *_M_free = nullptr;
+        char *_M_cur = nullptr; // 最近一个大块里还没切出去的部分
+        char *_M_end = nullptr;
+        std::size_t _M_next_count = 16; // 下一个大块切多少个槽位，逐次翻倍
+    };
+
+    static std::size_t _S_index(std::size_t __bytes) noexcept {
+        return __bytes ? (__bytes - 1) / _S_granularity : 0;
+    }
+
+    static std::size_t _S_block_size(std::size_t __bytes) noexcept {
+        return (_S_index(__bytes) + 1) * _S_granularity;
+    }
+
+    void _M_refill(_Bucket &__bucket, std::size_t __size) {
+        std::size_t __count = __bucket._M_next_count;
+        std::size_t __bytes = sizeof(_Chunk) + __count * __size;
+        if (__bytes > _S_max_chunk) {
+            __count = std::max<std::size_t>(
+                (_S_max_chunk - sizeof(_Chunk)) / __size, 1);
+            __bytes = sizeof(_Chunk) + __count * __size;
+        } else {
+            __bucket._M_next_count = __count * 2;
+        }
+        _Chunk *__chunk = static_cast<_Chunk *>(::operator new(__bytes));
+        __chunk->_M_next = _M_chunks;
+        __chunk->_M_bytes = __bytes;
+        _M_chunks = __chunk;
+        __bucket._M_cur = reinterpret_cast<char *>(__chunk + 1);
+        __bucket._M_end = __bucket._M_cur + __count * __size;
+    }
+
+    _Bucket _M_buckets[_S_max_block / _S_granularity];
+    _Chunk *_M_chunks = nullptr;
+};
+
+// 所有 rebind 出来的 pool_allocator 共享的池和引用计数
+struct _NodePoolShared {
+    node_pool _M_pool;
+    std::size_t _M_refs = 1;
+};
+
+// 从 node_pool 分配单个对象的分配器，给 list / forward_list / map / set
+// 这类逐个分配节点的容器用。
+//
+// 每个默认构造的 pool_allocator 都有自己的池，拷贝和 rebind 出来的分配器
+// 共享同一个池（引用计数，不加锁），所以每个容器的节点都集中在自己的大块里。
+// 一次分配多个对象时退化为 ::operator new。
+template <class _Tp>
+struct pool_allocator {
+    using value_type = _Tp;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <class _Up>
+    struct rebind {
+        using other = pool_allocator<_Up>;
+    };
+
+    pool_allocator() : _M_shared(new _NodePoolShared) {}
+
+    pool_allocator(const pool_allocator &__that) noexcept
+        : _M_shared(__that._M_shared) {
+        ++_M_shared->_M_refs;
+    }
+
+    template <class _Up>
+    pool_allocator(const pool_allocator<_Up> &__that) noexcept
+        : _M_shared(__that._M_shared) {
+        ++_M_shared->_M_refs;
+    }
+
+    pool_allocator &operator=(const pool_allocator &__that) noexcept {
+        ++__that._M_shared->_M_refs;
+        _M_drop();
+        _M_shared = __that._M_shared;
+        return *this;
+    }
+
+    ~pool_allocator() noexcept {
+        _M_drop();
+    }
+
+    _Tp *allocate(std::size_t __n) {
+        if (__n == 1) [[likely]] {
+            return static_cast<_Tp *>(
+                _M_shared->_M_pool.allocate(sizeof(_Tp), alignof(_Tp)));
+        }
+        return static_cast<_Tp *>(::operator new(
+            __n * sizeof(_Tp), std::align_val_t(alignof(_Tp))));
+    }
+
+    void deallocate(_Tp *__ptr, std::size_t __n) noexcept {
+        if (__n == 1) [[likely]] {
+            _M_shared->_M_pool.deallocate(__ptr, sizeof(_Tp), alignof(_Tp));
+            return;
+        }
+        ::operator delete(__ptr, __n * sizeof(_Tp),
+                          std::align_val_t(alignof(_Tp)));
+    }
+
+    // 拷贝出来的容器用自己的池
+    pool_allocator select_on_container_copy_construction() const {
+        return pool_allocator();
+    }
+
+    node_pool &pool() const noexcept {
+        return _M_shared->_M_pool;
+    }
+
+    template <class _Up>
+    bool operator==(const pool_allocator<_Up> &__that) const noexcept {
+        return _M_shared == __that._M_shared;
+    }
+
+    template <class _Up>
+    bool operator!=(const pool_allocator<_Up> &__that) const noexcept {
+        return _M_shared != __that._M_shared;
+    }
+
+private:
+    template <class>
+    friend struct pool_allocator;
+
+    void _M_drop() noexcept {
+        if (--_M_shared->_M_refs == 0) {
+            delete _M_shared;
+        }
+    }
+
+    _NodePoolShared *_M_shared;
+};
+
+} // namespace Marcus
@@ -38,7 +38,7 @@ struct _SpCounter {
 
     void _M_decref_weak() noexcept {
         if (_M_weak_refcnt.fetch_sub(1, std::memory_order_acq_rel) == 1) {
-            delete this;
+            _M_release();
         }
     }
 
@@ -64,6 +64,11 @@ struct _SpCounter {
 
     virtual void _M_destroy() noexcept = 0;
 
+    // 释放控制块本身，用分配器分配的控制块要还给分配器
+    virtual void _M_release() noexcept {
+        delete this;
+    }
+
     virtual ~_SpCounter() = default;
 };
 
@@ -111,6 +116,34 @@ struct _SpCounterImplFused final : _SpCounter {
     }
 };
 
+// allocate_shared: the control block and the object share one allocation
+// obtained from (a rebound copy of) the user's allocator.
+template <typename _Tp, typename _Alloc>
+struct _SpCounterImplAlloc final : _SpCounter {
+    using _Self_alloc = typename std::allocator_traits<
+        _Alloc>::template rebind_alloc<_SpCounterImplAlloc>;
+
+    [[no_unique_address]] _Self_alloc _M_alloc;
+    alignas(_Tp) unsigned char _M_storage[sizeof(_Tp)];
+
+    explicit _SpCounterImplAlloc(const _Self_alloc &__alloc) noexcept
+        : _M_alloc(__alloc) {}
+
+    _Tp *_M_ptr() noexcept {
+        return std::launder(reinterpret_cast<_Tp *>(_M_storage));
+    }
+
+    void _M_destroy() noexcept override {
+        _M_ptr()->~_Tp();
+    }
+
+    void _M_release() noexcept override {
+        _Self_alloc __alloc(std::move(_M_alloc));
+        this->~_SpCounterImplAlloc();
+        std::allocator_traits<_Self_alloc>::deallocate(__alloc, this, 1);
+    }
+};
+
 template <typename _Tp>
 struct shared_ptr {
 private:
@@ -591,6 +624,26 @@ shared_ptr<_Tp> make_shared_for_overwrite() {
     return _S_makeSharedFused(__object, __counter);
 }
 
+template <typename _Tp, typename _Alloc, typename... _Args,
+          std::enable_if_t<!std::is_unbounded_array_v<_Tp>, int> = 0>
+shared_ptr<_Tp> allocate_shared(const _Alloc &__alloc, _Args &&...__args) {
+    using _Counter = _SpCounterImplAlloc<_Tp, _Alloc>;
+    using _Traits = std::allocator_traits<typename _Counter::_Self_alloc>;
+    typename _Counter::_Self_alloc __self_alloc(__alloc);
+    _Counter *__counter = _Traits::allocate(__self_alloc, 1);
+    new (__counter) _Counter(__self_alloc);
+    _Tp *__object = __counter->_M_ptr();
+    try {
+        new (__object) _Tp(std::forward<_Args>(__args)...);
+    } catch (...) {
+        __counter->~_Counter();
+        _Traits::deallocate(__self_alloc, __counter, 1);
+        throw;
+    }
+    _S_setupEnableSharedFromThis(__object, __counter);
+    return _S_makeSharedFused(__object, __counter);
+}
+
 template <typename _Tp, typename... _Args,
           std::enable_if_t<std::is_unbounded_array_v<_Tp>, int> = 0>
 shared_ptr<_Tp> make_shared(std::size_t __len) {
@@ -1,55 +1,48 @@
 #pragma once
 
+#include <core/_erased.hpp>
+#include <cstddef>
 #include <functional>
-#include <memory>
 #include <type_traits>
 #include <typeinfo>
 #include <utility>
 
 namespace Marcus {
 
-template <class _FnSig>
+// _InlineSize 是能直接放在 Function 对象里的可调用对象的最大字节数，
+// 默认 3 个指针，够放捕获几个指针或引用的 lambda
+template <class _FnSig, std::size_t _InlineSize = 3 * sizeof(void *)>
 struct Function {
     static_assert(!std::is_same_v<_FnSig, _FnSig>,
                   "not a valid function signature");
 };
 
 // type : _Ret(_Args...)
-template <class _Ret, class... _Args>
-struct Function<_Ret(_Args...)> {
+template <class _Ret, class... _Args, std::size_t _InlineSize>
+struct Function<_Ret(_Args...), _InlineSize> {
 private:
-    struct _FuncBase {
-        virtual _Ret _M_call(_Args... __args) = 0;
-        virtual std::unique_ptr<_FuncBase> _M_clone() const = 0;
-        virtual const std::type_info &_M_type() const = 0;
-        virtual ~_FuncBase() = default;
-    };
-
-    template <class _Fn>
-    struct _FuncImpl : _FuncBase {
-        _Fn _M_f;
+    using _Buffer = _ErasedBuffer<_InlineSize, alignof(void *)>;
 
-        template <class... _CArgs>
-        explicit _FuncImpl(std::in_place_t, _CArgs &&...__args)
-            : _M_f(std::forward<_CArgs>(__args)...) {}
+    struct _FuncTable : _ErasedOps<_Buffer> {
+        _Ret (*_M_call)(_Buffer &, _Args &&...);
+    };
 
-        _Ret _M_call(_Args... __args) override {
-            return std::invoke(_M_f, std::forward<_Args>(__args)...);
-        }
+    using _Storage = _Erased<_InlineSize, alignof(void *), true, _FuncTable>;
 
-        std::unique_ptr<_FuncBase> _M_clone() const override {
-            return std::make_unique<_FuncImpl>(std::in_place, _M_f);
-        }
+    template <class _Fn>
+    static _Ret _S_call(_Buffer &__buf, _Args &&...__args) {
+        return std::invoke(*_Storage::template _S_get<_Fn>(__buf),
+                           std::forward<_Args>(__args)...);
+    }
 
-        const std::type_info &_M_type() const override {
-            return typeid(_Fn);
-        }
-    };
+    template <class _Fn>
+    static constexpr _FuncTable _S_table = {
+        _Storage::template _S_ops<_Fn>(), &_S_call<_Fn>};
 
-    std::unique_ptr<_FuncBase> _M_base;
+    mutable _Storage _M_storage;
 
 public:
-    Function() = default;
+    Function() noexcept = default;
 
     Function(std::nullptr_t) noexcept : Function() {}
 
@@ -57,59 +50,60 @@ public:
               class = std::enable_if_t<
                   std::is_invocable_r_v<_Ret, std::decay_t<_Fn>, _Args...> &&
                   std::is_copy_constructible_v<_Fn> &&
-                  !std::is_same_v<std::decay_t<_Fn>, Function<_Ret(_Args...)>>>>
-    Function(_Fn &&__f) // Without explicit, lambda expressions are allowed to
-                        // implicitly convert to Function.
-        : _M_base(std::make_unique<_FuncImpl<std::decay_t<_Fn>>>(
-              std::in_place, std::forward<_Fn>(__f))) {}
-
-    Function(Function &&) = default;
-    Function &operator=(Function &&) = default;
-
-    Function(const Function &other)
-        : _M_base(other._M_base ? other._M_base->_M_clone() : nullptr) {}
-
-    Function &operator=(const Function &other) {
-        if (other._M_base) {
-            _M_base = other._M_base->_M_clone();
-        } else {
-            _M_base = nullptr;
-        }
+                  !std::is_same_v<std::decay_t<_Fn>, Function>>>
+    Function(_Fn &&__f) { // Without explicit, lambda expressions are allowed
+                          // to implicitly convert to Function.
+        _M_storage.template _M_emplace<std::decay_t<_Fn>>(
+            &_S_table<std::decay_t<_Fn>>, std::forward<_Fn>(__f));
+    }
+
+    Function(Function &&) noexcept = default;
+    Function &operator=(Function &&) noexcept = default;
+    Function(const Function &) = default;
+    Function &operator=(const Function &) = default;
+
+    Function &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    void reset() noexcept {
+        _M_storage.reset();
     }
 
     explicit operator bool() const noexcept {
-        return _M_base != nullptr;
+        return _M_storage._M_table != nullptr;
     }
 
     bool operator==(std::nullptr_t) const noexcept {
-        return _M_base == nullptr;
+        return _M_storage._M_table == nullptr;
     }
 
     bool operator!=(std::nullptr_t) const noexcept {
-        return _M_base != nullptr;
+        return _M_storage._M_table != nullptr;
     }
 
     _Ret operator()(_Args... __args) const {
-        if (!_M_base) [[unlikely]] {
+        if (!_M_storage._M_table) [[unlikely]] {
             throw std::bad_function_call();
         }
-        return _M_base->_M_call(std::forward<_Args>(__args)...);
+        return _M_storage._M_table->_M_call(_M_storage._M_buf,
+                                            std::forward<_Args>(__args)...);
     }
 
     const std::type_info &target_type() const noexcept {
-        return _M_base ? _M_base->_M_type() : typeid(void);
+        return _M_storage._M_type();
     }
 
     template <class _Fn>
     _Fn *target() const noexcept {
-        return _M_base && typeid(_Fn) == _M_base->_M_type()
-                   ? std::addressof(
-                         static_cast<_FuncImpl<_Fn> *>(_M_base.get())->_M_f)
+        return _M_storage._M_table && target_type() == typeid(_Fn)
+                   ? _M_storage.template _M_get<_Fn>()
                    : nullptr;
     }
 
-    void swap(Function &__that) const noexcept {
-        _M_base.swap(__that._M_base);
+    void swap(Function &__that) noexcept {
+        _M_storage.swap(__that._M_storage);
     }
 };
 
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace Marcus {
+
+template <class _FnSig>
+struct function_ref {
+    static_assert(!std::is_same_v<_FnSig, _FnSig>,
+                  "not a valid function signature");
+};
+
+// 不拥有可调用对象的引用，两个指针大小，从不分配，调用是一次间接调用。
+// 只适合作为同步调用的参数：被引用的对象必须活得比 function_ref 长，
+// 不要把它存起来
+template <class _Ret, class... _Args>
+struct function_ref<_Ret(_Args...)> {
+private:
+    // 普通函数指针不能放进 void *，单独存
+    union _Bound {
+        void *_M_obj;
+        void (*_M_fn)();
+    };
+
+    using _Invoker = _Ret (*)(_Bound, _Args &&...);
+
+    _Bound _M_bound;
+    _Invoker _M_invoke;
+
+    // __fn 是左值引用，const 与否和绑定时一致
+    template <class _Fn>
+    static _Ret _S_invoke_obj(_Bound __bound, _Args &&...__args) {
+        return std::invoke(*static_cast<std::add_pointer_t<_Fn>>(__bound._M_obj),
+                           std::forward<_Args>(__args)...);
+    }
+
+    template <class _Fp>
+    static _Ret _S_invoke_fn(_Bound __bound, _Args &&...__args) {
+        return std::invoke(reinterpret_cast<_Fp>(__bound._M_fn),
+                           std::forward<_Args>(__args)...);
+    }
+
+public:
+    template <class _Fp,
+              class = std::enable_if_t<std::is_function_v<_Fp> &&
+                                       std::is_invocable_r_v<_Ret, _Fp &,
+                                                             _Args...>>>
+    function_ref(_Fp *__fp) noexcept
+        : _M_invoke(&_S_invoke_fn<_Fp *>) {
+        _M_bound._M_fn = reinterpret_cast<void (*)()>(__fp);
+    }
+
+    template <class _Fn,
+              class _Tp = std::remove_reference_t<_Fn>,
+              class = std::enable_if_t<
+                  !std::is_same_v<std::remove_cv_t<_Tp>, function_ref> &&
+                  !std::is_function_v<_Tp> && !std::is_pointer_v<_Tp> &&
+                  std::is_invocable_r_v<_Ret, _Tp &, _Args...>>>
+    function_ref(_Fn &&__f) noexcept
+        : _M_invoke(&_S_invoke_obj<_Tp>) {
+        _M_bound._M_obj = const_cast<void *>(
+            static_cast<const volatile void *>(std::addressof(__f)));
+    }
+
+    function_ref(const function_ref &) noexcept = default;
+    function_ref &operator=(const function_ref &) noexcept = default;
+
+    _Ret operator()(_Args... __args) const {
+        return _M_invoke(_M_bound, std::forward<_Args>(__args)...);
+    }
+};
+
+} // namespace Marcus
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <core/_erased.hpp>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace Marcus {
+
+// 可调用对象总是放在对象内的 _Capacity 字节里，保证从不分配堆内存；
+// 放不下或对齐要求超过 _Align 的可调用对象在编译期报错
+template <class _FnSig, std::size_t _Capacity = 4 * sizeof(void *),
+          std::size_t _Align = alignof(std::max_align_t)>
+struct inplace_function {
+    static_assert(!std::is_same_v<_FnSig, _FnSig>,
+                  "not a valid function signature");
+};
+
+template <class _Ret, class... _Args, std::size_t _Capacity,
+          std::size_t _Align>
+struct inplace_function<_Ret(_Args...), _Capacity, _Align> {
+private:
+    using _Buffer = _ErasedBuffer<_Capacity, _Align>;
+
+    struct _FuncTable : _ErasedOps<_Buffer> {
+        _Ret (*_M_call)(_Buffer &, _Args &&...);
+    };
+
+    // 不允许放到堆上
+    using _Storage = _Erased<_Capacity, _Align, false, _FuncTable>;
+
+    template <class _Fn>
+    static _Ret _S_call(_Buffer &__buf, _Args &&...__args) {
+        return std::invoke(*_Storage::template _S_get<_Fn>(__buf),
+                           std::forward<_Args>(__args)...);
+    }
+
+    template <class _Fn>
+    static constexpr _FuncTable _S_table = {
+        _Storage::template _S_ops<_Fn>(), &_S_call<_Fn>};
+
+    mutable _Storage _M_storage;
+
+    template <class _Fn, class... _CArgs>
+    void _M_create(_CArgs &&...__args) {
+        static_assert(sizeof(_Fn) <= _Capacity,
+                      "callable is too large for this inplace_function");
+        static_assert(alignof(_Fn) <= _Align,
+                      "callable is over-aligned for this inplace_function");
+        static_assert(std::is_copy_constructible_v<_Fn>,
+                      "inplace_function requires a copyable callable");
+        static_assert(std::is_nothrow_move_constructible_v<_Fn>,
+                      "inplace_function requires a nothrow-movable callable");
+        _M_storage.template _M_emplace<_Fn>(&_S_table<_Fn>,
+                                            std::forward<_CArgs>(__args)...);
+    }
+
+public:
+    inplace_function() noexcept = default;
+
+    inplace_function(std::nullptr_t) noexcept : inplace_function() {}
+
+    template <class _Fn,
+              class = std::enable_if_t<
+                  std::is_invocable_r_v<_Ret, std::decay_t<_Fn> &, _Args...> &&
+                  !std::is_same_v<std::decay_t<_Fn>, inplace_function>>>
+    inplace_function(_Fn &&__f) {
+        _M_create<std::decay_t<_Fn>>(std::forward<_Fn>(__f));
+    }
+
+    template <class _Fn, class... _CArgs>
+    explicit inplace_function(std::in_place_type_t<_Fn>, _CArgs &&...__args) {
+        _M_create<_Fn>(std::forward<_CArgs>(__args)...);
+    }
+
+    inplace_function(const inplace_function &) = default;
+    inplace_function(inplace_function &&) noexcept = default;
+    inplace_function &operator=(const inplace_function &) = default;
+    inplace_function &operator=(inplace_function &&) noexcept = default;
+
+    inplace_function &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    void reset() noexcept {
+        _M_storage.reset();
+    }
+
+    explicit operator bool() const noexcept {
+        return _M_storage._M_table != nullptr;
+    }
+
+    bool operator==(std::nullptr_t) const noexcept {
+        return _M_storage._M_table == nullptr;
+    }
+
+    bool operator!=(std::nullptr_t) const noexcept {
+        return _M_storage._M_table != nullptr;
+    }
+
+    // 空时抛出 std::bad_function_call
+    _Ret operator()(_Args... __args) const {
+        if (!_M_storage._M_table) [[unlikely]] {
+            throw std::bad_function_call();
+        }
+        return _M_storage._M_table->_M_call(_M_storage._M_buf,
+                                            std::forward<_Args>(__args)...);
+    }
+
+    const std::type_info &target_type() const noexcept {
+        return _M_storage._M_type();
+    }
+
+    template <class _Fn>
+    _Fn *target() const noexcept {
+        return _M_storage._M_table && target_type() == typeid(_Fn)
+                   ? _M_storage.template _M_get<_Fn>()
+                   : nullptr;
+    }
+
+    void swap(inplace_function &__that) noexcept {
+        _M_storage.swap(__that._M_storage);
+    }
+};
+
+} // namespace Marcus
@@ -1,81 +1,100 @@
 #pragma once
 
+#include <cassert>
+#include <core/_erased.hpp>
+#include <cstddef>
 #include <functional>
-#include <memory>
 #include <type_traits>
 #include <utility>
 
 namespace Marcus {
 
-template <typename _FnSig>
+// _InlineSize 是能直接放在对象里的可调用对象的最大字节数，默认 3 个指针
+template <typename _FnSig, std::size_t _InlineSize = 3 * sizeof(void *)>
 struct MoveOnlyFunction {
     static_assert(!std::is_same_v<_FnSig, _FnSig>,
                   "not a valid function signature");
 };
 
-template <typename _Ret, typename... _Args>
-struct MoveOnlyFunction<_Ret(_Args...)> {
+// 可平凡重定位的小对象（只捕获指针、引用、整数的 lambda）和放在堆上的
+// 对象，移动都只是复制缓冲区的字节
+template <typename _Ret, typename... _Args, std::size_t _InlineSize>
+struct MoveOnlyFunction<_Ret(_Args...), _InlineSize> {
 private:
-    struct _FuncBase {
-        virtual _Ret _M_call(_Args... __args) = 0;
-        virtual ~_FuncBase() = default;
+    using _Buffer = _ErasedBuffer<_InlineSize, alignof(void *)>;
+
+    struct _FuncTable : _ErasedOps<_Buffer> {
+        _Ret (*_M_call)(_Buffer &, _Args &&...);
     };
 
-    template <typename _Fn>
-    struct _FuncImpl : _FuncBase {
-        _Fn _M_f;
+    using _Storage = _Erased<_InlineSize, alignof(void *), true, _FuncTable>;
 
-        template <typename... _CArgs>
-        explicit _FuncImpl(std::in_place_t, _CArgs &&...__args)
-            : _M_f(std::forward<_CArgs>(__args)...) {}
+    template <typename _Fn>
+    static _Ret _S_call(_Buffer &__buf, _Args &&...__args) {
+        return std::invoke(*_Storage::template _S_get<_Fn>(__buf),
+                           std::forward<_Args>(__args)...);
+    }
 
-        _Ret _M_call(_Args... __args) override {
-            return std::invoke(_M_f, std::forward<_Args>(__args)...);
-        }
-    };
+    template <typename _Fn>
+    static constexpr _FuncTable _S_table = {
+        _Storage::template _S_ops<_Fn>(), &_S_call<_Fn>};
 
-    std::unique_ptr<_FuncBase> _M_base;
+    mutable _Storage _M_storage;
 
 public:
-    MoveOnlyFunction() = default; // _M_base 初始化为 nullptr
+    MoveOnlyFunction() noexcept = default;
 
     MoveOnlyFunction(std::nullptr_t) noexcept : MoveOnlyFunction() {}
 
-    template <typename _Fn, typename = std::enable_if_t<
-                                std::is_invocable_r_v<_Ret, _Fn &, _Args...>>>
-    MoveOnlyFunction(_Fn __f)
-        : _M_base(std::make_unique<_FuncImpl<_Fn>>(std::in_place,
-                                                   std::move(__f))) {}
+    template <typename _Fn,
+              typename = std::enable_if_t<
+                  std::is_invocable_r_v<_Ret, std::decay_t<_Fn> &, _Args...> &&
+                  !std::is_same_v<std::decay_t<_Fn>, MoveOnlyFunction>>>
+    MoveOnlyFunction(_Fn &&__f) {
+        _M_storage.template _M_emplace<std::decay_t<_Fn>>(
+            &_S_table<std::decay_t<_Fn>>, std::forward<_Fn>(__f));
+    }
 
     template <typename _Fn, typename... _CArgs>
-    explicit MoveOnlyFunction(std::in_place_type_t<_Fn>, _CArgs &&...__args)
-        : _M_base(std::make_unique<_FuncImpl<_Fn>>(
-              std::in_place, std::forward<_CArgs>(__args)...)) {}
+    explicit MoveOnlyFunction(std::in_place_type_t<_Fn>, _CArgs &&...__args) {
+        _M_storage.template _M_emplace<_Fn>(&_S_table<_Fn>,
+                                            std::forward<_CArgs>(__args)...);
+    }
 
-    MoveOnlyFunction(MoveOnlyFunction &&) = default;
-    MoveOnlyFunction &operator=(MoveOnlyFunction &&) = default;
+    MoveOnlyFunction(MoveOnlyFunction &&) noexcept = default;
+    MoveOnlyFunction &operator=(MoveOnlyFunction &&) noexcept = default;
     MoveOnlyFunction(const MoveOnlyFunction &) = delete;
     MoveOnlyFunction &operator=(const MoveOnlyFunction &) = delete;
 
+    MoveOnlyFunction &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    void reset() noexcept {
+        _M_storage.reset();
+    }
+
     explicit operator bool() const noexcept {
-        return _M_base != nullptr;
+        return _M_storage._M_table != nullptr;
     }
 
     bool operator==(std::nullptr_t) const noexcept {
-        return _M_base == nullptr;
+        return _M_storage._M_table == nullptr;
     }
 
     bool operator!=(std::nullptr_t) const noexcept {
-        return _M_base != nullptr;
+        return _M_storage._M_table != nullptr;
     }
 
     _Ret operator()(_Args... __args) const {
-        assert(_M_base);
-        return _M_base->_M_call(std::forward<_Args>(__args)...);
+        assert(_M_storage._M_table);
+        return _M_storage._M_table->_M_call(_M_storage._M_buf,
+                                            std::forward<_Args>(__args)...);
     }
 
-    void swap(MoveOnlyFunction &__that) const noexcept {
-        _M_base.swap(__that._M_base);
+    void swap(MoveOnlyFunction &__that) noexcept {
+        _M_storage.swap(__that._M_storage);
     }
 };
 } // namespace Marcus
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <core/_erased.hpp>
+#include <cstddef>
 #include <exception>
 #include <initializer_list>
 #include <type_traits>
@@ -25,82 +27,71 @@ struct InPlaceType {
 template <typename T>
 constexpr InPlaceType<T> in_place_type{};
 
-struct AnyConcept {
-    virtual ~AnyConcept() = default;
-    virtual AnyConcept *clone() const = 0;
-    virtual AnyConcept *move_clone() = 0;
-    virtual const std::type_info &type() const noexcept = 0;
-    virtual void *get_ptr() noexcept = 0;
-    virtual const void *get_ptr() const noexcept = 0;
-};
-
-template <typename T>
-struct AnyModel : AnyConcept {
-    T _value;
-
-    template <typename... Args>
-    AnyModel(Args &&...args) : _value(std::forward<Args>(args)...) {}
+class any {
+private:
+    // 不超过 3 个指针大小、移动不抛异常的值直接放在 any 对象里，
+    // 其余的放在堆上
+    static constexpr std::size_t _inline_size = 3 * sizeof(void *);
 
-    AnyConcept *clone() const override {
-        return new AnyModel<T>(
-            _value); // Create a new AnyModel with a copy of _value
-    }
+    using _Storage =
+        _Erased<_inline_size, alignof(void *), true,
+                _ErasedOps<_ErasedBuffer<_inline_size, alignof(void *)>>>;
+    using _Ops = typename _Storage::_Ops;
 
-    AnyConcept *move_clone() override {
-        return new AnyModel<T>(
-            std::move(_value)); // Create a new AnyModel with a moved _value
-    }
+    // 每种类型一张表，表的地址同时作为类型标签
+    template <typename T>
+    static constexpr _Ops _table = _Storage::template _S_ops<T>();
 
-    const std::type_info &type() const noexcept override {
-        return typeid(T); // Return type_info of T
-    }
+    _Storage _storage;
 
-    void *get_ptr() noexcept override {
-        return &_value; // Return pointer to the stored value
+    template <typename T, typename... Args>
+    void _emplace(Args &&...args) {
+        static_assert(std::is_copy_constructible_v<T>,
+                      "any requires a copyable type");
+        _storage.template _M_emplace<T>(&_table<T>,
+                                        std::forward<Args>(args)...);
     }
 
-    const void *get_ptr() const noexcept override {
-        return &_value; // Return const pointer to the stored value
+    template <typename T>
+    T *_get() noexcept {
+        return _storage.template _M_get<T>();
     }
-};
-
-class any {
-private:
-    AnyConcept *_storage;
 
-    void *_get_value_ptr() noexcept {
-        return _storage ? _storage->get_ptr() : nullptr;
+    template <typename T>
+    const T *_get() const noexcept {
+        return _storage.template _M_get<T>();
     }
 
-    const void *_get_value_ptr() const noexcept {
-        return _storage ? _storage->get_ptr() : nullptr;
+    // 先比较表的地址；同一类型在不同动态库里可能有各自的表，
+    // 地址不同时再比较 type_info
+    template <typename T>
+    bool _holds() const noexcept {
+        return _storage._M_table == &_table<T> ||
+               (_storage._M_table && type() == typeid(T));
     }
 
 public:
-    any() noexcept : _storage(nullptr) {}
+    any() noexcept = default;
 
     template <typename T, typename = std::enable_if_t<
                               !std::is_same_v<std::decay_t<T>, any>>>
-    any(T &&value)
-        : _storage(new AnyModel<std::decay_t<T>>(std::forward<T>(value))) {}
+    any(T &&value) {
+        _emplace<std::decay_t<T>>(std::forward<T>(value));
+    }
 
-    any(const any &other)
-        : _storage(other._storage ? other._storage->clone() : nullptr) {}
+    any(const any &other) = default;
 
-    any(any &&other) noexcept : _storage(other._storage) {
-        other._storage = nullptr;
-    }
+    any(any &&other) noexcept = default;
 
     template <typename T, typename... Args>
-    explicit any(InPlaceType<T>, Args &&...args)
-        : _storage(new AnyModel<T>(std::forward<Args>(args)...)) {}
+    explicit any(InPlaceType<T>, Args &&...args) {
+        _emplace<T>(std::forward<Args>(args)...);
+    }
 
     template <typename T, typename U, typename... Args>
-    explicit any(InPlaceType<T>, std::initializer_list<U> ilist, Args &&...args)
-        : _storage(new AnyModel<T>(ilist, std::forward<Args>(args)...)) {}
-
-    ~any() noexcept {
-        delete _storage;
+    explicit any(InPlaceType<T>, std::initializer_list<U> ilist,
+                 Args &&...args) {
+        _emplace<T>(ilist, std::forward<Args>(args)...);
     }
 
     any &operator=(const any &other) {
@@ -113,7 +104,8 @@ public:
         return *this;
     }
 
-    template <typename T>
+    template <typename T, typename = std::enable_if_t<
+                              !std::is_same_v<std::decay_t<T>, any>>>
     any &operator=(T &&value) {
         any(std::forward<T>(value)).swap(*this);
         return *this;
@@ -122,45 +114,31 @@ public:
     template <typename T, typename... Args>
     void emplace(Args &&...args) {
         reset();
-        _storage = new AnyModel<T>(std::forward<Args>(args)...);
+        _emplace<T>(std::forward<Args>(args)...);
     }
 
     template <typename T, typename U, typename... Args>
     void emplace(std::initializer_list<U> ilist, Args &&...args) {
         reset();
-        _storage = new AnyModel<T>(ilist, std::forward<Args>(args)...);
+        _emplace<T>(ilist, std::forward<Args>(args)...);
     }
 
     void reset() noexcept {
-        delete _storage;
-        _storage = nullptr;
+        _storage.reset();
     }
 
     void swap(any &other) noexcept {
-        using std::swap;
-        swap(_storage, other._storage);
+        _storage.swap(other._storage);
     }
 
     bool has_value() const noexcept {
-        return _storage != nullptr;
+        return _storage._M_table != nullptr;
     }
 
     const std::type_info &type() const noexcept {
-        return _storage ? _storage->type() : typeid(void);
+        return _storage._M_type();
     }
 
-    friend void *any_cast_impl_ref(any *operand, const std::type_info &info);
-    friend const void *any_cast_impl_ref(const any *operand,
-                                         const std::type_info &info);
-    template <typename T>
-    friend T any_cast(any &operand);
-
-    template <typename T>
-    friend T any_cast(const any &operand);
-
-    template <typename T>
-    friend T any_cast(any &&operand);
-
     template <typename T>
     friend const T *any_cast(const any *operand) noexcept;
 
@@ -168,56 +146,52 @@ public:
     friend T *any_cast(any *operand) noexcept;
 };
 
-inline void *any_cast_impl_ref(any *operand, const std::type_info &info) {
-    if (!operand || !operand->has_value() || operand->type() != info) {
-        throw BadAnyCast();
+template <typename T>
+const T *any_cast(const any *operand) noexcept {
+    using U = std::remove_cv_t<T>;
+    if (!operand || !operand->template _holds<U>()) {
+        return nullptr;
     }
-    return operand->_get_value_ptr();
+    return operand->template _get<U>();
 }
 
-inline const void *any_cast_impl_ref(const any *operand,
-                                     const std::type_info &info) {
-    if (!operand || !operand->has_value() || operand->type() != info) {
-        throw BadAnyCast();
+template <typename T>
+T *any_cast(any *operand) noexcept {
+    using U = std::remove_cv_t<T>;
+    if (!operand || !operand->template _holds<U>()) {
+        return nullptr;
     }
-    return operand->_get_value_ptr();
+    return operand->template _get<U>();
 }
 
 template <typename T>
 T any_cast(any &operand) {
-    using U = std::remove_reference_t<T>;
-    void *p = any_cast_impl_ref(&operand, typeid(U));
-    return static_cast<T>(*static_cast<U *>(p));
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    U *p = any_cast<U>(&operand);
+    if (!p) {
+        throw BadAnyCast();
+    }
+    return static_cast<T>(*p);
 }
 
 template <typename T>
 T any_cast(const any &operand) {
-    using U = std::remove_reference_t<T>;
-    const void *p = any_cast_impl_ref(&operand, typeid(U));
-    return static_cast<T>(*static_cast<const U *>(p));
-}
-
-template <typename T>
-T any_cast(any &&operand) {
-    using U = std::remove_reference_t<T>;
-    void *p = any_cast_impl_ref(&operand, typeid(U));
-    return static_cast<T>(std::move(*static_cast<U *>(p)));
-}
-
-template <typename T>
-const T *any_cast(const any *operand) noexcept {
-    if (!operand || !operand->has_value() || operand->type() != typeid(T)) {
-        return nullptr;
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    const U *p = any_cast<U>(&operand);
+    if (!p) {
+        throw BadAnyCast();
     }
-    return static_cast<const T *>(operand->_get_value_ptr());
+    return static_cast<T>(*p);
 }
 
 template <typename T>
-T *any_cast(any *operand) noexcept {
-    if (!operand || !operand->has_value() || operand->type() != typeid(T)) {
-        return nullptr;
+T any_cast(any &&operand) {
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    U *p = any_cast<U>(&operand);
+    if (!p) {
+        throw BadAnyCast();
     }
-    return static_cast<T *>(operand->_get_value_ptr());
+    return static_cast<T>(std::move(*p));
 }
 
 template <typename T, typename... Args>
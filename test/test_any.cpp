@@ -1,11 +1,32 @@
 #include <cassert> // 用于简单的断言
+#include <cstdlib>
 #include <iostream>
+#include <new>
 #include <stdexcept> // 尽管 BadAnyCast 继承自 std::exception，但显式包含有助于理解
 #include <string>
 #include <type_traits>     // 用于 std::decay_t 等
 #include <utility/any.hpp> // 包含你的 Marcus::any 实现
 #include <vector>
 
+// 统计堆分配次数，检查小的值放在 any 里
+static int allocations = 0;
+
+void *operator new(std::size_t n) {
+    ++allocations;
+    if (void *p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
 // --- 测试辅助宏和自定义结构体 ---
 
 // 帮助打印测试用例的名称和结果
@@ -471,6 +492,92 @@ void test_make_any() {
     TEST_PASSED()
 }
 
+// 记录存活对象个数，检查放在 any 里的值只析构一次
+struct Counted {
+    static inline int alive = 0;
+    int value;
+
+    Counted(int v) : value(v) {
+        ++alive;
+    }
+
+    Counted(const Counted &other) : value(other.value) {
+        ++alive;
+    }
+
+    Counted(Counted &&other) noexcept : value(other.value) {
+        ++alive;
+    }
+
+    ~Counted() {
+        --alive;
+    }
+};
+
+// 移动可能抛异常，不能放在 any 里
+struct ThrowingMove {
+    int value;
+
+    ThrowingMove(int v) : value(v) {}
+
+    ThrowingMove(const ThrowingMove &) = default;
+
+    ThrowingMove(ThrowingMove &&other) noexcept(false) : value(other.value) {}
+};
+
+struct Big {
+    void *p[4];
+};
+
+void test_small_object() {
+    TEST_CASE("Small object storage")
+    int before = allocations;
+    {
+        Marcus::any a = 42;
+        Marcus::any b = 3.5;
+        Marcus::any c = &before;
+        Marcus::any d = a;
+        Marcus::any e = std::move(b);
+        d.swap(e);
+        assert(Marcus::any_cast<int>(e) == 42);
+        assert(Marcus::any_cast<double>(d) == 3.5);
+        assert(Marcus::any_cast<int *>(c) == &before);
+        assert(Marcus::any_cast<double>(&a) == nullptr);
+        assert(Marcus::any_cast<const int>(&a) != nullptr);
+    }
+    assert(allocations == before);
+
+    {
+        Marcus::any a = Counted(7);
+        assert(Counted::alive == 1);
+        Marcus::any b = a;
+        Marcus::any c = std::move(a);
+        assert(Counted::alive == 2);
+        assert(Marcus::any_cast<Counted &>(c).value == 7);
+        c = 1;
+        assert(Counted::alive == 1);
+        b.reset();
+        assert(Counted::alive == 0);
+    }
+    assert(allocations == before);
+
+    before = allocations;
+    Marcus::any big = Big{};
+    assert(allocations == before + 1);
+    Marcus::any moved = std::move(big);
+    assert(allocations == before + 1);
+    assert(Marcus::any_cast<Big>(&moved) != nullptr);
+
+    before = allocations;
+    Marcus::any t = ThrowingMove(5);
+    assert(allocations == before + 1);
+    Marcus::any small = 9;
+    small.swap(t);
+    assert(Marcus::any_cast<ThrowingMove &>(small).value == 5);
+    assert(Marcus::any_cast<int>(t) == 9);
+    TEST_PASSED()
+}
+
 int main() {
     std::cout << "Starting Marcus::any tests..." << std::endl << std::endl;
 
@@ -489,6 +596,7 @@ int main() {
     test_any_cast_ref();
     test_any_cast_ptr();
     test_make_any();
+    test_small_object();
 
     std::cout << "All Marcus::any tests passed successfully!" << std::endl;
 
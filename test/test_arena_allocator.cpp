@@ -0,0 +1,202 @@
+#include <cassert>
+#include <containers/deque.hpp>
+#include <containers/forward_list.hpp>
+#include <containers/list.hpp>
+#include <containers/map.hpp>
+#include <containers/set.hpp>
+#include <containers/vector.hpp>
+#include <limits>
+#include <memory/arena_allocator.hpp>
+#include <memory/shared_ptr.hpp>
+#include <new>
+#include <stdio.h>
+#include <string>
+
+template <class T>
+using Arena = Marcus::arena_allocator<T>;
+
+static int live = 0;
+
+struct Counted {
+    int x;
+
+    explicit Counted(int x_) : x(x_) {
+        ++live;
+    }
+
+    ~Counted() {
+        --live;
+    }
+};
+
+struct Throws {
+    Throws() {
+        throw 1;
+    }
+};
+
+int main() {
+    {
+        alignas(64) char buf[256];
+        Marcus::monotonic_arena arena(buf, sizeof buf);
+        void *a = arena.allocate(10, 1);
+        void *b = arena.allocate(8, 8);
+        void *c = arena.allocate(1, 64);
+        assert(a == buf);
+        assert(reinterpret_cast<std::uintptr_t>(b) % 8 == 0 && b > a);
+        assert(reinterpret_cast<std::uintptr_t>(c) % 64 == 0 && c > b);
+        arena.deallocate(b, 8, 8);
+        assert(arena.allocate(1, 1) > c); // deallocate 不回收
+        assert(arena.bytes_reserved() == 0);
+        void *big = arena.allocate(1000);
+        assert(big < (void *)buf || big >= (void *)(buf + sizeof buf));
+        assert(arena.bytes_reserved() >= 1000);
+        arena.release();
+        assert(arena.bytes_reserved() == 0);
+        assert(arena.allocate(4, 1) == buf);
+        // 过大的请求不能因为加上对齐或块头而回绕
+        for (std::size_t huge: {std::numeric_limits<std::size_t>::max(),
+                                std::numeric_limits<std::size_t>::max() - 8}) {
+            bool threw = false;
+            try {
+                arena.allocate(huge, 16);
+            } catch (std::bad_alloc const &) {
+                threw = true;
+            }
+            assert(threw);
+        }
+        assert(arena.allocate(4, 1) == buf + 4);
+    }
+    {
+        Marcus::monotonic_arena arena;
+        for (int i = 0; i < 100; ++i) {
+            arena.allocate(100);
+        }
+        size_t reserved = arena.bytes_reserved();
+        arena.reset(); // 只留下最大的一块
+        assert(arena.bytes_reserved() < reserved);
+        size_t kept = arena.bytes_reserved();
+        for (int round = 0; round < 10; ++round) {
+            for (int i = 0; i < 50; ++i) {
+                arena.allocate(100);
+            }
+            arena.reset();
+            assert(arena.bytes_reserved() == kept);
+        }
+    }
+    {
+        Marcus::monotonic_arena arena;
+        Arena<int> a(arena);
+        Arena<std::string> b(a);
+        assert(a == b && b.arena() == &arena);
+        Marcus::monotonic_arena other;
+        assert(a != Arena<int>(other));
+    }
+    {
+        Marcus::monotonic_arena arena;
+        Marcus::vector<int, Arena<int>> v(arena);
+        for (int i = 0; i < 1000; ++i) {
+            v.push_back(i);
+        }
+        assert(v.size() == 1000 && v[999] == 999);
+        Marcus::vector<int, Arena<int>> w(v);
+        assert(w.get_allocator() == v.get_allocator());
+        Marcus::vector<int, Arena<int>> u(3, 7, Arena<int>(arena));
+        assert(u.size() == 3 && u[2] == 7);
+        u = std::move(w);
+        assert(u.size() == 1000 && w.size() == 0);
+
+        Marcus::vector<std::string, Arena<std::string>> s(arena);
+        for (int i = 0; i < 100; ++i) {
+            s.push_back(std::string(40, 'a' + i % 26));
+        }
+        assert(s[27] == std::string(40, 'b'));
+    }
+    {
+        Marcus::monotonic_arena arena;
+        Marcus::deque<int, Arena<int>> d(arena);
+        for (int i = 0; i < 2000; ++i) {
+            if (i % 2) {
+                d.push_back(i);
+            } else {
+                d.push_front(i);
+            }
+        }
+        assert(d.size() == 2000 && d.front() == 1998 && d.back() == 1999);
+        d.erase(d.begin() + 10, d.begin() + 500);
+        assert(d.size() == 1510);
+    }
+    {
+        Marcus::monotonic_arena arena;
+        Marcus::list<std::string, Arena<std::string>> l(arena);
+        Marcus::forward_list<int, Arena<int>> fl(arena);
+        for (int i = 0; i < 300; ++i) {
+            l.push_back(std::to_string(i));
+            fl.push_front(i);
+        }
+        assert(l.size() == 300 && l.back() == "299");
+        assert(fl.front() == 299);
+        Marcus::list<std::string, Arena<std::string>> l2(l);
+        assert(l2.size() == 300 && l2.front() == "0");
+    }
+    {
+        Marcus::monotonic_arena arena;
+        using Map = Marcus::map<int, std::string, std::less<int>,
+                                Arena<std::pair<const int, std::string>>>;
+        Map m(arena);
+        for (int i = 0; i < 500; ++i) {
+            m[i * 13 % 500] = std::to_string(i);
+        }
+        for (int i = 0; i < 500; i += 2) {
+            m.erase(i);
+        }
+        assert(m.size() == 250);
+        // 节点句柄带着分配器移动，arena_allocator 不能默认构造
+        Map::node_type nh = m.extract(1);
+        assert(!nh.empty() && nh.key() == 1);
+        Map::node_type held;
+        assert(held.empty());
+        held = std::move(nh);
+        assert(nh.empty() && held.key() == 1);
+        auto reinserted = m.insert(std::move(held));
+        assert(reinserted.second && m.size() == 250);
+        Map copy(m);
+        assert(copy.size() == 250 && copy.get_allocator() == m.get_allocator());
+        Map moved(std::move(copy));
+        assert(moved.size() == 250 && copy.size() == 0);
+
+        Marcus::set<int, std::less<int>, Arena<int>> s(arena);
+        Marcus::multiset<int, std::less<int>, Arena<int>> ms(arena);
+        for (int i = 0; i < 100; ++i) {
+            s.insert(i % 10);
+            ms.insert(i % 10);
+        }
+        assert(s.size() == 10 && ms.size() == 100);
+    }
+    {
+        Marcus::monotonic_arena arena;
+        {
+            auto p = Marcus::allocate_shared<Counted>(Arena<Counted>(arena), 5);
+            assert(p->x == 5 && live == 1);
+            auto q = p;
+            assert(q.use_count() == 2);
+            Marcus::weak_ptr<Counted> w = p;
+            p = nullptr;
+            q = nullptr;
+            assert(live == 0 && w.expired());
+        }
+        size_t reserved = arena.bytes_reserved();
+        try {
+            Marcus::allocate_shared<Throws>(Arena<Throws>(arena));
+            assert(false);
+        } catch (int) {
+        }
+        assert(arena.bytes_reserved() == reserved);
+
+        auto p = Marcus::allocate_shared<std::string>(
+            std::allocator<std::string>(), 100, 'x');
+        assert(p->size() == 100);
+    }
+    printf("ok\n");
+    return 0;
+}
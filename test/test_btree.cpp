@@ -0,0 +1,296 @@
+#include <cassert>
+#include <containers/btree_map.hpp>
+#include <containers/btree_set.hpp>
+#include <map>
+#include <random>
+#include <set>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// 通过派生类访问树的内部结构，检查 B 树的性质
+template <class _Base>
+struct checked : _Base {
+    using _Base::_Base;
+    using typename _Base::_Node;
+
+    // 返回子树的高度，同时检查父指针、元素个数和键的顺序
+    int _M_check(_Node *__node, _Node *__parent, std::size_t __position,
+                 std::size_t &__total) const {
+        assert(__node->_M_parent == __parent);
+        assert(__node->_M_position == __position);
+        assert(__node->_M_count <= _Base::_S_capacity);
+        assert(__parent == nullptr || __node->_M_count > 0);
+        for (std::size_t __i = 1; __i < __node->_M_count; ++__i) {
+            assert(!this->_M_comp(this->_S_key(__node, __i),
+                                  this->_S_key(__node, __i - 1)));
+        }
+        __total += __node->_M_count;
+        if (__node->_M_leaf) {
+            return 1;
+        }
+        int __h = _M_check(__node->_M_child(0), __node, 0, __total);
+        for (std::size_t __i = 1; __i <= __node->_M_count; ++__i) {
+            assert(_M_check(__node->_M_child(__i), __node, __i, __total) ==
+                   __h);
+        }
+        return __h + 1;
+    }
+
+    int height() const {
+        if (this->_M_root == nullptr) {
+            assert(this->_M_size == 0 && this->begin() == this->end());
+            return 0;
+        }
+        std::size_t __total = 0;
+        int __h = _M_check(this->_M_root, nullptr, 0, __total);
+        assert(__total == this->size());
+        _Node *__node = this->_M_root;
+        while (!__node->_M_leaf) {
+            __node = __node->_M_child(0);
+        }
+        assert(__node == this->_M_leftmost);
+        __node = this->_M_root;
+        while (!__node->_M_leaf) {
+            __node = __node->_M_child(__node->_M_count);
+        }
+        assert(__node == this->_M_rightmost);
+        assert(std::size_t(std::distance(this->begin(), this->end())) ==
+               this->size());
+        return __h;
+    }
+};
+
+// 每个节点只放 3 个元素，少量数据就能触发多层分裂与合并
+template <class K, class V>
+using tiny_map = checked<Marcus::btree_map<
+    K, V, std::less<K>, std::allocator<std::pair<const K, V>>, 16>>;
+template <class K, class V>
+using tiny_multimap = checked<Marcus::btree_multimap<
+    K, V, std::less<K>, std::allocator<std::pair<const K, V>>, 16>>;
+template <class K>
+using tiny_multiset = checked<
+    Marcus::btree_multiset<K, std::less<K>, std::allocator<K>, 16>>;
+
+int main() {
+    static_assert(tiny_map<int, int>::node_capacity == 3);
+    static_assert(Marcus::btree_map<int, int>::node_capacity == 30);
+    {
+        Marcus::btree_map<std::string, int> m;
+        m["b"] = 2;
+        m.insert({"a", 1});
+        m.emplace("c", 3);
+        assert(m.size() == 3 && m.at("a") == 1 && m["c"] == 3);
+        assert(m.begin()->first == "a" && (--m.end())->first == "c");
+        auto [it, ok] = m.try_emplace("a", 100);
+        assert(!ok && it->second == 1);
+        auto r = m.insert_or_assign("a", 10);
+        assert(!r.second && m.at("a") == 10);
+        r = m.insert_or_assign("d", 4);
+        assert(r.second && r.first->first == "d");
+        assert(m.lower_bound("bb")->first == "c");
+        assert(m.upper_bound("c")->first == "d");
+        std::size_t erased = m.erase("b");
+        std::size_t erased_again = m.erase("b");
+        assert(erased == 1 && erased_again == 0 && !m.contains("b"));
+        bool threw = false;
+        try {
+            m.at("zz");
+        } catch (std::out_of_range const &) {
+            threw = true;
+        }
+        assert(threw);
+        // 透明比较可以直接用 const char * 查找
+        Marcus::btree_map<std::string, int, std::less<>> t = {{"x", 1},
+                                                              {"y", 2}};
+        assert(t.find("y")->second == 2 && t.count("z") == 0);
+        assert(t.contains("x") && t.lower_bound("xa")->first == "y");
+        assert(t.at("x") == 1);
+        std::size_t erased_x = t.erase("x");
+        assert(erased_x == 1 && t.size() == 1);
+    }
+    {
+        // 随机操作与 std::map / std::multimap 对比，每一步后都检查结构
+        std::mt19937 rng(7);
+        tiny_map<int, int> m;
+        tiny_multimap<int, int> mm;
+        std::map<int, int> ref;
+        std::multimap<int, int> mref;
+        for (int round = 0; round < 20000; ++round) {
+            int k = int(rng() % 300);
+            int op = int(rng() % 8);
+            if (op < 3) {
+                auto [it, ok] = m.try_emplace(k, round);
+                auto [rit, rok] = ref.try_emplace(k, round);
+                assert(ok == rok && it->second == rit->second);
+                auto mit = mm.insert({k, round});
+                assert(mit->first == k && mit->second == round);
+                mref.insert({k, round});
+            } else if (op == 3) {
+                auto hint = m.lower_bound(int(rng() % 300));
+                m.emplace_hint(hint, k, round);
+                ref.emplace(k, round);
+                mm.emplace_hint(mm.end(), k, round);
+                mref.emplace_hint(mref.end(), k, round);
+            } else if (op == 4) {
+                auto it = m.find(k);
+                if (it != m.end()) {
+                    auto next = m.erase(it);
+                    auto rnext = ref.erase(ref.find(k));
+                    assert(rnext == ref.end() ? next == m.end()
+                                              : next->first == rnext->first);
+                }
+            } else if (op == 5) {
+                std::size_t n = m.erase(k);
+                std::size_t rn = ref.erase(k);
+                assert(n == rn);
+                std::size_t mn = mm.erase(k);
+                std::size_t mrn = mref.erase(k);
+                assert(mn == mrn);
+            } else if (op == 6) {
+                // 从 lower_bound 开始删一段
+                auto first = mm.lower_bound(k);
+                auto last = first;
+                auto rfirst = mref.lower_bound(k);
+                auto rlast = rfirst;
+                for (int i = int(rng() % 5); i > 0 && last != mm.end(); --i) {
+                    ++last;
+                    ++rlast;
+                }
+                auto next = mm.erase(first, last);
+                auto rnext = mref.erase(rfirst, rlast);
+                assert(rnext == mref.end() ? next == mm.end()
+                                           : *next == *rnext);
+            } else {
+                assert(m.contains(k) == bool(ref.count(k)));
+                assert(mm.count(k) == mref.count(k));
+                auto lb = m.lower_bound(k);
+                auto rlb = ref.lower_bound(k);
+                assert(rlb == ref.end() ? lb == m.end() : *lb == *rlb);
+                auto ub = mm.upper_bound(k);
+                auto rub = mref.upper_bound(k);
+                assert(rub == mref.end() ? ub == mm.end() : *ub == *rub);
+            }
+            if (round % 97 == 0) {
+                m.height();
+                mm.height();
+            }
+        }
+        m.height();
+        mm.height();
+        assert(std::equal(m.begin(), m.end(), ref.begin(), ref.end()));
+        assert(std::equal(mm.begin(), mm.end(), mref.begin(), mref.end()));
+        assert(std::equal(m.rbegin(), m.rend(), ref.rbegin(), ref.rend()));
+        // 删到空树再重新插入
+        while (!m.empty()) {
+            m.erase(m.begin());
+        }
+        m.height();
+        m[1] = 1;
+        assert(m.size() == 1 && m.begin()->second == 1);
+    }
+    {
+        // 非平凡重定位的元素（std::string）
+        std::mt19937 rng(5);
+        checked<Marcus::btree_set<std::string, std::less<std::string>,
+                                  std::allocator<std::string>, 64>>
+            s;
+        std::set<std::string> ref;
+        for (int round = 0; round < 5000; ++round) {
+            std::string k = "key" + std::to_string(rng() % 1000);
+            if (rng() % 3) {
+                bool inserted = s.insert(k).second;
+                bool rinserted = ref.insert(k).second;
+                assert(inserted == rinserted);
+            } else {
+                std::size_t n = s.erase(k);
+                std::size_t rn = ref.erase(k);
+                assert(n == rn);
+            }
+        }
+        s.height();
+        assert(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+        auto copy = s;
+        copy.height();
+        assert(copy == s);
+        copy.erase(copy.begin());
+        assert(copy != s && s < copy);
+        auto moved = std::move(copy);
+        assert(copy.empty() && moved.size() == s.size() - 1);
+    }
+    {
+        // 顺序追加把节点填满，以 end() 为提示每个元素只比较一次
+        std::size_t compares = 0;
+        auto counting = [&compares](int a, int b) {
+            ++compares;
+            return a < b;
+        };
+        checked<Marcus::btree_set<int, decltype(counting)>> s(counting);
+        for (int i = 0; i < 10000; ++i) {
+            s.emplace_hint(s.end(), i);
+        }
+        assert(compares <= 10000);
+        assert(s.height() == 3);
+        assert(*s.rbegin() == 9999 && *--s.end() == 9999);
+        auto it = s.insert(s.find(5001), 5000);
+        assert(*it == 5000);
+        auto last = --s.end();
+        ++last;
+        assert(last == s.end() && *--last == 9999);
+
+        std::vector<int> sorted(1000);
+        for (int i = 0; i < 1000; ++i) {
+            sorted[i] = i / 3;
+        }
+        tiny_multiset<int> ms(Marcus::sorted_equivalent, sorted.begin(),
+                              sorted.end());
+        ms.height();
+        assert(ms.size() == 1000 && ms.count(7) == 3);
+        checked<Marcus::btree_map<int, int>> m(
+            Marcus::sorted_unique, {{1, 1}, {2, 2}, {5, 5}});
+        m.height();
+        assert(m.size() == 3 && m.at(5) == 5);
+        m.assign({{3, 3}, {1, 1}, {3, 4}});
+        assert(m.size() == 2 && m.at(3) == 3);
+    }
+    {
+        // extract 把元素搬进句柄，可以改键后再插入
+        tiny_map<std::string, int> m = {{"a", 1}, {"b", 2}, {"c", 3}};
+        auto nh = m.extract("b");
+        assert(!nh.empty() && nh.mapped() == 2 && m.size() == 2);
+        m.height();
+        auto nh2 = std::move(nh);
+        assert(nh.empty() && nh2.key() == "b");
+        auto [it, ok] = m.insert(std::move(nh2));
+        assert(ok && it->first == "b" && nh2.empty());
+        auto dup = m.extract(m.begin());
+        m.insert({"a", 5});
+        auto r = m.insert(std::move(dup));
+        assert(!r.second && !dup.empty() && dup.mapped() == 1);
+        auto missing = m.extract("zz");
+        assert(missing.empty());
+
+        // merge 直接搬元素；唯一键的容器里已有的键留在源中
+        tiny_map<int, int> a;
+        tiny_map<int, int> b;
+        tiny_multimap<int, int> c;
+        for (int i = 0; i < 200; ++i) {
+            a.emplace(i * 2, 0);
+            b.emplace(i * 3, 1);
+            c.emplace(i % 10, 2);
+        }
+        a.merge(b);
+        a.height();
+        b.height();
+        assert(a.size() + b.size() == 400 && b.size() == 67);
+        for (auto const &kv: b) {
+            assert(kv.first % 2 == 0 && a.at(kv.first) == 0);
+        }
+        c.merge(a);
+        c.height();
+        a.height();
+        assert(a.empty() && c.size() == 533 && c.count(0) == 21);
+    }
+    printf("ok\n");
+    return 0;
+}
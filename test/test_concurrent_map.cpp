@@ -0,0 +1,139 @@
+#include <atomic>
+#include <cassert>
+#include <containers/concurrent_map.hpp>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 统计还没释放的节点和版本，检查旧版本最终都被回收
+static std::atomic<long> live = 0;
+
+template <class T>
+struct counting_allocator : std::allocator<T> {
+    using value_type = T;
+
+    template <class U>
+    struct rebind {
+        using other = counting_allocator<U>;
+    };
+
+    counting_allocator() = default;
+
+    template <class U>
+    counting_allocator(counting_allocator<U> const &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        ++live;
+        return std::allocator<T>::allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        --live;
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+int main() {
+    {
+        Marcus::concurrent_map<std::string, int> m = {{"a", 1}, {"b", 2}};
+        assert(m.size() == 2 && m.contains("a") && !m.contains("c"));
+        bool inserted = m.insert({"c", 3});
+        bool inserted_dup = m.insert({"c", 30});
+        assert(inserted && !inserted_dup);
+        bool tried = m.try_emplace("d", 4);
+        bool tried_dup = m.try_emplace("d", 40);
+        assert(tried && !tried_dup);
+        auto snap = m.snapshot();
+        bool assigned_a = m.insert_or_assign("a", 10);
+        bool assigned_e = m.insert_or_assign("e", 5);
+        assert(!assigned_a && assigned_e);
+        assert(m.get("a").value() == 10 && !m.get("zz").has_value());
+        assert(snap.at("a") == 1 && snap.size() == 4 && m.size() == 5);
+        std::string seen;
+        bool visited = m.visit("b", [&](auto const &kv) {
+            seen = kv.first;
+        });
+        bool visited_missing = m.visit("zz", [](auto const &) {});
+        assert(visited && seen == "b" && !visited_missing);
+        std::size_t erased = m.erase("b");
+        std::size_t erased_again = m.erase("b");
+        assert(erased == 1 && erased_again == 0 && !m.contains("b"));
+        // 一批修改一次发布，异常时不发布
+        std::size_t n = m.update([](auto &map) {
+            map.erase("a");
+            map.insert({"f", 6});
+            return map.size();
+        });
+        assert(n == 4 && m.size() == 4);
+        bool threw = false;
+        try {
+            m.update([](auto &map) {
+                map.clear();
+                throw 1;
+            });
+        } catch (int) {
+            threw = true;
+        }
+        assert(threw && m.size() == 4);
+        m.clear();
+        assert(m.empty());
+    }
+    {
+        // 写者在两个键之间来回转移，读者在任何时刻看到的总和都不变
+        using map = Marcus::concurrent_map<
+            int, long, std::less<int>,
+            counting_allocator<std::pair<const int, long>>>;
+        constexpr int keys = 256;
+        {
+            map m;
+            m.update([&](auto &v) {
+                for (int i = 0; i < keys; ++i) {
+                    v.insert({i, 100});
+                }
+            });
+            std::atomic<bool> done = false;
+            std::vector<std::thread> readers;
+            for (int t = 0; t < 4; ++t) {
+                readers.emplace_back([&, t] {
+                    unsigned k = unsigned(t);
+                    while (!done.load()) {
+                        for (int i = 0; i < 100; ++i) {
+                            k = k * 1103515245u + 12345u;
+                            assert(m.get(int(k % keys)).has_value());
+                        }
+                        long sum = 0;
+                        auto snap = m.snapshot();
+                        for (auto const &kv: snap) {
+                            sum += kv.second;
+                        }
+                        assert(sum == 100L * keys && snap.size() == keys);
+                    }
+                });
+            }
+            unsigned r = 1;
+            for (int round = 0; round < 5000; ++round) {
+                r = r * 1664525u + 1013904223u;
+                int from = int(r % keys);
+                int to = int((r >> 16) % keys);
+                m.update([&](auto &v) {
+                    long amount = round % 7;
+                    v.insert_or_assign(from, v.at(from) - amount);
+                    v.insert_or_assign(to, v.at(to) + amount);
+                });
+            }
+            done = true;
+            for (auto &t: readers) {
+                t.join();
+            }
+            long sum = 0;
+            for (auto const &kv: m.snapshot()) {
+                sum += kv.second;
+            }
+            assert(sum == 100L * keys);
+        }
+        assert(live == 0);
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <atomic>
+#include <cassert>
+#include <containers/concurrent_unordered_map.hpp>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 统计还没释放的节点、表和分片，检查摘下的节点和旧表最终都被回收
+static std::atomic<long> live = 0;
+
+template <class T>
+struct counting_allocator : std::allocator<T> {
+    using value_type = T;
+
+    template <class U>
+    struct rebind {
+        using other = counting_allocator<U>;
+    };
+
+    counting_allocator() = default;
+
+    template <class U>
+    counting_allocator(counting_allocator<U> const &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        ++live;
+        return std::allocator<T>::allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        --live;
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+int main() {
+    {
+        Marcus::concurrent_unordered_map<std::string, int> m(5);
+        assert(m.shard_count() == 8 && m.empty());
+        bool inserted = m.insert({"a", 1});
+        bool inserted_dup = m.insert({"a", 10});
+        assert(inserted && !inserted_dup);
+        bool tried = m.try_emplace("b", 2);
+        bool tried_dup = m.try_emplace("b", 20);
+        assert(tried && !tried_dup);
+        bool assigned_c = m.insert_or_assign("c", 3);
+        bool assigned_a = m.insert_or_assign("a", 11);
+        assert(assigned_c && !assigned_a);
+        assert(m.size() == 3 && m.contains("a") && !m.contains("z"));
+        assert(m.get("a").value() == 11 && !m.get("z").has_value());
+        auto found_b = m.find_or_emplace("b", 200);
+        assert(found_b == std::make_pair(2, false));
+        auto found_d = m.find_or_emplace("d", 4);
+        assert(found_d == std::make_pair(4, true));
+        bool updated = m.update_fn("d", [](int &v) {
+            v *= 10;
+        });
+        bool updated_missing = m.update_fn("z", [](int &) {});
+        assert(updated && !updated_missing && m.get("d").value() == 40);
+        std::string seen;
+        bool visited = m.visit("c", [&](auto const &kv) {
+            seen = kv.first;
+        });
+        bool visited_missing = m.visit("z", [](auto const &) {});
+        assert(visited && seen == "c" && !visited_missing);
+        // __fn 抛出异常时不修改
+        bool threw = false;
+        try {
+            m.update_fn("a", [](int &v) {
+                v = 0;
+                throw 1;
+            });
+        } catch (int) {
+            threw = true;
+        }
+        assert(threw && m.get("a").value() == 11);
+        std::size_t erased = m.erase("b");
+        std::size_t erased_again = m.erase("b");
+        assert(erased == 1 && erased_again == 0 && !m.contains("b"));
+        int sum = 0;
+        m.for_each([&](auto const &kv) {
+            sum += kv.second;
+        });
+        assert(sum == 11 + 3 + 40);
+        // 扩容后仍然都能找到
+        for (int i = 0; i < 1000; ++i) {
+            m.insert({std::to_string(i), i});
+        }
+        assert(m.size() == 1003);
+        for (int i = 0; i < 1000; ++i) {
+            assert(m.get(std::to_string(i)).value() == i);
+        }
+        m.clear();
+        assert(m.empty() && !m.contains("a"));
+    }
+    {
+        using map = Marcus::concurrent_unordered_map<
+            int, long, std::hash<int>, std::equal_to<int>,
+            counting_allocator<std::pair<const int, long>>>;
+        constexpr int keys = 512;
+        {
+            // 写者对固定的键做计数，同时插入、删除另一批键触发扩容；
+            // 读者始终能看到固定的键
+            map m(4);
+            for (int i = 0; i < keys; ++i) {
+                m.insert({i, 0});
+            }
+            std::atomic<bool> done = false;
+            std::vector<std::thread> readers;
+            for (int t = 0; t < 4; ++t) {
+                readers.emplace_back([&, t] {
+                    unsigned k = unsigned(t);
+                    while (!done.load()) {
+                        k = k * 1103515245u + 12345u;
+                        assert(m.get(int(k % keys)).has_value());
+                        m.contains(keys + int(k % 4096));
+                    }
+                });
+            }
+            constexpr int writers = 4, rounds = 20000;
+            std::vector<std::thread> workers;
+            for (int t = 0; t < writers; ++t) {
+                workers.emplace_back([&, t] {
+                    unsigned r = unsigned(t) + 1;
+                    for (int round = 0; round < rounds; ++round) {
+                        r = r * 1664525u + 1013904223u;
+                        bool hit = m.update_fn(int(r % keys), [](long &v) {
+                            ++v;
+                        });
+                        assert(hit);
+                        int extra = keys + int((r >> 8) % 4096);
+                        if (round % 3 == 0) {
+                            m.erase(extra);
+                        } else {
+                            m.find_or_emplace(extra, 1L);
+                        }
+                    }
+                });
+            }
+            for (auto &t: workers) {
+                t.join();
+            }
+            done = true;
+            for (auto &t: readers) {
+                t.join();
+            }
+            long sum = 0;
+            m.for_each([&](auto const &kv) {
+                if (kv.first < keys) {
+                    sum += kv.second;
+                }
+            });
+            assert(sum == long(writers) * rounds);
+        }
+        assert(live == 0);
+    }
+    printf("ok\n");
+    return 0;
+}
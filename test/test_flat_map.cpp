@@ -0,0 +1,154 @@
+#include <cassert>
+#include <containers/flat_map.hpp>
+#include <map>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+template <class Flat, class Ref>
+static void check_equal(const Flat &f, const Ref &r) {
+    assert(f.size() == r.size());
+    auto it = r.begin();
+    for ([[maybe_unused]] auto [k, v]: f) {
+        assert(k == it->first && v == it->second);
+        ++it;
+    }
+}
+
+int main() {
+    {
+        std::vector<std::pair<int, std::string>> input = {
+            {5, "a"}, {1, "b"}, {3, "c"}, {1, "dup"}, {4, "d"}, {5, "dup"}};
+        Marcus::flat_map<int, std::string> m(input.begin(), input.end());
+        assert(m.size() == 4);
+        assert(m.at(1) == "b" && m.at(5) == "a"); // 重复的键保留第一个
+        assert((m.keys() == Marcus::vector<int>{1, 3, 4, 5}));
+        assert(m.values()[2] == "d");
+        assert(m.lower_bound(2)->first == 3);
+        assert(m.upper_bound(3)->first == 4);
+        assert(m.find(2) == m.end());
+        assert(m.contains(4) && !m.contains(6) && m.count(5) == 1);
+        [[maybe_unused]] auto range = m.equal_range(3);
+        assert(range.second - range.first == 1 && range.first->second == "c");
+
+        [[maybe_unused]] auto [it, inserted] = m.try_emplace(2, "e");
+        assert(inserted && it->second == "e" && it - m.begin() == 1);
+        [[maybe_unused]] bool again = m.try_emplace(2, "f").second;
+        assert(!again && m[2] == "e");
+        m[7] = "g";
+        [[maybe_unused]] bool assigned = m.insert_or_assign(7, "h").second;
+        assert(!assigned && m.at(7) == "h");
+        [[maybe_unused]] bool emplaced = m.emplace(0, "z").second;
+        assert(emplaced);
+        assert(m.begin()->second == "z" && (--m.end())->first == 7);
+        [[maybe_unused]] std::size_t erased = m.erase(3);
+        [[maybe_unused]] std::size_t erased_again = m.erase(3);
+        assert(erased == 1 && erased_again == 0);
+        m.erase(m.begin());
+        assert(m.begin()->first == 1);
+        [[maybe_unused]] bool threw = false;
+        try {
+            m.at(100);
+        } catch (std::out_of_range const &) {
+            threw = true;
+        }
+        assert(threw);
+
+        const auto &cm = m;
+        [[maybe_unused]] Marcus::flat_map<int, std::string>::const_iterator
+            cit = m.begin();
+        assert(cit == cm.begin());
+        for (auto rit = cm.rbegin(); rit != cm.rend(); ++rit) {
+            assert(cm.find(rit->first) == std::prev(rit.base()));
+        }
+
+        Marcus::flat_map<int, std::string> copy = m;
+        assert(copy == m);
+        copy[1] = "changed";
+        assert(copy != m && m < copy);
+
+        auto parts = std::move(copy).extract();
+        assert(copy.empty() && parts.keys.size() == m.size());
+    }
+    {
+        Marcus::vector<int> keys = {3, 1, 2, 1};
+        Marcus::vector<double> values = {0.3, 0.1, 0.2, 0.9};
+        Marcus::flat_map<int, double> m(std::move(keys), std::move(values));
+        assert(m.size() == 3 && m.at(1) == 0.1 && m.at(3) == 0.3);
+        Marcus::flat_map<int, double> s(Marcus::sorted_unique,
+                                        Marcus::vector<int>{1, 2},
+                                        Marcus::vector<double>{1.0, 2.0});
+        assert(s.at(2) == 2.0);
+        std::pair<int, double> more[] = {{0, 0.0}, {2, 9.0}, {5, 5.0}};
+        s.insert(Marcus::sorted_unique, more, more + 3);
+        assert(s.size() == 4 && s.at(2) == 2.0 && s.at(5) == 5.0);
+    }
+    {
+        // 透明比较
+        Marcus::flat_map<std::string, int, std::less<>> m = {
+            {"one", 1}, {"two", 2}, {"three", 3}};
+        assert(m.find("two")->second == 2);
+        assert(m.contains("three") && m.count("four") == 0);
+        assert(m.at("one") == 1);
+        m["four"] = 4;
+        assert(m.lower_bound("g")->first == "one");
+        [[maybe_unused]] std::size_t erased = m.erase("one");
+        assert(erased == 1 && m.size() == 3);
+        [[maybe_unused]] bool emplaced = m.try_emplace("five", 5).second;
+        assert(emplaced);
+    }
+    {
+        Marcus::flat_multimap<int, int> mm = {{2, 0}, {1, 1}, {2, 2}, {1, 3}};
+        assert(mm.size() == 4 && mm.count(2) == 2);
+        [[maybe_unused]] auto it = mm.insert({2, 4});
+        assert(it->second == 4 && (it + 1) == mm.end());
+        [[maybe_unused]] auto range = mm.equal_range(1);
+        assert(range.first->second == 1 && (range.first + 1)->second == 3);
+        [[maybe_unused]] std::size_t erased = mm.erase(2);
+        assert(erased == 3 && mm.size() == 2);
+    }
+    {
+        std::mt19937 rng(42);
+        Marcus::flat_map<int, int> m;
+        Marcus::flat_multimap<int, int> mm;
+        std::map<int, int> ref;
+        std::multimap<int, int> mref;
+        for (int round = 0; round < 2000; ++round) {
+            int op = rng() % 5;
+            int k = rng() % 200;
+            if (op == 0) {
+                m.insert({k, round});
+                ref.insert({k, round});
+                mm.insert({k, round});
+                mref.insert({k, round});
+            } else if (op == 1) {
+                [[maybe_unused]] std::size_t n = m.erase(k);
+                [[maybe_unused]] std::size_t rn = ref.erase(k);
+                assert(n == rn);
+                [[maybe_unused]] std::size_t mn = mm.erase(k);
+                [[maybe_unused]] std::size_t mrn = mref.erase(k);
+                assert(mn == mrn);
+            } else if (op == 2) {
+                std::vector<std::pair<int, int>> batch;
+                for (int i = int(rng() % 20); i > 0; --i) {
+                    batch.push_back({int(rng() % 200), round * 100 + i});
+                }
+                m.insert(batch.begin(), batch.end());
+                ref.insert(batch.begin(), batch.end());
+                mm.insert(batch.begin(), batch.end());
+                mref.insert(batch.begin(), batch.end());
+            } else if (op == 3) {
+                m[k] += 1;
+                ref[k] += 1;
+            } else {
+                assert(m.contains(k) == ref.count(k));
+                assert(mm.count(k) == mref.count(k));
+            }
+        }
+        check_equal(m, ref);
+        check_equal(mm, mref);
+    }
+    printf("ok\n");
+    return 0;
+}
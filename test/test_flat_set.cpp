@@ -0,0 +1,90 @@
+#include <cassert>
+#include <containers/flat_set.hpp>
+#include <random>
+#include <set>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+int main() {
+    {
+        Marcus::flat_set<int> s = {5, 1, 4, 1, 3, 5};
+        assert((s.keys() == Marcus::vector<int>{1, 3, 4, 5}));
+        assert(*s.lower_bound(2) == 3 && *s.upper_bound(4) == 5);
+        assert(s.find(2) == s.end() && s.contains(3) && s.count(1) == 1);
+        [[maybe_unused]] bool inserted = s.insert(2).second;
+        [[maybe_unused]] bool inserted_again = s.insert(2).second;
+        assert(inserted && !inserted_again);
+        [[maybe_unused]] auto emplaced = s.emplace(0);
+        assert(*emplaced.first == 0 && *s.begin() == 0);
+        [[maybe_unused]] std::size_t erased = s.erase(4);
+        assert(erased == 1 && s.size() == 5);
+        s.erase(s.begin(), s.begin() + 2);
+        assert(*s.begin() == 2);
+
+        Marcus::flat_set<int> t(Marcus::sorted_unique,
+                                Marcus::vector<int>{2, 3, 5});
+        assert(t == s);
+        int more[] = {1, 4, 9};
+        t.insert(Marcus::sorted_unique, more, more + 3);
+        assert(t.size() == 6 && *t.rbegin() == 9);
+        auto keys = std::move(t).extract();
+        assert(t.empty() && keys.size() == 6);
+    }
+    {
+        Marcus::flat_set<std::string, std::less<>> s = {"pear", "apple", "fig"};
+        assert(s.contains("fig") && s.find("kiwi") == s.end());
+        assert(*s.lower_bound("b") == "fig");
+        [[maybe_unused]] std::size_t erased = s.erase("apple");
+        assert(erased == 1 && s.size() == 2);
+    }
+    {
+        Marcus::flat_multiset<int> ms = {3, 1, 3, 2};
+        assert(ms.size() == 4 && ms.count(3) == 2);
+        ms.insert(3);
+        assert(ms.count(3) == 3);
+        [[maybe_unused]] std::size_t erased = ms.erase(3);
+        assert(erased == 3 && ms.size() == 2);
+    }
+    {
+        std::mt19937 rng(7);
+        Marcus::flat_set<int> s;
+        Marcus::flat_multiset<int> ms;
+        std::set<int> ref;
+        std::multiset<int> mref;
+        for (int round = 0; round < 3000; ++round) {
+            int op = rng() % 4;
+            int k = rng() % 300;
+            if (op == 0) {
+                [[maybe_unused]] bool inserted = s.insert(k).second;
+                [[maybe_unused]] bool rinserted = ref.insert(k).second;
+                assert(inserted == rinserted);
+                ms.insert(k);
+                mref.insert(k);
+            } else if (op == 1) {
+                [[maybe_unused]] std::size_t n = s.erase(k);
+                [[maybe_unused]] std::size_t rn = ref.erase(k);
+                assert(n == rn);
+                [[maybe_unused]] std::size_t mn = ms.erase(k);
+                [[maybe_unused]] std::size_t mrn = mref.erase(k);
+                assert(mn == mrn);
+            } else if (op == 2) {
+                std::vector<int> batch;
+                for (int i = int(rng() % 30); i > 0; --i) {
+                    batch.push_back(int(rng() % 300));
+                }
+                s.insert(batch.begin(), batch.end());
+                ref.insert(batch.begin(), batch.end());
+                ms.insert(batch.begin(), batch.end());
+                mref.insert(batch.begin(), batch.end());
+            } else {
+                assert(s.contains(k) == ref.count(k));
+                assert(ms.count(k) == mref.count(k));
+            }
+        }
+        assert(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+        assert(std::equal(ms.begin(), ms.end(), mref.begin(), mref.end()));
+    }
+    printf("ok\n");
+    return 0;
+}
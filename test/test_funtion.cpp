@@ -1,7 +1,31 @@
+#include <cassert>
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <string>
 #include <utility/functional.hpp>
 
+// 统计堆分配次数，检查小的可调用对象放在 Function 里
+static int allocations = 0;
+
+void *operator new(std::size_t n) {
+    ++allocations;
+    if (void *p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
 void func_hello(int i) {
     printf("#%d Hello\n", i);
 }
@@ -20,6 +44,14 @@ void repeattwice(const Marcus::Function<void(int)> &func) {
     func(2);
 }
 
+int apply_twice(Marcus::function_ref<int(int)> f, int i) {
+    return f(f(i));
+}
+
+int plus_one(int i) {
+    return i + 1;
+}
+
 int main() {
     int x = 4;
     int y = 2;
@@ -37,5 +69,162 @@ int main() {
     auto ff = f;
     ff(3);
 
+    {
+        // 捕获不超过 3 个指针的可调用对象不分配，复制和移动也不分配
+        int a = 1, b = 2, c = 3;
+        int before = allocations;
+        Marcus::Function<int()> small = [&a, &b, &c] {
+            return a + b + c;
+        };
+        Marcus::Function<int()> copy = small;
+        Marcus::Function<int()> moved = std::move(small);
+        assert(!small && copy() == 6 && moved() == 6);
+        copy.swap(moved);
+        Marcus::Function<int(int)> fp = +[](int i) {
+            return i * 2;
+        };
+        assert(fp(4) == 8 && *fp.target<int (*)(int)>() != nullptr);
+        assert(allocations == before);
+
+        // 大的放到堆上，移动只转移指针
+        std::string s1 = "abc", s2 = "de";
+        Marcus::Function<std::size_t()> big = [s1, s2] {
+            return s1.size() + s2.size();
+        };
+        int after_big = allocations;
+        Marcus::Function<std::size_t()> big_moved = std::move(big);
+        assert(allocations == after_big && !big && big_moved() == 5);
+        Marcus::Function<std::size_t()> big_copy = big_moved;
+        assert(big_copy() == 5 && big_copy.target_type() ==
+                                      big_moved.target_type());
+        big_copy = nullptr;
+        assert(!big_copy && big_copy.target_type() == typeid(void));
+
+        // 缓冲区放大后两个 string 也能放下（短字符串本身不分配）
+        Marcus::Function<std::size_t(), 64> wide = [s1, s2] {
+            return s1.size() * s2.size();
+        };
+        int after_wide = allocations;
+        Marcus::Function<std::size_t(), 64> wide_copy = wide;
+        assert(wide_copy() == 6 && allocations == after_wide);
+    }
+
+    {
+        // MoveOnlyFunction：小对象放在对象内，移动不分配
+        int x = 5;
+        int before = allocations;
+        Marcus::MoveOnlyFunction<int(int)> plain = [&x](int i) {
+            return x + i;
+        };
+        Marcus::MoveOnlyFunction<int(int)> plain_moved = std::move(plain);
+        assert(!plain && plain_moved(1) == 6);
+        assert(allocations == before);
+
+        // 只能移动的捕获
+        auto p = std::make_unique<int>(7);
+        before = allocations;
+        Marcus::MoveOnlyFunction<int()> owner = [p = std::move(p)] {
+            return *p;
+        };
+        Marcus::MoveOnlyFunction<int()> owner_moved;
+        owner_moved = std::move(owner);
+        assert(allocations == before && !owner && owner_moved() == 7);
+        owner_moved.swap(owner);
+        assert(!owner_moved && owner() == 7);
+        owner.reset();
+        assert(owner == nullptr);
+
+        // 放不下的在堆上，移动只转移指针
+        std::string s1 = "abc", s2 = "de";
+        Marcus::MoveOnlyFunction<std::size_t()> big = [s1, s2] {
+            return s1.size() + s2.size();
+        };
+        before = allocations;
+        Marcus::MoveOnlyFunction<std::size_t()> big_moved = std::move(big);
+        assert(allocations == before && big_moved() == 5);
+
+        struct counter {
+            int n;
+
+            int operator()() {
+                return ++n;
+            }
+        };
+
+        Marcus::MoveOnlyFunction<int(), 8> inc(std::in_place_type<counter>,
+                                                10);
+        assert(inc() == 11 && inc() == 12);
+    }
+
+    {
+        // function_ref：两个指针大小，不分配
+        static_assert(sizeof(Marcus::function_ref<int(int)>) ==
+                      2 * sizeof(void *));
+        int before = allocations;
+        int k = 3;
+        auto mul = [&k](int i) {
+            return i * k;
+        };
+        assert(apply_twice(mul, 2) == 18);
+        assert(apply_twice(plus_one, 2) == 4 && apply_twice(&plus_one, 0) == 2);
+        assert(apply_twice([](int i) { return i - 1; }, 5) == 3);
+
+        // 引用的是对象本身，调用看得到对象的状态变化
+        struct counter {
+            int n = 0;
+
+            int operator()(int i) {
+                return n += i;
+            }
+        } c;
+
+        Marcus::function_ref<int(int)> r = c;
+        Marcus::function_ref<int(int)> r2 = r;
+        r(1);
+        r2(2);
+        assert(c.n == 3);
+
+        const auto &cmul = mul;
+        Marcus::function_ref<long(int)> widened = cmul;
+        assert(widened(4) == 12);
+
+        Marcus::Function<int(int)> f = mul;
+        assert(apply_twice(f, 1) == 9);
+        assert(allocations == before);
+    }
+
+    {
+        // inplace_function：从不分配，放不下的可调用对象编译不过
+        std::string s1 = "abc", s2 = "de";
+        int before = allocations;
+        Marcus::inplace_function<std::size_t(), 2 * sizeof(std::string)> f =
+            [s1, s2] {
+                return s1.size() + s2.size();
+            };
+        auto copy = f;
+        auto moved = std::move(f);
+        assert(!f && copy() == 5 && moved() == 5);
+        assert(copy.target_type() == moved.target_type());
+        assert(allocations == before);
+
+        Marcus::inplace_function<int(int)> g = plus_one;
+        assert(g(1) == 2 && *g.target<int (*)(int)>() == &plus_one);
+        assert(g.target<std::string>() == nullptr);
+        g = [](int i) {
+            return i * 3;
+        };
+        assert(g(2) == 6);
+        g = nullptr;
+        assert(!g && g.target_type() == typeid(void));
+        bool threw = false;
+        try {
+            g(1);
+        } catch (std::bad_function_call const &) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    printf("ok\n");
     return 0;
 }
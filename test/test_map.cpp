@@ -1,3 +1,4 @@
+#include <cassert>
 #include <containers/map.hpp>
 #include <iostream>
 #include <string>
@@ -18,4 +19,24 @@ int main() {
 
     std::cout << "at(delay)" << table.at("delay") << std::endl;
     std::cout << "size: " << table.size() << std::endl;
+
+    // size() 是缓存的计数，每种修改都必须维护它
+    Marcus::map<int, int> counted;
+    for (int i = 0; i < 100; i++) {
+        counted.emplace(i, i);
+    }
+    counted.insert({5, 5});
+    assert(counted.size() == 100);
+    counted.erase(5);
+    counted.erase(counted.begin());
+    assert(counted.size() == 98);
+    auto node = counted.extract(42);
+    assert(counted.size() == 97 && node.key() == 42);
+    counted.insert(std::move(node));
+    assert(counted.size() == 98);
+    Marcus::map<int, int> moved(std::move(counted));
+    assert(moved.size() == 98 && counted.size() == 0);
+    moved.clear();
+    assert(moved.size() == 0 && moved.empty());
+    std::cout << "cached size ok" << std::endl;
 }
@@ -0,0 +1,231 @@
+#include <cassert>
+#include <containers/persistent_map.hpp>
+#include <map>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 统计节点分配次数，检查一次修改只新建 O(log n) 个节点
+static std::size_t allocations = 0;
+static std::size_t live_nodes = 0;
+
+template <class T>
+struct counting_allocator : std::allocator<T> {
+    using value_type = T;
+
+    template <class U>
+    struct rebind {
+        using other = counting_allocator<U>;
+    };
+
+    counting_allocator() = default;
+
+    template <class U>
+    counting_allocator(counting_allocator<U> const &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        ++allocations;
+        ++live_nodes;
+        return std::allocator<T>::allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        --live_nodes;
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+// 通过派生类访问树的内部结构，检查红黑树的性质
+template <class _Base>
+struct checked : _Base {
+    using _Base::_Base;
+    using typename _Base::_Node;
+
+    // 返回黑高，同时检查红节点的子节点为黑、键的顺序和引用计数
+    int _M_check(const _Node *__node, std::size_t &__total) const {
+        if (__node == nullptr) {
+            return 1;
+        }
+        assert(__node->_M_refs.load() >= 1);
+        if (__node->_M_color == _S_red) {
+            assert(!this->_S_is_red(__node->_M_left));
+            assert(!this->_S_is_red(__node->_M_right));
+        }
+        if (__node->_M_left) {
+            assert(this->_M_comp(__node->_M_left->_M_value.first,
+                                 __node->_M_value.first));
+        }
+        if (__node->_M_right) {
+            assert(this->_M_comp(__node->_M_value.first,
+                                 __node->_M_right->_M_value.first));
+        }
+        ++__total;
+        int __h = _M_check(__node->_M_left, __total);
+        assert(_M_check(__node->_M_right, __total) == __h);
+        return __h + (__node->_M_color == _S_black);
+    }
+
+    int black_height() const {
+        assert(!this->_S_is_red(this->_M_root));
+        std::size_t __total = 0;
+        int __h = _M_check(this->_M_root, __total);
+        assert(__total == this->size());
+        assert(std::size_t(std::distance(this->begin(), this->end())) ==
+               this->size());
+        return __h;
+    }
+};
+
+int main() {
+    {
+        Marcus::persistent_map<std::string, int> m = {{"b", 2}, {"a", 1}};
+        bool inserted = m.insert({"c", 3});
+        bool inserted_dup = m.insert({"a", 9});
+        assert(inserted && !inserted_dup);
+        bool emplaced = m.emplace("d", 4);
+        bool tried = m.try_emplace("e", 5);
+        assert(emplaced && tried);
+        bool tried_dup = m.try_emplace("e", 50);
+        assert(!tried_dup && m.at("e") == 5);
+        assert(m.size() == 5 && m.begin()->first == "a");
+        auto snap = m;
+        assert(snap.shares_with(m) && snap == m);
+        bool assigned_new = m.insert_or_assign("a", 10);
+        assert(!assigned_new && m.at("a") == 10);
+        assigned_new = m.insert_or_assign("f", 6);
+        assert(assigned_new && m.size() == 6);
+        assert(!snap.shares_with(m) && snap.at("a") == 1 && snap.size() == 5);
+        std::size_t erased = m.erase("b");
+        std::size_t erased_again = m.erase("b");
+        assert(erased == 1 && erased_again == 0 && !m.contains("b"));
+        assert(snap.contains("b") && snap.find("b")->second == 2);
+        assert(m.lower_bound("bb")->first == "c");
+        assert(m.upper_bound("c")->first == "d");
+        assert(m.find("zz") == m.end() && m.count("a") == 1);
+        bool threw = false;
+        try {
+            m.at("zz");
+        } catch (std::out_of_range const &) {
+            threw = true;
+        }
+        assert(threw);
+        // 透明比较可以直接用 const char * 查找
+        Marcus::persistent_map<std::string, int, std::less<>> t = {{"x", 1},
+                                                                   {"y", 2}};
+        assert(t.find("y")->second == 2 && t.count("z") == 0);
+        assert(t.at("x") == 1);
+        std::size_t erased_x = t.erase("x");
+        assert(erased_x == 1 && t.size() == 1);
+        auto moved = std::move(snap);
+        assert(snap.empty() && moved.size() == 5);
+        snap = moved;
+        moved.clear();
+        assert(snap.size() == 5 && moved.empty() && snap < m);
+    }
+    {
+        // 随机修改与 std::map 对比，并不时留下快照，最后检查每个快照都没变
+        using map = checked<Marcus::persistent_map<
+            int, int, std::less<int>,
+            counting_allocator<std::pair<const int, int>>>>;
+        std::mt19937 rng(11);
+        map m;
+        std::map<int, int> ref;
+        std::vector<std::pair<map, std::map<int, int>>> snapshots;
+        for (int round = 0; round < 30000; ++round) {
+            int k = int(rng() % 2000);
+            int op = int(rng() % 6);
+            if (op < 2) {
+                bool inserted = m.insert({k, round});
+                bool rinserted = ref.insert({k, round}).second;
+                assert(inserted == rinserted);
+            } else if (op == 2) {
+                bool inserted = m.insert_or_assign(k, round);
+                assert(inserted == !ref.count(k));
+                ref[k] = round;
+            } else if (op < 5) {
+                std::size_t n = m.erase(k);
+                std::size_t rn = ref.erase(k);
+                assert(n == rn);
+            } else {
+                auto lb = m.lower_bound(k);
+                auto rlb = ref.lower_bound(k);
+                assert(rlb == ref.end() ? lb == m.end() : *lb == *rlb);
+                auto ub = m.upper_bound(k);
+                auto rub = ref.upper_bound(k);
+                assert(rub == ref.end() ? ub == m.end() : *ub == *rub);
+            }
+            assert(m.size() == ref.size());
+            if (round % 101 == 0) {
+                m.black_height();
+            }
+            if (round % 1000 == 0) {
+                snapshots.emplace_back(m, ref);
+            }
+        }
+        m.black_height();
+        assert(std::equal(m.begin(), m.end(), ref.begin(), ref.end()));
+        for (auto const &[snap, sref]: snapshots) {
+            snap.black_height();
+            assert(std::equal(snap.begin(), snap.end(), sref.begin(),
+                              sref.end()));
+        }
+
+        // 有快照时修改一次只分配路径上的节点
+        map big;
+        for (int i = 0; i < 4096; ++i) {
+            big.insert({i * 2, i});
+        }
+        int h = big.black_height();
+        for (int i = 0; i < 1000; ++i) {
+            map snap = big;
+            std::size_t before = allocations;
+            int k = int(rng() % 8192);
+            if (i % 2) {
+                big.insert_or_assign(k, -i);
+            } else {
+                big.erase(k);
+            }
+            assert(allocations - before <= std::size_t(2 * h + 4));
+            assert(snap.size() >= 4000);
+        }
+        big.black_height();
+
+        snapshots.clear();
+        m.clear();
+        big.clear();
+        assert(live_nodes == 0);
+    }
+    {
+        // 读者线程持有快照时写者继续修改，快照在读者线程里释放
+        Marcus::persistent_map<int, std::string> m;
+        for (int i = 0; i < 1000; ++i) {
+            m.insert({i, std::to_string(i)});
+        }
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([snap = m]() mutable {
+                for (int round = 0; round < 20; ++round) {
+                    std::size_t n = 0;
+                    for (auto const &kv: snap) {
+                        assert(kv.second == std::to_string(kv.first));
+                        ++n;
+                    }
+                    assert(n == 1000);
+                }
+                snap.clear();
+            });
+        }
+        for (int i = 0; i < 1000; ++i) {
+            m.erase(i);
+            m.insert_or_assign(i + 1000, "x");
+        }
+        for (auto &t: readers) {
+            t.join();
+        }
+        assert(m.size() == 1000 && m.begin()->first == 1000);
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,244 @@
+#include <cassert>
+#include <containers/forward_list.hpp>
+#include <containers/list.hpp>
+#include <containers/map.hpp>
+#include <containers/set.hpp>
+#include <map>
+#include <memory/pool_allocator.hpp>
+#include <stdio.h>
+#include <string>
+#include <type_traits>
+
+template <class T>
+using Pool = Marcus::pool_allocator<T>;
+
+int main() {
+    {
+        Marcus::node_pool pool;
+        void *a = pool.allocate(24);
+        void *b = pool.allocate(24);
+        assert(a != b);
+        size_t reserved = pool.bytes_reserved();
+        assert(reserved > 0);
+        pool.deallocate(a, 24);
+        assert(pool.allocate(24) == a); // 空闲链表复用
+        void *big = pool.allocate(4096);
+        pool.deallocate(big, 4096);
+        assert(pool.bytes_reserved() == reserved);
+        pool.deallocate(b, 24);
+        pool.release();
+        assert(pool.bytes_reserved() == 0);
+    }
+    {
+        Pool<int> a;
+        Pool<double> b(a);
+        Pool<int> c(b);
+        Pool<int> d;
+        assert(a == b && a == c && !(a != c));
+        assert(a != d);
+        assert(&a.pool() == &c.pool());
+        d = a;
+        assert(a == d);
+        int *p = a.allocate(1);
+        *p = 42;
+        c.deallocate(p, 1);
+        int *q = a.allocate(8);
+        c.deallocate(q, 8);
+    }
+    {
+        using Map = Marcus::map<int, std::string, std::less<int>,
+                                Pool<std::pair<const int, std::string>>>;
+        // 容器扩容时移动而不是复制元素
+        static_assert(std::is_nothrow_move_constructible_v<Map>);
+        static_assert(std::is_nothrow_move_constructible_v<Marcus::set<int>>);
+        Map m;
+        std::map<int, std::string> ref;
+        for (int i = 0; i < 1000; ++i) {
+            m[i * 7 % 1000] = std::to_string(i);
+            ref[i * 7 % 1000] = std::to_string(i);
+        }
+        size_t reserved = m.get_allocator().pool().bytes_reserved();
+        for (int round = 0; round < 5; ++round) {
+            for (int i = round; i < 1000; i += 2) {
+                m.erase(i);
+                ref.erase(i);
+            }
+            for (int i = round; i < 1000; i += 2) {
+                m[i] = "x" + std::to_string(i);
+                ref[i] = "x" + std::to_string(i);
+            }
+            // 删掉的节点回到空闲链表，重新插入不会再向系统要内存
+            assert(m.get_allocator().pool().bytes_reserved() == reserved);
+        }
+        assert(m.size() == ref.size());
+        assert(std::equal(m.begin(), m.end(), ref.begin(), ref.end()));
+
+        {
+            Map::node_type nh = m.extract(5);
+            m[5] = "five";
+            Map::node_type other = m.extract(6);
+            other = std::move(nh);
+            assert(other.key() == 5 && nh.key() == 6);
+            auto dup = m.insert(std::move(other));
+            assert(!dup.second && m.at(5) == "five");
+            auto reinserted = m.insert(std::move(nh));
+            assert(reinserted.second);
+            auto empty = m.insert(Map::node_type());
+            assert(empty.first == m.end());
+            // 被拒绝的节点回到 m 自己的池里，下一次分配直接复用
+            reserved = m.get_allocator().pool().bytes_reserved();
+            m[1000] = "new";
+            assert(m.get_allocator().pool().bytes_reserved() == reserved);
+            m.erase(1000);
+            m[5] = ref[5];
+        }
+
+        Map moved(std::move(m));
+        assert(moved.size() == ref.size() && m.size() == 0);
+        m[1] = "one";
+        assert(m.size() == 1 && m.at(1) == "one");
+        m = std::move(moved);
+        assert(m.size() == ref.size());
+        Map copy(m);
+        assert(copy.size() == m.size());
+        assert(copy.get_allocator() != m.get_allocator());
+        copy.clear();
+        assert(std::equal(m.begin(), m.end(), ref.begin(), ref.end()));
+
+        // const 版本的集合运算：拷贝出来的节点要来自 m 的池
+        Map other;
+        for (int i = 500; i < 1500; ++i) {
+            other[i] = "o";
+        }
+        Map u = m;
+        u.set_union(other);
+        assert(u.size() == 1500 && u.at(999) == ref[999] && u.at(1499) == "o");
+        u.set_intersection(other);
+        assert(u.size() == 1000 && u.begin()->first == 500);
+        u.set_difference(m);
+        assert(u.size() == 500 && u.begin()->first == 1000);
+        assert(other.size() == 1000);
+    }
+    {
+        Marcus::set<int, std::less<int>, Pool<int>> a, b;
+        for (int i = 0; i < 100; ++i) {
+            a.insert(i);
+            b.insert(i + 50);
+        }
+        a.set_union(b);
+        assert(a.size() == 150);
+        a.set_difference(b);
+        assert(a.size() == 50 && *a.rbegin() == 49);
+        a.set_intersection(b);
+        assert(a.empty() && b.size() == 100);
+        // 右值版本两个池不相等时也先拷贝
+        {
+            Marcus::set<int, std::less<int>, Pool<int>> c;
+            for (int i = 0; i < 100; ++i) {
+                c.insert(i * 2);
+            }
+            a.set_union(std::move(c));
+            assert(c.empty());
+        }
+        assert(a.size() == 100 && *a.rbegin() == 198);
+        a.set_difference(std::move(b));
+        assert(a.size() == 50 && b.empty() && !a.contains(100));
+    }
+    {
+        // 两个池不相等，merge 在 *this 的池里重新构造元素
+        Marcus::set<std::string, std::less<std::string>, Pool<std::string>> s;
+        s.insert("a");
+        s.insert("c");
+        {
+            Marcus::multiset<std::string, std::less<std::string>,
+                             Pool<std::string>>
+                from;
+            for (const char *x: {"a", "b", "b", "d"}) {
+                from.insert(x);
+            }
+            assert(from.get_allocator() != s.get_allocator());
+            s.merge(from);
+            assert(from.size() == 2 && *from.begin() == "a" &&
+                   *from.rbegin() == "b");
+        }
+        std::string joined;
+        for (auto const &x: s) {
+            joined += x;
+        }
+        assert(s.size() == 4 && joined == "abcd");
+
+        using Multimap =
+            Marcus::multimap<int, std::string, std::less<int>,
+                             Pool<std::pair<const int, std::string>>>;
+        Multimap mm;
+        mm.emplace(1, "x");
+        {
+            Multimap from;
+            from.emplace(1, "y");
+            from.emplace(0, "z");
+            mm.merge(std::move(from));
+            assert(from.empty());
+        }
+        assert(mm.size() == 3 && mm.begin()->second == "z");
+        assert(std::next(mm.begin())->second == "x" &&
+               mm.rbegin()->second == "y");
+    }
+    {
+        Marcus::set<int, std::less<int>, Pool<int>> s;
+        for (int i = 0; i < 500; ++i) {
+            s.insert(i * 31 % 500);
+        }
+        size_t reserved = s.get_allocator().pool().bytes_reserved();
+        for (int i = 0; i < 500; i += 3) {
+            s.erase(i);
+        }
+        for (int i = 0; i < 500; i += 3) {
+            s.insert(i);
+        }
+        assert(s.size() == 500);
+        assert(s.get_allocator().pool().bytes_reserved() == reserved);
+        int expect = 0;
+        for (int x: s) {
+            assert(x == expect++);
+        }
+    }
+    {
+        Marcus::list<std::string, Pool<std::string>> l;
+        for (int i = 0; i < 200; ++i) {
+            l.push_back(std::to_string(i));
+        }
+        size_t reserved = l.get_allocator().pool().bytes_reserved();
+        for (int i = 0; i < 100; ++i) {
+            l.pop_front();
+            l.push_back("y");
+        }
+        assert(l.size() == 200);
+        assert(l.get_allocator().pool().bytes_reserved() == reserved);
+        Marcus::list<std::string, Pool<std::string>> other;
+        other.push_back("z");
+        other = std::move(l);
+        assert(other.size() == 200 && other.front() == "100");
+        l = other;
+        assert(l.size() == 200 && l.back() == "y");
+    }
+    {
+        Marcus::forward_list<int, Pool<int>> fl;
+        for (int i = 0; i < 300; ++i) {
+            fl.push_front(i);
+        }
+        size_t reserved = fl.get_allocator().pool().bytes_reserved();
+        for (int i = 0; i < 300; ++i) {
+            fl.pop_front();
+        }
+        for (int i = 0; i < 300; ++i) {
+            fl.push_front(-i);
+        }
+        assert(fl.get_allocator().pool().bytes_reserved() == reserved);
+        Marcus::forward_list<int, Pool<int>> other;
+        other.push_front(1);
+        other.swap(fl);
+        assert(other.front() == -299 && fl.front() == 1);
+    }
+    printf("ok\n");
+    return 0;
+}
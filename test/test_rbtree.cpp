@@ -0,0 +1,455 @@
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <containers/map.hpp>
+#include <containers/set.hpp>
+#include <map>
+#include <random>
+#include <set>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// 通过派生类访问树的内部结构，检查红黑树的性质
+template <class _Base>
+struct checked : _Base {
+    using _Base::_Base;
+
+    // 返回子树的黑高，同时检查父指针和红节点的子节点
+    int _M_check(_RbTreeNode *__node, _RbTreeNode *__parent) const {
+        if (__node == nullptr) {
+            return 1;
+        }
+        assert(__node->_M_parent() == __parent);
+        assert(__node->_M_is_root() == (__parent == nullptr));
+        if (__node->_M_color() == _S_red) {
+            assert(_RbTreeBase::_S_is_black(__node->_M_left));
+            assert(_RbTreeBase::_S_is_black(__node->_M_right));
+        }
+        int __lh = _M_check(__node->_M_left, __node);
+        int __rh = _M_check(__node->_M_right, __node);
+        assert(__lh == __rh);
+        if constexpr (requires { this->nth(0); }) {
+            // 顺序统计模式下还要检查子树大小
+            assert(_RbTreeBase::_S_count(__node) ==
+                   _RbTreeBase::_S_count(__node->_M_left) +
+                       _RbTreeBase::_S_count(__node->_M_right) + 1);
+        }
+        return __lh + (__node->_M_color() == _S_black);
+    }
+
+    int black_height() const {
+        _RbTreeNode *__root = this->_M_block->_M_root;
+        assert(__root == nullptr || __root->_M_color() == _S_black);
+        assert(__root == nullptr ||
+               __root->_M_root_slot() == &this->_M_block->_M_root);
+        int __h = _M_check(__root, nullptr);
+        assert(std::size_t(std::distance(this->begin(), this->end())) ==
+               this->size());
+        return __h;
+    }
+};
+
+int main() {
+    // 各种大小的有序输入都要建出合法的红黑树
+    for (int n = 0; n < 300; ++n) {
+        std::vector<int> input(n);
+        for (int i = 0; i < n; ++i) {
+            input[i] = i * 2;
+        }
+        checked<Marcus::set<int>> s(input.begin(), input.end());
+        s.black_height();
+        assert(std::equal(s.begin(), s.end(), input.begin(), input.end()));
+        checked<Marcus::set<int>> t(Marcus::sorted_unique, input.begin(),
+                                    input.end());
+        t.black_height();
+        assert(std::equal(t.begin(), t.end(), input.begin(), input.end()));
+        // 建好之后继续插入和删除，结构依然合法
+        for (int i = 0; i < n; i += 3) {
+            t.insert(i * 2 + 1);
+            t.erase(i * 2);
+        }
+        t.black_height();
+    }
+    {
+        // 有序但有重复：set 保留第一个，multiset 全部保留且保持输入顺序
+        std::vector<std::pair<int, int>> input = {
+            {1, 0}, {1, 1}, {2, 2}, {3, 3}, {3, 4}, {3, 5}, {7, 6}};
+        checked<Marcus::map<int, int>> m(input.begin(), input.end());
+        m.black_height();
+        assert(m.size() == 4 && m.at(1) == 0 && m.at(3) == 3);
+        checked<Marcus::multimap<int, int>> mm(input.begin(), input.end());
+        mm.black_height();
+        assert(mm.size() == 7);
+        int expect = 0;
+        for (auto const &kv: mm) {
+            assert(kv.second == expect++);
+        }
+        checked<Marcus::multiset<int>> ms(Marcus::sorted_equivalent,
+                                          {1, 1, 2, 2, 2, 5});
+        ms.black_height();
+        assert(ms.size() == 6 && ms.count(2) == 3);
+        std::vector<int> more = {3, 3, 4, 9};
+        ms.assign(Marcus::sorted_equivalent, more.begin(), more.end());
+        ms.black_height();
+        assert(ms.size() == 4 && ms.count(3) == 2);
+    }
+    {
+        // 无序输入走逐个插入，和 std::map 的结果一致
+        std::mt19937 rng(3);
+        for (int round = 0; round < 50; ++round) {
+            std::vector<std::pair<int, int>> input;
+            for (int i = int(rng() % 200); i > 0; --i) {
+                input.push_back({int(rng() % 100), i});
+            }
+            if (round % 2) {
+                std::stable_sort(input.begin(), input.end(),
+                                 [](auto const &a, auto const &b) {
+                                     return a.first < b.first;
+                                 });
+            }
+            checked<Marcus::map<int, int>> m(input.begin(), input.end());
+            checked<Marcus::multimap<int, int>> mm;
+            mm.assign(input.begin(), input.end());
+            m.black_height();
+            mm.black_height();
+            std::map<int, int> ref(input.begin(), input.end());
+            std::multimap<int, int> mref(input.begin(), input.end());
+            assert(std::equal(m.begin(), m.end(), ref.begin(), ref.end()));
+            assert(std::equal(mm.begin(), mm.end(), mref.begin(), mref.end()));
+
+            Marcus::map<int, int> copy = m;
+            assert(
+                std::equal(copy.begin(), copy.end(), ref.begin(), ref.end()));
+            copy = m;
+            assert(copy.size() == m.size());
+        }
+    }
+    {
+        std::vector<std::string> words = {"apple", "fig", "kiwi", "pear"};
+        checked<Marcus::set<std::string>> s;
+        s.assign(Marcus::sorted_unique, words.begin(), words.end());
+        s.black_height();
+        assert(s.size() == 4 && *s.rbegin() == "pear");
+        s.assign(words.rbegin(), words.rend());
+        s.black_height();
+        assert(s.size() == 4 && *s.begin() == "apple");
+    }
+    {
+        // 以 end() 为提示按顺序追加，每个元素只比较常数次
+        std::size_t compares = 0;
+        auto counting = [&compares](int a, int b) {
+            ++compares;
+            return a < b;
+        };
+        checked<Marcus::set<int, decltype(counting)>> s(counting);
+        for (int i = 0; i < 10000; ++i) {
+            s.emplace_hint(s.end(), i);
+        }
+        assert(compares <= 10000);
+        s.black_height();
+        assert(*s.rbegin() == 9999 && *--s.end() == 9999);
+        // 提示正确时 O(1)，重复的键返回已有元素
+        auto hint = s.find(5000);
+        compares = 0;
+        auto it = s.insert(hint, 5000);
+        assert(*it == 5000 && s.size() == 10000 && compares <= 2);
+        s.erase(5000);
+        hint = s.find(5001);
+        compares = 0;
+        s.insert(hint, 5000);
+        assert(compares <= 4 && s.size() == 10000);
+        s.erase(9999);
+        assert(*--s.end() == 9998);
+        // 从最大元素走到 end() 再走回来，从最小元素走到 rend() 再走回来
+        auto last = --s.end();
+        ++last;
+        assert(last == s.end() && *--last == 9998);
+        auto first = --s.rend();
+        ++first;
+        assert(first == s.rend() && *--first == 0);
+        s.erase(s.begin(), s.end());
+        assert(s.empty() && s.begin() == s.end());
+        s.insert(s.end(), 1);
+        assert(*--s.end() == 1);
+    }
+    {
+        // 随机的提示（正确或错误）和 std::set / std::multiset 对比
+        std::mt19937 rng(11);
+        checked<Marcus::set<int>> s;
+        checked<Marcus::multiset<int>> ms;
+        checked<Marcus::map<int, int>> m;
+        checked<Marcus::multimap<int, int>> mm;
+        std::set<int> ref;
+        std::multiset<int> mref;
+        std::multimap<int, int> mmref;
+        for (int round = 0; round < 5000; ++round) {
+            int k = int(rng() % 500);
+            int op = rng() % 4;
+            if (op == 0) {
+                auto hint = s.lower_bound(int(rng() % 500));
+                auto it = s.insert(hint, k);
+                assert(*it == k);
+                ref.insert(k);
+                m.emplace_hint(m.lower_bound(k), k, round);
+            } else if (op == 1) {
+                auto hint = rng() % 2 ? ms.end() : ms.upper_bound(k);
+                auto it = ms.emplace_hint(hint, k);
+                assert(*it == k);
+                mref.insert(k);
+                // 提示恰好是等价元素的 lower_bound 时插在它们前面
+                mm.insert(mm.lower_bound(k), {k, round});
+                mmref.insert(mmref.lower_bound(k), {k, round});
+            } else if (op == 2) {
+                s.erase(k);
+                ref.erase(k);
+                ms.erase(k);
+                mref.erase(k);
+            } else {
+                assert(s.contains(k) == bool(ref.count(k)));
+                if (!ms.empty()) {
+                    assert(*--ms.end() == *mref.rbegin());
+                }
+            }
+        }
+        s.black_height();
+        ms.black_height();
+        m.black_height();
+        mm.black_height();
+        assert(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+        assert(std::equal(ms.begin(), ms.end(), mref.begin(), mref.end()));
+        assert(std::equal(mm.begin(), mm.end(), mmref.begin(), mmref.end()));
+        // 非空树的区间插入以 end() 为提示
+        std::vector<int> tail = {1000, 1001, 1002, 3, 1003};
+        s.insert(tail.begin(), tail.end());
+        ref.insert(tail.begin(), tail.end());
+        s.black_height();
+        assert(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+    }
+    {
+        // 顺序统计模式：插入、删除、提示插入、有序构建之后 nth / rank 都和
+        // std::multiset 的下标一致
+        std::mt19937 rng(13);
+        using ranked_multiset = checked<
+            Marcus::multiset<int, std::less<int>, std::allocator<int>, true>>;
+        using ranked_map =
+            checked<Marcus::map<int, int, std::less<int>,
+                                std::allocator<std::pair<const int, int>>,
+                                true>>;
+        ranked_multiset ms;
+        ranked_map m;
+        std::multiset<int> mref;
+        std::map<int, int> ref;
+        for (int round = 0; round < 20000; ++round) {
+            int k = int(rng() % 400);
+            int op = int(rng() % 6);
+            if (op < 2) {
+                ms.insert(k);
+                mref.insert(k);
+                m.try_emplace(k, round);
+                ref.try_emplace(k, round);
+            } else if (op == 2) {
+                ms.emplace_hint(ms.lower_bound(int(rng() % 400)), k);
+                mref.insert(k);
+                m.emplace_hint(m.end(), k, round);
+                ref.emplace(k, round);
+            } else if (op == 3) {
+                assert(ms.erase(k) == mref.erase(k));
+                auto it = m.find(k);
+                if (it != m.end()) {
+                    m.erase(it);
+                    ref.erase(k);
+                }
+            } else if (op == 4 && !ms.empty()) {
+                // 按下标取出再放回
+                std::size_t pos = rng() % ms.size();
+                auto nh = ms.extract(ms.nth(pos));
+                assert(nh.value() == *std::next(mref.begin(), pos));
+                ms.insert(std::move(nh));
+            } else {
+                assert(ms.count(k) == mref.count(k));
+                assert(ms.rank(k) ==
+                       std::size_t(std::distance(mref.begin(),
+                                                 mref.lower_bound(k))));
+                assert(m.rank(k) == std::size_t(std::distance(
+                                        ref.begin(), ref.lower_bound(k))));
+            }
+            if (round % 499 == 0) {
+                ms.black_height();
+                m.black_height();
+            }
+        }
+        ms.black_height();
+        m.black_height();
+        assert(std::equal(ms.begin(), ms.end(), mref.begin(), mref.end()));
+        std::size_t i = 0;
+        for (auto it = ms.begin(); it != ms.end(); ++it, ++i) {
+            assert(ms.nth(i) == it && ms.rank(it) == i);
+        }
+        assert(ms.nth(ms.size()) == ms.end() && ms.rank(ms.end()) == i);
+        assert(ms.distance(ms.begin(), ms.end()) == std::ptrdiff_t(i));
+        auto mid = ms.nth(i / 2);
+        assert(ms.distance(mid, ms.begin()) == -std::ptrdiff_t(i / 2));
+        i = 0;
+        for (auto const &kv: ref) {
+            assert(*m.nth(i++) == kv);
+        }
+
+        // 有序构建和拷贝也要维护子树大小
+        std::vector<int> sorted(1000);
+        for (int j = 0; j < 1000; ++j) {
+            sorted[j] = j / 2;
+        }
+        ranked_multiset built(Marcus::sorted_equivalent, sorted.begin(),
+                              sorted.end());
+        built.black_height();
+        assert(*built.nth(501) == 250 && built.rank(250) == 500);
+        assert(built.count(250) == 2);
+        ranked_multiset copy = built;
+        copy.erase(copy.nth(0));
+        copy.black_height();
+        assert(copy.size() == 999 && *copy.nth(0) == 0 && *copy.nth(1) == 1);
+    }
+    {
+        // split / join 集合运算与 std::set_union 等对比，结果仍是合法的红黑树
+        std::mt19937 rng(17);
+        using ranked_set = checked<
+            Marcus::set<int, std::less<int>, std::allocator<int>, true>>;
+        auto random_set = [&](std::size_t n, int range) {
+            std::set<int> ref;
+            while (ref.size() < n) {
+                ref.insert(int(rng() % range));
+            }
+            return ref;
+        };
+        auto run = [&](auto tag, std::set<int> const &x,
+                       std::set<int> const &y) {
+            using S = decltype(tag);
+            std::vector<int> expect;
+            S a(x.begin(), x.end());
+            a.set_union(S(y.begin(), y.end()));
+            a.black_height();
+            std::set_union(x.begin(), x.end(), y.begin(), y.end(),
+                           std::back_inserter(expect));
+            assert(std::equal(a.begin(), a.end(), expect.begin(),
+                              expect.end()));
+            expect.clear();
+            S b(x.begin(), x.end());
+            S other(y.begin(), y.end());
+            b.set_intersection(std::move(other));
+            assert(other.empty() && other.begin() == other.end());
+            b.black_height();
+            std::set_intersection(x.begin(), x.end(), y.begin(), y.end(),
+                                  std::back_inserter(expect));
+            assert(std::equal(b.begin(), b.end(), expect.begin(),
+                              expect.end()));
+            expect.clear();
+            S c(x.begin(), x.end());
+            c.set_difference(S(y.begin(), y.end()));
+            c.black_height();
+            std::set_difference(x.begin(), x.end(), y.begin(), y.end(),
+                                std::back_inserter(expect));
+            assert(std::equal(c.begin(), c.end(), expect.begin(),
+                              expect.end()));
+            // 运算之后树照常可用
+            c.insert(-1);
+            c.erase(c.begin());
+            c.black_height();
+        };
+        for (std::size_t n: {0, 1, 2, 5, 40, 300}) {
+            for (std::size_t m: {0, 1, 3, 17, 250}) {
+                std::set<int> x = random_set(n, 600);
+                std::set<int> y = random_set(m, 600);
+                run(checked<Marcus::set<int>>(), x, y);
+                run(ranked_set(), x, y);
+            }
+        }
+        // 足够大时会分给多个线程
+        std::set<int> x = random_set(60000, 200000);
+        std::set<int> y = random_set(50000, 200000);
+        run(checked<Marcus::set<int>>(), x, y);
+        run(ranked_set(), x, y);
+
+        // map 中键相同时保留 *this 的值；const 版本不改动参数
+        checked<Marcus::map<int, int>> m = {{1, 1}, {2, 2}, {3, 3}};
+        Marcus::map<int, int> const other = {{2, 20}, {4, 40}};
+        m.set_union(other);
+        m.black_height();
+        assert(m.size() == 4 && m.at(2) == 2 && m.at(4) == 40);
+        assert(other.size() == 2);
+        m.set_intersection(other);
+        assert(m.size() == 2 && m.at(2) == 2 && m.at(4) == 40);
+        m.set_difference(Marcus::map<int, int>{{4, 0}});
+        assert(m.size() == 1 && m.begin()->second == 2);
+        m.set_union(std::move(m));
+        assert(m.size() == 1);
+        m.set_difference(std::move(m));
+        assert(m.empty());
+    }
+    {
+        // merge 直接搬节点：来源小时逐个插入，两边都大时归并后重建
+        std::mt19937 rng(19);
+        for (std::size_t n: {0, 10, 1000}) {
+            for (std::size_t m: {0, 1, 10, 1000}) {
+                std::vector<int> xs(n);
+                std::vector<int> ys(m);
+                for (auto &x: xs) {
+                    x = int(rng() % 1500);
+                }
+                for (auto &y: ys) {
+                    y = int(rng() % 1500);
+                }
+                checked<Marcus::set<int>> s(xs.begin(), xs.end());
+                checked<Marcus::multiset<int>> ms(ys.begin(), ys.end());
+                std::set<int> ref(xs.begin(), xs.end());
+                std::multiset<int> mref(ys.begin(), ys.end());
+                const int *first = s.empty() ? nullptr : &*s.begin();
+                s.merge(ms);
+                ref.merge(mref);
+                s.black_height();
+                ms.black_height();
+                assert(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+                assert(std::equal(ms.begin(), ms.end(), mref.begin(),
+                                  mref.end()));
+                // 节点没有重新分配
+                assert(first == nullptr || s.contains(*first));
+                assert(first == nullptr || &*s.find(*first) == first);
+
+                checked<Marcus::multimap<int, int>> mm;
+                std::multimap<int, int> mmref;
+                for (std::size_t i = 0; i < n; ++i) {
+                    mm.emplace(xs[i], int(i));
+                    mmref.emplace(xs[i], int(i));
+                }
+                Marcus::multimap<int, int> from;
+                for (std::size_t i = 0; i < m; ++i) {
+                    from.emplace(ys[i], -int(i));
+                    mmref.emplace(ys[i], -int(i));
+                }
+                mm.merge(std::move(from));
+                mm.black_height();
+                assert(from.empty());
+                // 等价的元素中原有的排在前面
+                assert(std::equal(mm.begin(), mm.end(), mmref.begin(),
+                                  mmref.end()));
+            }
+        }
+        using ranked_map =
+            checked<Marcus::map<int, int, std::less<int>,
+                                std::allocator<std::pair<const int, int>>,
+                                true>>;
+        ranked_map a;
+        ranked_map b;
+        for (int i = 0; i < 3000; ++i) {
+            a.emplace(i * 2, 0);
+            b.emplace(i * 3, 1);
+        }
+        a.merge(b);
+        a.black_height();
+        b.black_height();
+        assert(a.size() == 5000 && b.size() == 1000);
+        assert(a.at(3) == 1 && a.at(6) == 0 && b.nth(1)->first == 6);
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <cassert>
+#include <containers/small_vector.hpp>
+#include <memory>
+#include <stdio.h>
+#include <string>
+
+static int live = 0;
+
+struct Tracked {
+    std::string s;
+
+    Tracked(std::string x) : s(std::move(x)) {
+        ++live;
+    }
+
+    Tracked(const Tracked &that) : s(that.s) {
+        ++live;
+    }
+
+    Tracked(Tracked &&that) noexcept : s(std::move(that.s)) {
+        ++live;
+    }
+
+    Tracked &operator=(const Tracked &) = default;
+    Tracked &operator=(Tracked &&) noexcept = default;
+
+    ~Tracked() {
+        --live;
+    }
+
+    bool operator==(const Tracked &that) const {
+        return s == that.s;
+    }
+
+    auto operator<=>(const Tracked &that) const {
+        return s <=> that.s;
+    }
+};
+
+int main() {
+    Marcus::small_vector<int, 4> arr;
+    assert(arr.capacity() == 4);
+    for (int i = 0; i < 4; i++) {
+        arr.push_back(i);
+    }
+    assert(!arr.is_heap_allocated());
+    arr.push_back(4);
+    assert(arr.is_heap_allocated());
+    arr.insert(arr.begin() + 1, {10, 11});
+    arr.erase(arr.begin());
+    for (size_t i = 0; i < arr.size(); i++) {
+        printf("arr[%zd] = %d\n", i, arr[i]);
+    }
+    assert((arr == Marcus::small_vector<int, 4>{10, 11, 1, 2, 3, 4}));
+    arr.resize(3);
+    arr.shrink_to_fit();
+    assert(!arr.is_heap_allocated());
+    assert((arr == Marcus::small_vector<int, 4>{10, 11, 1}));
+    assert((arr < Marcus::small_vector<int, 4>{10, 12}));
+
+    {
+        Marcus::small_vector<Tracked, 2> a;
+        a.emplace_back("a");
+        a.emplace_back("b");
+        Marcus::small_vector<Tracked, 2> b(a);
+        b.emplace(b.begin(), b[1]);
+        assert(b.size() == 3 && b[0].s == "b" && b[1].s == "a");
+        Marcus::small_vector<Tracked, 2> c(std::move(a));
+        assert(a.empty() && c.size() == 2 && c[1].s == "b");
+        c.swap(b);
+        assert(c.size() == 3 && b.size() == 2);
+        b = c;
+        assert(b == c);
+        c.assign(1, Tracked("z"));
+        c.insert(c.begin(), 2, c[0]);
+        assert(c.size() == 3 && c[0].s == "z" && c[2].s == "z");
+        assert(live == 6);
+    }
+    assert(live == 0);
+
+    {
+        // 参数引用自身的元素，扩容时不能先把它搬走
+        Marcus::small_vector<std::string, 2> v{std::string(40, 'a'), "b"};
+        v.push_back(v[0]);
+        assert(v.size() == 3 && v[2] == std::string(40, 'a'));
+        v.emplace_back(v[1]);
+        v.push_back(v[3]);
+        assert(v.size() == 5 && v[3] == "b" && v[4] == "b");
+        v.resize(v.capacity() + 1, v[0]);
+        assert(v.back() == v[0] && v.back().size() == 40);
+
+        Marcus::small_vector<std::string, 4> w{"x", "y", "z"};
+        w.insert(w.begin() + 1, w.begin(), w.end());
+        assert((w == Marcus::small_vector<std::string, 4>{"x", "x", "y", "z",
+                                                          "y", "z"}));
+        w.reserve(20);
+        w.insert(w.begin(), w.begin() + 3, w.end());
+        assert((w == Marcus::small_vector<std::string, 4>{
+                         "z", "y", "z", "x", "x", "y", "z", "y", "z"}));
+    }
+
+    {
+        // 扩容时搬动元素抛出，原来的元素和容量都不变
+        struct Fragile {
+            std::string s;
+            int *copies_left;
+
+            Fragile(std::string x, int *n) : s(std::move(x)), copies_left(n) {}
+
+            Fragile(const Fragile &that)
+                : s(that.s), copies_left(that.copies_left) {
+                if (*copies_left >= 0 && (*copies_left)-- == 0) {
+                    throw 1;
+                }
+            }
+        };
+        int copies_left = -1;
+        Marcus::small_vector<Fragile, 2> v;
+        v.emplace_back(std::string(32, 'a'), &copies_left);
+        v.emplace_back(std::string(32, 'b'), &copies_left);
+        copies_left = 1;
+        bool threw = false;
+        try {
+            v.emplace_back(std::string(32, 'c'), &copies_left);
+        } catch (int) {
+            threw = true;
+        }
+        assert(threw && v.size() == 2 && v.capacity() == 2);
+        copies_left = 1;
+        threw = false;
+        try {
+            v.reserve(10);
+        } catch (int) {
+            threw = true;
+        }
+        assert(threw && v.size() == 2 && v.capacity() == 2);
+        assert(v[0].s == std::string(32, 'a') &&
+               v[1].s == std::string(32, 'b'));
+        copies_left = -1;
+        v.reserve(10);
+        assert(v.capacity() >= 10 && v[1].s == std::string(32, 'b'));
+    }
+
+    printf("sizeof(small_vector<int, 4>) = %zd\n",
+           sizeof(Marcus::small_vector<int, 4>));
+}
@@ -0,0 +1,65 @@
+#include <cassert>
+#include <containers/unordered_map.hpp>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+struct StringHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view s) const noexcept {
+        return std::hash<std::string_view>()(s);
+    }
+};
+
+int main() {
+    std::cout << std::boolalpha;
+    Marcus::unordered_map<std::string, int> table;
+    table["delay"] = 12;
+    if (!table.contains("delay")) {
+        table["delay"] = 32;
+    }
+
+    table["timeout"] = 42;
+
+    for (auto it = table.begin(); it != table.end(); ++it) {
+        std::cout << it->first << "=" << it->second << std::endl;
+    }
+
+    std::cout << "at(delay)" << table.at("delay") << std::endl;
+    std::cout << "size: " << table.size() << std::endl;
+
+    Marcus::unordered_map<int, int> squares;
+    squares.reserve(1000);
+    std::size_t buckets = squares.bucket_count();
+    for (int i = 0; i < 1000; i++) {
+        squares.emplace(i, i * i);
+    }
+    assert(squares.bucket_count() == buckets);
+    assert(squares.size() == 1000 && squares.at(31) == 961);
+    assert(!squares.insert({31, 0}).second && squares[31] == 961);
+    for (int i = 0; i < 1000; i += 2) {
+        assert(squares.erase(i) == 1);
+    }
+    assert(squares.size() == 500 && !squares.contains(30));
+    std::size_t n = 0;
+    for (auto &[k, v]: squares) {
+        assert(k % 2 == 1 && v == k * k);
+        n++;
+    }
+    assert(n == 500);
+    Marcus::unordered_map<int, int> copy = squares;
+    assert(copy == squares);
+    copy.rehash(0);
+    assert(copy == squares && copy.bucket_count() < buckets);
+    std::cout << "load_factor: " << copy.load_factor() << std::endl;
+
+    // 透明哈希：用 string_view 查找不会构造临时的 std::string
+    Marcus::unordered_map<std::string, int, StringHash, std::equal_to<>> words{
+        {"alpha", 1}, {"beta", 2}};
+    std::string_view key = "beta";
+    assert(words.find(key) != words.end() && words.at(key) == 2);
+    assert(words.erase(std::string_view("alpha")) == 1);
+    assert(!words.contains(std::string_view("alpha")));
+    std::cout << "transparent lookup ok" << std::endl;
+}
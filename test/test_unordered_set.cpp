@@ -0,0 +1,31 @@
+#include <cassert>
+#include <containers/unordered_set.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main() {
+    Marcus::unordered_set<std::string> names = {"foo", "bar", "baz"};
+    names.insert("foo");
+    names.emplace("qux");
+    for (const std::string &name: names) {
+        std::cout << name << std::endl;
+    }
+    assert(names.size() == 4 && names.contains("qux"));
+    assert(names.erase("bar") == 1 && names.count("bar") == 0);
+
+    // 批量插入：先按元素个数预留，只扩容一次
+    std::vector<int> values;
+    for (int i = 0; i < 10000; i++) {
+        values.push_back(i % 5000);
+    }
+    Marcus::unordered_set<int> ints(values.begin(), values.end());
+    assert(ints.size() == 5000);
+    for (int i = 0; i < 5000; i++) {
+        assert(ints.contains(i));
+    }
+    assert(!ints.contains(5000));
+    ints.clear();
+    assert(ints.empty() && ints.begin() == ints.end());
+    std::cout << "size: " << names.size() << std::endl;
+}
@@ -1,5 +1,32 @@
+#include <cassert>
 #include <containers/vector.hpp>
+#include <memory>
 #include <stdio.h>
+#include <string>
+
+// 只持有 unique_ptr，按字节搬动是安全的
+struct Boxed {
+    std::unique_ptr<int> p;
+
+    explicit Boxed(int x) : p(std::make_unique<int>(x)) {}
+};
+
+template <>
+struct Marcus::is_trivially_relocatable<Boxed> : std::true_type {};
+
+// 复制构造可能抛出，第 copies_left 次之后抛出
+struct Fragile {
+    static inline int copies_left = -1;
+    std::string s;
+
+    explicit Fragile(std::string x) : s(std::move(x)) {}
+
+    Fragile(const Fragile &other) : s(other.s) {
+        if (copies_left >= 0 && copies_left-- == 0) {
+            throw 1;
+        }
+    }
+};
 
 int main() {
     Marcus::vector<int> arr;
@@ -22,4 +49,87 @@ int main() {
     printf("arr.size() = %zd\n", arr.size());
     printf("bar.size() = %zd\n", bar.size());
     printf("sizeof(vector) = %zd\n", sizeof(Marcus::vector<int>));
+
+    Marcus::vector<Boxed> boxes;
+    for (int i = 0; i < 100; i++) {
+        boxes.emplace_back(i);
+    }
+    boxes.emplace(boxes.begin() + 10, -1);
+    boxes.erase(boxes.begin(), boxes.begin() + 5);
+    boxes.shrink_to_fit();
+    assert(boxes.size() == 96);
+    assert(*boxes[5].p == -1);
+    assert(*boxes[6].p == 10);
+    assert(*boxes.back().p == 99);
+
+    Marcus::vector<std::string> strs;
+    for (int i = 0; i < 50; i++) {
+        strs.insert(strs.begin(), std::string(32, char('a' + i % 26)));
+    }
+    strs.erase(strs.begin() + 1);
+    assert(strs.size() == 49);
+    assert(strs[0] == std::string(32, char('a' + 49 % 26)));
+    assert(strs[1] == std::string(32, char('a' + 47 % 26)));
+    printf("relocation ok\n");
+
+    // 满了才扩容，不提前一格
+    Marcus::vector<int> exact;
+    exact.reserve(4);
+    for (int i = 0; i < 4; i++) {
+        exact.push_back(i);
+    }
+    assert(exact.capacity() == 4);
+    exact.push_back(4);
+    assert(exact.capacity() == 8);
+
+    Marcus::vector<int, std::allocator<int>, Marcus::vector_growth_x1_5> x15;
+    x15.reserve(10);
+    x15.resize(11);
+    assert(x15.capacity() == 15);
+
+    Marcus::vector<int, std::allocator<int>, Marcus::vector_growth_fixed<100>>
+        fixed;
+    for (int i = 0; i < 250; i++) {
+        fixed.push_back(i);
+    }
+    assert(fixed.capacity() == 300);
+
+    Marcus::vector<char, std::allocator<char>,
+                   Marcus::vector_growth_at_least<>>
+        at_least;
+    at_least.reserve(129);
+    assert(at_least.capacity() == 160);
+    for (int i = 0; i < 1000; i++) {
+        at_least.push_back(char(i));
+    }
+    assert(at_least.size() == 1000 && at_least[999] == char(999));
+    at_least.resize(129);
+    at_least.shrink_to_fit();
+    assert(at_least.capacity() == 129);
+    const char *shrunk = at_least.data();
+    at_least.shrink_to_fit();
+    assert(at_least.data() == shrunk && at_least[128] == char(128));
+    printf("growth policy ok\n");
+
+    // 扩容时搬动元素抛出，原来的元素和容量都不变
+    Marcus::vector<Fragile> fragile;
+    fragile.reserve(4);
+    for (int i = 0; i < 4; i++) {
+        fragile.push_back(Fragile(std::string(32, char('a' + i))));
+    }
+    Fragile::copies_left = 2;
+    bool threw = false;
+    try {
+        fragile.reserve(100);
+    } catch (int) {
+        threw = true;
+    }
+    Fragile::copies_left = -1;
+    assert(threw && fragile.capacity() == 4 && fragile.size() == 4);
+    for (int i = 0; i < 4; i++) {
+        assert(fragile[i].s == std::string(32, char('a' + i)));
+    }
+    fragile.reserve(100);
+    assert(fragile.capacity() == 100 && fragile[3].s == std::string(32, 'd'));
+    printf("strong reallocate ok\n");
 }